@@ -0,0 +1,29 @@
+CC=gcc
+PRESENT_DIRECTORY = $(filter %/, $(wildcard ./*/))
+CFLAGS=-g -D_GNU_SOURCE -Wall -std=c11
+LDFLAGS=-pthread
+FLAGS=$(CFLAGS) $(LDFLAGS)
+SOURCES=logger.c argument_check.c scoped_lock.c alloc_check.c btree.c btree_test.c ref_count.c iterator.c
+OBJECTS=$(notdir $(SOURCES:.c=.o))
+TARGET=btree_test
+DEPS=$(addprefix -I, $(PRESENT_DIRECTORY))
+VPATH=./misc/ ./io/  ./data_structures/ ./data_structures/tests ./threading/ ./string/ ./memory/
+
+all: $(TARGET)
+
+$(TARGET): $(OBJECTS)
+	$(CC) $(CFLAGS) $(DEPS) $(OBJECTS) -o $(TARGET) $(LDFLAGS)
+
+%.o: %.c
+	$(CC) $(CFLAGS) $(DEPS) -c $< -o $@
+
+.PHONY: depend clean
+
+depend: $(SOURCES)
+	makedepend $(DEPS) $^
+
+clean: 
+	$(RM) $(TARGET) *.o *~
+
+# DO NOT DELETE THIS LINE -- make depend depends on it.
+
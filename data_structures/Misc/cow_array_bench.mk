@@ -0,0 +1,29 @@
+CC=gcc
+PRESENT_DIRECTORY = $(filter %/, $(wildcard ./*/))
+CFLAGS=-O2 -g -D_GNU_SOURCE -Wall -std=c11
+LDFLAGS=-pthread
+FLAGS=$(CFLAGS) $(LDFLAGS)
+SOURCES=logger.c argument_check.c scoped_lock.c alloc_check.c list.c cow_array.c hazard.c node_pool.c cow_array_bench.c string_buffer.c ref_count.c iterator.c sort.c
+OBJECTS=$(notdir $(SOURCES:.c=.o))
+TARGET=cow_array_bench
+DEPS=$(addprefix -I, $(PRESENT_DIRECTORY))
+VPATH=./misc/ ./io/  ./data_structures/ ./data_structures/tests ./threading/ ./string/ ./memory/
+
+all: $(TARGET)
+
+$(TARGET): $(OBJECTS)
+	$(CC) $(CFLAGS) $(DEPS) $(OBJECTS) -o $(TARGET) $(LDFLAGS)
+
+%.o: %.c
+	$(CC) $(CFLAGS) $(DEPS) -c $< -o $@
+
+.PHONY: depend clean
+
+depend: $(SOURCES)
+	makedepend $(DEPS) $^
+
+clean: 
+	$(RM) $(TARGET) *.o *~
+
+# DO NOT DELETE THIS LINE -- make depend depends on it.
+
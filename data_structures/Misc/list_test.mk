@@ -3,7 +3,7 @@ PRESENT_DIRECTORY = $(filter %/, $(wildcard ./*/))
 CFLAGS=-g -D_GNU_SOURCE -Wall -std=c11
 LDFLAGS=-pthread
 FLAGS=$(CFLAGS) $(LDFLAGS)
-SOURCES=list.c list_test.c logger.c scoped_lock.c alloc_check.c iterator.c string_buffer.c argument_check.c ref_count.c
+SOURCES=list.c hazard.c node_pool.c list_test.c logger.c scoped_lock.c alloc_check.c iterator.c string_buffer.c argument_check.c ref_count.c sort.c
 OBJECTS=$(notdir $(SOURCES:.c=.o))
 TARGET=list_test
 VPATH=./misc/ ./data_structures/ ./data_structures/tests ./io/ ./threading/ ./string/ ./memory/
@@ -3,7 +3,7 @@ PRESENT_DIRECTORY = $(filter %/, $(wildcard ./*/))
 CFLAGS=-g -D_GNU_SOURCE -Wall -std=c11
 LDFLAGS=-pthread
 FLAGS=$(CFLAGS) $(LDFLAGS)
-SOURCES=stack.c stack_test.c list.c iterator.c logger.c argument_check.c alloc_check.c scoped_lock.c hazard.c thread_pool.c priority_queue.c events.c
+SOURCES=stack.c stack_test.c list.c node_pool.c iterator.c logger.c argument_check.c alloc_check.c scoped_lock.c hazard.c thread_pool.c priority_queue.c events.c ref_count.c sort.c blocking_queue.c heap.c
 OBJECTS=$(notdir $(SOURCES:.c=.o))
 TARGET=stack_test
 DEPS=$(addprefix -I, $(PRESENT_DIRECTORY))
@@ -0,0 +1,1073 @@
+#include "btree.h"
+
+#include "../misc/alloc_check.h"
+#include "../io/logger.h"
+#include "../threading/scoped_lock.h"
+#include "../memory/ref_count.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+/*
+	Every node is the same size, a whole amount of cache lines, and is aligned to a cache line. An inner
+	node holds count keys and count + 1 children, where keys[i] is the smallest key in the subtree of
+	children[i + 1]. A leaf holds count pairs, with the keys and values in separate arrays so that a search
+	only touches the keys.
+
+	Insertion and removal are both done in a single pass from the root: on the way down, a full child is
+	split before we descend into it, and a child at the minimum is refilled (by borrowing from or merging
+	with a sibling) before we descend into it. Hence a node never needs to be revisited on the way back up,
+	and a failed allocation never leaves the tree half-modified.
+
+	The separators in inner nodes are always keys which are still in the tree, so that the comparator is
+	never invoked on a key which has been removed (and possibly destroyed).
+*/
+#define C_UTILS_BTREE_CACHE_LINE 64
+
+#ifdef C_UTILS_BTREE_NODE_CACHE_LINES
+#define C_UTILS_BTREE_NODE_SIZE (C_UTILS_BTREE_NODE_CACHE_LINES * C_UTILS_BTREE_CACHE_LINE)
+#else
+#define C_UTILS_BTREE_NODE_SIZE (4 * C_UTILS_BTREE_CACHE_LINE)
+#endif
+
+struct c_utils_btree_node {
+	/// The amount of keys.
+	uint32_t count;
+	bool leaf;
+};
+
+#define C_UTILS_BTREE_INNER_KEYS \
+	((C_UTILS_BTREE_NODE_SIZE - sizeof(struct c_utils_btree_node) - sizeof(void *)) / (2 * sizeof(void *)))
+
+#define C_UTILS_BTREE_LEAF_KEYS \
+	((C_UTILS_BTREE_NODE_SIZE - sizeof(struct c_utils_btree_node) - 2 * sizeof(void *)) / (2 * sizeof(void *)))
+
+/// A node with no more than this amount of keys must be refilled before we remove from beneath it.
+#define C_UTILS_BTREE_INNER_MIN (C_UTILS_BTREE_INNER_KEYS / 2)
+
+#define C_UTILS_BTREE_LEAF_MIN (C_UTILS_BTREE_LEAF_KEYS / 2)
+
+struct c_utils_btree_inner {
+	struct c_utils_btree_node node;
+	void *keys[C_UTILS_BTREE_INNER_KEYS];
+	struct c_utils_btree_node *children[C_UTILS_BTREE_INNER_KEYS + 1];
+};
+
+struct c_utils_btree_leaf {
+	struct c_utils_btree_node node;
+	/// Siblings, used for range scans.
+	struct c_utils_btree_leaf *prev;
+	struct c_utils_btree_leaf *next;
+	void *keys[C_UTILS_BTREE_LEAF_KEYS];
+	void *values[C_UTILS_BTREE_LEAF_KEYS];
+};
+
+_Static_assert(sizeof(struct c_utils_btree_inner) <= C_UTILS_BTREE_NODE_SIZE, "Inner node does not fit in it's cache lines!");
+_Static_assert(sizeof(struct c_utils_btree_leaf) <= C_UTILS_BTREE_NODE_SIZE, "Leaf does not fit in it's cache lines!");
+_Static_assert(C_UTILS_BTREE_LEAF_KEYS >= 4, "Nodes must be large enough to hold at least 4 keys!");
+
+struct c_utils_btree {
+	/// The root, which is a leaf until the first split.
+	struct c_utils_btree_node *root;
+	/// The first and last leaves, for iteration.
+	struct c_utils_btree_leaf *first;
+	struct c_utils_btree_leaf *last;
+	/// The amount of key-value pairs.
+	size_t size;
+	/// Bumped on each modification, so that iterators can detect it.
+	size_t version;
+	/// Orders the keys.
+	int (*comparator)(const void *, const void *);
+	/// RWLock to enforce thread-safety.
+	struct c_utils_scoped_lock *lock;
+	/// Configuration
+	struct c_utils_btree_conf conf;
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						BTree Node Helper Functions                                 //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static struct c_utils_btree_leaf *create_leaf(struct c_utils_btree *tree);
+
+static struct c_utils_btree_inner *create_inner(struct c_utils_btree *tree);
+
+static void destroy_node(struct c_utils_btree *tree, struct c_utils_btree_node *node, bool delete);
+
+static size_t lower_index(struct c_utils_btree *tree, void **keys, size_t count, const void *key);
+
+static size_t upper_index(struct c_utils_btree *tree, void **keys, size_t count, const void *key);
+
+static struct c_utils_btree_leaf *find_leaf(struct c_utils_btree *tree, const void *key);
+
+static bool is_full(struct c_utils_btree_node *node);
+
+static bool is_thin(struct c_utils_btree_node *node);
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						BTree Modification Helper Functions                         //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static bool add_pair(struct c_utils_btree *tree, void *key, void *value);
+
+static bool split_child(struct c_utils_btree *tree, struct c_utils_btree_inner *parent, size_t index);
+
+static void *remove_pair(struct c_utils_btree *tree, const void *key, void **removed_key);
+
+static size_t refill_child(struct c_utils_btree *tree, struct c_utils_btree_inner *parent, size_t index);
+
+static void merge_children(struct c_utils_btree *tree, struct c_utils_btree_inner *parent, size_t index);
+
+static bool bulk_load(struct c_utils_btree *tree, void **keys, void **values, size_t len);
+
+static void btree_destroy(void *tree);
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						BTree Iterator Functions                                    //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static struct c_utils_iterator *create_iterator(struct c_utils_btree *tree);
+
+static void *head(void *instance, void *pos);
+
+static void *tail(void *instance, void *pos);
+
+static void *next(void *instance, void *pos);
+
+static void *prev(void *instance, void *pos);
+
+static void *curr(void *instance, void *pos);
+
+static void finalize(void *instance, void *pos);
+
+static bool check_version(struct c_utils_btree *tree, struct _c_utils_btree_iterator_position *pos);
+
+static void *set_current(struct _c_utils_btree_iterator_position *pos, struct c_utils_btree_leaf *leaf, size_t index);
+
+static void *set_before(struct _c_utils_btree_iterator_position *pos, struct c_utils_btree_leaf *leaf, size_t index);
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						BTree Core Functions                                        //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+struct c_utils_btree *c_utils_btree_create(int (*comparator)(const void *, const void *)) {
+	struct c_utils_btree_conf conf = { 0 };
+	return c_utils_btree_create_conf(comparator, &conf);
+}
+
+struct c_utils_btree *c_utils_btree_create_conf(int (*comparator)(const void *, const void *), struct c_utils_btree_conf *conf) {
+	if(!conf)
+		return NULL;
+
+	if(!comparator) {
+		C_UTILS_LOG_ERROR(conf->logger, "A comparator is required to order the keys!");
+		return NULL;
+	}
+
+	if(!conf->callbacks.destructors.value)
+		conf->callbacks.destructors.value = free;
+
+	struct c_utils_btree *tree;
+	if(conf->flags & C_UTILS_BTREE_RC_INSTANCE) {
+		struct c_utils_ref_count_conf rc_conf =
+		{
+			.destructor = btree_destroy,
+			.logger = conf->logger
+		};
+
+		tree = c_utils_ref_create_conf(sizeof(*tree), &rc_conf);
+	} else {
+		tree = malloc(sizeof(*tree));
+	}
+
+	if(!tree) {
+		C_UTILS_LOG_ASSERT(conf->logger, "Failed to create btree!");
+		goto err;
+	}
+
+	tree->conf = *conf;
+	tree->comparator = comparator;
+	tree->size = 0;
+	tree->version = 0;
+
+	struct c_utils_btree_leaf *leaf = create_leaf(tree);
+	if(!leaf)
+		goto err_root;
+
+	tree->root = &leaf->node;
+	tree->first = tree->last = leaf;
+
+	tree->lock = conf->flags & C_UTILS_BTREE_CONCURRENT ?
+		c_utils_scoped_lock_rwlock(NULL, conf->logger) : c_utils_scoped_lock_no_op();
+	if(!tree->lock) {
+		C_UTILS_LOG_ERROR(conf->logger, "Was unable to create the scoped_lock!");
+		goto err_lock;
+	}
+
+	return tree;
+
+	err_lock:
+		free(leaf);
+	err_root:
+		if(conf->flags & C_UTILS_BTREE_RC_INSTANCE)
+			c_utils_ref_destroy(tree);
+		else
+			free(tree);
+	err:
+		return NULL;
+}
+
+struct c_utils_btree *c_utils_btree_create_from(int (*comparator)(const void *, const void *), void **keys, void **values, size_t len) {
+	struct c_utils_btree_conf conf = { 0 };
+	return c_utils_btree_create_from_conf(comparator, keys, values, len, &conf);
+}
+
+struct c_utils_btree *c_utils_btree_create_from_conf(int (*comparator)(const void *, const void *), void **keys, void **values, size_t len, struct c_utils_btree_conf *conf) {
+	if(!conf)
+		return NULL;
+
+	if(len && (!keys || !values)) {
+		C_UTILS_LOG_ERROR(conf->logger, "Keys and values cannot be NULL!");
+		return NULL;
+	}
+
+	for(size_t i = 0; i < len; i++) {
+		if(!keys[i] || !values[i]) {
+			C_UTILS_LOG_ERROR(conf->logger, "This btree does not support NULL keys or values!");
+			return NULL;
+		}
+
+		if(i && comparator && comparator(keys[i - 1], keys[i]) >= 0) {
+			C_UTILS_LOG_ERROR(conf->logger, "Keys must be sorted and unique, but key %zu is not greater than key %zu!", i, i - 1);
+			return NULL;
+		}
+	}
+
+	struct c_utils_btree *tree = c_utils_btree_create_conf(comparator, conf);
+	if(!tree)
+		return NULL;
+
+	if(len && !bulk_load(tree, keys, values, len)) {
+		c_utils_btree_destroy(tree);
+		return NULL;
+	}
+
+	return tree;
+}
+
+bool c_utils_btree_add(struct c_utils_btree *tree, void *key, void *value) {
+	if(!tree)
+		return false;
+
+	if(!key || !value) {
+		C_UTILS_LOG_ERROR(tree->conf.logger, "This btree does not support NULL keys or values!");
+		return false;
+	}
+
+	C_UTILS_SCOPED_WRLOCK(tree->lock)
+		return add_pair(tree, key, value);
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+void *c_utils_btree_get(struct c_utils_btree *tree, const void *key) {
+	if(!tree)
+		return NULL;
+
+	if(!key) {
+		C_UTILS_LOG_ERROR(tree->conf.logger, "This btree does not support NULL keys!");
+		return NULL;
+	}
+
+	C_UTILS_SCOPED_RDLOCK(tree->lock) {
+		struct c_utils_btree_leaf *leaf = find_leaf(tree, key);
+		size_t index = lower_index(tree, leaf->keys, leaf->node.count, key);
+
+		if(index < leaf->node.count && tree->comparator(leaf->keys[index], key) == 0)
+			return leaf->values[index];
+
+		return NULL;
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+void *c_utils_btree_remove(struct c_utils_btree *tree, const void *key) {
+	if(!tree)
+		return NULL;
+
+	if(!key) {
+		C_UTILS_LOG_ERROR(tree->conf.logger, "This btree does not support NULL keys!");
+		return NULL;
+	}
+
+	C_UTILS_SCOPED_WRLOCK(tree->lock) {
+		void *removed_key;
+		return remove_pair(tree, key, &removed_key);
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+bool c_utils_btree_delete(struct c_utils_btree *tree, const void *key) {
+	if(!tree)
+		return false;
+
+	if(!key) {
+		C_UTILS_LOG_ERROR(tree->conf.logger, "This btree does not support NULL keys!");
+		return false;
+	}
+
+	C_UTILS_SCOPED_WRLOCK(tree->lock) {
+		void *removed_key;
+		void *value = remove_pair(tree, key, &removed_key);
+		if(!value)
+			return false;
+
+		if(tree->conf.callbacks.destructors.key)
+			tree->conf.callbacks.destructors.key(removed_key);
+
+		tree->conf.callbacks.destructors.value(value);
+
+		return true;
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+size_t c_utils_btree_size(struct c_utils_btree *tree) {
+	if(!tree)
+		return 0;
+
+	C_UTILS_SCOPED_RDLOCK(tree->lock)
+		return tree->size;
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+struct c_utils_iterator *c_utils_btree_iterator(struct c_utils_btree *tree) {
+	if(!tree)
+		return NULL;
+
+	struct c_utils_iterator *it = create_iterator(tree);
+	if(!it)
+		return NULL;
+
+	// The cursor starts before the first pair, so that the first call to next yields it.
+	C_UTILS_SCOPED_RDLOCK(tree->lock) {
+		struct _c_utils_btree_iterator_position *pos = it->pos;
+		set_before(pos, tree->first, 0);
+		pos->version = tree->version;
+	}
+
+	return it;
+}
+
+struct c_utils_iterator *c_utils_btree_lower_bound(struct c_utils_btree *tree, const void *key) {
+	if(!tree)
+		return NULL;
+
+	if(!key) {
+		C_UTILS_LOG_ERROR(tree->conf.logger, "This btree does not support NULL keys!");
+		return NULL;
+	}
+
+	struct c_utils_iterator *it = create_iterator(tree);
+	if(!it)
+		return NULL;
+
+	/*
+		If every key in the leaf is less than the key, the index is one past the end of the leaf, and the
+		first call to next moves on to the next leaf, whose first key is the bound.
+	*/
+	C_UTILS_SCOPED_RDLOCK(tree->lock) {
+		struct _c_utils_btree_iterator_position *pos = it->pos;
+		struct c_utils_btree_leaf *leaf = find_leaf(tree, key);
+		set_before(pos, leaf, lower_index(tree, leaf->keys, leaf->node.count, key));
+		pos->version = tree->version;
+	}
+
+	return it;
+}
+
+struct c_utils_iterator *c_utils_btree_upper_bound(struct c_utils_btree *tree, const void *key) {
+	if(!tree)
+		return NULL;
+
+	if(!key) {
+		C_UTILS_LOG_ERROR(tree->conf.logger, "This btree does not support NULL keys!");
+		return NULL;
+	}
+
+	struct c_utils_iterator *it = create_iterator(tree);
+	if(!it)
+		return NULL;
+
+	C_UTILS_SCOPED_RDLOCK(tree->lock) {
+		struct _c_utils_btree_iterator_position *pos = it->pos;
+		struct c_utils_btree_leaf *leaf = find_leaf(tree, key);
+		set_before(pos, leaf, upper_index(tree, leaf->keys, leaf->node.count, key));
+		pos->version = tree->version;
+	}
+
+	return it;
+}
+
+void c_utils_btree_destroy(struct c_utils_btree *tree) {
+	if(!tree)
+		return;
+
+	if(tree->conf.flags & C_UTILS_BTREE_RC_INSTANCE) {
+		C_UTILS_REF_DEC(tree);
+		return;
+	}
+
+	btree_destroy(tree);
+	free(tree);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						BTree Node Helper Functions                                 //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static struct c_utils_btree_leaf *create_leaf(struct c_utils_btree *tree) {
+	struct c_utils_btree_leaf *leaf = aligned_alloc(C_UTILS_BTREE_CACHE_LINE, C_UTILS_BTREE_NODE_SIZE);
+	if(!leaf) {
+		C_UTILS_LOG_ERROR(tree->conf.logger, "aligned_alloc: \"%s\"", strerror(errno));
+		return NULL;
+	}
+
+	leaf->node.count = 0;
+	leaf->node.leaf = true;
+	leaf->prev = leaf->next = NULL;
+
+	return leaf;
+}
+
+static struct c_utils_btree_inner *create_inner(struct c_utils_btree *tree) {
+	struct c_utils_btree_inner *inner = aligned_alloc(C_UTILS_BTREE_CACHE_LINE, C_UTILS_BTREE_NODE_SIZE);
+	if(!inner) {
+		C_UTILS_LOG_ERROR(tree->conf.logger, "aligned_alloc: \"%s\"", strerror(errno));
+		return NULL;
+	}
+
+	inner->node.count = 0;
+	inner->node.leaf = false;
+
+	return inner;
+}
+
+/// Frees the node and it's subtree. If delete is true, the destructors are invoked on each pair.
+static void destroy_node(struct c_utils_btree *tree, struct c_utils_btree_node *node, bool delete) {
+	if(node->leaf) {
+		struct c_utils_btree_leaf *leaf = (struct c_utils_btree_leaf *) node;
+		for(size_t i = 0; delete && i < node->count; i++) {
+			if(tree->conf.callbacks.destructors.key)
+				tree->conf.callbacks.destructors.key(leaf->keys[i]);
+
+			tree->conf.callbacks.destructors.value(leaf->values[i]);
+		}
+	} else {
+		struct c_utils_btree_inner *inner = (struct c_utils_btree_inner *) node;
+		for(size_t i = 0; i <= node->count; i++)
+			destroy_node(tree, inner->children[i], delete);
+	}
+
+	free(node);
+}
+
+/// Returns the index of the first key which is not less than the key.
+static size_t lower_index(struct c_utils_btree *tree, void **keys, size_t count, const void *key) {
+	size_t low = 0, high = count;
+
+	while(low < high) {
+		size_t mid = (low + high) / 2;
+		if(tree->comparator(keys[mid], key) < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+/// Returns the index of the first key which is greater than the key.
+static size_t upper_index(struct c_utils_btree *tree, void **keys, size_t count, const void *key) {
+	size_t low = 0, high = count;
+
+	while(low < high) {
+		size_t mid = (low + high) / 2;
+		if(tree->comparator(keys[mid], key) <= 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+/// Returns the leaf the key belongs in. As a separator is the smallest key of the subtree to it's right, equal keys go right.
+static struct c_utils_btree_leaf *find_leaf(struct c_utils_btree *tree, const void *key) {
+	struct c_utils_btree_node *node = tree->root;
+
+	while(!node->leaf) {
+		struct c_utils_btree_inner *inner = (struct c_utils_btree_inner *) node;
+		node = inner->children[upper_index(tree, inner->keys, node->count, key)];
+	}
+
+	return (struct c_utils_btree_leaf *) node;
+}
+
+static bool is_full(struct c_utils_btree_node *node) {
+	return node->count == (node->leaf ? C_UTILS_BTREE_LEAF_KEYS : C_UTILS_BTREE_INNER_KEYS);
+}
+
+static bool is_thin(struct c_utils_btree_node *node) {
+	return node->count <= (node->leaf ? C_UTILS_BTREE_LEAF_MIN : C_UTILS_BTREE_INNER_MIN);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						BTree Modification Helper Functions                         //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+/// Must be called while holding the writer lock.
+static bool add_pair(struct c_utils_btree *tree, void *key, void *value) {
+	// The root is split by giving it a new, empty parent, which is the only way the tree grows taller.
+	if(is_full(tree->root)) {
+		struct c_utils_btree_inner *root = create_inner(tree);
+		if(!root)
+			return false;
+
+		root->children[0] = tree->root;
+		if(!split_child(tree, root, 0)) {
+			free(root);
+			return false;
+		}
+
+		tree->root = &root->node;
+	}
+
+	struct c_utils_btree_node *node = tree->root;
+	while(!node->leaf) {
+		struct c_utils_btree_inner *inner = (struct c_utils_btree_inner *) node;
+		size_t index = upper_index(tree, inner->keys, node->count, key);
+
+		if(is_full(inner->children[index])) {
+			if(!split_child(tree, inner, index))
+				return false;
+
+			// The new separator is the smallest key of the new right half.
+			if(tree->comparator(key, inner->keys[index]) >= 0)
+				index++;
+		}
+
+		node = inner->children[index];
+	}
+
+	struct c_utils_btree_leaf *leaf = (struct c_utils_btree_leaf *) node;
+	size_t index = lower_index(tree, leaf->keys, node->count, key);
+	if(index < node->count && tree->comparator(leaf->keys[index], key) == 0)
+		return false;
+
+	memmove(leaf->keys + index + 1, leaf->keys + index, (node->count - index) * sizeof(void *));
+	memmove(leaf->values + index + 1, leaf->values + index, (node->count - index) * sizeof(void *));
+	leaf->keys[index] = key;
+	leaf->values[index] = value;
+	node->count++;
+
+	tree->size++;
+	tree->version++;
+
+	return true;
+}
+
+/// Splits the full child at the index into two, adding the new right half to the parent, which must not be full.
+static bool split_child(struct c_utils_btree *tree, struct c_utils_btree_inner *parent, size_t index) {
+	struct c_utils_btree_node *child = parent->children[index];
+	struct c_utils_btree_node *right;
+	void *separator;
+	size_t half = child->count / 2;
+
+	if(child->leaf) {
+		struct c_utils_btree_leaf *left_leaf = (struct c_utils_btree_leaf *) child;
+		struct c_utils_btree_leaf *right_leaf = create_leaf(tree);
+		if(!right_leaf)
+			return false;
+
+		right_leaf->node.count = child->count - half;
+		memcpy(right_leaf->keys, left_leaf->keys + half, right_leaf->node.count * sizeof(void *));
+		memcpy(right_leaf->values, left_leaf->values + half, right_leaf->node.count * sizeof(void *));
+		child->count = half;
+
+		right_leaf->prev = left_leaf;
+		right_leaf->next = left_leaf->next;
+		if(left_leaf->next)
+			left_leaf->next->prev = right_leaf;
+		else
+			tree->last = right_leaf;
+		left_leaf->next = right_leaf;
+
+		separator = right_leaf->keys[0];
+		right = &right_leaf->node;
+	} else {
+		// The middle key moves up into the parent, rather than being copied as it is for leaves.
+		struct c_utils_btree_inner *left_inner = (struct c_utils_btree_inner *) child;
+		struct c_utils_btree_inner *right_inner = create_inner(tree);
+		if(!right_inner)
+			return false;
+
+		right_inner->node.count = child->count - half - 1;
+		memcpy(right_inner->keys, left_inner->keys + half + 1, right_inner->node.count * sizeof(void *));
+		memcpy(right_inner->children, left_inner->children + half + 1, (right_inner->node.count + 1) * sizeof(void *));
+		separator = left_inner->keys[half];
+		child->count = half;
+
+		right = &right_inner->node;
+	}
+
+	size_t count = parent->node.count;
+	memmove(parent->keys + index + 1, parent->keys + index, (count - index) * sizeof(void *));
+	memmove(parent->children + index + 2, parent->children + index + 1, (count - index) * sizeof(void *));
+	parent->keys[index] = separator;
+	parent->children[index + 1] = right;
+	parent->node.count++;
+
+	return true;
+}
+
+/*
+	Removes the pair, returning it's value, or NULL if not found. Must be called while holding the writer lock.
+
+	If the key is also a separator, it is the smallest key in the subtree to the separator's right, and so it is the
+	first key of the leaf we end up in. Once it is removed, the separator is replaced with the leaf's new first key.
+*/
+static void *remove_pair(struct c_utils_btree *tree, const void *key, void **removed_key) {
+	struct c_utils_btree_inner *separator_node = NULL;
+	size_t separator_index = 0;
+	struct c_utils_btree_node *node = tree->root;
+
+	while(!node->leaf) {
+		struct c_utils_btree_inner *inner = (struct c_utils_btree_inner *) node;
+		size_t index = upper_index(tree, inner->keys, node->count, key);
+
+		if(is_thin(inner->children[index]))
+			index = refill_child(tree, inner, index);
+
+		// Refilling may have changed our keys, so the separator is only checked for afterwards.
+		if(index > 0 && tree->comparator(inner->keys[index - 1], key) == 0) {
+			separator_node = inner;
+			separator_index = index - 1;
+		}
+
+		node = inner->children[index];
+	}
+
+	// Merging the root's only two children leaves it without any keys, so it's only child becomes the root.
+	if(!tree->root->leaf && tree->root->count == 0) {
+		struct c_utils_btree_node *root = tree->root;
+		tree->root = ((struct c_utils_btree_inner *) root)->children[0];
+		free(root);
+	}
+
+	struct c_utils_btree_leaf *leaf = (struct c_utils_btree_leaf *) node;
+	size_t index = lower_index(tree, leaf->keys, node->count, key);
+	if(index == node->count || tree->comparator(leaf->keys[index], key) != 0)
+		return NULL;
+
+	*removed_key = leaf->keys[index];
+	void *value = leaf->values[index];
+
+	memmove(leaf->keys + index, leaf->keys + index + 1, (node->count - index - 1) * sizeof(void *));
+	memmove(leaf->values + index, leaf->values + index + 1, (node->count - index - 1) * sizeof(void *));
+	node->count--;
+
+	if(separator_node)
+		separator_node->keys[separator_index] = leaf->keys[0];
+
+	tree->size--;
+	tree->version++;
+
+	return value;
+}
+
+/*
+	Ensures the child at the index has more than the minimum amount of keys, by borrowing a key from a sibling
+	which can spare one, or otherwise merging with a sibling. Returns the index of the child afterwards, which
+	changes if it was merged into it's left sibling.
+*/
+static size_t refill_child(struct c_utils_btree *tree, struct c_utils_btree_inner *parent, size_t index) {
+	struct c_utils_btree_node *child = parent->children[index];
+	struct c_utils_btree_node *left = index > 0 ? parent->children[index - 1] : NULL;
+	struct c_utils_btree_node *right = index < parent->node.count ? parent->children[index + 1] : NULL;
+
+	if(left && !is_thin(left)) {
+		if(child->leaf) {
+			struct c_utils_btree_leaf *to = (struct c_utils_btree_leaf *) child, *from = (struct c_utils_btree_leaf *) left;
+			memmove(to->keys + 1, to->keys, child->count * sizeof(void *));
+			memmove(to->values + 1, to->values, child->count * sizeof(void *));
+			to->keys[0] = from->keys[left->count - 1];
+			to->values[0] = from->values[left->count - 1];
+			parent->keys[index - 1] = to->keys[0];
+		} else {
+			// The separator rotates down into the child, and the sibling's last key rotates up to replace it.
+			struct c_utils_btree_inner *to = (struct c_utils_btree_inner *) child, *from = (struct c_utils_btree_inner *) left;
+			memmove(to->keys + 1, to->keys, child->count * sizeof(void *));
+			memmove(to->children + 1, to->children, (child->count + 1) * sizeof(void *));
+			to->keys[0] = parent->keys[index - 1];
+			to->children[0] = from->children[left->count];
+			parent->keys[index - 1] = from->keys[left->count - 1];
+		}
+
+		left->count--;
+		child->count++;
+	} else if(right && !is_thin(right)) {
+		if(child->leaf) {
+			struct c_utils_btree_leaf *to = (struct c_utils_btree_leaf *) child, *from = (struct c_utils_btree_leaf *) right;
+			to->keys[child->count] = from->keys[0];
+			to->values[child->count] = from->values[0];
+			memmove(from->keys, from->keys + 1, (right->count - 1) * sizeof(void *));
+			memmove(from->values, from->values + 1, (right->count - 1) * sizeof(void *));
+			parent->keys[index] = from->keys[0];
+		} else {
+			struct c_utils_btree_inner *to = (struct c_utils_btree_inner *) child, *from = (struct c_utils_btree_inner *) right;
+			to->keys[child->count] = parent->keys[index];
+			to->children[child->count + 1] = from->children[0];
+			parent->keys[index] = from->keys[0];
+			memmove(from->keys, from->keys + 1, (right->count - 1) * sizeof(void *));
+			memmove(from->children, from->children + 1, right->count * sizeof(void *));
+		}
+
+		right->count--;
+		child->count++;
+	} else if(left) {
+		merge_children(tree, parent, index - 1);
+		index--;
+	} else {
+		merge_children(tree, parent, index);
+	}
+
+	return index;
+}
+
+/// Merges the child at the index with it's right sibling. Both must be at or below the minimum, so they fit in one node.
+static void merge_children(struct c_utils_btree *tree, struct c_utils_btree_inner *parent, size_t index) {
+	struct c_utils_btree_node *left = parent->children[index];
+	struct c_utils_btree_node *right = parent->children[index + 1];
+
+	if(left->leaf) {
+		struct c_utils_btree_leaf *to = (struct c_utils_btree_leaf *) left, *from = (struct c_utils_btree_leaf *) right;
+		memcpy(to->keys + left->count, from->keys, right->count * sizeof(void *));
+		memcpy(to->values + left->count, from->values, right->count * sizeof(void *));
+		left->count += right->count;
+
+		to->next = from->next;
+		if(from->next)
+			from->next->prev = to;
+		else
+			tree->last = to;
+	} else {
+		// The separator between them is pulled down between their keys.
+		struct c_utils_btree_inner *to = (struct c_utils_btree_inner *) left, *from = (struct c_utils_btree_inner *) right;
+		to->keys[left->count] = parent->keys[index];
+		memcpy(to->keys + left->count + 1, from->keys, right->count * sizeof(void *));
+		memcpy(to->children + left->count + 1, from->children, (right->count + 1) * sizeof(void *));
+		left->count += right->count + 1;
+	}
+
+	size_t count = parent->node.count;
+	memmove(parent->keys + index, parent->keys + index + 1, (count - index - 1) * sizeof(void *));
+	memmove(parent->children + index + 1, parent->children + index + 2, (count - index - 1) * sizeof(void *));
+	parent->node.count--;
+
+	free(right);
+}
+
+/*
+	Builds the tree bottom-up from sorted pairs. The pairs are spread evenly across as few leaves as possible,
+	then the nodes of each level are spread evenly across as few parents as possible, until one node remains.
+	Spreading evenly keeps every node at or above the minimum. Each node's smallest key is carried up alongside
+	it, as that is the separator it needs in it's parent.
+*/
+static bool bulk_load(struct c_utils_btree *tree, void **keys, void **values, size_t len) {
+	size_t count = (len + C_UTILS_BTREE_LEAF_KEYS - 1) / C_UTILS_BTREE_LEAF_KEYS;
+	struct c_utils_btree_node **level;
+	void **smallest;
+
+	C_UTILS_ON_BAD_MALLOC(level, tree->conf.logger, count * sizeof(*level))
+		goto err;
+
+	C_UTILS_ON_BAD_MALLOC(smallest, tree->conf.logger, count * sizeof(*smallest))
+		goto err_smallest;
+
+	struct c_utils_btree_leaf *first = NULL, *prev = NULL;
+	size_t built = 0, consumed = count;
+	for(size_t i = 0, offset = 0; i < count; i++, built++) {
+		struct c_utils_btree_leaf *leaf = create_leaf(tree);
+		if(!leaf)
+			goto err_level;
+
+		leaf->node.count = len / count + (i < len % count);
+		memcpy(leaf->keys, keys + offset, leaf->node.count * sizeof(void *));
+		memcpy(leaf->values, values + offset, leaf->node.count * sizeof(void *));
+		offset += leaf->node.count;
+
+		leaf->prev = prev;
+		if(prev)
+			prev->next = leaf;
+		else
+			first = leaf;
+		prev = leaf;
+
+		level[i] = &leaf->node;
+		smallest[i] = leaf->keys[0];
+	}
+
+	while(count > 1) {
+		size_t parents = (count + C_UTILS_BTREE_INNER_KEYS) / (C_UTILS_BTREE_INNER_KEYS + 1);
+		consumed = 0;
+
+		// Parents are written over the front of the level, which is safe as they never outnumber the children consumed.
+		for(built = 0; built < parents; built++) {
+			struct c_utils_btree_inner *inner = create_inner(tree);
+			if(!inner)
+				goto err_level;
+
+			size_t children = count / parents + (built < count % parents);
+			void *low = smallest[consumed];
+
+			for(size_t j = 0; j < children; j++) {
+				inner->children[j] = level[consumed + j];
+				if(j)
+					inner->keys[j - 1] = smallest[consumed + j];
+			}
+
+			inner->node.count = children - 1;
+			consumed += children;
+
+			level[built] = &inner->node;
+			smallest[built] = low;
+		}
+
+		count = parents;
+	}
+
+	free(tree->root);
+	tree->root = level[0];
+	tree->first = first;
+	tree->last = prev;
+	tree->size = len;
+	tree->version++;
+
+	free(smallest);
+	free(level);
+
+	return true;
+
+	/*
+		Partway through a level, the parents built so far own the children they consumed, and the children from
+		consumed onwards are still unowned.
+	*/
+	err_level:
+		for(size_t i = 0; i < built; i++)
+			destroy_node(tree, level[i], false);
+
+		for(size_t i = consumed; i < count; i++)
+			destroy_node(tree, level[i], false);
+
+		free(smallest);
+	err_smallest:
+		free(level);
+	err:
+		return false;
+}
+
+/// Frees every node, and the lock, but not the tree itself.
+static void btree_destroy(void *instance) {
+	struct c_utils_btree *tree = instance;
+
+	destroy_node(tree, tree->root, tree->conf.flags & C_UTILS_BTREE_DELETE_ON_DESTROY);
+	c_utils_scoped_lock_destroy(tree->lock);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						BTree Iterator Functions                                    //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static struct c_utils_iterator *create_iterator(struct c_utils_btree *tree) {
+	struct c_utils_iterator *it;
+	C_UTILS_ON_BAD_CALLOC(it, tree->conf.logger, sizeof(*it))
+		return NULL;
+
+	C_UTILS_ON_BAD_CALLOC(it->pos, tree->conf.logger, sizeof(struct _c_utils_btree_iterator_position)) {
+		free(it);
+		return NULL;
+	}
+
+	it->handle = tree;
+	it->head = head;
+	it->tail = tail;
+	it->next = next;
+	it->prev = prev;
+	it->curr = curr;
+	it->finalize = finalize;
+
+	// Increment reference count for iterator.
+	if(tree->conf.flags & C_UTILS_BTREE_RC_INSTANCE) {
+		C_UTILS_REF_INC(tree);
+		it->conf.ref_counted = true;
+	}
+
+	return it;
+}
+
+static void *head(void *instance, void *pos) {
+	struct c_utils_btree *tree = instance;
+	struct _c_utils_btree_iterator_position *position = pos;
+
+	// Restarting from either end is always safe, so the cursor also resynchronizes with the tree.
+	C_UTILS_SCOPED_RDLOCK(tree->lock) {
+		position->version = tree->version;
+
+		struct c_utils_btree_leaf *leaf = tree->first;
+		return leaf->node.count ? set_current(position, leaf, 0) : set_before(position, leaf, 0);
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void *tail(void *instance, void *pos) {
+	struct c_utils_btree *tree = instance;
+	struct _c_utils_btree_iterator_position *position = pos;
+
+	C_UTILS_SCOPED_RDLOCK(tree->lock) {
+		position->version = tree->version;
+
+		struct c_utils_btree_leaf *leaf = tree->last;
+		return leaf->node.count ? set_current(position, leaf, leaf->node.count - 1) : set_before(position, leaf, 0);
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void *next(void *instance, void *pos) {
+	struct c_utils_btree *tree = instance;
+	struct _c_utils_btree_iterator_position *position = pos;
+
+	C_UTILS_SCOPED_RDLOCK(tree->lock) {
+		if(!position->leaf || !check_version(tree, position))
+			return NULL;
+
+		struct c_utils_btree_leaf *leaf = position->leaf;
+		size_t index = position->before ? position->index : position->index + 1;
+
+		while(index >= leaf->node.count) {
+			// Past the end, the cursor waits after the last pair, so that prev yields it.
+			if(!leaf->next)
+				return set_before(position, leaf, leaf->node.count);
+
+			leaf = leaf->next;
+			index = 0;
+		}
+
+		return set_current(position, leaf, index);
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void *prev(void *instance, void *pos) {
+	struct c_utils_btree *tree = instance;
+	struct _c_utils_btree_iterator_position *position = pos;
+
+	C_UTILS_SCOPED_RDLOCK(tree->lock) {
+		if(!position->leaf || !check_version(tree, position))
+			return NULL;
+
+		// Whether the cursor is on the pair at index, or just before it, the previous pair is the one before index.
+		struct c_utils_btree_leaf *leaf = position->leaf;
+		size_t index = position->index;
+
+		while(index == 0) {
+			if(!leaf->prev)
+				return set_before(position, leaf, 0);
+
+			leaf = leaf->prev;
+			index = leaf->node.count;
+		}
+
+		return set_current(position, leaf, index - 1);
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void *curr(void *instance, void *pos) {
+	struct _c_utils_btree_iterator_position *position = pos;
+
+	return position->before ? NULL : position->value;
+}
+
+static void finalize(void *instance, void *pos) {
+	free(pos);
+}
+
+/// If the tree was modified since the iterator was created, the leaf we are on may no longer exist.
+static bool check_version(struct c_utils_btree *tree, struct _c_utils_btree_iterator_position *pos) {
+	if(pos->version == tree->version)
+		return true;
+
+	C_UTILS_LOG_WARNING(tree->conf.logger, "The btree was modified during iteration, ending it early!");
+	set_before(pos, NULL, 0);
+
+	return false;
+}
+
+static void *set_current(struct _c_utils_btree_iterator_position *pos, struct c_utils_btree_leaf *leaf, size_t index) {
+	pos->leaf = leaf;
+	pos->index = index;
+	pos->before = false;
+	pos->key = leaf->keys[index];
+	pos->value = leaf->values[index];
+
+	return pos->value;
+}
+
+/// Places the cursor just before the pair at the index, which may be one past the end of the leaf.
+static void *set_before(struct _c_utils_btree_iterator_position *pos, struct c_utils_btree_leaf *leaf, size_t index) {
+	pos->leaf = leaf;
+	pos->index = index;
+	pos->before = true;
+	pos->key = NULL;
+	pos->value = NULL;
+
+	return NULL;
+}
@@ -0,0 +1,163 @@
+#ifndef C_UTILS_BTREE_H
+#define C_UTILS_BTREE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "helpers.h"
+#include "iterator.h"
+#include "../io/logger.h"
+
+/*
+	An ordered map implemented as a B+tree, which can be made thread-safe by passing C_UTILS_BTREE_CONCURRENT
+	on construction, in which case it is guarded by a rwlock like the map.
+
+	Each node is sized to a fixed amount of cache lines (4 by default, see C_UTILS_BTREE_NODE_CACHE_LINES), and
+	stores it's keys contiguously so that a search within a node touches as few lines as possible. Every key-value
+	pair lives in the leaves, which are linked to their siblings, so that a range scan is a walk along the leaves
+	rather than back up and down the tree. Keys are ordered by the comparator given on creation, and are unique.
+*/
+struct c_utils_btree;
+
+/*
+	The iterator is a cursor on a leaf. Like the map's, if the tree is modified while the iterator is alive,
+	the iteration ends early and a warning is logged, as the leaf the cursor is on may have been split or merged.
+	The iterator yields values; the key of the current pair is available through C_UTILS_BTREE_ITERATOR_KEY.
+*/
+struct _c_utils_btree_iterator_position {
+	/// The leaf the cursor is on.
+	struct c_utils_btree_leaf *leaf;
+	/// The index within the leaf.
+	size_t index;
+	/// If set, the cursor sits just before the pair at index, rather than on it, as it does after a seek.
+	bool before;
+	/// The version of the tree when the iterator was created.
+	size_t version;
+	/// The pair the cursor is currently on.
+	void *key;
+	void *value;
+};
+
+#define C_UTILS_BTREE_ITERATOR_KEY(it) ((struct _c_utils_btree_iterator_position *)(it)->pos)->key
+
+#define C_UTILS_BTREE_ITERATOR_VALUE(it) ((struct _c_utils_btree_iterator_position *)(it)->pos)->value
+
+#define C_UTILS_BTREE_FOR_EACH_PAIR(key, value, tree) \
+	for(C_UTILS_AUTO_ITERATOR _this_it = c_utils_btree_iterator(tree); \
+		c_utils_iterator_next(_this_it) && (key = C_UTILS_BTREE_ITERATOR_KEY(_this_it)) && (value = C_UTILS_BTREE_ITERATOR_VALUE(_this_it));)
+
+/// Iterates over every pair whose key is no less than low, in order.
+#define C_UTILS_BTREE_FOR_EACH_FROM(key, value, tree, low) \
+	for(C_UTILS_AUTO_ITERATOR _this_it = c_utils_btree_lower_bound(tree, low); \
+		c_utils_iterator_next(_this_it) && (key = C_UTILS_BTREE_ITERATOR_KEY(_this_it)) && (value = C_UTILS_BTREE_ITERATOR_VALUE(_this_it));)
+
+#define C_UTILS_BTREE_CONCURRENT 1 << 0
+#define C_UTILS_BTREE_RC_INSTANCE 1 << 1
+#define C_UTILS_BTREE_DELETE_ON_DESTROY 1 << 2
+
+struct c_utils_btree_conf {
+	/// Configuration flags
+	int flags;
+	/// Callbacks
+	struct {
+		/// Destructors, invoked on delete, and on destroy if DELETE_ON_DESTROY is flagged.
+		struct {
+			void (*key)(void *);
+			/// Defaults to free.
+			void (*value)(void *);
+		} destructors;
+	} callbacks;
+	/// Logger
+	struct c_utils_logger *logger;
+};
+
+#ifdef NO_C_UTILS_PREFIX
+/*
+	Typedefs
+*/
+typedef struct c_utils_btree btree_t;
+typedef struct c_utils_btree_conf btree_conf_t;
+
+/*
+	Macros
+*/
+#define BTREE_CONCURRENT C_UTILS_BTREE_CONCURRENT
+#define BTREE_RC_INSTANCE C_UTILS_BTREE_RC_INSTANCE
+#define BTREE_DELETE_ON_DESTROY C_UTILS_BTREE_DELETE_ON_DESTROY
+#define BTREE_ITERATOR_KEY(...) C_UTILS_BTREE_ITERATOR_KEY(__VA_ARGS__)
+#define BTREE_ITERATOR_VALUE(...) C_UTILS_BTREE_ITERATOR_VALUE(__VA_ARGS__)
+#define BTREE_FOR_EACH_PAIR(...) C_UTILS_BTREE_FOR_EACH_PAIR(__VA_ARGS__)
+#define BTREE_FOR_EACH_FROM(...) C_UTILS_BTREE_FOR_EACH_FROM(__VA_ARGS__)
+
+/*
+	Functions
+*/
+#define btree_create(...) c_utils_btree_create(__VA_ARGS__)
+#define btree_create_conf(...) c_utils_btree_create_conf(__VA_ARGS__)
+#define btree_create_from(...) c_utils_btree_create_from(__VA_ARGS__)
+#define btree_create_from_conf(...) c_utils_btree_create_from_conf(__VA_ARGS__)
+#define btree_add(...) c_utils_btree_add(__VA_ARGS__)
+#define btree_get(...) c_utils_btree_get(__VA_ARGS__)
+#define btree_remove(...) c_utils_btree_remove(__VA_ARGS__)
+#define btree_delete(...) c_utils_btree_delete(__VA_ARGS__)
+#define btree_size(...) c_utils_btree_size(__VA_ARGS__)
+#define btree_iterator(...) c_utils_btree_iterator(__VA_ARGS__)
+#define btree_lower_bound(...) c_utils_btree_lower_bound(__VA_ARGS__)
+#define btree_upper_bound(...) c_utils_btree_upper_bound(__VA_ARGS__)
+#define btree_destroy(...) c_utils_btree_destroy(__VA_ARGS__)
+#endif
+
+/*
+	Creates a simple B+tree ordered by the comparator. It is not concurrent nor reference counted.
+*/
+struct c_utils_btree *c_utils_btree_create(int (*comparator)(const void *, const void *));
+
+struct c_utils_btree *c_utils_btree_create_conf(int (*comparator)(const void *, const void *), struct c_utils_btree_conf *conf);
+
+/*
+	Bulk loads a B+tree from arrays of keys and values, which must be sorted by the comparator with no duplicate
+	keys. The leaves are filled directly and each level is built on top of the last, so this is O(N) rather than
+	O(N log N) for adding each pair. Returns NULL if the keys are not sorted.
+*/
+struct c_utils_btree *c_utils_btree_create_from(int (*comparator)(const void *, const void *), void **keys, void **values, size_t len);
+
+struct c_utils_btree *c_utils_btree_create_from_conf(int (*comparator)(const void *, const void *), void **keys, void **values, size_t len, struct c_utils_btree_conf *conf);
+
+/*
+	Adds the key-value pair, O(log(N)). Returns false if the key is already present.
+*/
+bool c_utils_btree_add(struct c_utils_btree *tree, void *key, void *value);
+
+void *c_utils_btree_get(struct c_utils_btree *tree, const void *key);
+
+/*
+	Removes the pair, returning the value to the caller, O(log(N)).
+*/
+void *c_utils_btree_remove(struct c_utils_btree *tree, const void *key);
+
+/*
+	Removes the pair, invoking the key and value destructors on it.
+*/
+bool c_utils_btree_delete(struct c_utils_btree *tree, const void *key);
+
+size_t c_utils_btree_size(struct c_utils_btree *tree);
+
+/*
+	Iterates over every pair in order.
+*/
+struct c_utils_iterator *c_utils_btree_iterator(struct c_utils_btree *tree);
+
+/*
+	Returns an iterator positioned just before the first pair whose key is not less than the key, hence the
+	first call to next yields that pair, and the first call to prev yields the last pair before it.
+*/
+struct c_utils_iterator *c_utils_btree_lower_bound(struct c_utils_btree *tree, const void *key);
+
+/*
+	Like lower_bound, but for the first pair whose key is greater than the key.
+*/
+struct c_utils_iterator *c_utils_btree_upper_bound(struct c_utils_btree *tree, const void *key);
+
+void c_utils_btree_destroy(struct c_utils_btree *tree);
+
+#endif /* C_UTILS_BTREE_H */
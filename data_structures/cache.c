@@ -0,0 +1,510 @@
+#include "cache.h"
+#include "map.h"
+
+#include "../misc/alloc_check.h"
+#include "../io/logger.h"
+#include "../threading/scoped_lock.h"
+#include "../memory/ref_count.h"
+
+#include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+
+#define C_UTILS_CACHE_CACHE_LINE 64
+
+struct c_utils_cache_entry {
+	/// Key
+	void *key;
+	/// Value
+	void *value;
+	/// What this entry counts against the capacity.
+	size_t charge;
+	/// The index of this entry in it's shard's ring.
+	size_t index;
+	/// Set on every hit, and cleared by the clock hand as it passes over.
+	atomic_bool referenced;
+};
+
+/*
+	Each shard is aligned to a cache line so that the counters bumped by hits on one shard do not
+	contend with those of another.
+*/
+struct c_utils_cache_shard {
+	/// Map from key to entry, which is not concurrent itself; it is guarded by our lock.
+	struct c_utils_map *index;
+	/*
+		Every entry, in no particular order, swept by the hand. An entry which is removed is replaced by the last,
+		so that the ring stays packed.
+	*/
+	struct c_utils_cache_entry **ring;
+	/// The amount of entries.
+	size_t size;
+	/// The amount of entries the ring can hold before it must grow.
+	size_t ring_capacity;
+	/// The next entry to be considered for eviction.
+	size_t hand;
+	/// The total charge of every entry.
+	size_t charge;
+	/// The maximum total charge.
+	size_t capacity;
+	/// RWLock to enforce thread-safety.
+	struct c_utils_scoped_lock *lock;
+	/// Counters, which are bumped under the reader lock, hence atomic.
+	atomic_size_t hits;
+	atomic_size_t misses;
+	atomic_size_t evictions;
+} __attribute__((aligned(C_UTILS_CACHE_CACHE_LINE)));
+
+struct c_utils_cache {
+	/// The shards, of which there is always at least one.
+	struct c_utils_cache_shard *shards;
+	/// The amount of shards, always a power of two.
+	size_t num_shards;
+	/// log2(num_shards), used to select a shard from a hash.
+	unsigned int shard_bits;
+	/// Configuration
+	struct c_utils_cache_conf conf;
+};
+
+static const size_t default_capacity = 1024;
+
+static const size_t default_shards = 16;
+
+static const size_t default_ring_capacity = 16;
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Cache Helper Functions                                      //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static struct c_utils_cache_shard *get_shard(const struct c_utils_cache *cache, const void *key);
+
+static uint32_t hash_key(const void *key, size_t len);
+
+static size_t get_charge(const struct c_utils_cache *cache, const void *key, const void *value);
+
+static bool reserve_entry(struct c_utils_cache *cache, struct c_utils_cache_shard *shard);
+
+static void evict_entry(struct c_utils_cache *cache, struct c_utils_cache_shard *shard);
+
+static void remove_entry(struct c_utils_cache_shard *shard, struct c_utils_cache_entry *entry);
+
+static void destroy_entry(struct c_utils_cache *cache, struct c_utils_cache_entry *entry);
+
+static void configure(struct c_utils_cache_conf *conf);
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Cache Core Functions                                        //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+struct c_utils_cache *c_utils_cache_create(size_t capacity) {
+	struct c_utils_cache_conf conf = { .capacity = capacity };
+	return c_utils_cache_create_conf(&conf);
+}
+
+struct c_utils_cache *c_utils_cache_create_conf(struct c_utils_cache_conf *conf) {
+	if(!conf)
+		return NULL;
+
+	configure(conf);
+
+	struct c_utils_cache *cache;
+	C_UTILS_ON_BAD_MALLOC(cache, conf->logger, sizeof(*cache))
+		goto err;
+
+	cache->shard_bits = 0;
+	cache->num_shards = 1;
+	if(conf->flags & C_UTILS_CACHE_CONCURRENT)
+		while(cache->num_shards < conf->shards) {
+			cache->num_shards <<= 1;
+			cache->shard_bits++;
+		}
+
+	cache->shards = aligned_alloc(C_UTILS_CACHE_CACHE_LINE, sizeof(*cache->shards) * cache->num_shards);
+	if(!cache->shards) {
+		C_UTILS_LOG_ERROR(conf->logger, "aligned_alloc: \"%s\"", strerror(errno));
+		goto err_shards;
+	}
+
+	/*
+		Each shard's map is only ever accessed under the shard's lock, so it needs no lock of it's own. If every
+		entry is charged 1, we know up front how many entries the shard can hold, so the map is created large
+		enough to never need to grow.
+	*/
+	size_t capacity = (conf->capacity + cache->num_shards - 1) / cache->num_shards;
+	struct c_utils_map_conf map_conf =
+	{
+		.callbacks =
+		{
+			.comparators.key = conf->callbacks.comparator,
+			.hash_function = conf->callbacks.hash_function
+		},
+		.size.initial = conf->callbacks.charge ? 0 : capacity * 2,
+		.length.key = conf->key_length,
+		.logger = conf->logger
+	};
+
+	size_t i;
+	for(i = 0; i < cache->num_shards; i++) {
+		struct c_utils_cache_shard *shard = cache->shards + i;
+		shard->size = 0;
+		shard->hand = 0;
+		shard->charge = 0;
+		shard->capacity = capacity;
+		atomic_init(&shard->hits, 0);
+		atomic_init(&shard->misses, 0);
+		atomic_init(&shard->evictions, 0);
+
+		shard->ring_capacity = default_ring_capacity;
+		C_UTILS_ON_BAD_MALLOC(shard->ring, conf->logger, sizeof(*shard->ring) * shard->ring_capacity)
+			goto err_shard;
+
+		shard->index = c_utils_map_create_conf(&map_conf);
+		if(!shard->index) {
+			C_UTILS_LOG_ERROR(conf->logger, "Was unable to create the map!");
+			free(shard->ring);
+			goto err_shard;
+		}
+
+		shard->lock = conf->flags & C_UTILS_CACHE_CONCURRENT ?
+			c_utils_scoped_lock_rwlock(NULL, conf->logger) : c_utils_scoped_lock_no_op();
+		if(!shard->lock) {
+			C_UTILS_LOG_ERROR(conf->logger, "Was unable to create the scoped_lock!");
+			c_utils_map_destroy(shard->index);
+			free(shard->ring);
+			goto err_shard;
+		}
+	}
+
+	cache->conf = *conf;
+
+	return cache;
+
+	err_shard:
+		while(i--) {
+			c_utils_scoped_lock_destroy(cache->shards[i].lock);
+			c_utils_map_destroy(cache->shards[i].index);
+			free(cache->shards[i].ring);
+		}
+		free(cache->shards);
+	err_shards:
+		free(cache);
+	err:
+		return NULL;
+}
+
+bool c_utils_cache_add(struct c_utils_cache *cache, void *key, void *value) {
+	if(!cache)
+		return false;
+
+	if(!key || !value) {
+		C_UTILS_LOG_ERROR(cache->conf.logger, "This cache does not support NULL keys or values!");
+		return false;
+	}
+
+	struct c_utils_cache_shard *shard = get_shard(cache, key);
+	size_t charge = get_charge(cache, key, value);
+	if(charge > shard->capacity) {
+		C_UTILS_LOG_WARNING(cache->conf.logger, "An entry with a charge of %zu can never fit in a shard with a capacity of %zu!",
+			charge, shard->capacity);
+		return false;
+	}
+
+	struct c_utils_cache_entry *entry;
+	C_UTILS_ON_BAD_MALLOC(entry, cache->conf.logger, sizeof(*entry))
+		return false;
+
+	entry->key = key;
+	entry->value = value;
+	entry->charge = charge;
+	atomic_init(&entry->referenced, true);
+
+	C_UTILS_SCOPED_WRLOCK(shard->lock) {
+		/*
+			We make sure the entry can be added before evicting anything to make room for it. Adding it to the
+			index is what checks whether the key is already present, so the index is only probed once.
+		*/
+		if(!reserve_entry(cache, shard) || !c_utils_map_add(shard->index, key, entry)) {
+			free(entry);
+			return false;
+		}
+
+		while(shard->charge + charge > shard->capacity)
+			evict_entry(cache, shard);
+
+		entry->index = shard->size;
+		shard->ring[shard->size++] = entry;
+		shard->charge += charge;
+
+		return true;
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+void *c_utils_cache_get(struct c_utils_cache *cache, const void *key) {
+	if(!cache)
+		return NULL;
+
+	if(!key) {
+		C_UTILS_LOG_ERROR(cache->conf.logger, "This cache does not support NULL keys!");
+		return NULL;
+	}
+
+	struct c_utils_cache_shard *shard = get_shard(cache, key);
+
+	C_UTILS_SCOPED_RDLOCK(shard->lock) {
+		struct c_utils_cache_entry *entry = c_utils_map_get(shard->index, key);
+		if(!entry) {
+			atomic_fetch_add_explicit(&shard->misses, 1, memory_order_relaxed);
+			return NULL;
+		}
+
+		// Only write if needed, so that hits on a hot entry do not keep stealing it's cache line from each other.
+		if(!atomic_load_explicit(&entry->referenced, memory_order_relaxed))
+			atomic_store_explicit(&entry->referenced, true, memory_order_relaxed);
+
+		atomic_fetch_add_explicit(&shard->hits, 1, memory_order_relaxed);
+
+		// The caller is obtaining a copy of the value, hence they gain a reference to it.
+		if(cache->conf.flags & C_UTILS_CACHE_RC_VALUE)
+			C_UTILS_REF_INC(entry->value);
+
+		return entry->value;
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+void *c_utils_cache_remove(struct c_utils_cache *cache, const void *key) {
+	if(!cache)
+		return NULL;
+
+	if(!key) {
+		C_UTILS_LOG_ERROR(cache->conf.logger, "This cache does not support NULL keys!");
+		return NULL;
+	}
+
+	struct c_utils_cache_shard *shard = get_shard(cache, key);
+
+	C_UTILS_SCOPED_WRLOCK(shard->lock) {
+		struct c_utils_cache_entry *entry = c_utils_map_get(shard->index, key);
+		if(!entry)
+			return NULL;
+
+		// Note that the caller steals our reference to the value.
+		void *value = entry->value;
+		remove_entry(shard, entry);
+		free(entry);
+
+		return value;
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+bool c_utils_cache_delete(struct c_utils_cache *cache, const void *key) {
+	if(!cache)
+		return false;
+
+	if(!key) {
+		C_UTILS_LOG_ERROR(cache->conf.logger, "This cache does not support NULL keys!");
+		return false;
+	}
+
+	struct c_utils_cache_shard *shard = get_shard(cache, key);
+
+	C_UTILS_SCOPED_WRLOCK(shard->lock) {
+		struct c_utils_cache_entry *entry = c_utils_map_get(shard->index, key);
+		if(!entry)
+			return false;
+
+		remove_entry(shard, entry);
+		destroy_entry(cache, entry);
+
+		return true;
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+size_t c_utils_cache_size(struct c_utils_cache *cache) {
+	if(!cache)
+		return 0;
+
+	size_t size = 0;
+	for(size_t i = 0; i < cache->num_shards; i++)
+		C_UTILS_SCOPED_RDLOCK(cache->shards[i].lock)
+			size += cache->shards[i].size;
+
+	return size;
+}
+
+void c_utils_cache_stats(struct c_utils_cache *cache, struct c_utils_cache_stats *stats) {
+	if(!cache || !stats)
+		return;
+
+	memset(stats, 0, sizeof(*stats));
+
+	for(size_t i = 0; i < cache->num_shards; i++) {
+		struct c_utils_cache_shard *shard = cache->shards + i;
+
+		C_UTILS_SCOPED_RDLOCK(shard->lock) {
+			stats->hits += atomic_load_explicit(&shard->hits, memory_order_relaxed);
+			stats->misses += atomic_load_explicit(&shard->misses, memory_order_relaxed);
+			stats->evictions += atomic_load_explicit(&shard->evictions, memory_order_relaxed);
+			stats->size += shard->size;
+			stats->charge += shard->charge;
+		}
+	}
+}
+
+void c_utils_cache_destroy(struct c_utils_cache *cache) {
+	if(!cache)
+		return;
+
+	for(size_t i = 0; i < cache->num_shards; i++) {
+		struct c_utils_cache_shard *shard = cache->shards + i;
+
+		for(size_t j = 0; j < shard->size; j++) {
+			struct c_utils_cache_entry *entry = shard->ring[j];
+
+			if(cache->conf.flags & C_UTILS_CACHE_DELETE_ON_DESTROY)
+				destroy_entry(cache, entry);
+			else
+				free(entry);
+		}
+
+		c_utils_map_destroy(shard->index);
+		c_utils_scoped_lock_destroy(shard->lock);
+		free(shard->ring);
+	}
+
+	free(cache->shards);
+	free(cache);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Cache Helper Functions                                      //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+/*
+	The shard's map hashes the key again, and uses both the lowest and highest bits of the hash, so
+	the shard is selected from a remix of the hash rather than directly from it; otherwise every key of
+	a shard would share those bits, and collide within it's map.
+*/
+static struct c_utils_cache_shard *get_shard(const struct c_utils_cache *cache, const void *key) {
+	if(!cache->shard_bits)
+		return cache->shards;
+
+	uint32_t hash = cache->conf.callbacks.hash_function ?
+		cache->conf.callbacks.hash_function(key) :
+		hash_key(key, cache->conf.key_length ? cache->conf.key_length : strlen(key));
+
+	return cache->shards + ((hash * 0x9E3779B1u) >> (32 - cache->shard_bits));
+}
+
+/// Bob Jenkin's hash, the same as the map's default.
+static uint32_t hash_key(const void *key, size_t len) {
+	const unsigned char *k = key;
+	uint32_t hash = 0;
+
+	for (uint32_t i = 0;i < len; ++i) {
+		hash += k[i];
+		hash += (hash << 10);
+		hash ^= (hash >> 6);
+	}
+
+	hash += (hash << 3);
+	hash ^= (hash >> 11);
+	hash += (hash << 15);
+
+	return hash;
+}
+
+static size_t get_charge(const struct c_utils_cache *cache, const void *key, const void *value) {
+	return cache->conf.callbacks.charge ? cache->conf.callbacks.charge(key, value) : 1;
+}
+
+/// Ensures the ring has room for one more entry. Must be called while holding the writer lock.
+static bool reserve_entry(struct c_utils_cache *cache, struct c_utils_cache_shard *shard) {
+	if(shard->size < shard->ring_capacity)
+		return true;
+
+	size_t ring_capacity = shard->ring_capacity * 2;
+	C_UTILS_ON_BAD_REALLOC(&shard->ring, cache->conf.logger, sizeof(*shard->ring) * ring_capacity)
+		return false;
+
+	shard->ring_capacity = ring_capacity;
+
+	return true;
+}
+
+/*
+	Sweeps the hand over the ring, giving each referenced entry a second chance, and evicts the first
+	entry which has not been referenced since the hand last passed it. As every entry which is passed
+	over has it's mark cleared, this terminates within one revolution. Must be called while holding the
+	writer lock, with at least one entry in the shard.
+*/
+static void evict_entry(struct c_utils_cache *cache, struct c_utils_cache_shard *shard) {
+	struct c_utils_cache_entry *entry;
+
+	for(;;) {
+		if(shard->hand >= shard->size)
+			shard->hand = 0;
+
+		entry = shard->ring[shard->hand];
+		if(!atomic_load_explicit(&entry->referenced, memory_order_relaxed))
+			break;
+
+		atomic_store_explicit(&entry->referenced, false, memory_order_relaxed);
+		shard->hand++;
+	}
+
+	// The last entry is moved under the hand, so it is the next to be considered.
+	remove_entry(shard, entry);
+	destroy_entry(cache, entry);
+	atomic_fetch_add_explicit(&shard->evictions, 1, memory_order_relaxed);
+}
+
+/// Unlinks the entry from the map and ring, but does not free it. Must be called while holding the writer lock.
+static void remove_entry(struct c_utils_cache_shard *shard, struct c_utils_cache_entry *entry) {
+	c_utils_map_remove(shard->index, entry->key);
+
+	struct c_utils_cache_entry *last = shard->ring[--shard->size];
+	shard->ring[entry->index] = last;
+	last->index = entry->index;
+
+	shard->charge -= entry->charge;
+}
+
+static void destroy_entry(struct c_utils_cache *cache, struct c_utils_cache_entry *entry) {
+	if(cache->conf.callbacks.destructors.key)
+		cache->conf.callbacks.destructors.key(entry->key);
+
+	if(cache->conf.flags & C_UTILS_CACHE_RC_VALUE)
+		C_UTILS_REF_DEC(entry->value);
+	else if(cache->conf.callbacks.destructors.value)
+		cache->conf.callbacks.destructors.value(entry->value);
+
+	free(entry);
+}
+
+static void configure(struct c_utils_cache_conf *conf) {
+	if(!conf->capacity)
+		conf->capacity = default_capacity;
+
+	if(!conf->shards)
+		conf->shards = default_shards;
+}
@@ -0,0 +1,195 @@
+#ifndef C_UTILS_CACHE_H
+#define C_UTILS_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../io/logger.h"
+
+/*
+	A bounded cache which evicts with the CLOCK algorithm, and can be made thread-safe by passing
+	C_UTILS_CACHE_CONCURRENT on construction.
+
+	The cache is split into shards by the hash of the key, each with it's own rwlock, map from key to entry, and
+	ring of entries swept by the clock hand. A hit only marks it's entry as referenced, which is a single atomic
+	store, hence hits only ever take the reader lock and proceed concurrently. Adding a pair takes the writer lock
+	of it's shard, and if the shard is over capacity, the hand sweeps the ring, clearing the mark of each referenced
+	entry it passes over, and evicting the first one which is not. New entries start out referenced, so that they
+	survive at least one sweep.
+
+	The capacity is in units of charge. Every entry is charged 1 by default, which makes the capacity the maximum
+	amount of entries, but a charge callback may be supplied, for example to charge the size of the value in bytes.
+	The capacity is split evenly between the shards.
+*/
+struct c_utils_cache;
+
+#define C_UTILS_CACHE_CONCURRENT 1 << 0
+#define C_UTILS_CACHE_RC_VALUE 1 << 1
+#define C_UTILS_CACHE_DELETE_ON_DESTROY 1 << 2
+
+/*
+	concurrent:
+		default:
+			false
+		note:
+			Splits the cache into shards, each guarded by a rwlock. If this is not specified, there is a single shard
+			which does not use a lock, and hence any concurrent access will yield undefined behavior.
+	rc_value:
+		default:
+			false
+		note:
+			Values are reference counted. A value returned from get has had it's count incremented, so it remains valid
+			even if it is evicted before the caller is done with it, and eviction decrements the count rather than
+			invoking the value destructor. Without this, a value returned from get is only valid until it is evicted,
+			which another thread may do at any time.
+	delete_on_destroy:
+		default:
+			false
+		note:
+			Invokes the destructors on each remaining entry when the cache is destroyed. They are always invoked
+			on eviction.
+	capacity:
+		default:
+			1024
+		note:
+			The maximum total charge of all entries.
+	shards:
+		default:
+			16
+		note:
+			The amount of shards to use if concurrent, rounded up to a power of two.
+*/
+struct c_utils_cache_conf {
+	/// Configuration flags
+	int flags;
+	/// Maximum total charge.
+	size_t capacity;
+	/// The amount of shards. Relavent only when CACHE_CONCURRENT flagged.
+	size_t shards;
+	/// Callbacks
+	struct {
+		/// Destructors, invoked on eviction and delete.
+		struct {
+			void (*key)(void *);
+			void (*value)(void *);
+		} destructors;
+		/// Key comparator, used in place of memcmp or strcmp.
+		int (*comparator)(const void *, const void *);
+		/// Hash function, must be consistent with the comparator.
+		uint32_t (*hash_function)(const void *key);
+		/// The charge of an entry against the capacity. Defaults to 1.
+		size_t (*charge)(const void *key, const void *value);
+	} callbacks;
+	/// The length of the key, used for comparison and the default hash function. Keys are strings if 0.
+	size_t key_length;
+	/// Logger
+	struct c_utils_logger *logger;
+};
+
+/// The counters are only approximately consistent with each other while the cache is in use.
+struct c_utils_cache_stats {
+	size_t hits;
+	size_t misses;
+	size_t evictions;
+	/// The amount of entries.
+	size_t size;
+	/// The total charge of all entries.
+	size_t charge;
+};
+
+#ifdef NO_C_UTILS_PREFIX
+/*
+	Typedefs
+*/
+typedef struct c_utils_cache cache_t;
+typedef struct c_utils_cache_conf cache_conf_t;
+typedef struct c_utils_cache_stats cache_stats_t;
+
+/*
+	Macros
+*/
+#define CACHE_CONCURRENT C_UTILS_CACHE_CONCURRENT
+#define CACHE_RC_VALUE C_UTILS_CACHE_RC_VALUE
+#define CACHE_DELETE_ON_DESTROY C_UTILS_CACHE_DELETE_ON_DESTROY
+
+/*
+	Functions
+*/
+#define cache_create(...) c_utils_cache_create(__VA_ARGS__)
+#define cache_create_conf(...) c_utils_cache_create_conf(__VA_ARGS__)
+#define cache_add(...) c_utils_cache_add(__VA_ARGS__)
+#define cache_get(...) c_utils_cache_get(__VA_ARGS__)
+#define cache_remove(...) c_utils_cache_remove(__VA_ARGS__)
+#define cache_delete(...) c_utils_cache_delete(__VA_ARGS__)
+#define cache_size(...) c_utils_cache_size(__VA_ARGS__)
+#define cache_stats(...) c_utils_cache_stats(__VA_ARGS__)
+#define cache_destroy(...) c_utils_cache_destroy(__VA_ARGS__)
+#endif
+
+/**
+ * Creates a cache of string keys holding up to capacity entries. It is not concurrent.
+ *
+ * @param capacity Maximum amount of entries.
+ * @return Instance, or NULL if an allocation error occurs.
+ */
+struct c_utils_cache *c_utils_cache_create(size_t capacity);
+
+struct c_utils_cache *c_utils_cache_create_conf(struct c_utils_cache_conf *conf);
+
+/**
+ * Adds the key-value pair, evicting entries from it's shard until it fits.
+ *
+ * Writer-Lock: Not Concurrent, Is Thread Safe.
+ * @param cache Instance.
+ * @param key Key.
+ * @param value Value.
+ * @return True if added. False if the key is already present, the entry's charge exceeds the capacity of a shard,
+ * or an allocation error occurs; in which case the key and value still belong to the caller.
+ */
+bool c_utils_cache_add(struct c_utils_cache *cache, void *key, void *value);
+
+/**
+ * Obtains the value associated with the key, and marks it as referenced. Counts as a hit or a miss.
+ *
+ * Reader-Lock: Concurrent, Is Thread Safe.
+ * @param cache Instance.
+ * @param key Key.
+ * @return Value, or NULL if not present.
+ */
+void *c_utils_cache_get(struct c_utils_cache *cache, const void *key);
+
+/**
+ * Removes the entry without invoking the destructors. Does not count as an eviction.
+ *
+ * Writer-Lock: Not Concurrent, Is Thread Safe.
+ * @param cache Instance.
+ * @param key Key.
+ * @return The value, which now belongs to the caller, or NULL if not present.
+ */
+void *c_utils_cache_remove(struct c_utils_cache *cache, const void *key);
+
+/**
+ * Removes the entry, invoking the destructors on it.
+ *
+ * Writer-Lock: Not Concurrent, Is Thread Safe.
+ * @param cache Instance.
+ * @param key Key.
+ * @return True if present.
+ */
+bool c_utils_cache_delete(struct c_utils_cache *cache, const void *key);
+
+size_t c_utils_cache_size(struct c_utils_cache *cache);
+
+/**
+ * Sums the counters of every shard.
+ *
+ * Reader-Lock: Concurrent, Is Thread Safe.
+ * @param cache Instance.
+ * @param stats Filled in with the totals.
+ */
+void c_utils_cache_stats(struct c_utils_cache *cache, struct c_utils_cache_stats *stats);
+
+void c_utils_cache_destroy(struct c_utils_cache *cache);
+
+#endif /* C_UTILS_CACHE_H */
@@ -0,0 +1,228 @@
+#include "cow_array.h"
+
+#include "../memory/hazard.h"
+#include "../memory/ref_count.h"
+#include "../threading/scoped_lock.h"
+#include "../io/logger.h"
+#include "../misc/alloc_check.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// The hazard pointer held on a snapshot between loading it and taking a reference to it.
+#define C_UTILS_COW_ARRAY_HP_SNAPSHOT C_UTILS_HAZARD_INDEX_COW_ARRAY
+
+/// Reference counted, and never changed once published.
+struct c_utils_cow_array_snapshot {
+	size_t size;
+	void *items[];
+};
+
+struct c_utils_cow_array {
+	/// The current snapshot, which the array holds a reference to.
+	struct c_utils_cow_array_snapshot *snapshot;
+	/// Serializes the writers, which each copy the current snapshot.
+	struct c_utils_scoped_lock *lock;
+	/// Configuration
+	struct c_utils_cow_array_conf conf;
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Copy-On-Write Array Helper Functions                        //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static struct c_utils_cow_array_snapshot *create_snapshot(struct c_utils_cow_array *array, size_t size);
+
+static void unref_snapshot(void *snapshot);
+
+static void publish(struct c_utils_cow_array *array, struct c_utils_cow_array_snapshot *snapshot);
+
+
+
+struct c_utils_cow_array *c_utils_cow_array_create(void) {
+	struct c_utils_cow_array_conf conf = {};
+	return c_utils_cow_array_create_conf(&conf);
+}
+
+struct c_utils_cow_array *c_utils_cow_array_create_conf(struct c_utils_cow_array_conf *conf) {
+	if(!conf)
+		return NULL;
+
+	struct c_utils_cow_array *array;
+	C_UTILS_ON_BAD_CALLOC(array, conf->logger, sizeof(*array))
+		goto err;
+
+	array->conf = *conf;
+
+	array->snapshot = create_snapshot(array, 0);
+	if(!array->snapshot)
+		goto err_snapshot;
+
+	array->lock = c_utils_scoped_lock_mutex(NULL, conf->logger);
+	if(!array->lock) {
+		C_UTILS_LOG_ERROR(conf->logger, "Was unable to create scoped_lock for mutex!");
+		goto err_lock;
+	}
+
+	return array;
+
+	err_lock:
+		c_utils_ref_destroy(array->snapshot);
+	err_snapshot:
+		free(array);
+	err:
+		return NULL;
+}
+
+bool c_utils_cow_array_add(struct c_utils_cow_array *array, void *item) {
+	if(!array)
+		return false;
+
+	if(!item) {
+		C_UTILS_LOG_ERROR(array->conf.logger, "This array does not support NULL elements!");
+		return false;
+	}
+
+	C_UTILS_SCOPED_LOCK(array->lock) {
+		struct c_utils_cow_array_snapshot *old = array->snapshot;
+		struct c_utils_cow_array_snapshot *snapshot = create_snapshot(array, old->size + 1);
+		if(!snapshot)
+			return false;
+
+		memcpy(snapshot->items, old->items, old->size * sizeof(void *));
+		snapshot->items[old->size] = item;
+
+		publish(array, snapshot);
+	}
+
+	return true;
+}
+
+bool c_utils_cow_array_remove(struct c_utils_cow_array *array, void *item) {
+	if(!array)
+		return false;
+
+	C_UTILS_SCOPED_LOCK(array->lock) {
+		struct c_utils_cow_array_snapshot *old = array->snapshot;
+
+		size_t index = 0;
+		while(index < old->size && old->items[index] != item)
+			index++;
+
+		if(index == old->size)
+			return false;
+
+		struct c_utils_cow_array_snapshot *snapshot = create_snapshot(array, old->size - 1);
+		if(!snapshot)
+			return false;
+
+		memcpy(snapshot->items, old->items, index * sizeof(void *));
+		memcpy(snapshot->items + index, old->items + index + 1, (old->size - index - 1) * sizeof(void *));
+
+		publish(array, snapshot);
+	}
+
+	return true;
+}
+
+bool c_utils_cow_array_remove_all(struct c_utils_cow_array *array) {
+	if(!array)
+		return false;
+
+	C_UTILS_SCOPED_LOCK(array->lock) {
+		struct c_utils_cow_array_snapshot *snapshot = create_snapshot(array, 0);
+		if(!snapshot)
+			return false;
+
+		publish(array, snapshot);
+	}
+
+	return true;
+}
+
+void **c_utils_cow_array_acquire(struct c_utils_cow_array *array, size_t *size) {
+	if(!array || !size)
+		return NULL;
+
+	/*
+		The snapshot is protected before it's reference is taken, and is only taken once it is seen to still be
+		the current snapshot, as the array's own reference can not then have been released before it was protected.
+	*/
+	struct c_utils_cow_array_snapshot *snapshot;
+	do {
+		snapshot = __atomic_load_n(&array->snapshot, __ATOMIC_ACQUIRE);
+		c_utils_hazard_acquire(C_UTILS_COW_ARRAY_HP_SNAPSHOT, snapshot);
+	} while(snapshot != __atomic_load_n(&array->snapshot, __ATOMIC_ACQUIRE));
+
+	C_UTILS_REF_INC(snapshot);
+	c_utils_hazard_release(snapshot, false);
+
+	*size = snapshot->size;
+	return snapshot->items;
+}
+
+void c_utils_cow_array_release(void **items) {
+	if(!items)
+		return;
+
+	C_UTILS_REF_DEC((char *) items - offsetof(struct c_utils_cow_array_snapshot, items));
+}
+
+void c_utils_cow_array_auto_release(void ***items) {
+	c_utils_cow_array_release(*items);
+}
+
+size_t c_utils_cow_array_size(struct c_utils_cow_array *array) {
+	if(!array)
+		return 0;
+
+	size_t size;
+	c_utils_cow_array_release(c_utils_cow_array_acquire(array, &size));
+
+	return size;
+}
+
+void c_utils_cow_array_destroy(struct c_utils_cow_array *array, c_utils_delete_cb del) {
+	if(!array)
+		return;
+
+	struct c_utils_cow_array_snapshot *snapshot = array->snapshot;
+	if(del)
+		for(size_t i = 0; i < snapshot->size; i++)
+			del(snapshot->items[i]);
+
+	C_UTILS_REF_DEC(snapshot);
+
+	c_utils_scoped_lock_destroy(array->lock);
+	free(array);
+}
+
+
+
+static struct c_utils_cow_array_snapshot *create_snapshot(struct c_utils_cow_array *array, size_t size) {
+	struct c_utils_cow_array_snapshot *snapshot = c_utils_ref_create(sizeof(*snapshot) + size * sizeof(void *));
+	if(!snapshot) {
+		C_UTILS_LOG_ERROR(array->conf.logger, "Was unable to allocate a snapshot of %zu items!", size);
+		return NULL;
+	}
+
+	snapshot->size = size;
+	return snapshot;
+}
+
+static void unref_snapshot(void *snapshot) {
+	C_UTILS_REF_DEC(snapshot);
+}
+
+/// Must be called while holding the lock, and releases the array's reference to the old snapshot once no reader can still be acquiring it.
+static void publish(struct c_utils_cow_array *array, struct c_utils_cow_array_snapshot *snapshot) {
+	struct c_utils_cow_array_snapshot *old = array->snapshot;
+	__atomic_store_n(&array->snapshot, snapshot, __ATOMIC_RELEASE);
+
+	if(!c_utils_hazard_retire(old, unref_snapshot))
+		C_UTILS_LOG_ERROR(array->conf.logger, "Was unable to retire the old snapshot!");
+}
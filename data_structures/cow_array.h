@@ -0,0 +1,144 @@
+#ifndef C_UTILS_COW_ARRAY_H
+#define C_UTILS_COW_ARRAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "helpers.h"
+
+/*
+	A copy-on-write array, for collections which are iterated far more often than they are changed, such as the
+	sources of an event loop. Readers acquire an immutable snapshot of the items without taking a lock or copying
+	anything, and may hold on to it for as long as they like, as it is never changed after it is published.
+
+	Writers are serialized by a mutex, and each copies the current snapshot into a new one with their change made,
+	then publishes it in place of the old with a single atomic store. Each snapshot is reference counted, and the
+	array's own reference to the old snapshot is only released once no reader may still be acquiring it, which is
+	known through the hazard pointers, so it is freed once the last reader holding it releases it.
+
+	Adding or removing is hence O(N), while acquiring is O(1) no matter how many items there are.
+*/
+struct c_utils_cow_array;
+
+/*
+	logger:
+		default:
+			NULL
+		note:
+			Logs allocation failures.
+*/
+struct c_utils_cow_array_conf {
+	/// Logger
+	struct c_utils_logger *logger;
+};
+
+/*
+	Iterates over a snapshot of the array, which is released once the loop is finished or broken out of.
+	Items added or removed while iterating are not seen until the next time.
+*/
+#define C_UTILS_COW_ARRAY_FOR_EACH(item, array) \
+	for(size_t _this_size, _this_index = 0, _this_once = 1; _this_once; _this_once = 0) \
+		for(__attribute__((cleanup(c_utils_cow_array_auto_release))) void **_this_items = c_utils_cow_array_acquire(array, &_this_size); \
+			_this_items && _this_index < _this_size && ((item = _this_items[_this_index]), true); _this_index++)
+
+#ifdef NO_C_UTILS_PREFIX
+/*
+	Typedefs
+*/
+typedef struct c_utils_cow_array cow_array_t;
+typedef struct c_utils_cow_array_conf cow_array_conf_t;
+
+/*
+	Macros
+*/
+#define COW_ARRAY_FOR_EACH(...) C_UTILS_COW_ARRAY_FOR_EACH(__VA_ARGS__)
+
+/*
+	Functions
+*/
+#define cow_array_create(...) c_utils_cow_array_create(__VA_ARGS__)
+#define cow_array_create_conf(...) c_utils_cow_array_create_conf(__VA_ARGS__)
+#define cow_array_add(...) c_utils_cow_array_add(__VA_ARGS__)
+#define cow_array_remove(...) c_utils_cow_array_remove(__VA_ARGS__)
+#define cow_array_remove_all(...) c_utils_cow_array_remove_all(__VA_ARGS__)
+#define cow_array_acquire(...) c_utils_cow_array_acquire(__VA_ARGS__)
+#define cow_array_release(...) c_utils_cow_array_release(__VA_ARGS__)
+#define cow_array_size(...) c_utils_cow_array_size(__VA_ARGS__)
+#define cow_array_destroy(...) c_utils_cow_array_destroy(__VA_ARGS__)
+#endif
+
+/**
+ * Creates an empty array.
+ *
+ * @return Instance, or NULL if an allocation error occurs.
+ */
+struct c_utils_cow_array *c_utils_cow_array_create(void);
+
+struct c_utils_cow_array *c_utils_cow_array_create_conf(struct c_utils_cow_array_conf *conf);
+
+/**
+ * Publishes a copy of the items with the item appended.
+ *
+ * Concurrent, Is Thread Safe, and only blocks other writers.
+ * @param array Instance.
+ * @param item Item.
+ * @return true if added, false if the item is NULL or an allocation error occurs.
+ */
+bool c_utils_cow_array_add(struct c_utils_cow_array *array, void *item);
+
+/**
+ * Publishes a copy of the items without the first occurrence of the item. Snapshots acquired before still hold it.
+ *
+ * Concurrent, Is Thread Safe, and only blocks other writers.
+ * @param array Instance.
+ * @param item Item.
+ * @return true if removed, false if it is not held or an allocation error occurs.
+ */
+bool c_utils_cow_array_remove(struct c_utils_cow_array *array, void *item);
+
+/**
+ * Publishes an empty snapshot. Snapshots acquired before still hold the items.
+ *
+ * Concurrent, Is Thread Safe, and only blocks other writers.
+ * @param array Instance.
+ * @return true if emptied, false if an allocation error occurs.
+ */
+bool c_utils_cow_array_remove_all(struct c_utils_cow_array *array);
+
+/**
+ * Acquires the current snapshot, which is never changed, and remains valid until it is released.
+ *
+ * Lock-Free: Concurrent, Is Thread Safe.
+ * @param array Instance.
+ * @param size Set to the amount of items.
+ * @return The items, which must be released with c_utils_cow_array_release, or NULL if array or size is NULL.
+ */
+void **c_utils_cow_array_acquire(struct c_utils_cow_array *array, size_t *size);
+
+/**
+ * Releases a snapshot, which is freed once every reader holding it, and the array itself, have released it.
+ *
+ * Lock-Free: Concurrent, Is Thread Safe.
+ * @param items Items returned by c_utils_cow_array_acquire, or NULL.
+ */
+void c_utils_cow_array_release(void **items);
+
+/// Used by C_UTILS_COW_ARRAY_FOR_EACH to release the snapshot once it goes out of scope.
+void c_utils_cow_array_auto_release(void ***items);
+
+/**
+ * @param array Instance.
+ * @return The amount of items in the current snapshot.
+ */
+size_t c_utils_cow_array_size(struct c_utils_cow_array *array);
+
+/**
+ * Destroys the array, calling del on each item of the current snapshot if specified. Snapshots still held
+ * by readers remain valid until they are released, but their items may have been deleted.
+ *
+ * @param array Instance.
+ * @param del Deletion callback to call on each item if specified.
+ */
+void c_utils_cow_array_destroy(struct c_utils_cow_array *array, c_utils_delete_cb del);
+
+#endif /* C_UTILS_COW_ARRAY_H */
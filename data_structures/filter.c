@@ -0,0 +1,400 @@
+#include "filter.h"
+
+#include "../misc/alloc_check.h"
+#include "../io/logger.h"
+
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#define C_UTILS_FILTER_CACHE_LINE 64
+
+/// The amount of 32-bit words in a Bloom block, one bit of which is set per key.
+#define C_UTILS_FILTER_BLOCK_WORDS 8
+
+/// The amount of 16-bit fingerprints in a cuckoo bucket, packed into one 64-bit word.
+#define C_UTILS_FILTER_BUCKET_SLOTS 4
+
+/// How many fingerprints are relocated before an insertion gives up.
+#define C_UTILS_FILTER_MAX_KICKS 500
+
+/// The lowest and highest bit of each fingerprint in a bucket, for testing all 4 at once.
+#define C_UTILS_FILTER_LANES_LOW 0x0001000100010001ULL
+#define C_UTILS_FILTER_LANES_HIGH 0x8000800080008000ULL
+
+struct c_utils_filter_block {
+	uint32_t words[C_UTILS_FILTER_BLOCK_WORDS];
+};
+
+struct c_utils_filter {
+	/// Bloom blocks or cuckoo buckets, depending on the kind.
+	union {
+		struct c_utils_filter_block *blocks;
+		uint64_t *buckets;
+	};
+	/// The amount of blocks or buckets, minus one, as there is always a power of two of them.
+	size_t mask;
+	/// The amount of keys.
+	size_t size;
+	/*
+		A cuckoo insertion which runs out of kicks is left holding the last fingerprint it displaced, which is kept
+		here so that it is not lost. Once it is used, the filter is full.
+	*/
+	struct {
+		uint16_t fingerprint;
+		size_t index;
+		bool used;
+	} victim;
+	/// State of the generator used to choose which fingerprint to kick.
+	uint64_t random;
+	/// Configuration
+	struct c_utils_filter_conf conf;
+};
+
+/*
+	Odd constants used to derive each word's bit from the same 32 bits of the hash, as in the split block
+	Bloom filters of Impala and Parquet.
+*/
+static const uint32_t bloom_salt[C_UTILS_FILTER_BLOCK_WORDS] =
+{
+	0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+	0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+static const size_t default_capacity = 1024;
+
+static const size_t default_bits_per_key = 10;
+
+static const double cuckoo_max_load = .95;
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Filter Helper Functions                                     //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t mix_hash(uint64_t hash);
+
+static size_t round_pow2(size_t size);
+
+static void bloom_mask(uint32_t key, uint32_t mask[C_UTILS_FILTER_BLOCK_WORDS]);
+
+static inline uint64_t lanes_zero(uint64_t bucket);
+
+static inline uint64_t lanes_match(uint64_t bucket, uint16_t fingerprint);
+
+static inline uint16_t get_fingerprint(uint64_t hash);
+
+static inline size_t alt_index(const struct c_utils_filter *filter, size_t index, uint16_t fingerprint);
+
+static bool bucket_insert(struct c_utils_filter *filter, size_t index, uint16_t fingerprint);
+
+static bool bucket_remove(struct c_utils_filter *filter, size_t index, uint16_t fingerprint);
+
+static void configure(struct c_utils_filter_conf *conf);
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Filter Core Functions                                       //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+struct c_utils_filter *c_utils_filter_create(int flags, size_t capacity) {
+	struct c_utils_filter_conf conf = { .flags = flags, .capacity = capacity };
+	return c_utils_filter_create_conf(&conf);
+}
+
+struct c_utils_filter *c_utils_filter_create_conf(struct c_utils_filter_conf *conf) {
+	if(!conf)
+		return NULL;
+
+	configure(conf);
+
+	struct c_utils_filter *filter;
+	C_UTILS_ON_BAD_MALLOC(filter, conf->logger, sizeof(*filter))
+		goto err;
+
+	size_t count, size;
+	if(conf->flags & C_UTILS_FILTER_CUCKOO) {
+		count = round_pow2((conf->capacity + C_UTILS_FILTER_BUCKET_SLOTS - 1) / C_UTILS_FILTER_BUCKET_SLOTS);
+		if(conf->capacity > count * C_UTILS_FILTER_BUCKET_SLOTS * cuckoo_max_load)
+			count *= 2;
+
+		size = count * sizeof(*filter->buckets);
+	} else {
+		size_t bits = conf->capacity * conf->bits_per_key;
+		size_t block_bits = sizeof(struct c_utils_filter_block) * 8;
+		count = round_pow2((bits + block_bits - 1) / block_bits);
+		size = count * sizeof(*filter->blocks);
+	}
+
+	// A single bucket is smaller than a cache line, and aligned_alloc requires a multiple of the alignment.
+	size = (size + C_UTILS_FILTER_CACHE_LINE - 1) & ~((size_t) C_UTILS_FILTER_CACHE_LINE - 1);
+	void *data = aligned_alloc(C_UTILS_FILTER_CACHE_LINE, size);
+	if(!data) {
+		C_UTILS_LOG_ERROR(conf->logger, "aligned_alloc: \"%s\"", strerror(errno));
+		goto err_data;
+	}
+
+	memset(data, 0, size);
+	filter->blocks = data;
+	filter->mask = count - 1;
+	filter->size = 0;
+	filter->victim.used = false;
+	filter->random = 0x9E3779B97F4A7C15ULL;
+	filter->conf = *conf;
+
+	return filter;
+
+	err_data:
+		free(filter);
+	err:
+		return NULL;
+}
+
+bool c_utils_filter_add(struct c_utils_filter *filter, uint64_t hash) {
+	if(!filter)
+		return false;
+
+	hash = mix_hash(hash);
+
+	if(!(filter->conf.flags & C_UTILS_FILTER_CUCKOO)) {
+		uint32_t mask[C_UTILS_FILTER_BLOCK_WORDS];
+		struct c_utils_filter_block *block = filter->blocks + ((hash >> 32) & filter->mask);
+		bloom_mask((uint32_t) hash, mask);
+
+		for(int i = 0; i < C_UTILS_FILTER_BLOCK_WORDS; i++)
+			block->words[i] |= mask[i];
+
+		filter->size++;
+		return true;
+	}
+
+	if(filter->victim.used)
+		return false;
+
+	uint16_t fingerprint = get_fingerprint(hash);
+	size_t index = hash & filter->mask;
+
+	if(bucket_insert(filter, index, fingerprint) || bucket_insert(filter, (index = alt_index(filter, index, fingerprint)), fingerprint)) {
+		filter->size++;
+		return true;
+	}
+
+	/*
+		Both buckets are full, so a random fingerprint is kicked out of one and moved to it's own alternate
+		bucket, which may in turn kick out another, and so on.
+	*/
+	for(int kicks = 0; kicks < C_UTILS_FILTER_MAX_KICKS; kicks++) {
+		filter->random ^= filter->random << 13;
+		filter->random ^= filter->random >> 7;
+		filter->random ^= filter->random << 17;
+
+		unsigned int slot = filter->random % C_UTILS_FILTER_BUCKET_SLOTS;
+		uint64_t *bucket = filter->buckets + index;
+		uint16_t kicked = *bucket >> (slot * 16);
+
+		*bucket &= ~(0xFFFFULL << (slot * 16));
+		*bucket |= (uint64_t) fingerprint << (slot * 16);
+
+		fingerprint = kicked;
+		index = alt_index(filter, index, fingerprint);
+
+		if(bucket_insert(filter, index, fingerprint)) {
+			filter->size++;
+			return true;
+		}
+	}
+
+	// The key we were asked to add is in the filter; it is the last one kicked which did not find a home.
+	filter->victim.fingerprint = fingerprint;
+	filter->victim.index = index;
+	filter->victim.used = true;
+	filter->size++;
+
+	return true;
+}
+
+bool c_utils_filter_contains(const struct c_utils_filter *filter, uint64_t hash) {
+	if(!filter)
+		return false;
+
+	hash = mix_hash(hash);
+
+	if(!(filter->conf.flags & C_UTILS_FILTER_CUCKOO)) {
+		uint32_t mask[C_UTILS_FILTER_BLOCK_WORDS];
+		const struct c_utils_filter_block *block = filter->blocks + ((hash >> 32) & filter->mask);
+		bloom_mask((uint32_t) hash, mask);
+
+		// Accumulating every word rather than returning early keeps the loop branch-free.
+		uint32_t missing = 0;
+		for(int i = 0; i < C_UTILS_FILTER_BLOCK_WORDS; i++)
+			missing |= ~block->words[i] & mask[i];
+
+		return !missing;
+	}
+
+	uint16_t fingerprint = get_fingerprint(hash);
+	size_t index = hash & filter->mask;
+	size_t alt = alt_index(filter, index, fingerprint);
+
+	if(lanes_match(filter->buckets[index], fingerprint) || lanes_match(filter->buckets[alt], fingerprint))
+		return true;
+
+	return filter->victim.used && filter->victim.fingerprint == fingerprint &&
+		(filter->victim.index == index || filter->victim.index == alt);
+}
+
+bool c_utils_filter_remove(struct c_utils_filter *filter, uint64_t hash) {
+	if(!filter)
+		return false;
+
+	if(!(filter->conf.flags & C_UTILS_FILTER_CUCKOO)) {
+		C_UTILS_LOG_ERROR(filter->conf.logger, "Keys can not be removed from a Bloom filter!");
+		return false;
+	}
+
+	hash = mix_hash(hash);
+
+	uint16_t fingerprint = get_fingerprint(hash);
+	size_t index = hash & filter->mask;
+	size_t alt = alt_index(filter, index, fingerprint);
+
+	if(filter->victim.used && filter->victim.fingerprint == fingerprint &&
+		(filter->victim.index == index || filter->victim.index == alt)) {
+		filter->victim.used = false;
+		filter->size--;
+		return true;
+	}
+
+	if(!bucket_remove(filter, index, fingerprint) && !bucket_remove(filter, alt, fingerprint))
+		return false;
+
+	filter->size--;
+
+	// There may now be room for the victim, if the bucket freed up is one of it's own.
+	if(filter->victim.used) {
+		size_t victim = filter->victim.index;
+		uint16_t victim_fingerprint = filter->victim.fingerprint;
+
+		if(bucket_insert(filter, victim, victim_fingerprint) ||
+			bucket_insert(filter, alt_index(filter, victim, victim_fingerprint), victim_fingerprint))
+			filter->victim.used = false;
+	}
+
+	return true;
+}
+
+size_t c_utils_filter_size(const struct c_utils_filter *filter) {
+	return filter ? filter->size : 0;
+}
+
+void c_utils_filter_clear(struct c_utils_filter *filter) {
+	if(!filter)
+		return;
+
+	size_t size = (filter->mask + 1) * (filter->conf.flags & C_UTILS_FILTER_CUCKOO ?
+		sizeof(*filter->buckets) : sizeof(*filter->blocks));
+
+	memset(filter->blocks, 0, size);
+	filter->size = 0;
+	filter->victim.used = false;
+}
+
+void c_utils_filter_destroy(struct c_utils_filter *filter) {
+	if(!filter)
+		return;
+
+	free(filter->blocks);
+	free(filter);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Filter Helper Functions                                     //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+/// The finalizer of MurmurHash3, so that the bits of weak or 32-bit hashes are spread across all 64 bits.
+static uint64_t mix_hash(uint64_t hash) {
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+static size_t round_pow2(size_t size) {
+	size_t pow2 = 1;
+	while(pow2 < size)
+		pow2 <<= 1;
+
+	return pow2;
+}
+
+/// The top 5 bits of each product select one of the 32 bits of each word.
+static void bloom_mask(uint32_t key, uint32_t mask[C_UTILS_FILTER_BLOCK_WORDS]) {
+	for(int i = 0; i < C_UTILS_FILTER_BLOCK_WORDS; i++)
+		mask[i] = 1U << ((key * bloom_salt[i]) >> 27);
+}
+
+/// Returns a word whose lowest set bit is the high bit of the first empty lane, or 0 if there is none.
+static inline uint64_t lanes_zero(uint64_t bucket) {
+	return (bucket - C_UTILS_FILTER_LANES_LOW) & ~bucket & C_UTILS_FILTER_LANES_HIGH;
+}
+
+static inline uint64_t lanes_match(uint64_t bucket, uint16_t fingerprint) {
+	return lanes_zero(bucket ^ (fingerprint * C_UTILS_FILTER_LANES_LOW));
+}
+
+/// Fingerprints are taken from the top of the hash, as the bottom selects the bucket. 0 marks an empty lane.
+static inline uint16_t get_fingerprint(uint64_t hash) {
+	uint16_t fingerprint = hash >> 48;
+	return fingerprint ? fingerprint : 1;
+}
+
+/// The alternate bucket depends only on the fingerprint, so it can be found from either bucket.
+static inline size_t alt_index(const struct c_utils_filter *filter, size_t index, uint16_t fingerprint) {
+	return (index ^ (fingerprint * 0x5bd1e995ULL)) & filter->mask;
+}
+
+static bool bucket_insert(struct c_utils_filter *filter, size_t index, uint16_t fingerprint) {
+	uint64_t empty = lanes_zero(filter->buckets[index]);
+	if(!empty)
+		return false;
+
+	unsigned int shift = __builtin_ctzll(empty) - 15;
+	filter->buckets[index] |= (uint64_t) fingerprint << shift;
+
+	return true;
+}
+
+static bool bucket_remove(struct c_utils_filter *filter, size_t index, uint16_t fingerprint) {
+	uint64_t match = lanes_match(filter->buckets[index], fingerprint);
+	if(!match)
+		return false;
+
+	unsigned int shift = __builtin_ctzll(match) - 15;
+	filter->buckets[index] &= ~(0xFFFFULL << shift);
+
+	return true;
+}
+
+static void configure(struct c_utils_filter_conf *conf) {
+	if(!(conf->flags & (C_UTILS_FILTER_BLOOM | C_UTILS_FILTER_CUCKOO)))
+		conf->flags |= C_UTILS_FILTER_BLOOM;
+
+	if(!conf->capacity)
+		conf->capacity = default_capacity;
+
+	if(!conf->bits_per_key)
+		conf->bits_per_key = default_bits_per_key;
+}
@@ -0,0 +1,130 @@
+#ifndef C_UTILS_FILTER_H
+#define C_UTILS_FILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../io/logger.h"
+
+/*
+	An approximate set membership filter, which answers whether a key may have been added, or was definitely
+	not added. Filters operate on hashes of keys rather than the keys themselves, so the caller hashes each key
+	once (with any decent hash function; it is remixed internally) and the filter never touches the key.
+
+	Two kinds of filter are supported:
+
+	C_UTILS_FILTER_BLOOM:
+		A split block Bloom filter. Each key maps to a single 32-byte block of 8 32-bit words, and sets exactly
+		one bit in each word, so a lookup touches one cache line and is 8 independent word tests, which compilers
+		vectorize. Keys can not be removed.
+	C_UTILS_FILTER_CUCKOO:
+		A cuckoo filter, storing a 16-bit fingerprint of each key in one of two buckets of 4 fingerprints (8 bytes).
+		A lookup compares the fingerprint against both buckets a word at a time, touching at most two cache lines.
+		Keys can be removed, but only keys which were actually added, and adding fails once the filter is full.
+
+	The filter is not thread-safe.
+*/
+struct c_utils_filter;
+
+#define C_UTILS_FILTER_BLOOM 1 << 0
+#define C_UTILS_FILTER_CUCKOO 1 << 1
+
+/*
+	capacity:
+		default:
+			1024
+		note:
+			The amount of keys the filter is sized for. A Bloom filter may hold more keys at the cost of a higher
+			false positive rate, but a cuckoo filter holds at most around 95% of it's rounded up size.
+	bits_per_key:
+		default:
+			10
+		note:
+			Relevant only to Bloom filters, the amount of bits per key the filter is sized for, before it is rounded
+			up to a power of two blocks. At 10 bits, the false positive rate is around 1%. Cuckoo filters always use
+			16-bit fingerprints, for a false positive rate of around 0.01%.
+*/
+struct c_utils_filter_conf {
+	/// Either C_UTILS_FILTER_BLOOM (the default) or C_UTILS_FILTER_CUCKOO.
+	int flags;
+	size_t capacity;
+	size_t bits_per_key;
+	/// Logger
+	struct c_utils_logger *logger;
+};
+
+#ifdef NO_C_UTILS_PREFIX
+/*
+	Typedefs
+*/
+typedef struct c_utils_filter filter_t;
+typedef struct c_utils_filter_conf filter_conf_t;
+
+/*
+	Macros
+*/
+#define FILTER_BLOOM C_UTILS_FILTER_BLOOM
+#define FILTER_CUCKOO C_UTILS_FILTER_CUCKOO
+
+/*
+	Functions
+*/
+#define filter_create(...) c_utils_filter_create(__VA_ARGS__)
+#define filter_create_conf(...) c_utils_filter_create_conf(__VA_ARGS__)
+#define filter_add(...) c_utils_filter_add(__VA_ARGS__)
+#define filter_contains(...) c_utils_filter_contains(__VA_ARGS__)
+#define filter_remove(...) c_utils_filter_remove(__VA_ARGS__)
+#define filter_size(...) c_utils_filter_size(__VA_ARGS__)
+#define filter_clear(...) c_utils_filter_clear(__VA_ARGS__)
+#define filter_destroy(...) c_utils_filter_destroy(__VA_ARGS__)
+#endif
+
+/**
+ * Creates a filter of the given kind sized for capacity keys.
+ *
+ * @param flags C_UTILS_FILTER_BLOOM or C_UTILS_FILTER_CUCKOO.
+ * @param capacity Expected amount of keys.
+ * @return Instance, or NULL if an allocation error occurs.
+ */
+struct c_utils_filter *c_utils_filter_create(int flags, size_t capacity);
+
+struct c_utils_filter *c_utils_filter_create_conf(struct c_utils_filter_conf *conf);
+
+/**
+ * Adds the hash of a key. Adding the same hash twice to a cuckoo filter stores it twice, hence it must then
+ * be removed twice.
+ *
+ * @param filter Instance.
+ * @param hash Hash of the key.
+ * @return True if added, false if the cuckoo filter is full.
+ */
+bool c_utils_filter_add(struct c_utils_filter *filter, uint64_t hash);
+
+/**
+ * @param filter Instance.
+ * @param hash Hash of the key.
+ * @return False if the key was definitely never added, true if it may have been.
+ */
+bool c_utils_filter_contains(const struct c_utils_filter *filter, uint64_t hash);
+
+/**
+ * Removes the hash of a key which was previously added. Only supported by cuckoo filters.
+ *
+ * @param filter Instance.
+ * @param hash Hash of the key.
+ * @return True if removed, false if not found or this is a Bloom filter.
+ */
+bool c_utils_filter_remove(struct c_utils_filter *filter, uint64_t hash);
+
+/**
+ * @param filter Instance.
+ * @return The amount of keys added (less those removed).
+ */
+size_t c_utils_filter_size(const struct c_utils_filter *filter);
+
+void c_utils_filter_clear(struct c_utils_filter *filter);
+
+void c_utils_filter_destroy(struct c_utils_filter *filter);
+
+#endif /* C_UTILS_FILTER_H */
@@ -3,36 +3,92 @@
 #include "../memory/ref_count.h"
 #include "../misc/alloc_check.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+/// The slots are allocated aligned to a cache line, so that the children of a node begin on one.
+#define C_UTILS_HEAP_ALIGNMENT 64
+
 struct c_utils_heap {
+	/*
+		The root is stored in slot arity - 1, rather than slot 0, so that the children of every node begin in a slot
+		which is a multiple of the arity, and so are packed into as few cache lines as they can be. For a binary heap,
+		this is the usual 1-indexed layout. All other functions deal in the index of a node from the root.
+	*/
 	void **data;
+	/// The sort key of each item, in the same slot, if the key callback was specified.
+	uint64_t *keys;
+	/// The handle of each item, in the same slot, if the heap is indexed.
+	struct c_utils_heap_handle **handles;
 	int (*cmp)(const void *, const void *);
 	size_t size;
 	size_t used;
+	/// The slot of the root.
+	size_t offset;
 	struct c_utils_scoped_lock *lock;
 	struct c_utils_heap_conf conf;
 };
 
+/// Keeps track of where it's item is, so that it may be found without a search.
+struct c_utils_heap_handle {
+	/// The index of the item's node, updated whenever it moves.
+	size_t index;
+	/// The heap the item is in, or NULL once it has left it, by any means.
+	struct c_utils_heap *heap;
+};
+
+/// An item, along with it's key and handle if the heap has them, as it moves between slots.
+struct c_utils_heap_node {
+	void *item;
+	uint64_t key;
+	struct c_utils_heap_handle *handle;
+};
+
 static size_t default_initial = 64;
 
 static double default_growth_rate = 2;
 
 static double default_growth_trigger = .75;
 
-static size_t left(size_t parent);
+static size_t default_arity = 2;
 
-static size_t right(size_t parent);
+static size_t first_child(struct c_utils_heap *heap, size_t parent);
 
-static size_t parent(size_t child);
+static size_t parent(struct c_utils_heap *heap, size_t child);
 
-static void swap(struct c_utils_heap *heap, size_t first, size_t second);
+static struct c_utils_heap_node node_at(struct c_utils_heap *heap, size_t index);
+
+static int compare(struct c_utils_heap *heap, struct c_utils_heap_node *node, size_t index);
+
+static size_t greatest_child(struct c_utils_heap *heap, size_t parent);
+
+static void place(struct c_utils_heap *heap, size_t index, struct c_utils_heap_node node);
+
+static bool append(struct c_utils_heap *heap, void *item, struct c_utils_heap_handle **handle);
+
+static bool insert(struct c_utils_heap *heap, void *item, struct c_utils_heap_handle **handle);
 
 static void *extract_max(struct c_utils_heap *heap);
 
-static void heapify_up(struct c_utils_heap *heap);
+static void *extract(struct c_utils_heap *heap, size_t index);
+
+static void detach(struct c_utils_heap_node *node);
 
-static void heapify_down(struct c_utils_heap *heap);
+static void heapify_up(struct c_utils_heap *heap, size_t index);
 
-static void shift_down(struct c_utils_heap *heap, size_t index);
+static void heapify_down(struct c_utils_heap *heap, size_t index);
+
+static void heapify(struct c_utils_heap *heap, size_t index);
+
+static void build(struct c_utils_heap *heap, size_t from);
+
+static void clear(struct c_utils_heap *heap, bool delete);
+
+static size_t capacity_for(struct c_utils_heap_conf *conf, size_t len);
+
+static void *alloc_slots(size_t size, size_t slot_size);
+
+static bool realloc_slots(void **slots, size_t size, size_t slot_size, size_t in_use);
 
 static bool resize(struct c_utils_heap *heap, size_t size);
 
@@ -61,7 +117,7 @@ struct c_utils_heap *c_utils_heap_create_conf(int (*comparator)(const void *, co
 
 	if(conf->flags & C_UTILS_HEAP_RC_INSTANCE) {
 		struct c_utils_ref_count_conf rc_conf =
-		{ 
+		{
 			.logger = conf->logger,
 			.destructor = destroy_heap
 		};
@@ -86,18 +142,46 @@ struct c_utils_heap *c_utils_heap_create_conf(int (*comparator)(const void *, co
 		goto err_lock;
 	}
 
-	heap->data = malloc(sizeof(void *) * conf->size.initial);
+	// The root's slot, and one for an insert, must fit before the first resize.
+	if(conf->size.initial < conf->arity + 1)
+		conf->size.initial = conf->arity + 1;
+
+	heap->data = alloc_slots(conf->size.initial, sizeof(void *));
 	if(!heap->data) {
 		C_UTILS_LOG_ERROR(conf->logger, "Failed during creation of the heap container!");
 		goto err_heap;
 	}
 
+	heap->keys = NULL;
+	if(conf->callbacks.keys.item) {
+		heap->keys = alloc_slots(conf->size.initial, sizeof(uint64_t));
+		if(!heap->keys) {
+			C_UTILS_LOG_ERROR(conf->logger, "Failed during creation of the heap keys!");
+			goto err_keys;
+		}
+	}
+
+	heap->handles = NULL;
+	if(conf->flags & C_UTILS_HEAP_INDEXED) {
+		heap->handles = alloc_slots(conf->size.initial, sizeof(struct c_utils_heap_handle *));
+		if(!heap->handles) {
+			C_UTILS_LOG_ERROR(conf->logger, "Failed during creation of the heap handles!");
+			goto err_handles;
+		}
+	}
+
 	heap->size = conf->size.initial;
+	heap->used = 0;
+	heap->offset = conf->arity - 1;
 	heap->cmp = comparator;
 	heap->conf = *conf;
 
 	return heap;
 
+	err_handles:
+		free(heap->keys);
+	err_keys:
+		free(heap->data);
 	err_heap:
 		c_utils_scoped_lock_destroy(heap->lock);
 	err_lock:
@@ -118,8 +202,15 @@ struct c_utils_heap *c_utils_heap_create_from_conf(int (*comparator)(const void
 		return c_utils_heap_create_conf(comparator, conf);
 	}
 
-	if(len > conf->size.initial)
-		conf->size.initial = len;
+	configure(conf);
+
+	/*
+		An insert only grows the heap once the trigger has been passed, so the initial size must leave room for the
+		items, after the root's slot, and at least one more before it is reached.
+	*/
+	size_t capacity = capacity_for(conf, len);
+	if(capacity > conf->size.initial)
+		conf->size.initial = capacity;
 
 	if(conf->size.max && len > conf->size.max)
 		conf->size.max = len;
@@ -130,14 +221,51 @@ struct c_utils_heap *c_utils_heap_create_from_conf(int (*comparator)(const void
 		return NULL;
 	}
 
+	for(size_t i = 0; i < len; i++) {
+		if(!append(heap, arr[i], NULL)) {
+			C_UTILS_LOG_ERROR(conf->logger, "Failed to add item %zu to the heap!", i);
+			c_utils_heap_remove_all(heap);
+			c_utils_heap_destroy(heap);
+			return NULL;
+		}
+	}
+
+	build(heap, 0);
+
+	return heap;
+}
+
+bool c_utils_heap_insert_all(struct c_utils_heap *heap, void **arr, size_t len) {
+	if(!heap || !arr)
+		return false;
+
 	for(size_t i = 0; i < len; i++)
-		heap->data[i] = arr[i];
+		if(!arr[i]) {
+			C_UTILS_LOG_WARNING(heap->conf.logger, "This heap does not support NULL values!");
+			return false;
+		}
+
+	C_UTILS_SCOPED_LOCK(heap->lock) {
+		if(heap->conf.size.max && heap->used + len > heap->conf.size.max)
+			return false;
 
-	for(size_t i = len / 2; i >= 1; i--) {
-		shift_down(heap, i);
+		size_t capacity = capacity_for(&heap->conf, heap->used + len);
+		if(capacity > heap->size && !resize(heap, capacity))
+			return false;
+
+		size_t from = heap->used;
+		for(size_t i = 0; i < len; i++) {
+			if(!append(heap, arr[i], NULL)) {
+				// Those already appended are kept, so that the heap is left whole.
+				build(heap, from);
+				return false;
+			}
+		}
+
+		build(heap, from);
 	}
 
-	return heap;
+	return true;
 }
 
 bool c_utils_heap_insert(struct c_utils_heap *heap, void *item) {
@@ -149,28 +277,94 @@ bool c_utils_heap_insert(struct c_utils_heap *heap, void *item) {
 		return false;
 	}
 
+	C_UTILS_SCOPED_LOCK(heap->lock)
+		return insert(heap, item, NULL);
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+struct c_utils_heap_handle *c_utils_heap_insert_handle(struct c_utils_heap *heap, void *item) {
+	if(!heap)
+		return NULL;
+
+	if(!(heap->conf.flags & C_UTILS_HEAP_INDEXED)) {
+		C_UTILS_LOG_ERROR(heap->conf.logger, "Only an indexed heap has handles!");
+		return NULL;
+	}
+
+	if(!item) {
+		C_UTILS_LOG_WARNING(heap->conf.logger, "This heap does not support NULL values!");
+		return NULL;
+	}
+
+	struct c_utils_heap_handle *handle;
+	C_UTILS_SCOPED_LOCK(heap->lock)
+		return insert(heap, item, &handle) ? handle : NULL;
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+bool c_utils_heap_update_priority(struct c_utils_heap *heap, struct c_utils_heap_handle *handle) {
+	if(!heap || !handle)
+		return false;
+
 	C_UTILS_SCOPED_LOCK(heap->lock) {
-		if(heap->conf.size.max && heap->conf.size.max == heap->used)
+		if(!handle->heap) {
+			C_UTILS_LOG_TRACE(heap->conf.logger, "The item of the handle has already left the heap!");
 			return false;
+		}
 
-		heap->data[++heap->used] = item;
-
-		if(heap->conf.flags & C_UTILS_HEAP_RC_ITEM)
-			C_UTILS_REF_INC(item);
+		if(handle->heap != heap) {
+			C_UTILS_LOG_ERROR(heap->conf.logger, "The handle does not belong to this heap!");
+			return false;
+		}
 
-		/*
-			After inserting an item into the heap, we must move the recently
-			added value to it's correct place if necessary.
-		*/
-		heapify_up(heap);
+		if(heap->keys) {
+			size_t slot = heap->offset + handle->index;
+			heap->keys[slot] = heap->conf.callbacks.keys.item(heap->data[slot]);
+		}
 
-		if(((double)heap->used / heap->size) > heap->conf.growth.trigger)
-			resize(heap, heap->size * heap->conf.growth.rate);
+		heapify(heap, handle->index);
 	}
 
 	return true;
 }
 
+void *c_utils_heap_remove_handle(struct c_utils_heap *heap, struct c_utils_heap_handle *handle) {
+	if(!heap || !handle)
+		return NULL;
+
+	C_UTILS_SCOPED_LOCK(heap->lock) {
+		if(!handle->heap) {
+			C_UTILS_LOG_TRACE(heap->conf.logger, "The item of the handle has already left the heap!");
+			return NULL;
+		}
+
+		if(handle->heap != heap) {
+			C_UTILS_LOG_ERROR(heap->conf.logger, "The handle does not belong to this heap!");
+			return NULL;
+		}
+
+		return extract(heap, handle->index);
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+void c_utils_heap_handle_destroy(struct c_utils_heap *heap, struct c_utils_heap_handle *handle) {
+	if(!handle)
+		return;
+
+	// If it's item is still in the heap, it stays there without a handle.
+	if(heap) {
+		C_UTILS_SCOPED_LOCK(heap->lock)
+			if(handle->heap == heap)
+				heap->handles[heap->offset + handle->index] = NULL;
+	}
+
+	free(handle);
+}
+
 size_t c_utils_heap_size(struct c_utils_heap *heap) {
 	if(!heap)
 		return 0;
@@ -186,7 +380,7 @@ void *c_utils_heap_get(struct c_utils_heap *heap) {
 		if(!heap->used)
 			return NULL;
 
-		void *item = heap->data[1];
+		void *item = heap->data[heap->offset];
 		if(heap->conf.flags & C_UTILS_HEAP_RC_ITEM)
 			C_UTILS_REF_INC(item);
 
@@ -214,18 +408,8 @@ void c_utils_heap_remove_all(struct c_utils_heap *heap) {
 	if(!heap)
 		return;
 
-	C_UTILS_SCOPED_LOCK(heap->lock) {
-		if(!heap->used)
-			return;
-
-		for(size_t i = 1; i <= heap->used; i++) {
-			void *item = heap->data[i];
-			if(heap->conf.flags & C_UTILS_HEAP_RC_ITEM)
-				C_UTILS_REF_DEC(item);
-		}
-
-		heap->used = 0;
-	}
+	C_UTILS_SCOPED_LOCK(heap->lock)
+		clear(heap, false);
 }
 
 bool c_utils_heap_delete(struct c_utils_heap *heap) {
@@ -241,7 +425,7 @@ bool c_utils_heap_delete(struct c_utils_heap *heap) {
 		if(heap->conf.flags & C_UTILS_HEAP_RC_ITEM)
 			C_UTILS_REF_DEC(item);
 		else
-			heap->conf.callbacks.destructors.item(heap);
+			heap->conf.callbacks.destructors.item(item);
 
 		return true;
 	}
@@ -253,20 +437,8 @@ void c_utils_heap_delete_all(struct c_utils_heap *heap) {
 	if(!heap)
 		return;
 
-	C_UTILS_SCOPED_LOCK(heap->lock) {
-		if(!heap->used)
-			return;
-
-		for(size_t i = 1; i <= heap->used; i++) {
-			void *item = heap->data[i];
-			if(heap->conf.flags & C_UTILS_HEAP_RC_ITEM)
-				C_UTILS_REF_DEC(item);
-			else
-				heap->conf.callbacks.destructors.item(heap);
-		}
-
-		heap->used = 0;
-	}
+	C_UTILS_SCOPED_LOCK(heap->lock)
+		clear(heap, true);
 }
 
 void c_utils_heap_destroy(struct c_utils_heap *heap) {
@@ -279,78 +451,279 @@ void c_utils_heap_destroy(struct c_utils_heap *heap) {
 	}
 
 	destroy_heap(heap);
+	free(heap);
 }
 
 
 
-static size_t left(size_t parent) {
-	return parent * 2;
+static size_t first_child(struct c_utils_heap *heap, size_t parent) {
+	return parent * heap->conf.arity + 1;
 }
 
-static size_t right(size_t parent) {
-	return parent * 2 + 1;
+static size_t parent(struct c_utils_heap *heap, size_t child) {
+	return (child - 1) / heap->conf.arity;
 }
 
-static size_t parent(size_t child) {
-	return child / 2;
+static struct c_utils_heap_node node_at(struct c_utils_heap *heap, size_t index) {
+	size_t slot = heap->offset + index;
+
+	return (struct c_utils_heap_node) {
+		.item = heap->data[slot],
+		.key = heap->keys ? heap->keys[slot] : 0,
+		.handle = heap->handles ? heap->handles[slot] : NULL
+	};
 }
 
-static void swap(struct c_utils_heap *heap, size_t first, size_t second) {
-	void *item = heap->data[first];
-	heap->data[first] = heap->data[second];
-	heap->data[second] = item;
+/// Compares the node, by it's key if keyed, to the node at the index.
+static int compare(struct c_utils_heap *heap, struct c_utils_heap_node *node, size_t index) {
+	if(heap->keys) {
+		uint64_t other = heap->keys[heap->offset + index];
+		return (node->key > other) - (node->key < other);
+	}
+
+	return heap->cmp(node->item, heap->data[heap->offset + index]);
 }
 
+/// Must only be called on a node with children.
+static size_t greatest_child(struct c_utils_heap *heap, size_t parent) {
+	size_t first = first_child(heap, parent);
+	size_t last = first + heap->conf.arity;
+	if(last > heap->used)
+		last = heap->used;
+
+	size_t greatest = first;
+	for(size_t i = first + 1; i < last; i++) {
+		struct c_utils_heap_node node = node_at(heap, i);
+		if(compare(heap, &node, greatest) > 0)
+			greatest = i;
+	}
+
+	return greatest;
+}
+
+/// All moves of an item go through here, so that it's handle always knows where it is.
+static void place(struct c_utils_heap *heap, size_t index, struct c_utils_heap_node node) {
+	size_t slot = heap->offset + index;
+
+	heap->data[slot] = node.item;
+	if(heap->keys)
+		heap->keys[slot] = node.key;
+
+	if(heap->handles) {
+		heap->handles[slot] = node.handle;
+		if(node.handle)
+			node.handle->index = index;
+	}
+}
+
+/*
+	Adds the item after the last node without restoring the heap, which must have room for it. A handle is only
+	created if one is asked for, as the caller is the one to destroy it.
+*/
+static bool append(struct c_utils_heap *heap, void *item, struct c_utils_heap_handle **handle) {
+	struct c_utils_heap_node node = { .item = item };
+
+	if(heap->keys)
+		node.key = heap->conf.callbacks.keys.item(item);
+
+	if(handle) {
+		C_UTILS_ON_BAD_MALLOC(node.handle, heap->conf.logger, sizeof(*node.handle))
+			return false;
+
+		node.handle->heap = heap;
+	}
+
+	place(heap, heap->used++, node);
+
+	if(heap->conf.flags & C_UTILS_HEAP_RC_ITEM)
+		C_UTILS_REF_INC(item);
+
+	if(handle)
+		*handle = node.handle;
+
+	return true;
+}
+
+/// Must be called while holding the lock.
+static bool insert(struct c_utils_heap *heap, void *item, struct c_utils_heap_handle **handle) {
+	if(heap->conf.size.max && heap->conf.size.max == heap->used)
+		return false;
+
+	// Only reached if a previous resize failed, or the trigger is beyond the size itself.
+	if(heap->offset + heap->used + 1 >= heap->size && !resize(heap, heap->size * heap->conf.growth.rate + 1))
+		return false;
+
+	if(!append(heap, item, handle))
+		return false;
+
+	/*
+		After inserting an item into the heap, we must move the recently
+		added value to it's correct place if necessary.
+	*/
+	heapify_up(heap, heap->used - 1);
+
+	if(((double)(heap->offset + heap->used) / heap->size) > heap->conf.growth.trigger)
+		resize(heap, heap->size * heap->conf.growth.rate);
+
+	return true;
+}
+
+/*
+	Floyd's bottom-up removal: rather than comparing the last item against the children at each level on it's way
+	down from the root, the hole left by the root is moved down along the greatest children all the way to a leaf,
+	and the last item is moved up from there. As the last item almost always belongs near the bottom, this takes
+	close to half the comparisons.
+*/
 static void *extract_max(struct c_utils_heap *heap) {
-	void *item = heap->data[1];
-	heap->data[1] = heap->data[heap->used--];
+	struct c_utils_heap_node top = node_at(heap, 0);
+	struct c_utils_heap_node last = node_at(heap, --heap->used);
+
+	detach(&top);
 
-	heapify_down(heap);
+	if(!heap->used)
+		return top.item;
+
+	size_t hole = 0;
+	while(first_child(heap, hole) < heap->used) {
+		size_t child = greatest_child(heap, hole);
+
+		place(heap, hole, node_at(heap, child));
+		hole = child;
+	}
 
-	return item;
+	place(heap, hole, last);
+	heapify_up(heap, hole);
+
+	return top.item;
 }
 
-static void heapify_up(struct c_utils_heap *heap) {
-	for(size_t i = heap->used; i > 1; i = parent(i)) {
-		if(heap->cmp(heap->data[i], heap->data[parent(i)]) > 0)
-			swap(heap, i, parent(i));
-		else
-			break;
+/// Removes the node at any index, by moving the last node into it's place, which may belong above or below it.
+static void *extract(struct c_utils_heap *heap, size_t index) {
+	if(!index)
+		return extract_max(heap);
+
+	struct c_utils_heap_node node = node_at(heap, index);
+	struct c_utils_heap_node last = node_at(heap, --heap->used);
+
+	detach(&node);
+
+	if(index != heap->used) {
+		place(heap, index, last);
+		heapify(heap, index);
 	}
+
+	return node.item;
 }
 
-static void heapify_down(struct c_utils_heap *heap) {
-	// If the root node is less than it's children, correct it here.
-	for(size_t i = 1; i <= heap->used;) {
-		size_t largest = i;
+/// The handle outlives the item leaving the heap, so that a caller still holding it finds out it has left.
+static void detach(struct c_utils_heap_node *node) {
+	if(node->handle)
+		node->handle->heap = NULL;
+}
 
-		if(left(i) <= heap->used && heap->cmp(heap->data[left(i)], heap->data[largest]) > 0)
-			largest = left(i);
-		
-		if(right(i) <= heap->used && heap->cmp(heap->data[right(i)], heap->data[largest]) > 0)
-			largest = right(i);
+static void heapify_up(struct c_utils_heap *heap, size_t index) {
+	struct c_utils_heap_node node = node_at(heap, index);
 
-		// No change?
-		if(largest == i)
+	// The node is only placed once it's position is found, rather than swapped with each parent on the way.
+	size_t i = index;
+	while(i > 0) {
+		size_t p = parent(heap, i);
+		if(compare(heap, &node, p) <= 0)
 			break;
 
-		swap(heap, largest, i);
-		i = largest;
+		place(heap, i, node_at(heap, p));
+		i = p;
 	}
+
+	if(i != index)
+		place(heap, i, node);
 }
 
-static void shift_down(struct c_utils_heap *heap, size_t index) {
-	for(size_t i = index; i <= heap->used;) {
-		if(heap->cmp(heap->data[left(i)], heap->data[i]) > 0) {
-			swap(heap, left(i), i);
-			i = left(i);
-		} else if(heap->cmp(heap->data[right(i)], heap->data[i]) > 0) {
-			swap(heap, right(i), i);
-			i = right(i);
-		} else {
+static void heapify_down(struct c_utils_heap *heap, size_t index) {
+	struct c_utils_heap_node node = node_at(heap, index);
+
+	// While the node is less than the greatest child, that child moves up into it's place.
+	size_t i = index;
+	while(first_child(heap, i) < heap->used) {
+		size_t child = greatest_child(heap, i);
+		if(compare(heap, &node, child) >= 0)
 			break;
-		}
+
+		place(heap, i, node_at(heap, child));
+		i = child;
+	}
+
+	if(i != index)
+		place(heap, i, node);
+}
+
+/// Moves the node at the index up or down to where it belongs, after it has been changed or replaced.
+static void heapify(struct c_utils_heap *heap, size_t index) {
+	struct c_utils_heap_node node = node_at(heap, index);
+
+	if(index > 0 && compare(heap, &node, parent(heap, index)) > 0)
+		heapify_up(heap, index);
+	else
+		heapify_down(heap, index);
+}
+
+/*
+	Restores the heap after the items from the given index onwards were appended to it. If they are at least as
+	many as were already in it, it is rebuilt bottom-up, as Floyd's method is O(N) in all of them, rather than
+	moving each up on it's own in O(log(N)).
+*/
+static void build(struct c_utils_heap *heap, size_t from) {
+	if(heap->used - from < from) {
+		for(size_t i = from; i < heap->used; i++)
+			heapify_up(heap, i);
+
+		return;
+	}
+
+	if(heap->used < 2)
+		return;
+
+	for(size_t i = parent(heap, heap->used - 1) + 1; i-- > 0;)
+		heapify_down(heap, i);
+}
+
+/// Must be called while holding the lock.
+static void clear(struct c_utils_heap *heap, bool delete) {
+	for(size_t i = 0; i < heap->used; i++) {
+		struct c_utils_heap_node node = node_at(heap, i);
+		detach(&node);
+
+		if(heap->conf.flags & C_UTILS_HEAP_RC_ITEM)
+			C_UTILS_REF_DEC(node.item);
+		else if(delete)
+			heap->conf.callbacks.destructors.item(node.item);
 	}
+
+	heap->used = 0;
+}
+
+static size_t capacity_for(struct c_utils_heap_conf *conf, size_t len) {
+	return (size_t) ((conf->arity - 1 + len) / conf->growth.trigger) + 2;
+}
+
+static void *alloc_slots(size_t size, size_t slot_size) {
+	size_t bytes = size * slot_size;
+	bytes += (C_UTILS_HEAP_ALIGNMENT - bytes % C_UTILS_HEAP_ALIGNMENT) % C_UTILS_HEAP_ALIGNMENT;
+
+	return aligned_alloc(C_UTILS_HEAP_ALIGNMENT, bytes);
+}
+
+/// Realloc can not keep the alignment, so the slots in use are copied to a new allocation instead.
+static bool realloc_slots(void **slots, size_t size, size_t slot_size, size_t in_use) {
+	void *new_slots = alloc_slots(size, slot_size);
+	if(!new_slots)
+		return false;
+
+	memcpy(new_slots, *slots, in_use * slot_size);
+	free(*slots);
+	*slots = new_slots;
+
+	return true;
 }
 
 static bool resize(struct c_utils_heap *heap, size_t size) {
@@ -364,8 +737,20 @@ static bool resize(struct c_utils_heap *heap, size_t size) {
 	else
 		new_size = size;
 
-	C_UTILS_ON_BAD_REALLOC(&heap->data, heap->conf.logger, sizeof(void *) * new_size)
+	size_t in_use = heap->offset + heap->used;
+	if(new_size <= in_use)
+		return false;
+
+	/*
+		Each array of slots is grown in turn, and if one fails, those already grown are simply larger than the
+		size recorded, which is harmless.
+	*/
+	if(!realloc_slots((void **) &heap->data, new_size, sizeof(void *), in_use)
+		|| (heap->keys && !realloc_slots((void **) &heap->keys, new_size, sizeof(uint64_t), in_use))
+		|| (heap->handles && !realloc_slots((void **) &heap->handles, new_size, sizeof(struct c_utils_heap_handle *), in_use))) {
+		C_UTILS_LOG_ERROR(heap->conf.logger, "Failed to grow the heap to %zu slots!", new_size);
 		return false;
+	}
 
 	heap->size = new_size;
 	return true;
@@ -383,6 +768,8 @@ static void destroy_heap(void *instance) {
 
 	c_utils_scoped_lock_destroy(heap->lock);
 
+	free(heap->handles);
+	free(heap->keys);
 	free(heap->data);
 }
 
@@ -396,6 +783,9 @@ static void configure(struct c_utils_heap_conf *conf) {
 	if(!conf->size.initial)
 		conf->size.initial = default_initial;
 
+	if(conf->arity < 2)
+		conf->arity = default_arity;
+
 	if(!conf->callbacks.destructors.item)
 		conf->callbacks.destructors.item = free;
-}
\ No newline at end of file
+}
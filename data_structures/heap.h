@@ -2,6 +2,8 @@
 #define C_UTILS_HEAP_H
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
 
 #include "../io/logger.h"
 
@@ -13,14 +15,40 @@
 
 #define C_UTILS_HEAP_DELETE_ON_DESTROY 1 << 3
 
+/*
+	Tracks where each item is in the heap, so that it may be inserted with c_utils_heap_insert_handle, and the handle
+	later used to change it's priority or remove it in O(log(N)), rather than only the top.
+*/
+#define C_UTILS_HEAP_INDEXED 1 << 4
+
 struct c_utils_heap;
 
+/*
+	Refers to an item in an indexed heap. It stays valid after the item is removed from it, by any means, so that using it
+	afterwards fails rather than touching freed memory, and must be destroyed by the caller with c_utils_heap_handle_destroy.
+*/
+struct c_utils_heap_handle;
+
 struct c_utils_heap_conf {
 	int flags;
+	/*
+		The amount of children of each node, 2 by default. A 4-ary or 8-ary heap is half or a third as deep, and the
+		children of a node are laid out to share a cache line, so each level down costs more comparisons but far fewer
+		cache misses on a large heap.
+	*/
+	size_t arity;
 	struct {
 		struct {
 			void (*item)(void *);
 		} destructors;
+		/*
+			If specified, the key of each item is obtained once when it is inserted and copied next to it, and is compared
+			in place of the comparator, so ordering the heap does not dereference the items. It must order the items as the
+			comparator does, the greatest key being at the top, and must not change while the item is in the heap.
+		*/
+		struct {
+			uint64_t (*item)(const void *);
+		} keys;
 	} callbacks;
 	struct {
 		size_t initial;
@@ -39,6 +67,7 @@ struct c_utils_heap_conf {
 */
 typedef struct c_utils_heap heap_t;
 typedef struct c_utils_heap_conf heap_conf_t;
+typedef struct c_utils_heap_handle heap_handle_t;
 
 /*
 	Macros
@@ -47,6 +76,7 @@ typedef struct c_utils_heap_conf heap_conf_t;
 #define HEAP_RC_ITEM C_UTILS_HEAP_RC_ITEM
 #define HEAP_CONCURRENT C_UTILS_HEAP_CONCURRENT
 #define HEAP_DELETE_ON_DESTROY C_UTILS_HEAP_DELETE_ON_DESTROY
+#define HEAP_INDEXED C_UTILS_HEAP_INDEXED
 
 /*
 	Functions
@@ -56,6 +86,11 @@ typedef struct c_utils_heap_conf heap_conf_t;
 #define heap_create_from(...) c_utils_heap_create_from(__VA_ARGS__)
 #define heap_create_from_conf(...) c_utils_heap_create_from_conf(__VA_ARGS__)
 #define heap_insert(...) c_utils_heap_insert(__VA_ARGS__)
+#define heap_insert_all(...) c_utils_heap_insert_all(__VA_ARGS__)
+#define heap_insert_handle(...) c_utils_heap_insert_handle(__VA_ARGS__)
+#define heap_update_priority(...) c_utils_heap_update_priority(__VA_ARGS__)
+#define heap_remove_handle(...) c_utils_heap_remove_handle(__VA_ARGS__)
+#define heap_handle_destroy(...) c_utils_heap_handle_destroy(__VA_ARGS__)
 #define heap_size(...) c_utils_heap_size(__VA_ARGS__)
 #define heap_get(...) c_utils_heap_get(__VA_ARGS__)
 #define heap_remove(...) c_utils_heap_remove(__VA_ARGS__)
@@ -90,6 +125,39 @@ struct c_utils_heap *c_utils_heap_create_from_conf(int (*comparator)(const void
 */
 bool c_utils_heap_insert(struct c_utils_heap *tree, void *item);
 
+/*
+	Inserts all elements of the passed array into the heap at once, such as the output of c_utils_list_as_array. If they are at least as many as
+	are already in the heap, it is rebuilt in O(N), otherwise each is moved into place in O(log(N)). If any is NULL, or the heap would exceed it's
+	maximum size (or is unable to resize), none are inserted and it will return false.
+*/
+bool c_utils_heap_insert_all(struct c_utils_heap *tree, void **arr, size_t len);
+
+/*
+	Inserts a new element into an indexed heap as c_utils_heap_insert does, returning the handle to it, or NULL if it could not be inserted or the
+	heap is not indexed.
+*/
+struct c_utils_heap_handle *c_utils_heap_insert_handle(struct c_utils_heap *tree, void *item);
+
+/*
+	Moves the element of the handle to it's new place after it's priority has been changed, such as a timer being rescheduled, with a complexity of
+	O(log(N)). It's key is obtained again if the heap is keyed. It will return false if the handle does not belong to the heap, or it's element
+	has already left it.
+*/
+bool c_utils_heap_update_priority(struct c_utils_heap *tree, struct c_utils_heap_handle *handle);
+
+/*
+	Returns and removes the element of the handle from anywhere in the heap, such as a timer being cancelled, with a complexity of O(log(N)). It
+	will return NULL if the element has already left the heap, such as a timer which has already fired. As with c_utils_heap_remove, the reference
+	count is transfered to the caller.
+*/
+void *c_utils_heap_remove_handle(struct c_utils_heap *tree, struct c_utils_heap_handle *handle);
+
+/*
+	Destroys the handle. If it's element is still in the passed heap, it is left there without a handle. The heap may only be NULL if the element
+	has already left it, such as once the heap itself has been destroyed.
+*/
+void c_utils_heap_handle_destroy(struct c_utils_heap *tree, struct c_utils_heap_handle *handle);
+
 /*
 	Obtains the number of elements inside of the heap.
 */
@@ -0,0 +1,625 @@
+#include "intrusive_list.h"
+#include "../threading/scoped_lock.h"
+#include "../memory/ref_count.h"
+#include "../misc/alloc_check.h"
+
+#include <stdlib.h>
+
+/*
+	The position of an iterator, which the list keeps track of so that it can correct it as items are removed.
+*/
+struct c_utils_intrusive_list_cursor {
+	/// The link positioned on, or NULL if none or if it has been removed.
+	struct c_utils_intrusive_link *curr;
+	/// Set once the link positioned on is removed, after which before and after are where it was.
+	bool removed;
+	struct c_utils_intrusive_link *before;
+	struct c_utils_intrusive_link *after;
+	/// The other iterators of the list.
+	struct c_utils_intrusive_list_cursor *next;
+	struct c_utils_intrusive_list_cursor *prev;
+};
+
+struct c_utils_intrusive_list {
+	struct c_utils_intrusive_link *head;
+	struct c_utils_intrusive_link *tail;
+	volatile size_t size;
+	/// The positions of each iterator of the list.
+	struct c_utils_intrusive_list_cursor *cursors;
+	/// Ensures only one thread manipulates the items in the list, but multiple threads can read.
+	struct c_utils_scoped_lock *lock;
+	/// Configuration
+	struct c_utils_intrusive_list_conf conf;
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Intrusive List Helper Functions                             //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static inline struct c_utils_intrusive_link *item_to_link(struct c_utils_intrusive_list *list, void *item);
+
+static inline void *link_to_item(struct c_utils_intrusive_list *list, struct c_utils_intrusive_link *link);
+
+static void link_before(struct c_utils_intrusive_list *list, struct c_utils_intrusive_link *next, struct c_utils_intrusive_link *link);
+
+static void link_sorted(struct c_utils_intrusive_list *list, struct c_utils_intrusive_link *link);
+
+static void unlink_link(struct c_utils_intrusive_list *list, struct c_utils_intrusive_link *link);
+
+static void unlink_all(struct c_utils_intrusive_list *list, c_utils_delete_cb del);
+
+static void destroy_list(void *instance);
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Intrusive List Iterator Functions                           //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static void *move_to(struct c_utils_intrusive_list *list, struct c_utils_intrusive_list_cursor *cursor, struct c_utils_intrusive_link *link);
+
+static void *head(void *instance, void *pos);
+
+static void *tail(void *instance, void *pos);
+
+static void *next(void *instance, void *pos);
+
+static void *prev(void *instance, void *pos);
+
+static void *curr(void *instance, void *pos);
+
+static bool append(void *instance, void *pos, void *item);
+
+static bool prepend(void *instance, void *pos, void *item);
+
+static bool del(void *instance, void *pos);
+
+static bool rem(void *instance, void *pos);
+
+static void finalize(void *instance, void *pos);
+
+
+
+struct c_utils_intrusive_list *c_utils_intrusive_list_create(size_t offset) {
+	struct c_utils_intrusive_list_conf conf = { .offset = offset };
+	return c_utils_intrusive_list_create_conf(&conf);
+}
+
+struct c_utils_intrusive_list *c_utils_intrusive_list_create_conf(struct c_utils_intrusive_list_conf *conf) {
+	if(!conf)
+		return NULL;
+
+	struct c_utils_intrusive_list *list;
+
+	if(conf->flags & C_UTILS_INTRUSIVE_LIST_RC_INSTANCE) {
+		struct c_utils_ref_count_conf rc_conf = { .logger = conf->logger, .destructor = destroy_list };
+		list = c_utils_ref_create_conf(sizeof(*list), &rc_conf);
+		if(!list) {
+			C_UTILS_LOG_ERROR(conf->logger, "Was unable to allocate the list!");
+			return NULL;
+		}
+	}
+	else {
+		C_UTILS_ON_BAD_MALLOC(list, conf->logger, sizeof(*list))
+			return NULL;
+	}
+
+	list->head = list->tail = NULL;
+	list->size = 0;
+	list->cursors = NULL;
+
+	if(conf->flags & C_UTILS_INTRUSIVE_LIST_CONCURRENT)
+		list->lock = c_utils_scoped_lock_rwlock(NULL, conf->logger);
+	else
+		list->lock = c_utils_scoped_lock_no_op();
+
+	if(!list->lock) {
+		C_UTILS_LOG_ERROR(conf->logger, "Was unable to create scoped_lock for rwlock!");
+
+		if(conf->flags & C_UTILS_INTRUSIVE_LIST_RC_INSTANCE)
+			c_utils_ref_destroy(list);
+		else
+			free(list);
+
+		return NULL;
+	}
+
+	list->conf = *conf;
+
+	if(!list->conf.callbacks.destructors.item)
+		list->conf.callbacks.destructors.item = free;
+
+	return list;
+}
+
+bool c_utils_intrusive_list_add(struct c_utils_intrusive_list *list, void *item) {
+	if(!list || !item)
+		return false;
+
+	struct c_utils_intrusive_link *link = item_to_link(list, item);
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		if(link->list) {
+			C_UTILS_LOG_ERROR(list->conf.logger, "The item is already on a list!");
+			return false;
+		}
+
+		if(list->conf.callbacks.comparators.item)
+			link_sorted(list, link);
+		else
+			link_before(list, NULL, link);
+
+		return true;
+	} // Release Writer Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+bool c_utils_intrusive_list_remove(struct c_utils_intrusive_list *list, void *item) {
+	if(!list || !item)
+		return false;
+
+	struct c_utils_intrusive_link *link = item_to_link(list, item);
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		if(link->list != list)
+			return false;
+
+		unlink_link(list, link);
+		return true;
+	} // Release Writer Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+bool c_utils_intrusive_list_delete(struct c_utils_intrusive_list *list, void *item) {
+	// Deleted outside of the lock, as it is no longer reachable through the list once removed.
+	if(!c_utils_intrusive_list_remove(list, item))
+		return false;
+
+	list->conf.callbacks.destructors.item(item);
+	return true;
+}
+
+void *c_utils_intrusive_list_remove_head(struct c_utils_intrusive_list *list) {
+	if(!list)
+		return NULL;
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		struct c_utils_intrusive_link *link = list->head;
+		if(!link)
+			return NULL;
+
+		unlink_link(list, link);
+		return link_to_item(list, link);
+	} // Release Writer Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+void c_utils_intrusive_list_remove_all(struct c_utils_intrusive_list *list) {
+	if(!list)
+		return;
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock)
+		unlink_all(list, NULL);
+}
+
+void c_utils_intrusive_list_delete_all(struct c_utils_intrusive_list *list) {
+	if(!list)
+		return;
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock)
+		unlink_all(list, list->conf.callbacks.destructors.item);
+}
+
+bool c_utils_intrusive_list_contains(struct c_utils_intrusive_list *list, void *item) {
+	if(!list || !item)
+		return false;
+
+	// Acquire Reader Lock
+	C_UTILS_SCOPED_RDLOCK(list->lock)
+		return item_to_link(list, item)->list == list;
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+void *c_utils_intrusive_list_head(struct c_utils_intrusive_list *list) {
+	if(!list)
+		return NULL;
+
+	// Acquire Reader Lock
+	C_UTILS_SCOPED_RDLOCK(list->lock)
+		return list->head ? link_to_item(list, list->head) : NULL;
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+void *c_utils_intrusive_list_tail(struct c_utils_intrusive_list *list) {
+	if(!list)
+		return NULL;
+
+	// Acquire Reader Lock
+	C_UTILS_SCOPED_RDLOCK(list->lock)
+		return list->tail ? link_to_item(list, list->tail) : NULL;
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+size_t c_utils_intrusive_list_size(struct c_utils_intrusive_list *list) {
+	if(!list)
+		return 0;
+
+	return __atomic_load_n(&list->size, __ATOMIC_RELAXED);
+}
+
+bool c_utils_intrusive_list_for_each(struct c_utils_intrusive_list *list, c_utils_general_cb callback) {
+	if(!list)
+		return false;
+
+	if(!callback) {
+		C_UTILS_LOG_ERROR(list->conf.logger, "A callback function is expected to be invoked on each item!");
+		return false;
+	}
+
+	// Acquire Reader Lock
+	C_UTILS_SCOPED_RDLOCK(list->lock)
+		for(struct c_utils_intrusive_link *link = list->head; link; link = link->next)
+			callback(link_to_item(list, link));
+
+	return true;
+}
+
+struct c_utils_iterator *c_utils_intrusive_list_iterator(struct c_utils_intrusive_list *list) {
+	if(!list)
+		return NULL;
+
+	struct c_utils_iterator *it;
+	C_UTILS_ON_BAD_CALLOC(it, list->conf.logger, sizeof(*it))
+		return NULL;
+
+	struct c_utils_intrusive_list_cursor *cursor;
+	C_UTILS_ON_BAD_CALLOC(cursor, list->conf.logger, sizeof(*cursor)) {
+		free(it);
+		return NULL;
+	}
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		cursor->next = list->cursors;
+		if(list->cursors)
+			list->cursors->prev = cursor;
+		list->cursors = cursor;
+	} // Release Writer Lock
+
+	it->handle = list;
+	it->pos = cursor;
+	it->head = head;
+	it->tail = tail;
+	it->next = next;
+	it->prev = prev;
+	it->curr = curr;
+	it->append = append;
+	it->prepend = prepend;
+	it->rem = rem;
+	it->del = del;
+	it->finalize = finalize;
+
+	if(list->conf.flags & C_UTILS_INTRUSIVE_LIST_RC_INSTANCE) {
+		C_UTILS_REF_INC(list);
+		it->conf.ref_counted = true;
+	}
+
+	return it;
+}
+
+void c_utils_intrusive_list_destroy(struct c_utils_intrusive_list *list) {
+	if(!list)
+		return;
+
+	if(list->conf.flags & C_UTILS_INTRUSIVE_LIST_RC_INSTANCE) {
+		C_UTILS_REF_DEC(list);
+		return;
+	}
+
+	destroy_list(list);
+}
+
+
+
+static inline struct c_utils_intrusive_link *item_to_link(struct c_utils_intrusive_list *list, void *item) {
+	return (struct c_utils_intrusive_link *) ((char *) item + list->conf.offset);
+}
+
+static inline void *link_to_item(struct c_utils_intrusive_list *list, struct c_utils_intrusive_link *link) {
+	return (char *) link - list->conf.offset;
+}
+
+/// Links before next, or at the tail if next is NULL.
+static void link_before(struct c_utils_intrusive_list *list, struct c_utils_intrusive_link *next, struct c_utils_intrusive_link *link) {
+	struct c_utils_intrusive_link *prev = next ? next->prev : list->tail;
+
+	link->next = next;
+	link->prev = prev;
+	link->list = list;
+
+	if(prev)
+		prev->next = link;
+	else
+		list->head = link;
+
+	if(next)
+		next->prev = link;
+	else
+		list->tail = link;
+
+	list->size++;
+}
+
+/// Links after every item which does not compare greater, so that equal items stay in the order they were added.
+static void link_sorted(struct c_utils_intrusive_list *list, struct c_utils_intrusive_link *link) {
+	c_utils_comparator_cb compare = list->conf.callbacks.comparators.item;
+	void *item = link_to_item(list, link);
+
+	// Items are often added in about the order they are kept, such as timers, so the search starts from the tail.
+	struct c_utils_intrusive_link *prev = list->tail;
+	while(prev && compare(link_to_item(list, prev), item) > 0)
+		prev = prev->prev;
+
+	link_before(list, prev ? prev->next : list->head, link);
+}
+
+/// Unlinks the link, correcting any iterator positioned on or beside it.
+static void unlink_link(struct c_utils_intrusive_list *list, struct c_utils_intrusive_link *link) {
+	for(struct c_utils_intrusive_list_cursor *cursor = list->cursors; cursor; cursor = cursor->next) {
+		if(cursor->curr == link) {
+			cursor->curr = NULL;
+			cursor->removed = true;
+			cursor->before = link->prev;
+			cursor->after = link->next;
+		} else if(cursor->removed) {
+			if(cursor->before == link)
+				cursor->before = link->prev;
+			if(cursor->after == link)
+				cursor->after = link->next;
+		}
+	}
+
+	if(link->prev)
+		link->prev->next = link->next;
+	else
+		list->head = link->next;
+
+	if(link->next)
+		link->next->prev = link->prev;
+	else
+		list->tail = link->prev;
+
+	link->next = link->prev = NULL;
+	link->list = NULL;
+
+	list->size--;
+}
+
+static void unlink_all(struct c_utils_intrusive_list *list, c_utils_delete_cb del) {
+	while(list->head) {
+		struct c_utils_intrusive_link *link = list->head;
+		unlink_link(list, link);
+
+		if(del)
+			del(link_to_item(list, link));
+	}
+}
+
+static void destroy_list(void *instance) {
+	struct c_utils_intrusive_list *list = instance;
+	unlink_all(list, list->conf.flags & C_UTILS_INTRUSIVE_LIST_DELETE_ON_DESTROY ? list->conf.callbacks.destructors.item : NULL);
+
+	c_utils_scoped_lock_destroy(list->lock);
+
+	// A reference counted list is freed along with it's reference count.
+	if(!(list->conf.flags & C_UTILS_INTRUSIVE_LIST_RC_INSTANCE))
+		free(list);
+}
+
+
+
+/// Positions the cursor on the link, which may be NULL to reset it.
+static void *move_to(struct c_utils_intrusive_list *list, struct c_utils_intrusive_list_cursor *cursor, struct c_utils_intrusive_link *link) {
+	cursor->curr = link;
+	cursor->removed = false;
+	cursor->before = cursor->after = NULL;
+
+	return link ? link_to_item(list, link) : NULL;
+}
+
+static void *head(void *instance, void *pos) {
+	struct c_utils_intrusive_list *list = instance;
+
+	// Acquire Reader Lock
+	C_UTILS_SCOPED_RDLOCK(list->lock)
+		return move_to(list, pos, list->head);
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void *tail(void *instance, void *pos) {
+	struct c_utils_intrusive_list *list = instance;
+
+	// Acquire Reader Lock
+	C_UTILS_SCOPED_RDLOCK(list->lock)
+		return move_to(list, pos, list->tail);
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void *next(void *instance, void *pos) {
+	struct c_utils_intrusive_list *list = instance;
+	struct c_utils_intrusive_list_cursor *cursor = pos;
+
+	// Acquire Reader Lock
+	C_UTILS_SCOPED_RDLOCK(list->lock) {
+		if(cursor->removed)
+			return move_to(list, cursor, cursor->after);
+
+		return move_to(list, cursor, cursor->curr ? cursor->curr->next : list->head);
+	} // Release Reader Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void *prev(void *instance, void *pos) {
+	struct c_utils_intrusive_list *list = instance;
+	struct c_utils_intrusive_list_cursor *cursor = pos;
+
+	// Acquire Reader Lock
+	C_UTILS_SCOPED_RDLOCK(list->lock) {
+		if(cursor->removed)
+			return move_to(list, cursor, cursor->before);
+
+		return move_to(list, cursor, cursor->curr ? cursor->curr->prev : list->tail);
+	} // Release Reader Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void *curr(void *instance, void *pos) {
+	struct c_utils_intrusive_list *list = instance;
+	struct c_utils_intrusive_list_cursor *cursor = pos;
+
+	// Acquire Reader Lock
+	C_UTILS_SCOPED_RDLOCK(list->lock)
+		return cursor->curr ? link_to_item(list, cursor->curr) : NULL;
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static bool append(void *instance, void *pos, void *item) {
+	struct c_utils_intrusive_list *list = instance;
+	struct c_utils_intrusive_list_cursor *cursor = pos;
+
+	// We cannot append to the list and violate sorted order.
+	if(!item || list->conf.callbacks.comparators.item)
+		return false;
+
+	struct c_utils_intrusive_link *link = item_to_link(list, item);
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		if(link->list) {
+			C_UTILS_LOG_ERROR(list->conf.logger, "The item is already on a list!");
+			return false;
+		}
+
+		// Appended where the removed item was, or at the tail if not positioned on one.
+		if(cursor->curr)
+			link_before(list, cursor->curr->next, link);
+		else if(cursor->removed)
+			link_before(list, cursor->after, link);
+		else
+			link_before(list, NULL, link);
+
+		move_to(list, cursor, link);
+		return true;
+	} // Release Writer Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static bool prepend(void *instance, void *pos, void *item) {
+	struct c_utils_intrusive_list *list = instance;
+	struct c_utils_intrusive_list_cursor *cursor = pos;
+
+	// We cannot prepend to the list and violate sorted order.
+	if(!item || list->conf.callbacks.comparators.item)
+		return false;
+
+	struct c_utils_intrusive_link *link = item_to_link(list, item);
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		if(link->list) {
+			C_UTILS_LOG_ERROR(list->conf.logger, "The item is already on a list!");
+			return false;
+		}
+
+		// Prepended where the removed item was, or at the head if not positioned on one.
+		if(cursor->curr)
+			link_before(list, cursor->curr, link);
+		else if(cursor->removed)
+			link_before(list, cursor->after, link);
+		else
+			link_before(list, list->head, link);
+
+		move_to(list, cursor, link);
+		return true;
+	} // Release Writer Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static bool del(void *instance, void *pos) {
+	struct c_utils_intrusive_list *list = instance;
+	struct c_utils_intrusive_list_cursor *cursor = pos;
+	void *item = NULL;
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		if(!cursor->curr)
+			return false;
+
+		item = link_to_item(list, cursor->curr);
+		unlink_link(list, cursor->curr);
+	} // Release Writer Lock
+
+	if(!item)
+		return false;
+
+	list->conf.callbacks.destructors.item(item);
+	return true;
+}
+
+static bool rem(void *instance, void *pos) {
+	struct c_utils_intrusive_list *list = instance;
+	struct c_utils_intrusive_list_cursor *cursor = pos;
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		if(!cursor->curr)
+			return false;
+
+		unlink_link(list, cursor->curr);
+		return true;
+	} // Release Writer Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void finalize(void *instance, void *pos) {
+	struct c_utils_intrusive_list *list = instance;
+	struct c_utils_intrusive_list_cursor *cursor = pos;
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		if(cursor->prev)
+			cursor->prev->next = cursor->next;
+		else
+			list->cursors = cursor->next;
+
+		if(cursor->next)
+			cursor->next->prev = cursor->prev;
+	} // Release Writer Lock
+
+	free(cursor);
+}
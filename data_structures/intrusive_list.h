@@ -0,0 +1,257 @@
+#ifndef C_UTILS_INTRUSIVE_LIST_H
+#define C_UTILS_INTRUSIVE_LIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "iterator.h"
+#include "helpers.h"
+#include "../io/logger.h"
+
+/*
+	Will use a Reader-Writer lock to allow concurrent access to the list, as LIST_CONCURRENT does for c_utils_list.
+*/
+#define C_UTILS_INTRUSIVE_LIST_CONCURRENT 1 << 0
+
+/*
+	This will create the list with a reference count with the appropriate destructor for this type.
+	This allows an iterator to remain valid even after all other users relinquish their count.
+*/
+#define C_UTILS_INTRUSIVE_LIST_RC_INSTANCE 1 << 1
+
+/*
+	Marks the list to call it's destructor on each item when it is destroyed.
+*/
+#define C_UTILS_INTRUSIVE_LIST_DELETE_ON_DESTROY 1 << 2
+
+/*
+	A double linked-list whose links live inside of the items themselves, rather than in a node allocated for
+	each item. Each item embeds a struct c_utils_intrusive_link, and the list is told the offset of it within
+	the item, so that the link of an item, and the item of a link, are found by adding or subtracting it.
+
+	As the caller already holds the link whenever it holds the item, removing an item, or finding whether the
+	list holds it, is O(1) rather than a search for the node which holds it, and adding never allocates. In
+	exchange, an item may only be on one list at a time for each link it embeds, and must outlive it's time on it.
+
+	The list is otherwise used as c_utils_list is, with the same optional locking and iterator. As the list can
+	not hold a reference to a link, it instead keeps track of it's iterators, and corrects any positioned on an
+	item as it is removed, so that they continue on from where it was, as c_utils_list's do.
+
+	Time complexity of adding is O(1), or O(N) if a comparator is specified, and of removing, finding and
+	retrieving the head or tail is O(1).
+*/
+struct c_utils_intrusive_list;
+
+/*
+	Embedded in each item. Must be zeroed, such as by calloc or an initializer, before it is first added.
+*/
+struct c_utils_intrusive_link {
+	struct c_utils_intrusive_link *next;
+	struct c_utils_intrusive_link *prev;
+	/// The list the item is on, or NULL if it is on none.
+	struct c_utils_intrusive_list *list;
+};
+
+/*
+	flags:
+		default:
+			0
+		note:
+			Used to toggle certain functionality on and off.
+	offset:
+		default:
+			0
+		note:
+			The offset of the struct c_utils_intrusive_link within each item, as given by offsetof.
+	callbacks:
+		comparators:
+			item:
+				default:
+					NULL
+				note:
+					When specified, the list is kept sorted, and the iterator may not append or prepend.
+		destructors:
+			item:
+				default:
+					free
+				note:
+					Called when an item is deleted rather than removed.
+	logger:
+		default:
+			NULL
+		note:
+			Logs misuse, such as adding an item already on a list.
+*/
+struct c_utils_intrusive_list_conf {
+	/// Additional flags used to configure and tune the list.
+	int flags;
+	/// Offset of the link within each item.
+	size_t offset;
+	/// Grouping of callback functions
+	struct {
+		struct {
+			c_utils_comparator_cb item;
+		} comparators;
+		struct {
+			c_utils_delete_cb item;
+		} destructors;
+	} callbacks;
+	/// Logger
+	struct c_utils_logger *logger;
+};
+
+/// Obtains the struct of the given type from a pointer to the member embedded within it.
+#define C_UTILS_CONTAINER_OF(ptr, type, member) ((type *) ((char *) (ptr) - offsetof(type, member)))
+
+/*
+	Used to iterate through the list using an automatic iterator (requires GCC and Clang). The item iterated over
+	may be removed within the loop, after which the iterator continues on from where it was.
+*/
+#define C_UTILS_INTRUSIVE_LIST_FOR_EACH(item, list) \
+	for(C_UTILS_AUTO_ITERATOR _this_iterator = c_utils_intrusive_list_iterator(list); (item = c_utils_iterator_next(_this_iterator));)
+
+/*
+	Used to iterate backwards through the list using an automatic iterator (requires GCC and Clang).
+*/
+#define C_UTILS_INTRUSIVE_LIST_FOR_EACH_REV(item, list) \
+	for(C_UTILS_AUTO_ITERATOR _this_iterator = c_utils_intrusive_list_iterator(list); (item = c_utils_iterator_prev(_this_iterator));)
+
+#ifdef NO_C_UTILS_PREFIX
+/*
+	Typedefs
+*/
+typedef struct c_utils_intrusive_list intrusive_list_t;
+typedef struct c_utils_intrusive_list_conf intrusive_list_conf_t;
+typedef struct c_utils_intrusive_link intrusive_link_t;
+
+/*
+	Macros
+*/
+#define CONTAINER_OF(...) C_UTILS_CONTAINER_OF(__VA_ARGS__)
+#define INTRUSIVE_LIST_FOR_EACH(...) C_UTILS_INTRUSIVE_LIST_FOR_EACH(__VA_ARGS__)
+#define INTRUSIVE_LIST_FOR_EACH_REV(...) C_UTILS_INTRUSIVE_LIST_FOR_EACH_REV(__VA_ARGS__)
+
+/*
+	Constants
+*/
+#define INTRUSIVE_LIST_CONCURRENT C_UTILS_INTRUSIVE_LIST_CONCURRENT
+#define INTRUSIVE_LIST_RC_INSTANCE C_UTILS_INTRUSIVE_LIST_RC_INSTANCE
+#define INTRUSIVE_LIST_DELETE_ON_DESTROY C_UTILS_INTRUSIVE_LIST_DELETE_ON_DESTROY
+
+/*
+	Functions
+*/
+#define intrusive_list_create(...) c_utils_intrusive_list_create(__VA_ARGS__)
+#define intrusive_list_create_conf(...) c_utils_intrusive_list_create_conf(__VA_ARGS__)
+#define intrusive_list_add(...) c_utils_intrusive_list_add(__VA_ARGS__)
+#define intrusive_list_remove(...) c_utils_intrusive_list_remove(__VA_ARGS__)
+#define intrusive_list_delete(...) c_utils_intrusive_list_delete(__VA_ARGS__)
+#define intrusive_list_remove_head(...) c_utils_intrusive_list_remove_head(__VA_ARGS__)
+#define intrusive_list_remove_all(...) c_utils_intrusive_list_remove_all(__VA_ARGS__)
+#define intrusive_list_delete_all(...) c_utils_intrusive_list_delete_all(__VA_ARGS__)
+#define intrusive_list_contains(...) c_utils_intrusive_list_contains(__VA_ARGS__)
+#define intrusive_list_head(...) c_utils_intrusive_list_head(__VA_ARGS__)
+#define intrusive_list_tail(...) c_utils_intrusive_list_tail(__VA_ARGS__)
+#define intrusive_list_size(...) c_utils_intrusive_list_size(__VA_ARGS__)
+#define intrusive_list_for_each(...) c_utils_intrusive_list_for_each(__VA_ARGS__)
+#define intrusive_list_iterator(...) c_utils_intrusive_list_iterator(__VA_ARGS__)
+#define intrusive_list_destroy(...) c_utils_intrusive_list_destroy(__VA_ARGS__)
+#endif
+
+/**
+ * Creates an empty list of items which embed their link at the given offset.
+ *
+ * @param offset Offset of the link within each item, as given by offsetof.
+ * @return Instance, or NULL if an allocation error occurs.
+ */
+struct c_utils_intrusive_list *c_utils_intrusive_list_create(size_t offset);
+
+struct c_utils_intrusive_list *c_utils_intrusive_list_create_conf(struct c_utils_intrusive_list_conf *conf);
+
+/**
+ * Links the item into the list, in sorted order if a comparator was specified, or at the tail if not.
+ *
+ * @param list Instance.
+ * @param item Item, whose link must not be on any list.
+ * @return true if added, false if the item is NULL or already on a list.
+ */
+bool c_utils_intrusive_list_add(struct c_utils_intrusive_list *list, void *item);
+
+/**
+ * Unlinks the item from the list in O(1), without deleting it.
+ *
+ * @param list Instance.
+ * @param item Item.
+ * @return true if removed, false if the item is not on this list.
+ */
+bool c_utils_intrusive_list_remove(struct c_utils_intrusive_list *list, void *item);
+
+/**
+ * Unlinks the item from the list in O(1), and then calls the destructor on it.
+ *
+ * @param list Instance.
+ * @param item Item.
+ * @return true if deleted, false if the item is not on this list.
+ */
+bool c_utils_intrusive_list_delete(struct c_utils_intrusive_list *list, void *item);
+
+/**
+ * Unlinks the item at the head of the list, such as the earliest of a sorted list of timers.
+ *
+ * @param list Instance.
+ * @return The item, or NULL if the list is empty.
+ */
+void *c_utils_intrusive_list_remove_head(struct c_utils_intrusive_list *list);
+
+void c_utils_intrusive_list_remove_all(struct c_utils_intrusive_list *list);
+
+void c_utils_intrusive_list_delete_all(struct c_utils_intrusive_list *list);
+
+/**
+ * @param list Instance.
+ * @param item Item.
+ * @return true if the item is on this list.
+ */
+bool c_utils_intrusive_list_contains(struct c_utils_intrusive_list *list, void *item);
+
+/**
+ * @param list Instance.
+ * @return The item at the head, or NULL if the list is empty.
+ */
+void *c_utils_intrusive_list_head(struct c_utils_intrusive_list *list);
+
+/**
+ * @param list Instance.
+ * @return The item at the tail, or NULL if the list is empty.
+ */
+void *c_utils_intrusive_list_tail(struct c_utils_intrusive_list *list);
+
+size_t c_utils_intrusive_list_size(struct c_utils_intrusive_list *list);
+
+/**
+ * Calls the callback on each item while holding the reader lock, so it may not add or remove items.
+ *
+ * @param list Instance.
+ * @param callback Callback.
+ * @return true on success, false if list or callback is NULL.
+ */
+bool c_utils_intrusive_list_for_each(struct c_utils_intrusive_list *list, c_utils_general_cb callback);
+
+/**
+ * Creates an iterator which supports the same operations as c_utils_list's. If the item it is positioned on is
+ * removed, moving next or prev continues from where it was, and appending or prepending inserts where it was.
+ *
+ * @param list Instance.
+ * @return Iterator, or NULL if an allocation error occurs.
+ */
+struct c_utils_iterator *c_utils_intrusive_list_iterator(struct c_utils_intrusive_list *list);
+
+/**
+ * Destroys the list, calling the destructor on each item if INTRUSIVE_LIST_DELETE_ON_DESTROY is flagged, or otherwise
+ * leaving each unlinked, so that it may be added to another list.
+ *
+ * @param list Instance.
+ */
+void c_utils_intrusive_list_destroy(struct c_utils_intrusive_list *list);
+
+#endif /* C_UTILS_INTRUSIVE_LIST_H */
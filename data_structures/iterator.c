@@ -79,11 +79,12 @@ void c_utils_iterator_destroy(struct c_utils_iterator *it) {
 	if(!it)
 		return;
 
-	if(it->conf.ref_counted)
-		C_UTILS_REF_DEC(it->handle);
-
+	// Finalized first, as finalize may still need the handle, which the last reference frees.
 	if(it->finalize)
 		it->finalize(it->handle, it->pos);
 
+	if(it->conf.ref_counted)
+		C_UTILS_REF_DEC(it->handle);
+
 	free(it);
 }
\ No newline at end of file
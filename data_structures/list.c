@@ -5,6 +5,77 @@
 #include "../threading/scoped_lock.h"
 #include "../misc/argument_check.h"
 #include "../memory/ref_count.h"
+#include "../memory/node_pool.h"
+#include "../memory/hazard.h"
+#include "sort.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#define C_UTILS_LIST_CACHE_LINE 64
+
+/// The size of a chunk when conf.size.chunk is not specified.
+#define C_UTILS_LIST_CHUNK_SIZE (4 * C_UTILS_LIST_CACHE_LINE)
+
+/// The most levels of the skip list if C_UTILS_LIST_INDEXED is flagged, enough for 4^32 nodes.
+#define C_UTILS_LIST_SKIP_LEVELS 32
+
+/// The hazard pointers held if C_UTILS_LIST_LOCK_FREE is flagged, on the node being compared, the node behind it, and the node stepped onto.
+#define C_UTILS_LIST_HP_CURR (C_UTILS_HAZARD_INDEX_LIST + 0)
+#define C_UTILS_LIST_HP_PRED (C_UTILS_HAZARD_INDEX_LIST + 1)
+#define C_UTILS_LIST_HP_STEP (C_UTILS_HAZARD_INDEX_LIST + 2)
+
+/// Set on a lock-free node's state once the thread which marked it has decided what becomes of it's item.
+#define C_UTILS_LIST_REMOVED 1 << 0
+
+/// Set on a lock-free node's state once it has been unlinked from the list.
+#define C_UTILS_LIST_UNLINKED 1 << 1
+
+struct c_utils_list_chunk {
+	/// The next chunk in the list.
+	struct c_utils_list_chunk *next;
+	/// The previous chunk in the list.
+	struct c_utils_list_chunk *prev;
+	/// The chunk this one's items were moved to when it was merged, which it holds a reference to.
+	struct c_utils_list_chunk *into;
+	/// Held by the list while linked, by each iterator positioned around it, and by each chunk merged into it.
+	volatile unsigned int ref_count;
+	/// The amount of items, which are kept contiguous at the start of items.
+	unsigned int count;
+	/// If this chunk is still linked into the list, used by iterator implementations.
+	volatile bool is_valid;
+	void *items[];
+};
+
+/// A node's link on a level of the skip list above the list itself, which is it's own level 0.
+struct c_utils_list_skip_link {
+	/// The next node at least as tall as this level, or NULL.
+	struct c_utils_node *next;
+	/// The previous node at least as tall as this level, or NULL for the list's own links.
+	struct c_utils_node *prev;
+	/// The amount of nodes next is ahead of this one, counting next, or of the end of the list if next is NULL.
+	size_t span;
+};
+
+/// Allocated directly after each node if C_UTILS_LIST_INDEXED is flagged.
+struct c_utils_list_tower {
+	/// The amount of levels the node is linked on, including level 0.
+	unsigned int height;
+	/// The links for levels 1 up to height - 1.
+	struct c_utils_list_skip_link links[];
+};
+
+/// Allocated directly after each node if C_UTILS_LIST_LOCK_FREE is flagged.
+struct c_utils_list_lock_free_node {
+	/// Called on the item once the node is retired, set by the thread which removed it.
+	c_utils_delete_cb del;
+	/// Whichever of the removing and unlinking thread sets the second flag retires the node.
+	volatile unsigned int state;
+};
+
+/// Decides whether a lock-free search stops at the node, the position being the amount of nodes before it.
+typedef bool (*c_utils_list_match_cb)(struct c_utils_list *list, struct c_utils_node *node, const void *target, size_t position);
 
 struct c_utils_list {
 	/// The head node of the list.
@@ -13,6 +84,24 @@ struct c_utils_list {
 	struct c_utils_node *tail;
 	/// The current size of the linked list.
 	volatile size_t size;
+	/// Used instead of nodes if C_UTILS_LIST_UNROLLED is flagged.
+	struct {
+		struct c_utils_list_chunk *head;
+		struct c_utils_list_chunk *tail;
+		/// The amount of items each chunk holds.
+		unsigned int capacity;
+		/// The size of each chunk, a multiple of the cache line.
+		size_t size;
+	} chunks;
+	/// Indexes the nodes if C_UTILS_LIST_INDEXED is flagged.
+	struct {
+		/// The amount of levels in use, including the list itself.
+		unsigned int level;
+		/// Advanced atomically to pick the height of each node before the lock is acquired.
+		uint64_t seed;
+		/// The links before the first node of each level, for levels 1 and up.
+		struct c_utils_list_skip_link links[C_UTILS_LIST_SKIP_LEVELS - 1];
+	} skip;
 	/// Ensures only one thread manipulates the items in the list, but multiple threads can read.
 	struct c_utils_scoped_lock *lock;
 	/// The configuration object used to retrieve callbacks and flags.
@@ -25,6 +114,19 @@ struct c_utils_list_iterator_position {
 	struct c_utils_node *next;
 };
 
+struct c_utils_list_slot {
+	struct c_utils_list_chunk *chunk;
+	unsigned int index;
+	/// The item in the slot when it was taken, used to find it again after it has been moved.
+	void *item;
+};
+
+struct c_utils_list_unrolled_iterator_position {
+	struct c_utils_list_slot prev;
+	struct c_utils_list_slot curr;
+	struct c_utils_list_slot next;
+};
+
 //////////////////////////////////////////////////////////////////////////////////////
 //	 																				//
 //						List Add Helper Functions                                   //
@@ -75,7 +177,7 @@ static void remove_item(struct c_utils_list *list, void *item, bool delete_item)
 //  																				//
 //////////////////////////////////////////////////////////////////////////////////////
 
-static struct c_utils_node *create_node(void *item, bool ref_item);
+static struct c_utils_node *create_node(struct c_utils_list *list, void *item);
 
 static void invalidate_node(struct c_utils_node *node);
 
@@ -89,6 +191,109 @@ static void for_each_item(struct c_utils_list *list, void (*callback)(void *item
 
 static void destroy_list(void *instance);
 
+static int compare_nodes(const void *node_one, const void *node_two);
+
+static bool sort_nodes(struct c_utils_list *list, c_utils_comparator_cb compare);
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Unrolled List Helper Functions                              //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static struct c_utils_list_chunk *create_chunk(struct c_utils_list *list);
+
+static void ref_chunk(struct c_utils_list_chunk *chunk);
+
+static void unref_chunk(struct c_utils_list_chunk *chunk);
+
+static void link_chunk(struct c_utils_list *list, struct c_utils_list_chunk *prev, struct c_utils_list_chunk *chunk);
+
+static void unlink_chunk(struct c_utils_list *list, struct c_utils_list_chunk *chunk, struct c_utils_list_chunk *into);
+
+static bool insert_item(struct c_utils_list *list, struct c_utils_list_slot *slot, void *item);
+
+static void remove_slot(struct c_utils_list *list, struct c_utils_list_chunk *chunk, unsigned int index, c_utils_delete_cb del);
+
+static bool add_to_chunk(struct c_utils_list *list, void *item);
+
+static struct c_utils_list_chunk *item_to_chunk(struct c_utils_list *list, void *item, unsigned int *index);
+
+static struct c_utils_list_chunk *index_to_chunk(struct c_utils_list *list, unsigned int *index);
+
+static int delete_all_chunks(struct c_utils_list *list, c_utils_delete_cb del);
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Indexed List Helper Functions                               //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static unsigned int skip_random_height(struct c_utils_list *list);
+
+static unsigned int skip_height(struct c_utils_node *node);
+
+static struct c_utils_list_skip_link *skip_link(struct c_utils_list *list, struct c_utils_node *node, unsigned int level);
+
+static size_t skip_predecessors(struct c_utils_list *list, struct c_utils_node *node, struct c_utils_node **update, size_t *distance);
+
+static void skip_insert(struct c_utils_list *list, struct c_utils_node *node);
+
+static void skip_unlink(struct c_utils_list *list, struct c_utils_node *node);
+
+static struct c_utils_node *skip_find_sorted(struct c_utils_list *list, void *item, c_utils_comparator_cb compare);
+
+static struct c_utils_node *skip_find_index(struct c_utils_list *list, unsigned int index);
+
+static void skip_rebuild(struct c_utils_list *list);
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Lock-Free List Helper Functions                             //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static inline bool lock_free_is_marked(struct c_utils_node *node);
+
+static inline struct c_utils_node *lock_free_mark(struct c_utils_node *node);
+
+static inline struct c_utils_node *lock_free_unmark(struct c_utils_node *node);
+
+static inline struct c_utils_list_lock_free_node *lock_free_node(struct c_utils_node *node);
+
+static bool lock_free_match_item(struct c_utils_list *list, struct c_utils_node *node, const void *item, size_t position);
+
+static bool lock_free_match_index(struct c_utils_list *list, struct c_utils_node *node, const void *index, size_t position);
+
+static bool lock_free_match_node(struct c_utils_list *list, struct c_utils_node *node, const void *target, size_t position);
+
+static bool lock_free_match_sorted(struct c_utils_list *list, struct c_utils_node *node, const void *item, size_t position);
+
+static void lock_free_unref_item(void *item);
+
+static void lock_free_release_next(void *node);
+
+static void lock_free_retired(void *node);
+
+static void lock_free_finish(struct c_utils_node *node, unsigned int flag);
+
+static void lock_free_release_find(void);
+
+static struct c_utils_node *lock_free_find(struct c_utils_list *list, c_utils_list_match_cb match, const void *target, struct c_utils_node ***link_ptr);
+
+static struct c_utils_node *lock_free_step(struct c_utils_list *list, struct c_utils_node *node, bool ref_item);
+
+static bool lock_free_add(struct c_utils_list *list, struct c_utils_node *node);
+
+static void *lock_free_remove(struct c_utils_list *list, c_utils_list_match_cb match, const void *target, c_utils_delete_cb del);
+
+static void *lock_free_as_array(struct c_utils_list *list, size_t *size);
+
+static void lock_free_destroy_nodes(struct c_utils_list *list, c_utils_delete_cb del);
+
 
 //////////////////////////////////////////////////////////////////////////////////////
 //	 																				//
@@ -121,6 +326,58 @@ static bool rem(void *instance, void *pos);
 static void finalize(void *instance, void *pos);
 
 
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Unrolled Iterator Implementation functions                  //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static bool locate(struct c_utils_list_slot *slot, struct c_utils_list_chunk **chunk, unsigned int *index);
+
+static void set_slot(struct c_utils_list_slot *slot, struct c_utils_list_chunk *chunk, unsigned int index);
+
+static void update_slots(struct c_utils_list_unrolled_iterator_position *pos, struct c_utils_list_chunk *chunk, unsigned int index, bool ref_item);
+
+static void *unrolled_head(void *instance, void *pos);
+
+static void *unrolled_tail(void *instance, void *pos);
+
+static void *unrolled_next(void *instance, void *pos);
+
+static void *unrolled_prev(void *instance, void *pos);
+
+static void *unrolled_curr(void *instance, void *pos);
+
+static bool unrolled_append(void *instance, void *pos, void *item);
+
+static bool unrolled_prepend(void *instance, void *pos, void *item);
+
+static bool unrolled_del(void *instance, void *pos);
+
+static bool unrolled_rem(void *instance, void *pos);
+
+static void unrolled_finalize(void *instance, void *pos);
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Lock-Free Iterator Implementation functions                 //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static void *lock_free_head(void *instance, void *pos);
+
+static void *lock_free_next(void *instance, void *pos);
+
+static void *lock_free_curr(void *instance, void *pos);
+
+static bool lock_free_append(void *instance, void *pos, void *item);
+
+static bool lock_free_del(void *instance, void *pos);
+
+static bool lock_free_rem(void *instance, void *pos);
+
+
 
 
 struct c_utils_list *c_utils_list_create() {
@@ -132,6 +389,21 @@ struct c_utils_list *c_utils_list_create_conf(struct c_utils_list_conf *conf) {
 	if(!conf)
 		return NULL;
 
+	if((conf->flags & C_UTILS_LIST_INDEXED) && (conf->flags & C_UTILS_LIST_UNROLLED)) {
+		C_UTILS_LOG_ERROR(conf->logger, "LIST_INDEXED and LIST_UNROLLED may not both be flagged!");
+		return NULL;
+	}
+
+	if((conf->flags & C_UTILS_LIST_LOCK_FREE) && (conf->flags & (C_UTILS_LIST_INDEXED | C_UTILS_LIST_UNROLLED))) {
+		C_UTILS_LOG_ERROR(conf->logger, "LIST_LOCK_FREE may not be flagged with LIST_INDEXED or LIST_UNROLLED!");
+		return NULL;
+	}
+
+	if(conf->pool && c_utils_node_pool_node_size(conf->pool) < c_utils_ref_size(sizeof(struct c_utils_node))) {
+		C_UTILS_LOG_ERROR(conf->logger, "The pool's nodes of %zu bytes are too small!", c_utils_node_pool_node_size(conf->pool));
+		return NULL;
+	}
+
 	struct c_utils_list *list;
 
 	if(conf->flags & C_UTILS_LIST_RC_INSTANCE) {
@@ -147,8 +419,20 @@ struct c_utils_list *c_utils_list_create_conf(struct c_utils_list_conf *conf) {
 
 	list->head = list->tail = NULL;
 	list->size = 0;
+	list->chunks.head = list->chunks.tail = NULL;
+	list->skip.level = 1;
+	list->skip.seed = (uintptr_t) list ^ (uint64_t) time(NULL);
+
+	if(conf->flags & C_UTILS_LIST_UNROLLED) {
+		size_t size = conf->size.chunk ? offsetof(struct c_utils_list_chunk, items) + conf->size.chunk * sizeof(void *) : C_UTILS_LIST_CHUNK_SIZE;
+		size = (size + C_UTILS_LIST_CACHE_LINE - 1) & ~(size_t) (C_UTILS_LIST_CACHE_LINE - 1);
+
+		list->chunks.size = size;
+		list->chunks.capacity = (size - offsetof(struct c_utils_list_chunk, items)) / sizeof(void *);
+	}
 
-	if (conf->flags & C_UTILS_LIST_CONCURRENT)
+	// A lock-free list is concurrent without one.
+	if ((conf->flags & C_UTILS_LIST_CONCURRENT) && !(conf->flags & C_UTILS_LIST_LOCK_FREE))
 		list->lock = c_utils_scoped_lock_rwlock(NULL, conf->logger);
 	else
 		list->lock = c_utils_scoped_lock_no_op();
@@ -224,13 +508,28 @@ bool c_utils_list_add(struct c_utils_list *list, void *item) {
 		C_UTILS_LOG_ERROR(list->conf.logger, "This list does not support NULL elements!");
 		return false;
 	}
+
+	if(list->conf.flags & C_UTILS_LIST_UNROLLED) {
+		// Acquire Writer Lock
+		C_UTILS_SCOPED_WRLOCK(list->lock) {
+			if(list->conf.size.max && list->conf.size.max == list->size)
+				return false;
+
+			return add_to_chunk(list, item);
+		} // Release Writer Lock
+
+		C_UTILS_UNACCESSIBLE;
+	}
 	
-	struct c_utils_node *node = create_node(item, list->conf.flags & C_UTILS_LIST_RC_ITEM);
+	struct c_utils_node *node = create_node(list, item);
 	if(!node) {
 		C_UTILS_LOG_ASSERT(list->conf.logger, "create_node: \"Failed to create reference counted node!\"");
 		return false;
 	}
 
+	if(list->conf.flags & C_UTILS_LIST_LOCK_FREE)
+		return lock_free_add(list, node);
+
 	// Acquire Writer Lock
 	C_UTILS_SCOPED_WRLOCK(list->lock) {
 		if(list->conf.size.max && list->conf.size.max == list->size)
@@ -287,7 +586,7 @@ void c_utils_list_delete_at(struct c_utils_list *list, unsigned int index) {
 }
 
 size_t c_utils_list_size(struct c_utils_list *list) {
-	return list->size;
+	return __atomic_load_n(&list->size, __ATOMIC_RELAXED);
 }
 
 bool c_utils_list_for_each(struct c_utils_list *list, void (*callback)(void *item)) {
@@ -299,6 +598,11 @@ bool c_utils_list_for_each(struct c_utils_list *list, void (*callback)(void *ite
 		return false;
 	}
 
+	if(list->conf.flags & C_UTILS_LIST_LOCK_FREE) {
+		for_each_item(list, callback);
+		return true;
+	}
+
 	// Acquire Reader Lock
 	C_UTILS_SCOPED_RDLOCK(list->lock)
 		for_each_item(list, callback);
@@ -315,9 +619,23 @@ bool c_utils_list_contains(struct c_utils_list *list, void *item) {
 		return false;
 	}
 
+	unsigned int index;
+
+	if(list->conf.flags & C_UTILS_LIST_LOCK_FREE) {
+		struct c_utils_node **link;
+		bool found = !!lock_free_find(list, lock_free_match_item, item, &link);
+		lock_free_release_find();
+
+		return found;
+	}
+
 	// Acquire Reader Lock
-	C_UTILS_SCOPED_RDLOCK(list->lock)
+	C_UTILS_SCOPED_RDLOCK(list->lock) {
+		if(list->conf.flags & C_UTILS_LIST_UNROLLED)
+			return !!item_to_chunk(list, item, &index);
+
 		return !!item_to_node(list, item);
+	} // Release Reader Lock
 
 	C_UTILS_UNACCESSIBLE;
 }
@@ -326,8 +644,21 @@ void *c_utils_list_get(struct c_utils_list *list, unsigned int index) {
 	if(!list)
 		return NULL;
 
+	if(list->conf.flags & C_UTILS_LIST_LOCK_FREE) {
+		struct c_utils_node **link, *node = lock_free_find(list, lock_free_match_index, &index, &link);
+		void *item = node ? node->item : NULL;
+		lock_free_release_find();
+
+		return item;
+	}
+
 	// Acquire Reader Lock
 	C_UTILS_SCOPED_RDLOCK(list->lock) {
+		if(list->conf.flags & C_UTILS_LIST_UNROLLED) {
+			struct c_utils_list_chunk *chunk = index_to_chunk(list, &index);
+			return chunk ? chunk->items[index] : NULL;
+		}
+
 		struct c_utils_node *node = index_to_node(list, index);
 		return node ? node->item : NULL;
 	} // Release Reader Lock
@@ -339,6 +670,9 @@ void *c_utils_list_as_array(struct c_utils_list *list, size_t *size) {
 	if(!list)
 		return NULL;
 
+	if(list->conf.flags & C_UTILS_LIST_LOCK_FREE)
+		return lock_free_as_array(list, size);
+
 	// Acquire Reader Lock
 	C_UTILS_SCOPED_RDLOCK(list->lock) {
 		void **array_of_items;
@@ -346,8 +680,15 @@ void *c_utils_list_as_array(struct c_utils_list *list, size_t *size) {
 			return NULL;
 
 		int index = 0;
-		for (struct c_utils_node *node = list->head; node; node = node->next)
-			array_of_items[index++] = node->item;
+		if(list->conf.flags & C_UTILS_LIST_UNROLLED) {
+			for (struct c_utils_list_chunk *chunk = list->chunks.head; chunk; chunk = chunk->next) {
+				memcpy(array_of_items + index, chunk->items, chunk->count * sizeof(void *));
+				index += chunk->count;
+			}
+		} else {
+			for (struct c_utils_node *node = list->head; node; node = node->next)
+				array_of_items[index++] = node->item;
+		}
 
 		*size = index;
 		return array_of_items;
@@ -356,6 +697,64 @@ void *c_utils_list_as_array(struct c_utils_list *list, size_t *size) {
 	C_UTILS_UNACCESSIBLE;
 }
 
+bool c_utils_list_sort(struct c_utils_list *list, c_utils_comparator_cb compare) {
+	if(!list)
+		return false;
+
+	if(!compare) {
+		C_UTILS_LOG_ERROR(list->conf.logger, "A comparator is expected to sort the list by!");
+		return false;
+	}
+
+	// A sorted list is already in the order of it's own comparator, and must stay in it.
+	if(list->conf.callbacks.comparators.item) {
+		if(compare != list->conf.callbacks.comparators.item) {
+			C_UTILS_LOG_ERROR(list->conf.logger, "A sorted list may only be sorted by it's own comparator!");
+			return false;
+		}
+
+		return true;
+	}
+
+	if(list->conf.flags & C_UTILS_LIST_LOCK_FREE) {
+		C_UTILS_LOG_ERROR(list->conf.logger, "A lock-free list may not be sorted!");
+		return false;
+	}
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		if(!(list->conf.flags & C_UTILS_LIST_UNROLLED))
+			return sort_nodes(list, compare);
+
+		void **items;
+		C_UTILS_ON_BAD_MALLOC(items, list->conf.logger, sizeof(void *) * list->size)
+			return false;
+
+		size_t index = 0;
+		for (struct c_utils_list_chunk *chunk = list->chunks.head; chunk; chunk = chunk->next) {
+			memcpy(items + index, chunk->items, chunk->count * sizeof(void *));
+			index += chunk->count;
+		}
+
+		c_utils_sort(items, index, compare);
+
+		/*
+			Each chunk keeps the amount of items it held, so only the items are moved. Iterators keep their slot, and
+			so end up on whichever item is sorted into it, as the list does not know of them to reposition them.
+		*/
+		index = 0;
+		for (struct c_utils_list_chunk *chunk = list->chunks.head; chunk; chunk = chunk->next) {
+			memcpy(chunk->items, items + index, chunk->count * sizeof(void *));
+			index += chunk->count;
+		}
+
+		free(items);
+		return true;
+	} // Release Writer Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
 struct c_utils_iterator *c_utils_list_iterator(struct c_utils_list *list) {
 	if(!list)
 		return NULL;
@@ -364,22 +763,48 @@ struct c_utils_iterator *c_utils_list_iterator(struct c_utils_list *list) {
 	C_UTILS_ON_BAD_CALLOC(it, list->conf.logger, sizeof(*it))
 		return NULL;
 
-	C_UTILS_ON_BAD_CALLOC(it->pos, list->conf.logger, sizeof(struct c_utils_list_iterator_position)) {
+	if(list->conf.flags & C_UTILS_LIST_LOCK_FREE) {
+		C_UTILS_ON_BAD_CALLOC(it->pos, list->conf.logger, sizeof(struct c_utils_list_iterator_position)) {
+			free(it);
+			return NULL;
+		}
+
+		// The nodes are only linked forwards, so the rest are left NULL to fail.
+		it->handle = list;
+		it->head = lock_free_head;
+		it->next = lock_free_next;
+		it->curr = lock_free_curr;
+		it->append = lock_free_append;
+		it->rem = lock_free_rem;
+		it->del = lock_free_del;
+		it->finalize = finalize;
+
+		if(list->conf.flags & C_UTILS_LIST_RC_INSTANCE) {
+			C_UTILS_REF_INC(list);
+			it->conf.ref_counted = true;
+		}
+
+		return it;
+	}
+
+	bool unrolled = list->conf.flags & C_UTILS_LIST_UNROLLED;
+	size_t pos_size = unrolled ? sizeof(struct c_utils_list_unrolled_iterator_position) : sizeof(struct c_utils_list_iterator_position);
+	C_UTILS_ON_BAD_CALLOC(it->pos, list->conf.logger, pos_size) {
 		free(it);
 		return NULL;
 	}
 
 	it->handle = list;
-	it->head = head;
-	it->tail = tail;
-	it->next = next;
-	it->prev = prev;
-	it->curr = curr;
-	it->append = append;
-	it->prepend = prepend;
-	it->rem = rem;
-	it->del = del;
-	it->finalize = finalize;
+	it->head = unrolled ? unrolled_head : head;
+	it->tail = unrolled ? unrolled_tail : tail;
+	it->next = unrolled ? unrolled_next : next;
+	it->prev = unrolled ? unrolled_prev : prev;
+	it->curr = unrolled ? unrolled_curr : curr;
+	it->append = unrolled ? unrolled_append : append;
+	it->prepend = unrolled ? unrolled_prepend : prepend;
+	it->rem = unrolled ? unrolled_rem : rem;
+	it->del = unrolled ? unrolled_del : del;
+	it->finalize = unrolled ? unrolled_finalize : finalize;
 
 	// Increment reference count for iterator.
 	if(list->conf.flags & C_UTILS_LIST_RC_INSTANCE) {
@@ -399,6 +824,9 @@ static inline int add_as_head(struct c_utils_list *list, struct c_utils_node *no
 	list->head = node;
 	node->prev = NULL;
 	list->size++;
+
+	if (list->conf.flags & C_UTILS_LIST_INDEXED)
+		skip_insert(list, node);
 	
 	return 1;
 }
@@ -409,6 +837,9 @@ static inline int add_as_tail(struct c_utils_list *list, struct c_utils_node *no
 	list->tail = node;
 	node->next = NULL;
 	list->size++;
+
+	if (list->conf.flags & C_UTILS_LIST_INDEXED)
+		skip_insert(list, node);
 	
 	return 1;
 }
@@ -419,6 +850,9 @@ static inline int add_after(struct c_utils_list *list, struct c_utils_node *curr
 	new_node->prev = current_node;
 	current_node->next = new_node;
 	list->size++;
+
+	if (list->conf.flags & C_UTILS_LIST_INDEXED)
+		skip_insert(list, new_node);
 	
 	return 1;
 }
@@ -428,6 +862,9 @@ static inline int add_as_only(struct c_utils_list *list, struct c_utils_node *no
 	list->head = list->tail = node;
 	node->next = node->prev = NULL;
 	list->size++;
+
+	if (list->conf.flags & C_UTILS_LIST_INDEXED)
+		skip_insert(list, node);
 	
 	return 1;
 }
@@ -438,12 +875,23 @@ static inline int add_before(struct c_utils_list *list, struct c_utils_node *cur
 	new_node->prev = current_node->prev;
 	current_node->prev = new_node;
 	list->size++;
+
+	if (list->conf.flags & C_UTILS_LIST_INDEXED)
+		skip_insert(list, new_node);
 	
 	return 1;
 }
 
 static inline int add_sorted(struct c_utils_list *list, struct c_utils_node *node, c_utils_comparator_cb compare) {
 	struct c_utils_node *current_node = NULL;
+	if (list->conf.flags & C_UTILS_LIST_INDEXED) {
+		current_node = skip_find_sorted(list, node->item, compare);
+		if (!current_node)
+			return add_as_tail(list, node);
+
+		return current_node == list->head ? add_as_head(list, node) : add_before(list, current_node, node);
+	}
+
 	if (list->size == 1)
 		return compare(node->item, list->head->item) < 0 ? add_as_head(list, node) : add_as_tail(list, node);
 
@@ -471,6 +919,9 @@ static inline int add_unsorted(struct c_utils_list *list, struct c_utils_node *n
 	list->tail = node;
 	list->size++;
 
+	if (list->conf.flags & C_UTILS_LIST_INDEXED)
+		skip_insert(list, node);
+
 	return 1;
 }
 
@@ -537,6 +988,9 @@ static inline int remove_normal(struct c_utils_list *list, struct c_utils_node *
 }
 
 static inline int remove_node(struct c_utils_list *list, struct c_utils_node *node, c_utils_delete_cb del) {
+	if (list->conf.flags & C_UTILS_LIST_INDEXED)
+		skip_unlink(list, node);
+
 	if (list->size == 1)
 		return remove_only(list, node, del);
 	else if (list->tail == node)
@@ -548,8 +1002,23 @@ static inline int remove_node(struct c_utils_list *list, struct c_utils_node *no
 }
 
 static void *remove_at(struct c_utils_list *list, unsigned int index, bool delete_item) {
+	if(list->conf.flags & C_UTILS_LIST_LOCK_FREE)
+		return lock_free_remove(list, lock_free_match_index, &index, delete_item ? list->conf.callbacks.destructors.item : NULL);
+
 	// Acquire Writer Lock
 	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		if(list->conf.flags & C_UTILS_LIST_UNROLLED) {
+			struct c_utils_list_chunk *chunk = index_to_chunk(list, &index);
+			if(!chunk) {
+				C_UTILS_LOG_WARNING(list->conf.logger, "The chunk returned from index_to_chunk was NULL!\n");
+				return NULL;
+			}
+
+			void *item = chunk->items[index];
+			remove_slot(list, chunk, index, delete_item ? list->conf.callbacks.destructors.item : NULL);
+			return item;
+		}
+
 		struct c_utils_node *temp_node = index_to_node(list, index);
 		
 		if (temp_node) {
@@ -566,19 +1035,54 @@ static void *remove_at(struct c_utils_list *list, unsigned int index, bool delet
 }
 
 static void remove_item(struct c_utils_list *list, void *item, bool delete_item) {
+	if(list->conf.flags & C_UTILS_LIST_LOCK_FREE) {
+		lock_free_remove(list, lock_free_match_item, item, delete_item ? list->conf.callbacks.destructors.item : NULL);
+		return;
+	}
+
 	// Acquire Writer Lock
 	C_UTILS_SCOPED_WRLOCK(list->lock) {
-		struct c_utils_node *node = item_to_node(list, item);
+		if(list->conf.flags & C_UTILS_LIST_UNROLLED) {
+			unsigned int index;
+			struct c_utils_list_chunk *chunk = item_to_chunk(list, item, &index);
+			if(chunk)
+				remove_slot(list, chunk, index, delete_item ? list->conf.callbacks.destructors.item : NULL);
+
+			return;
+		}
 
-		remove_node(list, node, delete_item ? list->conf.callbacks.destructors.item : NULL);
+		struct c_utils_node *node = item_to_node(list, item);
+		if(node)
+			remove_node(list, node, delete_item ? list->conf.callbacks.destructors.item : NULL);
 	} // Release Writer Lock
 }
 
 
 
-static struct c_utils_node *create_node(void *item, bool ref_item) {
-	struct c_utils_ref_count_conf conf = { .destructor = free };
-	struct c_utils_node *node = c_utils_ref_create_conf(sizeof(*node), &conf);
+static struct c_utils_node *create_node(struct c_utils_list *list, void *item) {
+	struct c_utils_node *node;
+
+	if(list->conf.flags & C_UTILS_LIST_INDEXED) {
+		// The node's tower of links follows it, and is only as tall as it's height.
+		unsigned int height = skip_random_height(list);
+		node = c_utils_ref_create(sizeof(*node) + offsetof(struct c_utils_list_tower, links) + (height - 1) * sizeof(struct c_utils_list_skip_link));
+		if(node)
+			((struct c_utils_list_tower *) (node + 1))->height = height;
+	} else if(list->conf.flags & C_UTILS_LIST_LOCK_FREE) {
+		// Releases the node's reference to it's successor along with it.
+		struct c_utils_ref_count_conf rc_conf = { .destructor = lock_free_release_next };
+		node = c_utils_ref_create_conf(sizeof(*node) + sizeof(struct c_utils_list_lock_free_node), &rc_conf);
+		if(node) {
+			node->next = node->prev = NULL;
+			*lock_free_node(node) = (struct c_utils_list_lock_free_node) { .del = NULL, .state = 0 };
+		}
+	} else if(list->conf.pool) {
+		struct c_utils_ref_count_conf rc_conf = { .deallocator = c_utils_node_pool_free };
+		node = c_utils_ref_create_in(c_utils_node_pool_alloc(list->conf.pool), sizeof(*node), &rc_conf);
+	} else {
+		node = c_utils_ref_create(sizeof(*node));
+	}
+
 	if(!node)
 		return NULL;
 
@@ -594,6 +1098,17 @@ static void invalidate_node(struct c_utils_node *node) {
 }
 
 static int delete_all_nodes(struct c_utils_list *list, c_utils_delete_cb del) {
+	if (list->conf.flags & C_UTILS_LIST_UNROLLED)
+		return delete_all_chunks(list, del);
+
+	if (list->conf.flags & C_UTILS_LIST_LOCK_FREE) {
+		unsigned int head = 0;
+		while (lock_free_remove(list, lock_free_match_index, &head, del))
+			;
+
+		return 1;
+	}
+
 	while (list->head)
 		remove_node(list, list->head, del);
 	
@@ -601,6 +1116,17 @@ static int delete_all_nodes(struct c_utils_list *list, c_utils_delete_cb del) {
 }
 
 static struct c_utils_node *item_to_node(struct c_utils_list *list, void *item) {
+	// Sorted, so only the items which compare equal to it need to be checked.
+	if (list->conf.flags & C_UTILS_LIST_INDEXED && list->conf.callbacks.comparators.item) {
+		c_utils_comparator_cb compare = list->conf.callbacks.comparators.item;
+
+		for (struct c_utils_node *node = skip_find_sorted(list, item, compare); node && !compare(node->item, item); node = node->next)
+			if (item == node->item)
+				return node;
+
+		return NULL;
+	}
+
 	if (list->head && list->head->item == item)
 		return list->head;
 	
@@ -628,6 +1154,9 @@ static struct c_utils_node *index_to_node(struct c_utils_list *list, unsigned in
 	
 	if (index == 0)
 		return list->head;
+
+	if (list->conf.flags & C_UTILS_LIST_INDEXED)
+		return skip_find_index(list, index);
 	
 	struct c_utils_node *node;
 	if (index > (list->size / 2)) {
@@ -635,62 +1164,886 @@ static struct c_utils_node *index_to_node(struct c_utils_list *list, unsigned in
 		node = list->tail;
 		while ((node = node->prev) && --i != index)
 			;
-		C_UTILS_ASSERT(i == index, list->conf.logger, "Error in Node Traversal!Expected index %u, stopped at index %d!", index, i);
+		C_UTILS_ASSERT((i == index), list->conf.logger, "Error in Node Traversal!Expected index %u, stopped at index %d!", index, i);
 		return node;
 	} else {
 		int i = 0;
 		node = list->head;
 		while ((node = node->next) && ++i != index);
-		C_UTILS_ASSERT(i == index, list->conf.logger, "Error in Node Traversal!Expected index %u, stopped at index %d!", index, i);
+		C_UTILS_ASSERT((i == index), list->conf.logger, "Error in Node Traversal!Expected index %u, stopped at index %d!", index, i);
 	}
 	
 	return node;
 }
 
 static void for_each_item(struct c_utils_list *list, void (*callback)(void *item)) {
+	if (list->conf.flags & C_UTILS_LIST_UNROLLED) {
+		for (struct c_utils_list_chunk *chunk = list->chunks.head; chunk; chunk = chunk->next) {
+			__builtin_prefetch(chunk->next);
+
+			for (unsigned int i = 0; i < chunk->count; i++)
+				callback(chunk->items[i]);
+		}
+
+		return;
+	}
+
+	if (list->conf.flags & C_UTILS_LIST_LOCK_FREE) {
+		/*
+			Each node is still protected by the hazard pointer it was stepped onto with while the callback is invoked on
+			it. Searches of the list, and every other structure, release only their own hazard pointers.
+		*/
+		for (struct c_utils_node *node = lock_free_step(list, NULL, false); node; node = lock_free_step(list, node, false))
+			callback(node->item);
+
+		c_utils_hazard_release_at(C_UTILS_LIST_HP_STEP, false);
+		return;
+	}
+
 	struct c_utils_node *node = NULL;
 	for (node = list->head; node; node = node->next)
 		callback(node->item);
 }
 
-static void destroy_list(void *instance) {
-	struct c_utils_list *list = instance;
-	delete_all_nodes(list, list->conf.flags & C_UTILS_LIST_DELETE_ON_DESTROY ? list->conf.callbacks.destructors.item : NULL);
+/// The comparator of the items of the nodes being sorted by this thread.
+static _Thread_local c_utils_comparator_cb node_compare;
 
-	c_utils_scoped_lock_destroy(list->lock);
-	free(list);
+static int compare_nodes(const void *node_one, const void *node_two) {
+	return node_compare(((struct c_utils_node *) node_one)->item, ((struct c_utils_node *) node_two)->item);
 }
 
+/*
+	Sorts the nodes themselves rather than their items, then relinks them in order, so that each iterator stays on
+	the item it was positioned on, and continues on from wherever it is now.
+*/
+static bool sort_nodes(struct c_utils_list *list, c_utils_comparator_cb compare) {
+	if (list->size < 2)
+		return true;
 
+	struct c_utils_node **nodes;
+	C_UTILS_ON_BAD_MALLOC(nodes, list->conf.logger, sizeof(*nodes) * list->size)
+		return false;
 
-static inline void *get_item(struct c_utils_node *node) {
-	return node ? node->item : NULL;
-}
+	size_t index = 0;
+	for (struct c_utils_node *node = list->head; node; node = node->next)
+		nodes[index++] = node;
 
-static void update_pos(struct c_utils_list_iterator_position *pos, struct c_utils_node *node, bool ref_item) {
-	// Decrement reference counts of old nodes (and current item if applicable.)
-	if(pos->curr) {
-		if(ref_item)
-			C_UTILS_REF_DEC(pos->curr->item);
+	node_compare = compare;
+	c_utils_sort((void **) nodes, index, compare_nodes);
 
-		C_UTILS_REF_DEC(pos->curr);
-	}
-	if(pos->next) {
-		C_UTILS_REF_DEC(pos->next);
-	}
-	if(pos->prev) {
-		C_UTILS_REF_DEC(pos->prev);
+	for (size_t i = 0; i < index; i++) {
+		nodes[i]->prev = i ? nodes[i - 1] : NULL;
+		nodes[i]->next = i + 1 < index ? nodes[i + 1] : NULL;
 	}
 
-	// Acquire reference count to new nodes.
-	if(node) {
-		C_UTILS_REF_INC(node);
-
-		if(ref_item)
-			C_UTILS_REF_INC(node->item);
+	list->head = nodes[0];
+	list->tail = nodes[index - 1];
+	free(nodes);
 
-		if(node->next)
-			C_UTILS_REF_INC(node->next);
+	if (list->conf.flags & C_UTILS_LIST_INDEXED)
+		skip_rebuild(list);
+
+	return true;
+}
+
+static void destroy_list(void *instance) {
+	struct c_utils_list *list = instance;
+	c_utils_delete_cb del = list->conf.flags & C_UTILS_LIST_DELETE_ON_DESTROY ? list->conf.callbacks.destructors.item : NULL;
+
+	if(list->conf.flags & C_UTILS_LIST_LOCK_FREE)
+		lock_free_destroy_nodes(list, del);
+	else
+		delete_all_nodes(list, del);
+
+	c_utils_scoped_lock_destroy(list->lock);
+
+	// A reference counted list is freed along with it's reference count.
+	if(!(list->conf.flags & C_UTILS_LIST_RC_INSTANCE))
+		free(list);
+}
+
+
+
+static struct c_utils_list_chunk *create_chunk(struct c_utils_list *list) {
+	struct c_utils_list_chunk *chunk = aligned_alloc(C_UTILS_LIST_CACHE_LINE, list->chunks.size);
+	if(!chunk) {
+		C_UTILS_LOG_ERROR(list->conf.logger, "aligned_alloc: \"%s\"", strerror(errno));
+		return NULL;
+	}
+
+	chunk->next = chunk->prev = chunk->into = NULL;
+	chunk->ref_count = 1;
+	chunk->count = 0;
+	chunk->is_valid = true;
+
+	return chunk;
+}
+
+/// Iterators reference chunks while only holding the reader lock, hence the count must be atomic.
+static void ref_chunk(struct c_utils_list_chunk *chunk) {
+	__atomic_add_fetch(&chunk->ref_count, 1, __ATOMIC_RELAXED);
+}
+
+static void unref_chunk(struct c_utils_list_chunk *chunk) {
+	if(__atomic_sub_fetch(&chunk->ref_count, 1, __ATOMIC_ACQ_REL))
+		return;
+
+	if(chunk->into)
+		unref_chunk(chunk->into);
+
+	free(chunk);
+}
+
+/// Links the chunk after prev, or as the head if prev is NULL.
+static void link_chunk(struct c_utils_list *list, struct c_utils_list_chunk *prev, struct c_utils_list_chunk *chunk) {
+	chunk->prev = prev;
+	chunk->next = prev ? prev->next : list->chunks.head;
+
+	if(chunk->next)
+		chunk->next->prev = chunk;
+	else
+		list->chunks.tail = chunk;
+
+	if(prev)
+		prev->next = chunk;
+	else
+		list->chunks.head = chunk;
+}
+
+/*
+	Unlinks and invalidates the chunk, releasing the list's reference to it. If it's items were moved to another
+	chunk, it keeps that chunk alive for as long as it is, so that iterators positioned on it can follow them.
+*/
+static void unlink_chunk(struct c_utils_list *list, struct c_utils_list_chunk *chunk, struct c_utils_list_chunk *into) {
+	if(chunk->prev)
+		chunk->prev->next = chunk->next;
+	else
+		list->chunks.head = chunk->next;
+
+	if(chunk->next)
+		chunk->next->prev = chunk->prev;
+	else
+		list->chunks.tail = chunk->prev;
+
+	if(into) {
+		ref_chunk(into);
+		chunk->into = into;
+	}
+
+	chunk->is_valid = false;
+	unref_chunk(chunk);
+}
+
+/*
+	Inserts the item before the one at the slot's index, which may also be one past the last item of the chunk.
+	A full chunk is split in half first, unless the item is appended to it, in which case it begins the next chunk
+	instead, so that a list which is only ever added to at the tail is left with full chunks. If the slot has no
+	chunk, the list must be empty and the item is added as the only one. Upon return, the slot is where the item
+	ended up.
+*/
+static bool insert_item(struct c_utils_list *list, struct c_utils_list_slot *slot, void *item) {
+	struct c_utils_list_chunk *chunk = slot->chunk;
+	unsigned int index = slot->index;
+
+	if(!chunk) {
+		if(!(chunk = create_chunk(list)))
+			return false;
+
+		link_chunk(list, NULL, chunk);
+		index = 0;
+	} else if(chunk->count == list->chunks.capacity) {
+		struct c_utils_list_chunk *next = create_chunk(list);
+		if(!next)
+			return false;
+
+		link_chunk(list, chunk, next);
+
+		if(index == chunk->count) {
+			chunk = next;
+			index = 0;
+		} else {
+			unsigned int half = chunk->count / 2;
+			next->count = chunk->count - half;
+			memcpy(next->items, chunk->items + half, next->count * sizeof(void *));
+			chunk->count = half;
+
+			if(index > half) {
+				chunk = next;
+				index -= half;
+			}
+		}
+	}
+
+	memmove(chunk->items + index + 1, chunk->items + index, (chunk->count - index) * sizeof(void *));
+	chunk->items[index] = item;
+	chunk->count++;
+	list->size++;
+
+	slot->chunk = chunk;
+	slot->index = index;
+	slot->item = item;
+
+	return true;
+}
+
+/*
+	Removes the item at the index, unlinking it's chunk if it is left empty. Otherwise, if the chunk and one of it's
+	neighbours could fit in half of a chunk together, they are merged, so that removals do not leave behind sparse
+	chunks, and a split chunk is not immediately merged again.
+*/
+static void remove_slot(struct c_utils_list *list, struct c_utils_list_chunk *chunk, unsigned int index, c_utils_delete_cb del) {
+	void *item = chunk->items[index];
+
+	memmove(chunk->items + index, chunk->items + index + 1, (chunk->count - index - 1) * sizeof(void *));
+	chunk->count--;
+	list->size--;
+
+	if (list->conf.flags & C_UTILS_LIST_RC_ITEM)
+		C_UTILS_REF_DEC(item);
+	else if (del)
+		del(item);
+
+	if (!chunk->count) {
+		unlink_chunk(list, chunk, NULL);
+		return;
+	}
+
+	struct c_utils_list_chunk *next = chunk->next, *prev = chunk->prev;
+	if (next && chunk->count + next->count <= list->chunks.capacity / 2) {
+		memcpy(chunk->items + chunk->count, next->items, next->count * sizeof(void *));
+		chunk->count += next->count;
+		unlink_chunk(list, next, chunk);
+	} else if (prev && prev->count + chunk->count <= list->chunks.capacity / 2) {
+		memcpy(prev->items + prev->count, chunk->items, chunk->count * sizeof(void *));
+		prev->count += chunk->count;
+		unlink_chunk(list, chunk, prev);
+	}
+}
+
+/// Has the same semantics as add_sorted and add_unsorted.
+static bool add_to_chunk(struct c_utils_list *list, void *item) {
+	struct c_utils_list_chunk *tail = list->chunks.tail;
+	struct c_utils_list_slot slot = { .chunk = tail, .index = tail ? tail->count : 0 };
+	c_utils_comparator_cb compare = list->conf.callbacks.comparators.item;
+
+	if (tail && compare && compare(item, tail->items[tail->count - 1]) < 0) {
+		for (struct c_utils_list_chunk *chunk = list->chunks.head; chunk; chunk = chunk->next) {
+			if (compare(item, chunk->items[chunk->count - 1]) > 0)
+				continue;
+
+			unsigned int index = 0;
+			while (compare(item, chunk->items[index]) > 0)
+				index++;
+
+			slot.chunk = chunk;
+			slot.index = index;
+			break;
+		}
+	}
+
+	return insert_item(list, &slot, item);
+}
+
+static struct c_utils_list_chunk *item_to_chunk(struct c_utils_list *list, void *item, unsigned int *index) {
+	for (struct c_utils_list_chunk *chunk = list->chunks.head; chunk; chunk = chunk->next) {
+		__builtin_prefetch(chunk->next);
+
+		for (unsigned int i = 0; i < chunk->count; i++)
+			if (chunk->items[i] == item) {
+				*index = i;
+				return chunk;
+			}
+	}
+
+	return NULL;
+}
+
+/// Returns the chunk holding the item at the index, which is made relative to the chunk.
+static struct c_utils_list_chunk *index_to_chunk(struct c_utils_list *list, unsigned int *index) {
+	if (*index >= list->size)
+		return NULL;
+
+	if (*index > list->size / 2) {
+		size_t remaining = list->size - *index;
+		for (struct c_utils_list_chunk *chunk = list->chunks.tail; chunk; chunk = chunk->prev) {
+			if (remaining <= chunk->count) {
+				*index = chunk->count - remaining;
+				return chunk;
+			}
+
+			remaining -= chunk->count;
+		}
+	} else {
+		for (struct c_utils_list_chunk *chunk = list->chunks.head; chunk; chunk = chunk->next) {
+			if (*index < chunk->count)
+				return chunk;
+
+			*index -= chunk->count;
+		}
+	}
+
+	C_UTILS_LOG_ASSERT(list->conf.logger, "Error in Chunk Traversal! Size of list does not match the items in it's chunks!");
+	return NULL;
+}
+
+static int delete_all_chunks(struct c_utils_list *list, c_utils_delete_cb del) {
+	while (list->chunks.head) {
+		struct c_utils_list_chunk *chunk = list->chunks.head;
+
+		for (unsigned int i = 0; i < chunk->count; i++) {
+			if (list->conf.flags & C_UTILS_LIST_RC_ITEM)
+				C_UTILS_REF_DEC(chunk->items[i]);
+			else if (del)
+				del(chunk->items[i]);
+		}
+
+		list->size -= chunk->count;
+		chunk->count = 0;
+		unlink_chunk(list, chunk, NULL);
+	}
+
+	return 1;
+}
+
+
+
+/// Each node is as tall as the amount of trailing pairs of zero bits plus one, so one in four reaches each next level.
+static unsigned int skip_random_height(struct c_utils_list *list) {
+	// SplitMix64, which only needs the seed advanced atomically to be thread-safe.
+	uint64_t rand = __atomic_add_fetch(&list->skip.seed, 0x9E3779B97F4A7C15ULL, __ATOMIC_RELAXED);
+	rand = (rand ^ (rand >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	rand = (rand ^ (rand >> 27)) * 0x94D049BB133111EBULL;
+	rand ^= rand >> 31;
+
+	unsigned int height = 1;
+	while ((rand & 3) == 0 && height < C_UTILS_LIST_SKIP_LEVELS) {
+		rand >>= 2;
+		height++;
+	}
+
+	return height;
+}
+
+static unsigned int skip_height(struct c_utils_node *node) {
+	return ((struct c_utils_list_tower *) (node + 1))->height;
+}
+
+/// The node's link on the given level, which must be above 0, or the list's own if node is NULL.
+static struct c_utils_list_skip_link *skip_link(struct c_utils_list *list, struct c_utils_node *node, unsigned int level) {
+	if (!node)
+		return list->skip.links + level - 1;
+
+	return ((struct c_utils_list_tower *) (node + 1))->links + level - 1;
+}
+
+/*
+	Finds, for each level above 0, the last node at or before node which is linked on that level (or NULL for
+	the list itself), along with how many nodes it is behind node. This walks backwards from node, climbing a level
+	whenever it reaches a node which is tall enough, which is expected to take O(log N) steps, as it retraces
+	the path a search from the head would have taken. Returns the rank of node, where the first node is 1, or 0
+	if node is NULL.
+*/
+static size_t skip_predecessors(struct c_utils_list *list, struct c_utils_node *node, struct c_utils_node **update, size_t *distance) {
+	size_t walked = 0;
+	unsigned int level;
+
+	for (level = 1; level < list->skip.level; level++) {
+		while (node && skip_height(node) <= level) {
+			struct c_utils_node *before = level == 1 ? node->prev : skip_link(list, node, level - 1)->prev;
+			walked += level == 1 ? 1 : skip_link(list, before, level - 1)->span;
+			node = before;
+		}
+
+		update[level] = node;
+		distance[level] = walked;
+	}
+
+	// The rest of the way to the front of the list is along the highest level.
+	level--;
+	while (node) {
+		struct c_utils_node *before = level == 0 ? node->prev : skip_link(list, node, level)->prev;
+		walked += level == 0 ? 1 : skip_link(list, before, level)->span;
+		node = before;
+	}
+
+	return walked;
+}
+
+/// Links the node, which has just been linked on level 0, into every level it is tall enough for.
+static void skip_insert(struct c_utils_list *list, struct c_utils_node *node) {
+	struct c_utils_node *update[C_UTILS_LIST_SKIP_LEVELS];
+	size_t distance[C_UTILS_LIST_SKIP_LEVELS];
+	unsigned int height = skip_height(node);
+
+	/*
+		A level which no node has reached yet spans the entire list. The size already counts this node, but the
+		spans of every other level do not until it is linked below, so it is left out here as well.
+	*/
+	for (; list->skip.level < height; list->skip.level++) {
+		struct c_utils_list_skip_link *link = list->skip.links + list->skip.level - 1;
+		link->next = NULL;
+		link->span = list->size - 1;
+	}
+
+	skip_predecessors(list, node->prev, update, distance);
+
+	for (unsigned int level = 1; level < list->skip.level; level++) {
+		struct c_utils_list_skip_link *before = skip_link(list, update[level], level);
+
+		if (level >= height) {
+			before->span++;
+			continue;
+		}
+
+		struct c_utils_list_skip_link *link = skip_link(list, node, level);
+		link->next = before->next;
+		link->prev = update[level];
+		link->span = before->span - distance[level];
+
+		if (link->next)
+			skip_link(list, link->next, level)->prev = node;
+
+		before->next = node;
+		before->span = distance[level] + 1;
+	}
+}
+
+/// Unlinks the node from every level above 0, before it is unlinked from level 0.
+static void skip_unlink(struct c_utils_list *list, struct c_utils_node *node) {
+	struct c_utils_node *update[C_UTILS_LIST_SKIP_LEVELS];
+	size_t distance[C_UTILS_LIST_SKIP_LEVELS];
+
+	skip_predecessors(list, node->prev, update, distance);
+
+	for (unsigned int level = 1; level < list->skip.level; level++) {
+		struct c_utils_list_skip_link *before = skip_link(list, update[level], level);
+
+		if (before->next != node) {
+			before->span--;
+			continue;
+		}
+
+		struct c_utils_list_skip_link *link = skip_link(list, node, level);
+		before->next = link->next;
+		before->span += link->span - 1;
+
+		if (link->next)
+			skip_link(list, link->next, level)->prev = update[level];
+	}
+
+	while (list->skip.level > 1 && !list->skip.links[list->skip.level - 2].next)
+		list->skip.level--;
+}
+
+/// Returns the first node whose item is not less than item, or NULL if there is none.
+static struct c_utils_node *skip_find_sorted(struct c_utils_list *list, void *item, c_utils_comparator_cb compare) {
+	struct c_utils_node *node = NULL, *next;
+
+	for (unsigned int level = list->skip.level - 1; level > 0; level--)
+		while ((next = skip_link(list, node, level)->next) && compare(next->item, item) < 0)
+			node = next;
+
+	for (next = node ? node->next : list->head; next && compare(next->item, item) < 0; next = next->next)
+		;
+
+	return next;
+}
+
+/// Relinks every level above 0 in the order of level 0, keeping the height of each node, after it has been reordered.
+static void skip_rebuild(struct c_utils_list *list) {
+	struct c_utils_node *last[C_UTILS_LIST_SKIP_LEVELS] = { NULL };
+	size_t last_rank[C_UTILS_LIST_SKIP_LEVELS] = { 0 }, rank = 0;
+
+	for (struct c_utils_node *node = list->head; node; node = node->next) {
+		rank++;
+
+		for (unsigned int level = 1; level < skip_height(node); level++) {
+			struct c_utils_list_skip_link *before = skip_link(list, last[level], level);
+			before->next = node;
+			before->span = rank - last_rank[level];
+
+			skip_link(list, node, level)->prev = last[level];
+			last[level] = node;
+			last_rank[level] = rank;
+		}
+	}
+
+	for (unsigned int level = 1; level < list->skip.level; level++) {
+		struct c_utils_list_skip_link *link = skip_link(list, last[level], level);
+		link->next = NULL;
+		link->span = list->size - last_rank[level];
+	}
+}
+
+static struct c_utils_node *skip_find_index(struct c_utils_list *list, unsigned int index) {
+	if (index >= list->size)
+		return NULL;
+
+	struct c_utils_node *node = NULL;
+	size_t rank = 0, target = (size_t) index + 1;
+
+	for (unsigned int level = list->skip.level - 1; level > 0 && rank < target; level--) {
+		struct c_utils_list_skip_link *link;
+		while ((link = skip_link(list, node, level))->next && rank + link->span <= target) {
+			rank += link->span;
+			node = link->next;
+		}
+	}
+
+	for (; rank < target; rank++)
+		node = node ? node->next : list->head;
+
+	return node;
+}
+
+
+
+static inline bool lock_free_is_marked(struct c_utils_node *node) {
+	return (uintptr_t) node & 1;
+}
+
+static inline struct c_utils_node *lock_free_mark(struct c_utils_node *node) {
+	return (struct c_utils_node *) ((uintptr_t) node | 1);
+}
+
+static inline struct c_utils_node *lock_free_unmark(struct c_utils_node *node) {
+	return (struct c_utils_node *) ((uintptr_t) node & ~(uintptr_t) 1);
+}
+
+static inline struct c_utils_list_lock_free_node *lock_free_node(struct c_utils_node *node) {
+	return (struct c_utils_list_lock_free_node *) (node + 1);
+}
+
+static bool lock_free_match_item(struct c_utils_list *list, struct c_utils_node *node, const void *item, size_t position) {
+	return node->item == item;
+}
+
+static bool lock_free_match_index(struct c_utils_list *list, struct c_utils_node *node, const void *index, size_t position) {
+	return position == *(const unsigned int *) index;
+}
+
+static bool lock_free_match_node(struct c_utils_list *list, struct c_utils_node *node, const void *target, size_t position) {
+	return node == target;
+}
+
+/// Stops at the first node the item is to be added before, as add_sorted does.
+static bool lock_free_match_sorted(struct c_utils_list *list, struct c_utils_node *node, const void *item, size_t position) {
+	return list->conf.callbacks.comparators.item(item, node->item) <= 0;
+}
+
+static void lock_free_unref_item(void *item) {
+	C_UTILS_REF_DEC(item);
+}
+
+/*
+	Each node's next pointer holds a reference to it's successor, which is released along with the node. A node
+	released while releasing another only hands back it's successor, so that releasing a long chain of removed
+	nodes, such as those an iterator was left holding the first of, does not recurse once for each of them.
+*/
+static void lock_free_release_next(void *node) {
+	static _Thread_local bool releasing = false;
+	static _Thread_local struct c_utils_node *pending = NULL;
+
+	struct c_utils_node *next = lock_free_unmark(((struct c_utils_node *) node)->next);
+	if (!next)
+		return;
+
+	if (releasing) {
+		pending = next;
+		return;
+	}
+
+	releasing = true;
+	while (next) {
+		pending = NULL;
+		C_UTILS_REF_DEC(next);
+		next = pending;
+	}
+	releasing = false;
+}
+
+/// Releases the reference held by the link it was unlinked from, once no thread may still be comparing it.
+static void lock_free_retired(void *node) {
+	c_utils_delete_cb del = lock_free_node(node)->del;
+	if (del)
+		del(((struct c_utils_node *) node)->item);
+
+	C_UTILS_REF_DEC(node);
+}
+
+static void lock_free_finish(struct c_utils_node *node, unsigned int flag) {
+	if (__atomic_or_fetch(&lock_free_node(node)->state, flag, __ATOMIC_ACQ_REL) == (C_UTILS_LIST_REMOVED | C_UTILS_LIST_UNLINKED))
+		c_utils_hazard_retire(node, lock_free_retired);
+}
+
+/// Releases only the hazard pointers lock_free_find acquires, as the caller may be holding others, such as in a callback of for_each.
+static void lock_free_release_find(void) {
+	c_utils_hazard_release_at(C_UTILS_LIST_HP_CURR, false);
+	c_utils_hazard_release_at(C_UTILS_LIST_HP_PRED, false);
+}
+
+/*
+	Finds the first node the callback matches, and the link to it from the node behind it or the list's head,
+	unlinking any removed node along the way. Both nodes are left protected by the hazard pointers until the
+	caller releases them. Returns NULL if none match, in which case the link is the last node's.
+
+	A node is only stepped onto once it's predecessor, while protected, is seen to still point to it without
+	being marked, as it is then still linked, and so cannot have been retired before it was protected.
+*/
+static struct c_utils_node *lock_free_find(struct c_utils_list *list, c_utils_list_match_cb match, const void *target, struct c_utils_node ***link_ptr) {
+	struct c_utils_node **link, *curr, *next;
+	size_t position;
+
+	retry:
+		link = &list->head;
+		curr = __atomic_load_n(link, __ATOMIC_ACQUIRE);
+		position = 0;
+
+		while (true) {
+			// The predecessor is being removed, and may no longer be linked.
+			if (lock_free_is_marked(curr))
+				goto retry;
+
+			if (!curr)
+				break;
+
+			c_utils_hazard_acquire(C_UTILS_LIST_HP_CURR, curr);
+			if (__atomic_load_n(link, __ATOMIC_ACQUIRE) != curr)
+				goto retry;
+
+			next = __atomic_load_n(&curr->next, __ATOMIC_ACQUIRE);
+			if (lock_free_is_marked(next)) {
+				// The link takes a reference to the successor before it is swung to it, as the removed node's reference is only released once retired.
+				struct c_utils_node *succ = lock_free_unmark(next), *expected = curr;
+				if (succ)
+					C_UTILS_REF_INC(succ);
+
+				if (!__atomic_compare_exchange_n(link, &expected, succ, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+					if (succ)
+						C_UTILS_REF_DEC(succ);
+
+					goto retry;
+				}
+
+				lock_free_finish(curr, C_UTILS_LIST_UNLINKED);
+				curr = succ;
+				continue;
+			}
+
+			if (match(list, curr, target, position))
+				break;
+
+			link = &curr->next;
+			c_utils_hazard_acquire(C_UTILS_LIST_HP_PRED, curr);
+			curr = next;
+			position++;
+		}
+
+		*link_ptr = link;
+		return curr;
+}
+
+/*
+	Steps from the node, or the head if it is NULL, onto the next node which has not been removed, moving the caller's
+	reference from the one to the other, and the item's as well if ref_item. The node may itself have been removed, as
+	it's next pointer is never changed after that, and holds a reference to it's successor for as long as it is held.
+
+	The node returned is left protected by the hazard pointer, until the caller releases it, as it's item may only be
+	deleted once it is no longer protected.
+*/
+static struct c_utils_node *lock_free_step(struct c_utils_list *list, struct c_utils_node *node, bool ref_item) {
+	struct c_utils_node *curr = node, *next;
+
+	while (true) {
+		struct c_utils_node **link = curr ? &curr->next : &list->head;
+
+		next = lock_free_unmark(__atomic_load_n(link, __ATOMIC_ACQUIRE));
+		if (next) {
+			c_utils_hazard_acquire(C_UTILS_LIST_HP_STEP, next);
+			if (lock_free_unmark(__atomic_load_n(link, __ATOMIC_ACQUIRE)) != next)
+				continue;
+
+			C_UTILS_REF_INC(next);
+		}
+
+		if (curr)
+			C_UTILS_REF_DEC(curr);
+
+		curr = next;
+
+		// Protected before it was seen unmarked, so it's item cannot have been deleted yet.
+		if (!curr || !lock_free_is_marked(__atomic_load_n(&curr->next, __ATOMIC_ACQUIRE)))
+			break;
+	}
+
+	if (curr && ref_item)
+		C_UTILS_REF_INC(curr->item);
+
+	return curr;
+}
+
+static bool lock_free_add(struct c_utils_list *list, struct c_utils_node *node) {
+	// The maximum is only enforced on a best-effort basis, as the size is reserved before the node is linked.
+	if (__atomic_add_fetch(&list->size, 1, __ATOMIC_RELAXED) > list->conf.size.max && list->conf.size.max) {
+		__atomic_sub_fetch(&list->size, 1, __ATOMIC_RELAXED);
+		c_utils_ref_destroy(node);
+		return false;
+	}
+
+	// The node's initial reference is the one held by the link it is added to, and it takes over the link's reference to it's successor.
+	struct c_utils_node **link = &list->head, *next;
+	if (!list->conf.callbacks.comparators.item) {
+		next = __atomic_load_n(link, __ATOMIC_RELAXED);
+		do {
+			node->next = next;
+		} while (!__atomic_compare_exchange_n(link, &next, node, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+		return true;
+	}
+
+	do {
+		next = lock_free_find(list, lock_free_match_sorted, node->item, &link);
+		node->next = next;
+	} while (!__atomic_compare_exchange_n(link, &next, node, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	lock_free_release_find();
+	return true;
+}
+
+/*
+	Removes the first node matched, returning it's item. Only the thread which marks the node removes it, after
+	which it attempts to unlink it as well, or otherwise searches for it, which unlinks it if it is still linked.
+*/
+static void *lock_free_remove(struct c_utils_list *list, c_utils_list_match_cb match, const void *target, c_utils_delete_cb del) {
+	struct c_utils_node **link, *node, *next;
+
+	do {
+		node = lock_free_find(list, match, target, &link);
+		if (!node) {
+			lock_free_release_find();
+			return NULL;
+		}
+
+		next = __atomic_load_n(&node->next, __ATOMIC_RELAXED);
+	} while (lock_free_is_marked(next) || !__atomic_compare_exchange_n(&node->next, &next, lock_free_mark(next), false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+	void *item = node->item;
+	__atomic_sub_fetch(&list->size, 1, __ATOMIC_RELAXED);
+
+	if (next)
+		C_UTILS_REF_INC(next);
+
+	struct c_utils_node *expected = node;
+	if (__atomic_compare_exchange_n(link, &expected, next, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+		lock_free_finish(node, C_UTILS_LIST_UNLINKED);
+	} else {
+		if (next)
+			C_UTILS_REF_DEC(next);
+
+		lock_free_find(list, lock_free_match_node, node, &link);
+	}
+
+	// It can not be retired before this, so it's still safe to access after the hazard pointers were moved on.
+	lock_free_node(node)->del = list->conf.flags & C_UTILS_LIST_RC_ITEM ? lock_free_unref_item : del;
+	lock_free_finish(node, C_UTILS_LIST_REMOVED);
+
+	lock_free_release_find();
+	return item;
+}
+
+static void *lock_free_as_array(struct c_utils_list *list, size_t *size) {
+	size_t capacity = c_utils_list_size(list) + 1, index = 0;
+
+	void **array_of_items;
+	C_UTILS_ON_BAD_MALLOC(array_of_items, list->conf.logger, sizeof(void *) * capacity)
+		return NULL;
+
+	// Items may be added while it is being copied, so the array grows as needed.
+	for (struct c_utils_node *node = lock_free_step(list, NULL, false); node; node = lock_free_step(list, node, false)) {
+		if (index == capacity) {
+			capacity *= 2;
+
+			void **resized = realloc(array_of_items, sizeof(void *) * capacity);
+			if (!resized) {
+				C_UTILS_LOG_ERROR(list->conf.logger, "Was unable to grow the array!");
+				C_UTILS_REF_DEC(node);
+				c_utils_hazard_release_at(C_UTILS_LIST_HP_STEP, false);
+				free(array_of_items);
+				return NULL;
+			}
+
+			array_of_items = resized;
+		}
+
+		array_of_items[index++] = node->item;
+	}
+
+	c_utils_hazard_release_at(C_UTILS_LIST_HP_STEP, false);
+
+	*size = index;
+	return array_of_items;
+}
+
+/*
+	No other thread may be using the list, so rather than retiring the nodes, each is released as it is taken off,
+	other than those which have been removed but not yet unlinked, which have only to be unlinked to be retired.
+*/
+static void lock_free_destroy_nodes(struct c_utils_list *list, c_utils_delete_cb del) {
+	struct c_utils_node *node = list->head;
+	list->head = NULL;
+
+	while (node) {
+		// Takes over the node's reference to it's successor, so that releasing the node does not release the rest.
+		struct c_utils_node *next = node->next;
+		node->next = NULL;
+
+		if (lock_free_is_marked(next)) {
+			lock_free_finish(node, C_UTILS_LIST_UNLINKED);
+		} else {
+			if (list->conf.flags & C_UTILS_LIST_RC_ITEM)
+				C_UTILS_REF_DEC(node->item);
+			else if (del)
+				del(node->item);
+
+			C_UTILS_REF_DEC(node);
+		}
+
+		node = lock_free_unmark(next);
+	}
+
+	list->size = 0;
+}
+
+
+
+static inline void *get_item(struct c_utils_node *node) {
+	return node ? node->item : NULL;
+}
+
+static void update_pos(struct c_utils_list_iterator_position *pos, struct c_utils_node *node, bool ref_item) {
+	// Decrement reference counts of old nodes (and current item if applicable.)
+	if(pos->curr) {
+		if(ref_item)
+			C_UTILS_REF_DEC(pos->curr->item);
+
+		C_UTILS_REF_DEC(pos->curr);
+	}
+	if(pos->next) {
+		C_UTILS_REF_DEC(pos->next);
+	}
+	if(pos->prev) {
+		C_UTILS_REF_DEC(pos->prev);
+	}
+
+	// Acquire reference count to new nodes.
+	if(node) {
+		C_UTILS_REF_INC(node);
+
+		if(ref_item)
+			C_UTILS_REF_INC(node->item);
+
+		if(node->next)
+			C_UTILS_REF_INC(node->next);
 
 		if(node->prev)
 			C_UTILS_REF_INC(node->prev);
@@ -803,20 +2156,18 @@ static bool append(void *instance, void *pos, void *item) {
 	if(list->conf.callbacks.comparators.item)
 		return false;
 
-	struct c_utils_node *node = create_node(item, list->conf.flags & C_UTILS_LIST_RC_ITEM);
+	struct c_utils_node *node = create_node(list, item);
 	if (!node) {
 		C_UTILS_LOG_ASSERT(list->conf.logger, "create_node: 'Was unable to create a reference counted node!'");
 		return false;
 	}
 
-	// Since the list must have a reference as well, we append it here.
-	C_UTILS_REF_INC(node);
-
 	// Acquire Writer Lock
 	C_UTILS_SCOPED_WRLOCK(list->lock) {
-		if(list->conf.size.max && list->conf.size.max == list->size)
+		if(list->conf.size.max && list->conf.size.max == list->size) {
 			c_utils_ref_destroy(node);
 			return false;
+		}
 
 		if (list->size == 0) {
 			add_as_only(list, node);
@@ -869,15 +2220,12 @@ static bool prepend(void *instance, void *pos, void *item) {
 	if(list->conf.callbacks.comparators.item)
 		return false;
 
-	struct c_utils_node *node = create_node(item, list->conf.flags & C_UTILS_LIST_RC_ITEM);
+	struct c_utils_node *node = create_node(list, item);
 	if (!node) {
 		C_UTILS_LOG_ASSERT(list->conf.logger, "create_node: 'Was unable to create a reference counted node!'");
 		return false;
 	}
 
-	// Since the list must have a reference as well, we append it here.
-	C_UTILS_REF_INC(node);
-
 	// Acquire Writer Lock
 	C_UTILS_SCOPED_WRLOCK(list->lock) {
 		if(list->conf.size.max && list->conf.size.max == list->size) {
@@ -978,4 +2326,426 @@ static void *curr(void *instance, void *pos) {
 static void finalize(void *instance, void *pos) {
 	update_pos(pos, NULL, ((struct c_utils_list *)instance)->conf.flags & C_UTILS_LIST_RC_ITEM);
 	free(pos);
-}
\ No newline at end of file
+}
+
+
+
+/*
+	Finds where the item of the slot is now. It is usually still at the same index, but it may have been shifted
+	within it's chunk, moved to a neighbour when the chunk was split, or moved along with the rest of the chunk when
+	it was merged. Returns false if it could not be found, such as if it was removed.
+*/
+static bool locate(struct c_utils_list_slot *slot, struct c_utils_list_chunk **chunk, unsigned int *index) {
+	struct c_utils_list_chunk *c = slot->chunk;
+	if (!c)
+		return false;
+
+	while (!c->is_valid && c->into)
+		c = c->into;
+
+	if (!c->is_valid)
+		return false;
+
+	if (slot->index < c->count && c->items[slot->index] == slot->item) {
+		*chunk = c;
+		*index = slot->index;
+		return true;
+	}
+
+	// A valid chunk's neighbours are also valid.
+	struct c_utils_list_chunk *candidates[] = { c, c->next, c->prev };
+	for (int i = 0; i < 3; i++) {
+		if (!(c = candidates[i]))
+			continue;
+
+		for (unsigned int j = 0; j < c->count; j++)
+			if (c->items[j] == slot->item) {
+				*chunk = c;
+				*index = j;
+				return true;
+			}
+	}
+
+	return false;
+}
+
+static void set_slot(struct c_utils_list_slot *slot, struct c_utils_list_chunk *chunk, unsigned int index) {
+	slot->chunk = chunk;
+	slot->index = index;
+	slot->item = chunk ? chunk->items[index] : NULL;
+
+	if (chunk)
+		ref_chunk(chunk);
+}
+
+/*
+	The same as update_pos, but positions on the item at the index of the chunk. The new chunks are referenced
+	before the old are released, as the old chunk may only be kept alive by this iterator.
+*/
+static void update_slots(struct c_utils_list_unrolled_iterator_position *pos, struct c_utils_list_chunk *chunk, unsigned int index, bool ref_item) {
+	struct c_utils_list_unrolled_iterator_position old = *pos;
+
+	set_slot(&pos->curr, chunk, index);
+
+	if (chunk && index + 1 < chunk->count)
+		set_slot(&pos->next, chunk, index + 1);
+	else
+		set_slot(&pos->next, chunk ? chunk->next : NULL, 0);
+
+	if (chunk && index)
+		set_slot(&pos->prev, chunk, index - 1);
+	else if (chunk && chunk->prev)
+		set_slot(&pos->prev, chunk->prev, chunk->prev->count - 1);
+	else
+		set_slot(&pos->prev, NULL, 0);
+
+	if (chunk && ref_item)
+		C_UTILS_REF_INC(pos->curr.item);
+
+	if (old.curr.chunk) {
+		if (ref_item)
+			C_UTILS_REF_DEC(old.curr.item);
+
+		unref_chunk(old.curr.chunk);
+	}
+
+	if (old.next.chunk)
+		unref_chunk(old.next.chunk);
+
+	if (old.prev.chunk)
+		unref_chunk(old.prev.chunk);
+}
+
+static void *unrolled_head(void *instance, void *pos) {
+	struct c_utils_list *list = instance;
+
+	// Acquire Reader Lock
+	C_UTILS_SCOPED_RDLOCK(list->lock) {
+		struct c_utils_list_chunk *head = list->chunks.head;
+		update_slots(pos, head, 0, list->conf.flags & C_UTILS_LIST_RC_ITEM);
+		return head ? head->items[0] : NULL;
+	} // Release Reader Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void *unrolled_tail(void *instance, void *pos) {
+	struct c_utils_list *list = instance;
+
+	// Acquire Reader Lock
+	C_UTILS_SCOPED_RDLOCK(list->lock) {
+		struct c_utils_list_chunk *tail = list->chunks.tail;
+		unsigned int index = tail ? tail->count - 1 : 0;
+		update_slots(pos, tail, index, list->conf.flags & C_UTILS_LIST_RC_ITEM);
+		return tail ? tail->items[index] : NULL;
+	} // Release Reader Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void *unrolled_next(void *instance, void *pos) {
+	struct c_utils_list *list = instance;
+	struct c_utils_list_unrolled_iterator_position *p = pos;
+	struct c_utils_list_chunk *chunk = NULL;
+	unsigned int index = 0;
+
+	// Acquire Reader Lock
+	C_UTILS_SCOPED_RDLOCK(list->lock) {
+		if (!list->size) {
+			update_slots(p, NULL, 0, list->conf.flags & C_UTILS_LIST_RC_ITEM);
+			return NULL;
+		}
+
+		if (!p->curr.chunk) {
+			chunk = list->chunks.head;
+		} else if (locate(&p->curr, &chunk, &index)) {
+			if (++index == chunk->count) {
+				chunk = chunk->next;
+				index = 0;
+			}
+		} else if (!locate(&p->next, &chunk, &index)) {
+			chunk = NULL;
+		}
+
+		update_slots(p, chunk, index, list->conf.flags & C_UTILS_LIST_RC_ITEM);
+
+		return chunk ? chunk->items[index] : NULL;
+	} // Release Reader Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void *unrolled_prev(void *instance, void *pos) {
+	struct c_utils_list *list = instance;
+	struct c_utils_list_unrolled_iterator_position *p = pos;
+	struct c_utils_list_chunk *chunk = NULL;
+	unsigned int index = 0;
+
+	// Acquire Reader Lock
+	C_UTILS_SCOPED_RDLOCK(list->lock) {
+		if (!list->size) {
+			update_slots(p, NULL, 0, list->conf.flags & C_UTILS_LIST_RC_ITEM);
+			return NULL;
+		}
+
+		if (!p->curr.chunk) {
+			chunk = list->chunks.tail;
+			index = chunk->count - 1;
+		} else if (locate(&p->curr, &chunk, &index)) {
+			if (index-- == 0) {
+				chunk = chunk->prev;
+				index = chunk ? chunk->count - 1 : 0;
+			}
+		} else if (!locate(&p->prev, &chunk, &index)) {
+			chunk = NULL;
+		}
+
+		update_slots(p, chunk, index, list->conf.flags & C_UTILS_LIST_RC_ITEM);
+
+		return chunk ? chunk->items[index] : NULL;
+	} // Release Reader Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void *unrolled_curr(void *instance, void *pos) {
+	struct c_utils_list *list = instance;
+	struct c_utils_list_unrolled_iterator_position *p = pos;
+	struct c_utils_list_chunk *chunk;
+	unsigned int index;
+
+	C_UTILS_SCOPED_RDLOCK(list->lock)
+		return locate(&p->curr, &chunk, &index) ? chunk->items[index] : NULL;
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static bool unrolled_append(void *instance, void *pos, void *item) {
+	if(!item)
+		return false;
+
+	struct c_utils_list *list = instance;
+	struct c_utils_list_unrolled_iterator_position *p = pos;
+
+	// We cannot append to the list and violate sorted order.
+	if(list->conf.callbacks.comparators.item)
+		return false;
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		if(list->conf.size.max && list->conf.size.max == list->size)
+			return false;
+
+		// After the first of current, next or previous which is still in the list, otherwise at the tail.
+		struct c_utils_list_slot slot;
+		if (locate(&p->curr, &slot.chunk, &slot.index) || locate(&p->next, &slot.chunk, &slot.index) || locate(&p->prev, &slot.chunk, &slot.index)) {
+			slot.index++;
+		} else {
+			slot.chunk = list->chunks.tail;
+			slot.index = slot.chunk ? slot.chunk->count : 0;
+		}
+
+		if (!insert_item(list, &slot, item))
+			return false;
+
+		update_slots(p, slot.chunk, slot.index, list->conf.flags & C_UTILS_LIST_RC_ITEM);
+
+		return true;
+	} // Release Writer Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static bool unrolled_prepend(void *instance, void *pos, void *item) {
+	if(!item)
+		return false;
+
+	struct c_utils_list *list = instance;
+	struct c_utils_list_unrolled_iterator_position *p = pos;
+
+	// We cannot prepend an element if it will violate the sorted principle.
+	if(list->conf.callbacks.comparators.item)
+		return false;
+
+	// Acquire Writer Lock
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		if(list->conf.size.max && list->conf.size.max == list->size)
+			return false;
+
+		// Before the first of current, next or previous which is still in the list, otherwise at the head.
+		struct c_utils_list_slot slot;
+		if (!locate(&p->curr, &slot.chunk, &slot.index) && !locate(&p->next, &slot.chunk, &slot.index) && !locate(&p->prev, &slot.chunk, &slot.index)) {
+			slot.chunk = list->chunks.head;
+			slot.index = 0;
+		}
+
+		if (!insert_item(list, &slot, item))
+			return false;
+
+		update_slots(p, slot.chunk, slot.index, list->conf.flags & C_UTILS_LIST_RC_ITEM);
+
+		return true;
+	} // Release Writer Lock
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static bool unrolled_del(void *instance, void *pos) {
+	struct c_utils_list *list = instance;
+	struct c_utils_list_unrolled_iterator_position *p = pos;
+	struct c_utils_list_chunk *chunk;
+	unsigned int index;
+
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		// List is empty or we are not pointed to an item.
+		if(!list->size || !p->curr.chunk)
+			return false;
+
+		if (locate(&p->curr, &chunk, &index))
+			remove_slot(list, chunk, index, list->conf.callbacks.destructors.item);
+
+		return true;
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static bool unrolled_rem(void *instance, void *pos) {
+	struct c_utils_list *list = instance;
+	struct c_utils_list_unrolled_iterator_position *p = pos;
+	struct c_utils_list_chunk *chunk;
+	unsigned int index;
+
+	C_UTILS_SCOPED_WRLOCK(list->lock) {
+		// List is empty or we are not pointed to an item.
+		if(!list->size || !p->curr.chunk)
+			return false;
+
+		if (locate(&p->curr, &chunk, &index))
+			remove_slot(list, chunk, index, NULL);
+
+		return true;
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+static void unrolled_finalize(void *instance, void *pos) {
+	update_slots(pos, NULL, 0, ((struct c_utils_list *)instance)->conf.flags & C_UTILS_LIST_RC_ITEM);
+	free(pos);
+}
+
+
+
+static void *lock_free_head(void *instance, void *pos) {
+	struct c_utils_list *list = instance;
+	struct c_utils_list_iterator_position *p = pos;
+	bool ref_item = list->conf.flags & C_UTILS_LIST_RC_ITEM;
+
+	update_pos(p, NULL, ref_item);
+	p->curr = lock_free_step(list, NULL, ref_item);
+	c_utils_hazard_release_at(C_UTILS_LIST_HP_STEP, false);
+
+	return get_item(p->curr);
+}
+
+static void *lock_free_next(void *instance, void *pos) {
+	struct c_utils_list *list = instance;
+	struct c_utils_list_iterator_position *p = pos;
+	bool ref_item = list->conf.flags & C_UTILS_LIST_RC_ITEM;
+
+	// The reference to the node is moved on to the next, even if the node has since been removed.
+	if (p->curr && ref_item)
+		C_UTILS_REF_DEC(p->curr->item);
+
+	p->curr = lock_free_step(list, p->curr, ref_item);
+	c_utils_hazard_release_at(C_UTILS_LIST_HP_STEP, false);
+
+	return get_item(p->curr);
+}
+
+static void *lock_free_curr(void *instance, void *pos) {
+	struct c_utils_list_iterator_position *p = pos;
+
+	if (p->curr && !lock_free_is_marked(__atomic_load_n(&p->curr->next, __ATOMIC_ACQUIRE)))
+		return p->curr->item;
+
+	return NULL;
+}
+
+static bool lock_free_append(void *instance, void *pos, void *item) {
+	if(!item)
+		return false;
+
+	struct c_utils_list *list = instance;
+	struct c_utils_list_iterator_position *p = pos;
+	bool ref_item = list->conf.flags & C_UTILS_LIST_RC_ITEM;
+
+	// We cannot append to the list and violate sorted order.
+	if(list->conf.callbacks.comparators.item)
+		return false;
+
+	struct c_utils_node *node = create_node(list, item);
+	if (!node) {
+		C_UTILS_LOG_ASSERT(list->conf.logger, "create_node: 'Was unable to create a reference counted node!'");
+		return false;
+	}
+
+	if(__atomic_add_fetch(&list->size, 1, __ATOMIC_RELAXED) > list->conf.size.max && list->conf.size.max) {
+		__atomic_sub_fetch(&list->size, 1, __ATOMIC_RELAXED);
+		c_utils_ref_destroy(node);
+		return false;
+	}
+
+	// Taken before it is linked, as it may be removed as soon as it is.
+	C_UTILS_REF_INC(node);
+	if (ref_item)
+		C_UTILS_REF_INC(item);
+
+	/*
+		Linked after the current node, unless it has been removed, in which case no node may be linked after it, or
+		there is none, in which case it is linked at the head as list_add does.
+	*/
+	struct c_utils_node **link = p->curr ? &p->curr->next : &list->head;
+	struct c_utils_node *next = __atomic_load_n(link, __ATOMIC_RELAXED);
+	while (true) {
+		if (lock_free_is_marked(next)) {
+			link = &list->head;
+			next = __atomic_load_n(link, __ATOMIC_RELAXED);
+			continue;
+		}
+
+		node->next = next;
+		if (__atomic_compare_exchange_n(link, &next, node, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+			break;
+	}
+
+	update_pos(p, NULL, ref_item);
+	p->curr = node;
+
+	return true;
+}
+
+static bool lock_free_del(void *instance, void *pos) {
+	struct c_utils_list *list = instance;
+	struct c_utils_list_iterator_position *p = pos;
+
+	// We are not pointed to a node.
+	if (!p->curr)
+		return false;
+
+	lock_free_remove(list, lock_free_match_node, p->curr, list->conf.callbacks.destructors.item);
+	return true;
+}
+
+static bool lock_free_rem(void *instance, void *pos) {
+	struct c_utils_list *list = instance;
+	struct c_utils_list_iterator_position *p = pos;
+
+	// We are not pointed to a node.
+	if (!p->curr)
+		return false;
+
+	lock_free_remove(list, lock_free_match_node, p->curr, NULL);
+	return true;
+}
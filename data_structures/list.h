@@ -34,6 +34,44 @@
 */
 #define C_UTILS_LIST_DELETE_ON_DESTROY 1 << 3
 
+/*
+	Stores the items in chunks of contiguous slots, each aligned to and spanning whole cache lines, rather than
+	allocating a reference counted node for each item. Iterating and searching then touch one cache line for every
+	several items rather than chasing a pointer for each, and the list costs little more than a pointer per item.
+
+	Items shift within their chunk as others are added or removed around them, a full chunk is split in half, and
+	a mostly empty chunk is merged into a neighbour. Iterators hence remember the item they are positioned on and
+	find it again within it's chunk or that chunk's neighbours, so they are still corrected when the item they were
+	positioned on is removed, as they would be for nodes.
+*/
+#define C_UTILS_LIST_UNROLLED 1 << 4
+
+/*
+	Links the nodes into a skip list as well, in which every node has a random height and each of it's links above
+	the first counts how many nodes it skips over. Indexing the list, as c_utils_list_get and c_utils_list_remove_at
+	do, then only takes O(log N) steps, as does adding to a sorted list and finding an item in one. Iterators are
+	unchanged, as the nodes are still linked to each other in order.
+
+	Each node is larger by the links of it's height, and adding or removing a node relinks each of it's levels as
+	well, so it is only worth flagging for lists which are indexed or sorted. It may not be used with LIST_UNROLLED.
+*/
+#define C_UTILS_LIST_INDEXED 1 << 5
+
+/*
+	Adds, removes and finds items without taking a lock, after Harris' and Michael's lock-free lists, in which a node
+	is removed by marking the lowest bit of it's next pointer, so that no node can be linked after it, and then
+	unlinked by whichever thread passes it first. Searches restart only when the node they stand on is removed.
+
+	Nodes are protected by the hazard pointers while being searched, and are only retired once both unlinked and
+	marked. Iterators instead hold a reference to their node, as they do for the other modes, so they may still
+	step past it after it is unlinked. Deleted items are only destroyed once no thread may still be comparing them.
+
+	The nodes are only linked forwards, so iterating backwards, from the tail, or prepending with an iterator is not
+	supported, and items are added at the head rather than the tail when unsorted. LIST_CONCURRENT is implied, and it
+	may not be used with LIST_UNROLLED or LIST_INDEXED.
+*/
+#define C_UTILS_LIST_LOCK_FREE 1 << 6
+
 /*
 	A double linked-list implementation, which can used as a generic data structure. 
 
@@ -104,6 +142,8 @@
 
 struct c_utils_list;
 
+struct c_utils_node_pool;
+
 /**
  *	flags:
  *		defaults:
@@ -129,6 +169,25 @@ struct c_utils_list;
  *		notes:
  *			Can be used to allow tracing and debugging information. This logger will also be passed to the reference counter meta data if the
  *			flag LIST_RC_INSTANCE.
+ *	size:
+ *		max:
+ *			defaults:
+ *				0
+ *			notes:
+ *				The maximum amount of items the list may hold, or unbounded if 0.
+ *		chunk:
+ *			defaults:
+ *				As many items as fit in 4 cache lines
+ *			notes:
+ *				The amount of items held by each chunk if LIST_UNROLLED is flagged, rounded up so that each chunk fills a whole
+ *				amount of cache lines. Larger chunks iterate faster, but shift more items on each add and remove.
+ *	pool:
+ *		defaults:
+ *			NULL
+ *		notes:
+ *			When specified, each node is allocated from the pool rather than with malloc, which must have been created with
+ *			nodes at least as large as the default. The pool may be shared between lists, and must outlive them. Not used if
+ *			LIST_UNROLLED, LIST_INDEXED or LIST_LOCK_FREE is flagged, as the chunks and nodes vary in size.
  */
 struct c_utils_list_conf {
 	/// Additional flags used to configure and tune the list.
@@ -144,7 +203,10 @@ struct c_utils_list_conf {
 	} callbacks;
 	struct {
 		size_t max;
+		size_t chunk;
 	} size;
+	/// Allocates the nodes, if specified.
+	struct c_utils_node_pool *pool;
 	/// Used to log any errors or trace information to.
 	struct c_utils_logger *logger;
 };
@@ -191,6 +253,9 @@ typedef struct c_utils_list_conf list_conf_t;
 #define LIST_RC_INSTANCE C_UTILS_LIST_RC_INSTANCE
 #define LIST_RC_ITEM C_UTILS_LIST_RC_ITEM
 #define LIST_DELETE_ON_DESTROY C_UTILS_LIST_DELETE_ON_DESTROY
+#define LIST_UNROLLED C_UTILS_LIST_UNROLLED
+#define LIST_INDEXED C_UTILS_LIST_INDEXED
+#define LIST_LOCK_FREE C_UTILS_LIST_LOCK_FREE
 
 /*
 	Functions
@@ -276,6 +341,17 @@ void c_utils_list_delete_at(struct c_utils_list *list, unsigned int index);
  */
 void *c_utils_list_remove_at(struct c_utils_list *list, unsigned int index);
 
+/**
+ * Sorts the items of the list in ascending order of the comparator, by copying them out to an array, sorting it
+ * with c_utils_sort, and relinking the nodes in that order, so iterators stay on the item they are positioned on.
+ * The exception is a LIST_UNROLLED list, whose items are instead copied back into their chunks in place. Its iterators
+ * stay on the same slot, and so are left on whichever item was sorted into that slot, rather than the one they were on.
+ * @param list The list to sort.
+ * @param compare Comparator, which must be the list's own if it has one.
+ * @return true if sorted, false if the list is NULL or LIST_LOCK_FREE, compare is not the list's own, or on allocation failure.
+ */
+bool c_utils_list_sort(struct c_utils_list *list, c_utils_comparator_cb compare);
+
 /**
  *	Head:
  *		Concurrent:
@@ -347,7 +423,10 @@ bool c_utils_list_add(struct c_utils_list *list, void *item);
 void *c_utils_list_as_array(struct c_utils_list *list, size_t *array_size);
 
 /**
- * Calls the passed callback on all items in the linked list.
+ * Calls the passed callback on all items in the linked list. On a LIST_LOCK_FREE list, each item is protected by a
+ * hazard pointer while the callback runs. The callback may use other lock-free structures, and add, remove or find
+ * items of this list, as none of those release it. It must not iterate this list itself, through for_each, as_array
+ * or an iterator, as those step through it with the same hazard pointer.
  * @param list List to execute the callback on.
  * @param callback Callback to manipulate the item in the list.
  * @return 1 on success, 0 if list or callback is NULL.
@@ -5,34 +5,163 @@
 #include "../io/logger.h"
 #include "../threading/scoped_lock.h"
 #include "../memory/ref_count.h"
+#include "../memory/hazard.h"
+#include "filter.h"
 
-struct c_utils_bucket {
-	/// Hash.
-	uint32_t hash;
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+	The map is an open-addressing table split into two parallel arrays: a packed array of
+	control bytes and the slots themselves. A control byte is either empty, or holds the upper
+	7 bits of the hash of the key stored in that slot with the sign bit set (the "tag"). Empty is
+	zero, so that a freshly allocated table can be handed out zeroed by calloc, and its pages are
+	only touched as they are filled in rather than all at once. The tags allow a probe to inspect
+	an entire group of slots at once (16 with SSE2) and only touch a slot when the tag matches.
+	Probing is linear, hence on deletion we shift any displaced entries back into the hole
+	(backward-shift deletion), which leaves no tombstones behind and allows any probe to stop on
+	the first empty control byte.
+
+	Resizing is incremental: the old table is kept alongside the new one, and each write to the
+	shard migrates a bounded amount of slots from the old table to the new one. Slots which have
+	been migrated (or removed while still in the old table) are marked as moved rather than empty,
+	so that probes in the old table continue past them; the old table is never shifted, as that
+	could move an entry behind the migration cursor.
+
+	The control bytes are followed by a clone of the first C_UTILS_MAP_GROUP_WIDTH - 1 bytes, so
+	that a group may be loaded at any position without wrapping around.
+*/
+#define C_UTILS_MAP_GROUP_WIDTH 16
+
+#define C_UTILS_MAP_CTRL_EMPTY ((int8_t) 0)
+
+#define C_UTILS_MAP_CTRL_MOVED ((int8_t) 1)
+
+#define C_UTILS_MAP_TAG(hash) ((int8_t) (((hash) >> 25) | 0x80))
+
+/// The amount of slots of the old table that are migrated per write during a resize.
+#define C_UTILS_MAP_MIGRATE_BUDGET 64
+
+#define C_UTILS_MAP_NPOS ((size_t) -1)
+
+#define C_UTILS_MAP_CACHE_LINE 64
+
+/// The hazard pointers held by an optimistic read, on the table and the old table being migrated from.
+#define C_UTILS_MAP_HP_TABLE (C_UTILS_HAZARD_INDEX_MAP + 0)
+#define C_UTILS_MAP_HP_OLD (C_UTILS_HAZARD_INDEX_MAP + 1)
+
+struct c_utils_map_slot {
 	/// Key
 	void *key;
 	/// Value
 	void *value;
-	/// Determines whether or not the bucket is in use, to allow for "caching".
-	volatile bool in_use;
+	/// The full hash of the key, so we never need to rehash it.
+	uint32_t hash;
 };
 
-struct c_utils_map {
-	/// Array of all bucket head nodes.
-	struct c_utils_bucket *buckets;
-	/// The size of the hash map.
+struct c_utils_map_table {
+	/// The amount of slots, always a power of two.
+	size_t capacity;
+	/// Used to map a hash to a slot (capacity - 1).
+	size_t mask;
+	/// Control bytes, one per slot plus the cloned group.
+	int8_t *ctrl;
+	/// Key-value slots.
+	struct c_utils_map_slot *slots;
+};
+
+/*
+	Each shard is an independent table with it's own lock, and is aligned to a cache line so that
+	writers to different shards do not contend on the same line. A map which is not sharded is
+	simply a map with a single shard.
+*/
+struct c_utils_map_shard {
+	/// The table containing all key-value pairs of this shard.
+	struct c_utils_map_table *table;
+	/// The table being migrated from, if a resize is in progress.
+	struct c_utils_map_table *old;
+	/// The next slot of the old table to be migrated.
+	size_t migrate_pos;
+	/// Bumped whenever pairs are moved between slots, so that iterators can detect it.
+	size_t version;
+	/*
+		If the last bump of the version was a removal from the table, which only shifted pairs back into
+		the removed slot from slots after it, that slot, otherwise C_UTILS_MAP_NPOS. An iterator on that
+		slot can find every pair it has yet to visit by visiting it again.
+	*/
+	size_t erased;
+	/*
+		Index from value to key, if enabled. It is a table of the same kind, keyed by the hash of the value,
+		where each slot's key is the value and it's value is the key. As more than one key may map to an equal
+		value, it may hold duplicates.
+	*/
+	struct c_utils_map_table *reverse;
+	/// Filter of the hashes of every key in this shard, if C_UTILS_MAP_FILTERED is flagged, otherwise NULL.
+	struct c_utils_filter *filter;
+	/// The size of this shard.
 	size_t size;
-	/// Maximum amount of buckets.
-	size_t num_buckets;
 	/// RWLock to enforce thread-safety.
 	struct c_utils_scoped_lock *lock;
+	/// The minimum and maximum amount of slots for this shard's table.
+	size_t min;
+	size_t max;
+} __attribute__((aligned(C_UTILS_MAP_CACHE_LINE)));
+
+struct c_utils_map {
+	/// The shards, of which there is always at least one.
+	struct c_utils_map_shard *shards;
+	/// The amount of shards, always a power of two.
+	size_t num_shards;
+	/// log2(num_shards), used to select a shard from a hash.
+	unsigned int shard_bits;
+	/// Counters, if C_UTILS_MAP_STATS is flagged, otherwise NULL.
+	struct c_utils_map_counters *counters;
 	/// Configuration
 	struct c_utils_map_conf conf;
 };
 
+/// The amount of keys of a batch which are hashed and grouped by shard at once.
+#define C_UTILS_MAP_BATCH_SIZE 64
+
+/*
+	Scratch space for a batch operation. The keys are first hashed, and then the indices of the keys are
+	ordered by shard, so that each shard is only locked once per batch.
+*/
+struct c_utils_map_batch {
+	uint32_t hashes[C_UTILS_MAP_BATCH_SIZE];
+	size_t shards[C_UTILS_MAP_BATCH_SIZE];
+	uint8_t order[C_UTILS_MAP_BATCH_SIZE];
+};
+
+/*
+	Counters are striped rather than kept per shard, as lookups of the same shard from different threads would
+	otherwise contend on the same cache line. Each thread is assigned a stripe the first time it counts anything,
+	and the stripes are summed when read.
+*/
+#define C_UTILS_MAP_STATS_STRIPES 16
+
+struct c_utils_map_counters {
+	size_t lookups;
+	size_t misses;
+	/// Total groups probed by all lookups.
+	size_t probes;
+	size_t max_probe;
+	size_t histogram[C_UTILS_MAP_STATS_HISTOGRAM];
+	size_t resizes;
+	size_t resize_ns;
+} __attribute__((aligned(C_UTILS_MAP_CACHE_LINE)));
+
 static const int default_initial = 64;
 static const int default_min = 32;
-static const int default_max = 1024;
+static const size_t default_max = SIZE_MAX;
+static const int default_shards = 16;
+static const double default_reverse_trigger = .75;
 static const double default_growth_rate = 2;
 static const double default_growth_trigger = .5;
 static const double default_shrink_rate = .5;
@@ -40,15 +169,45 @@ static const double default_shrink_trigger = .1;
 
 
 
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Map Table Helper Functions                                  //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static struct c_utils_map_table *create_table(size_t capacity, struct c_utils_logger *logger);
+
+static inline uint32_t group_match(const int8_t *group, int8_t tag);
+
+static inline uint32_t group_match_empty(const int8_t *group);
+
+static inline bool is_full(int8_t ctrl);
+
+static inline void set_ctrl(struct c_utils_map_table *table, size_t index, int8_t ctrl);
+
+static inline void move_slot(struct c_utils_map_table *table, size_t from, size_t to);
+
+static bool erase_slot(struct c_utils_map_table *table, size_t index, bool *wrapped);
+
+static size_t round_capacity(size_t size);
+
+
+
 //////////////////////////////////////////////////////////////////////////////////////
 //	 																				//
 //						Map Retrieval Helper Functions                              //
 //  																				//
 //////////////////////////////////////////////////////////////////////////////////////
 
-static struct c_utils_bucket *get_existing_bucket(const struct c_utils_map *map, const void *key);
+static inline struct c_utils_map_shard *get_shard(const struct c_utils_map *map, uint32_t hash);
 
-static struct c_utils_bucket *get_empty_bucket(const struct c_utils_map *map, const void *key);
+static size_t find_slot(const struct c_utils_map *map, const struct c_utils_map_table *table, const void *key, uint32_t hash, size_t *groups);
+
+static size_t find_or_prepare_insert(const struct c_utils_map *map, const struct c_utils_map_table *table, const void *key, uint32_t hash, bool *found);
+
+static size_t find_empty(const struct c_utils_map_table *table, uint32_t hash);
+
+static struct c_utils_map_table *lookup(const struct c_utils_map *map, const struct c_utils_map_shard *shard, const void *key, uint32_t hash, size_t *index, size_t *groups);
 
 
 
@@ -58,11 +217,73 @@ static struct c_utils_bucket *get_empty_bucket(const struct c_utils_map *map, co
 //  																				//
 //////////////////////////////////////////////////////////////////////////////////////
 
+static uint32_t get_hash(const struct c_utils_map *map, const void *key);
+
 static size_t get_key_size(const struct c_utils_map *map, const void *key);
 
 static uint32_t hash_key(const void *key, size_t len);
 
-static void *value_to_key(struct c_utils_map *map, const void *value);
+static void *value_to_key(struct c_utils_map *map, struct c_utils_map_shard *shard, const void *value);
+
+static bool add_pair(struct c_utils_map *map, struct c_utils_map_shard *shard, void *key, void *value, uint32_t hash);
+
+static bool find_or_reserve(struct c_utils_map *map, struct c_utils_map_shard *shard, const void *key, uint32_t hash, struct c_utils_map_table **table, size_t *index, bool *found);
+
+static bool insert_slot(struct c_utils_map *map, struct c_utils_map_shard *shard, struct c_utils_map_table *table, size_t index, void *key, void *value, uint32_t hash);
+
+static void release_value(struct c_utils_map *map, void *value);
+
+static void *get_value(struct c_utils_map *map, struct c_utils_map_shard *shard, const void *key, uint32_t hash);
+
+static void *get_value_optimistic(struct c_utils_map *map, struct c_utils_map_shard *shard, const void *key, uint32_t hash);
+
+static void free_table(struct c_utils_map *map, struct c_utils_map_table *table);
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Map Batch Helper Functions                                  //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static void prepare_batch(const struct c_utils_map *map, const void **keys, size_t n, struct c_utils_map_batch *batch);
+
+static void prefetch_batch(const struct c_utils_map_shard *shard, const struct c_utils_map_batch *batch, size_t start, size_t end);
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Map Statistics Helper Functions                             //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static struct c_utils_map_counters *get_counters(const struct c_utils_map *map);
+
+static void count_lookup(const struct c_utils_map *map, size_t groups, bool found);
+
+static void count_resize_time(const struct c_utils_map *map, uint64_t start);
+
+static uint64_t get_time_ns(void);
+
+static void add_table_probes(const struct c_utils_map_table *table, struct c_utils_map_stats *stats, size_t *probes);
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Map Reverse Index Helper Functions                          //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t get_value_hash(const struct c_utils_map *map, const void *value);
+
+static bool reverse_add(struct c_utils_map *map, struct c_utils_map_shard *shard, void *key, void *value);
+
+static void reverse_remove(struct c_utils_map_shard *shard, const void *key, const void *value, uint32_t hash);
+
+static void *reverse_find(struct c_utils_map *map, struct c_utils_map_shard *shard, const void *value, uint32_t hash);
 
 
 
@@ -84,6 +305,12 @@ static void *curr(void *instance, void *pos);
 
 static void finalize(void *instance, void *pos);
 
+static void *seek(struct c_utils_map *map, struct _c_utils_map_iterator_position *pos, bool forward);
+
+static void *seek_snapshot(struct c_utils_map *map, struct _c_utils_map_iterator_position *pos, bool forward);
+
+static void set_current(struct c_utils_map *map, struct _c_utils_map_iterator_position *pos, void *key, void *value);
+
 
 
 //////////////////////////////////////////////////////////////////////////////////////
@@ -92,7 +319,21 @@ static void finalize(void *instance, void *pos);
 //  																				//
 //////////////////////////////////////////////////////////////////////////////////////
 
-static bool resize_map(struct c_utils_map *map, size_t size);
+static bool resize_shard(struct c_utils_map *map, struct c_utils_map_shard *shard, size_t size);
+
+static void migrate(struct c_utils_map *map, struct c_utils_map_shard *shard, size_t budget);
+
+static void shrink_shard(struct c_utils_map *map, struct c_utils_map_shard *shard);
+
+static struct c_utils_filter *create_filter(size_t capacity, struct c_utils_logger *logger);
+
+static void rebuild_filter(struct c_utils_map *map, struct c_utils_map_shard *shard, size_t capacity);
+
+static void drop_filter(struct c_utils_map *map, struct c_utils_map_shard *shard);
+
+static void remove_slot(struct c_utils_map *map, struct c_utils_map_shard *shard, struct c_utils_map_table *table, size_t index);
+
+static void clear_shard(struct c_utils_map *map, struct c_utils_map_shard *shard, bool delete);
 
 static void map_destroy(void *map);
 
@@ -141,25 +382,100 @@ struct c_utils_map *c_utils_map_create_conf(struct c_utils_map_conf *conf) {
 		goto err;
 	}
 
-	map->num_buckets = conf->size.initial;
-	map->size = 0;
+	map->shard_bits = 0;
+	map->num_shards = 1;
+	if(conf->flags & C_UTILS_MAP_SHARDED)
+		while(map->num_shards < conf->shards) {
+			map->num_shards <<= 1;
+			map->shard_bits++;
+		}
+
+	map->counters = NULL;
+	if(conf->flags & C_UTILS_MAP_STATS) {
+		map->counters = aligned_alloc(C_UTILS_MAP_CACHE_LINE, sizeof(*map->counters) * C_UTILS_MAP_STATS_STRIPES);
+		if(!map->counters) {
+			C_UTILS_LOG_ERROR(conf->logger, "aligned_alloc: \"%s\"", strerror(errno));
+			goto err_counters;
+		}
+
+		memset(map->counters, 0, sizeof(*map->counters) * C_UTILS_MAP_STATS_STRIPES);
+	}
+
+	map->shards = aligned_alloc(C_UTILS_MAP_CACHE_LINE, sizeof(*map->shards) * map->num_shards);
+	if(!map->shards) {
+		C_UTILS_LOG_ERROR(conf->logger, "aligned_alloc: \"%s\"", strerror(errno));
+		goto err_shards;
+	}
+
+	// The sizes in the configuration are for the map as a whole, so they are split evenly between shards.
+	size_t initial = round_capacity((conf->size.initial + map->num_shards - 1) / map->num_shards);
+	size_t min = (conf->size.min + map->num_shards - 1) / map->num_shards;
+	size_t max = conf->size.max / map->num_shards + (conf->size.max % map->num_shards != 0);
+
+	size_t i;
+	for(i = 0; i < map->num_shards; i++) {
+		struct c_utils_map_shard *shard = map->shards + i;
+		shard->size = 0;
+		shard->old = NULL;
+		shard->migrate_pos = 0;
+		shard->version = 0;
+		shard->erased = C_UTILS_MAP_NPOS;
+		shard->min = min;
+		shard->max = max < initial ? initial : max;
+
+		shard->table = create_table(initial, conf->logger);
+		if(!shard->table)
+			goto err_shard;
+
+		shard->reverse = NULL;
+		if(conf->flags & C_UTILS_MAP_REVERSE_INDEX) {
+			shard->reverse = create_table(initial, conf->logger);
+			if(!shard->reverse) {
+				free(shard->table);
+				goto err_shard;
+			}
+		}
 
-	C_UTILS_ON_BAD_CALLOC(map->buckets, conf->logger, sizeof(struct c_utils_bucket) * map->num_buckets)
-		goto err_buckets;
+		shard->filter = NULL;
+		if(conf->flags & C_UTILS_MAP_FILTERED) {
+			shard->filter = create_filter(initial, conf->logger);
+			if(!shard->filter) {
+				free(shard->table);
+				free(shard->reverse);
+				goto err_shard;
+			}
+		}
 
-	map->lock = conf->flags & C_UTILS_MAP_CONCURRENT ? c_utils_scoped_lock_rwlock(NULL, conf->logger) : c_utils_scoped_lock_no_op();
-	if(!map->lock) {
-		C_UTILS_LOG_ERROR(conf->logger, "Was unable to create the scoped_lock!");
-		goto err_lock;
+		// Sharding is only useful for concurrent access, hence each shard is always locked.
+		if(conf->flags & C_UTILS_MAP_OPTIMISTIC_READ)
+			shard->lock = c_utils_scoped_lock_seqlock(NULL, conf->logger);
+		else
+			shard->lock = conf->flags & (C_UTILS_MAP_CONCURRENT | C_UTILS_MAP_SHARDED) ?
+				c_utils_scoped_lock_rwlock(NULL, conf->logger) : c_utils_scoped_lock_no_op();
+		if(!shard->lock) {
+			C_UTILS_LOG_ERROR(conf->logger, "Was unable to create the scoped_lock!");
+			free(shard->table);
+			free(shard->reverse);
+			c_utils_filter_destroy(shard->filter);
+			goto err_shard;
+		}
 	}
 
 	map->conf = *conf;
 
 	return map;
 
-	err_lock:
-		free(map->buckets);
-	err_buckets:
+	err_shard:
+		while(i--) {
+			c_utils_scoped_lock_destroy(map->shards[i].lock);
+			free(map->shards[i].table);
+			free(map->shards[i].reverse);
+			c_utils_filter_destroy(map->shards[i].filter);
+		}
+		free(map->shards);
+	err_shards:
+		free(map->counters);
+	err_counters:
 		if(conf->flags & C_UTILS_MAP_RC_INSTANCE)
 			c_utils_ref_destroy(map);
 		else
@@ -180,268 +496,597 @@ bool c_utils_map_add(struct c_utils_map *map, void *key, void *value) {
 		return false;
 	}
 
-	C_UTILS_SCOPED_WRLOCK(map->lock) {
-		struct c_utils_bucket *bucket = get_empty_bucket(map, key);
-		if(!bucket)
-			return false;
-
-		bucket->key = key;
-		bucket->value = value;
-		bucket->in_use = true;
+	// Hashing is done before acquiring the lock, as it may be expensive for large keys.
+	uint32_t hash = get_hash(map, key);
 
-		// Have we added enough to trigger a growth?
-		if((++map->size / (double)map->num_buckets) >= map->conf.growth.trigger)
-			resize_map(map, map->num_buckets * map->conf.growth.ratio);
+	struct c_utils_map_shard *shard = get_shard(map, hash);
 
-		return true;
-	}
+	C_UTILS_SCOPED_WRLOCK(shard->lock)
+		return add_pair(map, shard, key, value, hash);
 
 	C_UTILS_UNACCESSIBLE;
 }
 
-void *c_utils_map_get(struct c_utils_map *map, const void *key) {
-	if(!map || !map->size)
-		return false;
+size_t c_utils_map_add_batch(struct c_utils_map *map, void **keys, void **values, size_t n) {
+	if(!map)
+		return 0;
 
-	if(!key) {
-		C_UTILS_LOG_ERROR(map->conf.logger, "This map does not support NULL keys!");
-		return false;
+	if(!keys || !values) {
+		C_UTILS_LOG_ERROR(map->conf.logger, "Keys and values cannot be NULL!");
+		return 0;
 	}
 
-	C_UTILS_SCOPED_RDLOCK(map->lock) {
-		struct c_utils_bucket *bucket = get_existing_bucket(map, key);
-		if(!bucket)
-			return NULL;
+	size_t added = 0;
+	struct c_utils_map_batch batch;
 
-		void *value = bucket->value;
+	for(size_t offset = 0; offset < n; offset += C_UTILS_MAP_BATCH_SIZE) {
+		size_t count = n - offset < C_UTILS_MAP_BATCH_SIZE ? n - offset : C_UTILS_MAP_BATCH_SIZE;
+		prepare_batch(map, (const void **) keys + offset, count, &batch);
 
-		// The caller is obtaining a copy of the value, hence they gain a reference to it.
-		if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
-			C_UTILS_REF_INC(value);
+		for(size_t start = 0, end; start < count; start = end) {
+			struct c_utils_map_shard *shard = map->shards + batch.shards[batch.order[start]];
+			for(end = start + 1; end < count && batch.shards[batch.order[end]] == batch.shards[batch.order[start]]; end++)
+				;
 
-		return value;
+			C_UTILS_SCOPED_WRLOCK(shard->lock) {
+				prefetch_batch(shard, &batch, start, end);
+
+				for(size_t i = start; i < end; i++) {
+					size_t j = batch.order[i];
+					void *key = keys[offset + j], *value = values[offset + j];
+
+					if(!key || !value) {
+						C_UTILS_LOG_ERROR(map->conf.logger, "This map does not support NULL keys or values!");
+						continue;
+					}
+
+					added += add_pair(map, shard, key, value, batch.hashes[j]);
+				}
+			}
+		}
 	}
 
-	C_UTILS_UNACCESSIBLE;
+	return added;
 }
 
-void *c_utils_map_remove(struct c_utils_map *map, const void *key) {
-	if(!map || !map->size)
+bool c_utils_map_upsert(struct c_utils_map *map, void *key, void *value, void **old) {
+	if(old)
+		*old = NULL;
+
+	if(!map)
 		return false;
 
 	if(!key) {
 		C_UTILS_LOG_ERROR(map->conf.logger, "This map does not support NULL keys!");
 		return false;
+	} else if (!value) {
+		C_UTILS_LOG_ERROR(map->conf.logger, "This map does not support NULL values!");
+		return false;
 	}
 
-	C_UTILS_SCOPED_WRLOCK(map->lock) {
-		struct c_utils_bucket *bucket = get_existing_bucket(map, key);
-		if(!bucket)
-			return NULL;
+	uint32_t hash = get_hash(map, key);
+	struct c_utils_map_shard *shard = get_shard(map, hash);
 
-		// If we have a reference to the bucket's key, release it.
-		if(map->conf.flags & C_UTILS_MAP_RC_KEY)
-			C_UTILS_REF_DEC(bucket->key);
+	C_UTILS_SCOPED_WRLOCK(shard->lock) {
+		bool found;
+		size_t index;
+		struct c_utils_map_table *table;
 
-		bucket->in_use = false;
-		map->size--;
+		if(!find_or_reserve(map, shard, key, hash, &table, &index, &found))
+			return false;
 
-		// Is shrinking enabled? Do we have enough free space to trigger shrinking?
-		if(map->conf.flags & C_UTILS_MAP_SHRINK_ON_TRIGGER)
-			if((map->size / (double)map->num_buckets) <= map->conf.shrink.trigger)
-				resize_map(map, map->size * map->conf.shrink.ratio);
+		if(!found)
+			return insert_slot(map, shard, table, index, key, value, hash);
 
-		// Note that the caller steals our reference to the value.
-		return bucket->value;
-	}
+		struct c_utils_map_slot *slot = table->slots + index;
 
-	C_UTILS_UNACCESSIBLE;
-}
+		// The new value is indexed first, so that if that fails, the map is left as it was.
+		if(shard->reverse) {
+			if(!reverse_add(map, shard, slot->key, value))
+				return false;
 
-void c_utils_map_remove_all(struct c_utils_map *map) {
-	if(!map || !map->size)
-		return;
+			reverse_remove(shard, slot->key, slot->value, get_value_hash(map, slot->value));
+		}
 
-	C_UTILS_SCOPED_WRLOCK(map->lock) {
-		for(size_t i = 0; i < map->num_buckets; i++) {
-			struct c_utils_bucket *bucket = map->buckets + i;
-			if(bucket->in_use) {
-				// If we have a reference to the key, release it.
-				if(map->conf.flags & C_UTILS_MAP_RC_KEY)
-					C_UTILS_REF_DEC(bucket->key);
+		// Note that the caller steals our reference to the old value if they asked for it.
+		if(old)
+			*old = slot->value;
+		else
+			release_value(map, slot->value);
 
-				// If we have a reference to the value, release it.
-				if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
-					C_UTILS_REF_DEC(bucket->value);
+		slot->value = value;
 
-				bucket->in_use = false;
-				map->size--;
-			}
-		}
+		return true;
 	}
+
+	C_UTILS_UNACCESSIBLE;
 }
 
-bool c_utils_map_delete(struct c_utils_map *map, const void *key) {
-	if(!map || !map->size)
-		return false;
+void *c_utils_map_compute_if_absent(struct c_utils_map *map, void *key, void *(*compute)(const void *key), bool *added) {
+	if(added)
+		*added = false;
 
-	if(!key) {
-		C_UTILS_LOG_ERROR(map->conf.logger, "This map does not support NULL keys!");
-		return false;
+	if(!map)
+		return NULL;
+
+	if(!key || !compute) {
+		C_UTILS_LOG_ERROR(map->conf.logger, "Key and callback cannot be NULL!");
+		return NULL;
 	}
 
-	C_UTILS_SCOPED_WRLOCK(map->lock) {
-		struct c_utils_bucket *bucket = get_existing_bucket(map, key);
-		if(!bucket)
-			return false;
+	uint32_t hash = get_hash(map, key);
+	struct c_utils_map_shard *shard = get_shard(map, hash);
 
-		// If we have a reference to the key, release it.
-		if(!(map->conf.flags & C_UTILS_MAP_RC_KEY))
-			C_UTILS_REF_DEC(bucket->key);
+	C_UTILS_SCOPED_WRLOCK(shard->lock) {
+		bool found;
+		size_t index;
+		struct c_utils_map_table *table;
 
-		// If we have a reference to the value, release it. Otherwise, invoke destructor.
-		if(!(map->conf.flags & C_UTILS_MAP_RC_VALUE))
-			C_UTILS_REF_DEC(bucket->value);
-		else
-			map->conf.callbacks.destructors.value(bucket->value);
+		if(!find_or_reserve(map, shard, key, hash, &table, &index, &found))
+			return NULL;
 
-		bucket->in_use = false;
-		map->size--;
+		void *value;
+		if(found) {
+			value = table->slots[index].value;
+		} else {
+			value = compute(key);
+			if(!value)
+				return NULL;
+
+			if(!insert_slot(map, shard, table, index, key, value, hash)) {
+				release_value(map, value);
+				return NULL;
+			}
 
-		// Is shrinking enabled? Do we have enough free space to trigger shrinking?
-		if(map->conf.flags & C_UTILS_MAP_SHRINK_ON_TRIGGER)
-			if((map->size / (double)map->num_buckets) <= map->conf.shrink.trigger)
-				resize_map(map, map->size * map->conf.shrink.ratio);
+			if(added)
+				*added = true;
+		}
 
-		return true;
+		// As with get, the caller gains a reference to the value.
+		if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
+			C_UTILS_REF_INC(value);
+
+		return value;
 	}
 
 	C_UTILS_UNACCESSIBLE;
 }
 
-void c_utils_map_delete_all(struct c_utils_map *map) {
-	if(!map || !map->size)
-		return;
+void *c_utils_map_merge(struct c_utils_map *map, void *key, void *value, void *(*merge)(void *old, void *value), bool *added) {
+	if(added)
+		*added = false;
 
-	C_UTILS_SCOPED_WRLOCK(map->lock) {
-		for(size_t i = 0; i < map->num_buckets; i++) {
-			struct c_utils_bucket *bucket = map->buckets + i;
-			if(bucket->in_use) {
-				// If we have a reference to the key, release it. Otherwise, invoke destructor
-				if(map->conf.flags & C_UTILS_MAP_RC_KEY)
-					C_UTILS_REF_DEC(bucket->key);
-				else if(map->conf.callbacks.destructors.key)
-					map->conf.callbacks.destructors.key(bucket->key);
+	if(!map)
+		return NULL;
 
-				// If we have a reference to the value, release it. Otherwise, invoke destructor.
-				if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
-					C_UTILS_REF_DEC(bucket->value);
-				else
-					map->conf.callbacks.destructors.value(bucket->value);
+	if(!key || !value || !merge) {
+		C_UTILS_LOG_ERROR(map->conf.logger, "Key, value and callback cannot be NULL!");
+		return NULL;
+	}
+
+	uint32_t hash = get_hash(map, key);
+	struct c_utils_map_shard *shard = get_shard(map, hash);
 
-				bucket->in_use = false;
-				map->size--;
+	C_UTILS_SCOPED_WRLOCK(shard->lock) {
+		bool found;
+		size_t index;
+		struct c_utils_map_table *table;
+
+		if(!find_or_reserve(map, shard, key, hash, &table, &index, &found))
+			return NULL;
+
+		void *result = value;
+		if(!found) {
+			if(!insert_slot(map, shard, table, index, key, value, hash))
+				return NULL;
+
+			if(added)
+				*added = true;
+		} else {
+			struct c_utils_map_slot *slot = table->slots + index;
+
+			// The callback may release the old value, so it must leave the index while it is still valid.
+			if(shard->reverse)
+				reverse_remove(shard, slot->key, slot->value, get_value_hash(map, slot->value));
+
+			result = merge(slot->value, value);
+			if(!result) {
+				if(map->conf.flags & C_UTILS_MAP_RC_KEY)
+					C_UTILS_REF_DEC(slot->key);
+
+				remove_slot(map, shard, table, index);
+				return NULL;
 			}
+
+			slot->value = result;
+
+			if(shard->reverse && !reverse_add(map, shard, slot->key, result))
+				C_UTILS_LOG_ERROR(map->conf.logger, "Was unable to index the merged value, it will not be found by contains!");
 		}
+
+		if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
+			C_UTILS_REF_INC(result);
+
+		return result;
 	}
+
+	C_UTILS_UNACCESSIBLE;
 }
 
-const void *c_utils_map_contains(struct c_utils_map *map, const void *value) {
-	if(!map || !map->size)
+bool c_utils_map_increment(struct c_utils_map *map, const void *key, int64_t delta, int64_t *result) {
+	if(!map)
 		return false;
 
-	if(!value) {
-		C_UTILS_LOG_ERROR(map->conf.logger, "This map does not support NULL values!");
+	if(!key) {
+		C_UTILS_LOG_ERROR(map->conf.logger, "This map does not support NULL keys!");
 		return false;
 	}
 
-	C_UTILS_SCOPED_RDLOCK(map->lock) {
-		void *key = value_to_key(map, value);
-		if(!key)
-			return NULL;
+	uint32_t hash = get_hash(map, key);
+	struct c_utils_map_shard *shard = get_shard(map, hash);
+	int64_t sum;
 
-		// As the caller is receiving a copy, they now also gain a reference to it.
-		if(map->conf.flags & C_UTILS_MAP_RC_KEY)
-			C_UTILS_REF_INC(key);
+	// The counter is found without taking any lock, and is updated in place.
+	if(map->conf.flags & C_UTILS_MAP_OPTIMISTIC_READ) {
+		int64_t *counter = get_value_optimistic(map, shard, key, hash);
+		if(!counter)
+			return false;
 
-		return key;
+		sum = __atomic_add_fetch(counter, delta, __ATOMIC_RELAXED);
+		if(result)
+			*result = sum;
+
+		return true;
+	}
+
+	// Holding the reader lock keeps the counter from being deleted underneath us, while other increments proceed concurrently.
+	C_UTILS_SCOPED_RDLOCK(shard->lock) {
+		size_t index;
+		struct c_utils_map_table *table = lookup(map, shard, key, hash, &index, NULL);
+		if(!table)
+			return false;
+
+		sum = __atomic_add_fetch((int64_t *) table->slots[index].value, delta, __ATOMIC_RELAXED);
+		if(result)
+			*result = sum;
+
+		return true;
 	}
 
 	C_UTILS_UNACCESSIBLE;
 }
 
-/// Uses said callback on all elements inside of the map based on the general callback supplied.
-bool c_utils_map_for_each(struct c_utils_map *map, void (*callback)(const void *key, const void *value)) {
-	if(!map || !map->size)
+void *c_utils_map_get(struct c_utils_map *map, const void *key) {
+	if(!map)
 		return false;
 
-	if(!callback) {
-		C_UTILS_LOG_ERROR(map->conf.logger, "Callback cannot be NULL!");
+	if(!key) {
+		C_UTILS_LOG_ERROR(map->conf.logger, "This map does not support NULL keys!");
 		return false;
 	}
 
-	C_UTILS_SCOPED_RDLOCK(map->lock) {
-		for(size_t i = 0; i < map->num_buckets; i++) {
-			struct c_utils_bucket *bucket = map->buckets + i;
-			if(bucket->in_use)
-				callback(bucket->key, bucket->value);
-		}
+	uint32_t hash = get_hash(map, key);
+	struct c_utils_map_shard *shard = get_shard(map, hash);
+
+	if(map->conf.flags & C_UTILS_MAP_OPTIMISTIC_READ)
+		return get_value_optimistic(map, shard, key, hash);
+
+	C_UTILS_SCOPED_RDLOCK(shard->lock)
+		return get_value(map, shard, key, hash);
 
-		return true;
-	}
-	
 	C_UTILS_UNACCESSIBLE;
 }
 
-/// Determines the size at the time this function is called.
-size_t c_utils_map_size(struct c_utils_map *map) {
+size_t c_utils_map_get_batch(struct c_utils_map *map, const void **keys, void **values, size_t n) {
 	if(!map)
 		return 0;
 
-	C_UTILS_SCOPED_RDLOCK(map->lock)
-		return map->size;
+	if(!keys || !values) {
+		C_UTILS_LOG_ERROR(map->conf.logger, "Keys and values cannot be NULL!");
+		return 0;
+	}
 
-	C_UTILS_UNACCESSIBLE;
-}
+	size_t found = 0;
+	struct c_utils_map_batch batch;
 
-struct c_utils_iterator *c_utils_map_iterator(struct c_utils_map *map) {
-	if(!map)
-		return NULL;
+	for(size_t offset = 0; offset < n; offset += C_UTILS_MAP_BATCH_SIZE) {
+		size_t count = n - offset < C_UTILS_MAP_BATCH_SIZE ? n - offset : C_UTILS_MAP_BATCH_SIZE;
+		prepare_batch(map, keys + offset, count, &batch);
 
-	struct c_utils_iterator *it;
-	struct _c_utils_map_iterator_position *pos;
-	C_UTILS_ON_BAD_CALLOC(it, map->conf.logger, sizeof(*it))
-		goto err;
+		// Each run of keys which belong to the same shard is looked up under a single acquisition of it's lock.
+		for(size_t start = 0, end; start < count; start = end) {
+			struct c_utils_map_shard *shard = map->shards + batch.shards[batch.order[start]];
+			for(end = start + 1; end < count && batch.shards[batch.order[end]] == batch.shards[batch.order[start]]; end++)
+				;
 
-	C_UTILS_SCOPED_RDLOCK(map->lock) {
-		size_t occupied_buckets = map->size;
+			C_UTILS_SCOPED_RDLOCK(shard->lock) {
+				prefetch_batch(shard, &batch, start, end);
 
-		C_UTILS_ON_BAD_CALLOC(pos, map->conf.logger, sizeof(*pos) + sizeof(struct _c_utils_map_data) * occupied_buckets)
-			goto err_pos;
+				for(size_t i = start; i < end; i++) {
+					size_t j = batch.order[i];
+					values[offset + j] = keys[offset + j] ? get_value(map, shard, keys[offset + j], batch.hashes[j]) : NULL;
+					found += values[offset + j] != NULL;
+				}
+			}
+		}
+	}
 
-		pos->size = occupied_buckets;
+	return found;
+}
 
-		/*
-			Copy each key-value pair into the iterator position's data, incrementing the reference
-			count of the key-value pair if needed.
-		*/
-		for(size_t i = 0, j = 0; occupied_buckets &&  i < map->num_buckets; i++) {
-			if(!map->buckets[i].in_use)
+void *c_utils_map_remove(struct c_utils_map *map, const void *key) {
+	if(!map)
+		return false;
+
+	if(!key) {
+		C_UTILS_LOG_ERROR(map->conf.logger, "This map does not support NULL keys!");
+		return false;
+	}
+
+	uint32_t hash = get_hash(map, key);
+	struct c_utils_map_shard *shard = get_shard(map, hash);
+
+	C_UTILS_SCOPED_WRLOCK(shard->lock) {
+		migrate(map, shard, C_UTILS_MAP_MIGRATE_BUDGET);
+
+		size_t index;
+		struct c_utils_map_table *table = lookup(map, shard, key, hash, &index, NULL);
+		if(!table)
+			return NULL;
+
+		// Note that the caller steals our reference to the value.
+		void *value = table->slots[index].value;
+
+		if(shard->reverse)
+			reverse_remove(shard, table->slots[index].key, value, get_value_hash(map, value));
+
+		// If we have a reference to the bucket's key, release it.
+		if(map->conf.flags & C_UTILS_MAP_RC_KEY)
+			C_UTILS_REF_DEC(table->slots[index].key);
+
+		remove_slot(map, shard, table, index);
+
+		return value;
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+void c_utils_map_remove_all(struct c_utils_map *map) {
+	if(!map)
+		return;
+
+	for(size_t i = 0; i < map->num_shards; i++)
+		C_UTILS_SCOPED_WRLOCK(map->shards[i].lock)
+			clear_shard(map, map->shards + i, false);
+}
+
+bool c_utils_map_delete(struct c_utils_map *map, const void *key) {
+	if(!map)
+		return false;
+
+	if(!key) {
+		C_UTILS_LOG_ERROR(map->conf.logger, "This map does not support NULL keys!");
+		return false;
+	}
+
+	uint32_t hash = get_hash(map, key);
+	struct c_utils_map_shard *shard = get_shard(map, hash);
+
+	C_UTILS_SCOPED_WRLOCK(shard->lock) {
+		migrate(map, shard, C_UTILS_MAP_MIGRATE_BUDGET);
+
+		size_t index;
+		struct c_utils_map_table *table = lookup(map, shard, key, hash, &index, NULL);
+		if(!table)
+			return false;
+
+		// The pair must leave the index before it is released, as hashing the value requires it to still be valid.
+		if(shard->reverse)
+			reverse_remove(shard, table->slots[index].key, table->slots[index].value, get_value_hash(map, table->slots[index].value));
+
+		// If we have a reference to the key, release it.
+		if(map->conf.flags & C_UTILS_MAP_RC_KEY)
+			C_UTILS_REF_DEC(table->slots[index].key);
+
+		release_value(map, table->slots[index].value);
+		remove_slot(map, shard, table, index);
+
+		return true;
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+void c_utils_map_delete_all(struct c_utils_map *map) {
+	if(!map)
+		return;
+
+	for(size_t i = 0; i < map->num_shards; i++)
+		C_UTILS_SCOPED_WRLOCK(map->shards[i].lock)
+			clear_shard(map, map->shards + i, true);
+}
+
+const void *c_utils_map_contains(struct c_utils_map *map, const void *value) {
+	if(!map)
+		return false;
+
+	if(!value) {
+		C_UTILS_LOG_ERROR(map->conf.logger, "This map does not support NULL values!");
+		return false;
+	}
+
+	// With the reverse index, the value is only hashed once, rather than once per shard.
+	uint32_t hash = map->conf.flags & C_UTILS_MAP_REVERSE_INDEX ? get_value_hash(map, value) : 0;
+
+	for(size_t i = 0; i < map->num_shards; i++) {
+		C_UTILS_SCOPED_RDLOCK(map->shards[i].lock) {
+			struct c_utils_map_shard *shard = map->shards + i;
+			void *key = shard->reverse ? reverse_find(map, shard, value, hash) : value_to_key(map, shard, value);
+			if(!key)
 				continue;
 
-			// We gain a reference to key
+			// As the caller is receiving a copy, they now also gain a reference to it.
 			if(map->conf.flags & C_UTILS_MAP_RC_KEY)
-				C_UTILS_REF_INC(map->buckets[i].key);
+				C_UTILS_REF_INC(key);
 
-			// We gain a reference to the value
-			if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
-				C_UTILS_REF_INC(map->buckets[i].value);
+			return key;
+		}
+	}
+
+	return NULL;
+}
+
+/// Uses said callback on all elements inside of the map based on the general callback supplied.
+bool c_utils_map_for_each(struct c_utils_map *map, void (*callback)(const void *key, const void *value)) {
+	if(!map)
+		return false;
+
+	if(!callback) {
+		C_UTILS_LOG_ERROR(map->conf.logger, "Callback cannot be NULL!");
+		return false;
+	}
+
+	// Each shard is visited under it's own reader lock, so writers are only held back from one shard at a time.
+	for(size_t i = 0; i < map->num_shards; i++) {
+		C_UTILS_SCOPED_RDLOCK(map->shards[i].lock) {
+			// During a resize, the pairs are split between the old and new table.
+			struct c_utils_map_table *tables[] = { map->shards[i].table, map->shards[i].old };
+			for(int t = 0; t < 2 && tables[t]; t++) {
+				for(size_t j = 0; j < tables[t]->capacity; j++) {
+					if(is_full(tables[t]->ctrl[j]))
+						callback(tables[t]->slots[j].key, tables[t]->slots[j].value);
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+/// Determines the size at the time this function is called. With shards, it is the sum of each shard's size as they are visited.
+size_t c_utils_map_size(struct c_utils_map *map) {
+	if(!map)
+		return 0;
+
+	size_t size = 0;
+	for(size_t i = 0; i < map->num_shards; i++)
+		C_UTILS_SCOPED_RDLOCK(map->shards[i].lock)
+			size += map->shards[i].size;
+
+	return size;
+}
+
+bool c_utils_map_stats(struct c_utils_map *map, struct c_utils_map_stats *stats) {
+	if(!map || !stats)
+		return false;
+
+	memset(stats, 0, sizeof(*stats));
+
+	size_t probes = 0, slots = 0, moved = 0;
+	for(size_t i = 0; i < map->num_shards; i++) {
+		struct c_utils_map_shard *shard = map->shards + i;
+
+		C_UTILS_SCOPED_RDLOCK(shard->lock) {
+			stats->size += shard->size;
+			stats->capacity += shard->table->capacity;
+			slots += shard->table->capacity;
+			add_table_probes(shard->table, stats, &probes);
+
+			if(shard->old) {
+				slots += shard->old->capacity;
+				add_table_probes(shard->old, stats, &probes);
+
+				for(size_t j = 0; j < shard->old->capacity; j++)
+					moved += shard->old->ctrl[j] == C_UTILS_MAP_CTRL_MOVED;
+			}
+		}
+	}
+
+	stats->load_factor = (double) stats->size / stats->capacity;
+	stats->tombstone_ratio = (double) moved / slots;
+	stats->probe.average = stats->size ? (double) probes / stats->size : 0;
+
+	if(!map->counters)
+		return true;
+
+	probes = 0;
+	for(size_t i = 0; i < C_UTILS_MAP_STATS_STRIPES; i++) {
+		struct c_utils_map_counters *counters = map->counters + i;
+
+		stats->counters.lookups += __atomic_load_n(&counters->lookups, __ATOMIC_RELAXED);
+		stats->counters.misses += __atomic_load_n(&counters->misses, __ATOMIC_RELAXED);
+		stats->counters.resizes += __atomic_load_n(&counters->resizes, __ATOMIC_RELAXED);
+		stats->counters.resize_ns += __atomic_load_n(&counters->resize_ns, __ATOMIC_RELAXED);
+		probes += __atomic_load_n(&counters->probes, __ATOMIC_RELAXED);
+
+		size_t max = __atomic_load_n(&counters->max_probe, __ATOMIC_RELAXED);
+		if(max > stats->counters.max_probe)
+			stats->counters.max_probe = max;
+
+		for(size_t j = 0; j < C_UTILS_MAP_STATS_HISTOGRAM; j++)
+			stats->counters.histogram[j] += __atomic_load_n(counters->histogram + j, __ATOMIC_RELAXED);
+	}
+
+	stats->counters.average_probe = stats->counters.lookups ? (double) probes / stats->counters.lookups : 0;
+
+	return true;
+}
+
+struct c_utils_iterator *c_utils_map_iterator(struct c_utils_map *map) {
+	if(!map)
+		return NULL;
+
+	struct c_utils_iterator *it;
+	struct _c_utils_map_iterator_position *pos;
+	C_UTILS_ON_BAD_CALLOC(it, map->conf.logger, sizeof(*it))
+		goto err;
+
+	C_UTILS_ON_BAD_CALLOC(pos, map->conf.logger, sizeof(*pos))
+		goto err_pos;
 
-			pos->data[j].key = map->buckets[i].key;
-			pos->data[j].value = map->buckets[i].value;
+	// The cursor starts before the first slot, so that the first call to next yields the first pair.
+	pos->index = C_UTILS_MAP_NPOS;
 
-			j++;
-			occupied_buckets--;
+	/*
+		In snapshot mode, copy each key-value pair into the iterator position's data, incrementing the reference
+		count of the key-value pair if needed. Each shard is copied under it's own reader lock, growing the
+		position's data as we go. Otherwise, the cursor walks the shards in place.
+	*/
+	if(map->conf.flags & C_UTILS_MAP_SNAPSHOT_ITERATOR) {
+		for(size_t i = 0; i < map->num_shards; i++) {
+			C_UTILS_SCOPED_RDLOCK(map->shards[i].lock) {
+				struct c_utils_map_shard *shard = map->shards + i;
+				size_t occupied_buckets = shard->size;
+				if(!occupied_buckets)
+					continue;
+
+				C_UTILS_ON_BAD_REALLOC(&pos->data, map->conf.logger, sizeof(*pos->data) * (pos->size + occupied_buckets))
+					goto err_data;
+
+				struct c_utils_map_table *tables[] = { shard->table, shard->old };
+				for(int t = 0; t < 2 && tables[t]; t++) {
+					struct c_utils_map_table *table = tables[t];
+					for(size_t j = 0; occupied_buckets && j < table->capacity; j++) {
+						if(!is_full(table->ctrl[j]))
+							continue;
+
+						// We gain a reference to key
+						if(map->conf.flags & C_UTILS_MAP_RC_KEY)
+							C_UTILS_REF_INC(table->slots[j].key);
+
+						// We gain a reference to the value
+						if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
+							C_UTILS_REF_INC(table->slots[j].value);
+
+						pos->data[pos->size].key = table->slots[j].key;
+						pos->data[pos->size].value = table->slots[j].value;
+
+						pos->size++;
+						occupied_buckets--;
+					}
+				}
+			}
 		}
 	}
 
@@ -463,6 +1108,17 @@ struct c_utils_iterator *c_utils_map_iterator(struct c_utils_map *map) {
 
 	return it;
 
+	err_data:
+		// Release the references we have gained so far.
+		for(size_t i = 0; i < pos->size; i++) {
+			if(map->conf.flags & C_UTILS_MAP_RC_KEY)
+				C_UTILS_REF_DEC(pos->data[i].key);
+
+			if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
+				C_UTILS_REF_DEC(pos->data[i].value);
+		}
+		free(pos->data);
+		free(pos);
 	err_pos:
 		free(it);
 	err:
@@ -485,56 +1141,215 @@ void c_utils_map_destroy(struct c_utils_map *map) {
 
 
 
-static struct c_utils_bucket *get_existing_bucket(const struct c_utils_map *map, const void *key) {
-	if(!map->size)
+/*
+	The table is allocated in one contiguous block, with the slots directly after the table
+	itself, followed by the control bytes.
+*/
+static struct c_utils_map_table *create_table(size_t capacity, struct c_utils_logger *logger) {
+	size_t ctrl_size = capacity + C_UTILS_MAP_GROUP_WIDTH - 1;
+
+	struct c_utils_map_table *table;
+	C_UTILS_ON_BAD_CALLOC(table, logger, sizeof(*table) + sizeof(*table->slots) * capacity + ctrl_size)
 		return NULL;
 
-	// Hash key, falling back on default if no hash function given.
-	uint32_t hash;
-	if(map->conf.callbacks.hash_function)
-		hash = map->conf.callbacks.hash_function(key);
-	else
-		hash = hash_key(key, get_key_size(map, key));
+	table->capacity = capacity;
+	table->mask = capacity - 1;
+	table->slots = (struct c_utils_map_slot *) (table + 1);
+	table->ctrl = (int8_t *) (table->slots + capacity);
+
+	return table;
+}
+
+/*
+	Returns a bitmask where the N'th bit is set if the N'th control byte of the group matches
+	the tag. With SSE2, the entire group is compared in one instruction.
+*/
+static inline uint32_t group_match(const int8_t *group, int8_t tag) {
+#ifdef __SSE2__
+	__m128i ctrl = _mm_loadu_si128((const __m128i *) group);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl));
+#else
+	uint32_t mask = 0;
+	for(int i = 0; i < C_UTILS_MAP_GROUP_WIDTH; i++)
+		mask |= (uint32_t) (group[i] == tag) << i;
+
+	return mask;
+#endif
+}
+
+static inline uint32_t group_match_empty(const int8_t *group) {
+	return group_match(group, C_UTILS_MAP_CTRL_EMPTY);
+}
+
+/// A slot is full if it holds a tag, which are the only control bytes with the sign bit set.
+static inline bool is_full(int8_t ctrl) {
+	return ctrl < 0;
+}
+
+/// Sets the control byte, as well as it's clone if it is within the first group.
+static inline void set_ctrl(struct c_utils_map_table *table, size_t index, int8_t ctrl) {
+	table->ctrl[index] = ctrl;
+
+	if(index < C_UTILS_MAP_GROUP_WIDTH - 1)
+		table->ctrl[table->capacity + index] = ctrl;
+}
+
+static inline void move_slot(struct c_utils_map_table *table, size_t from, size_t to) {
+	table->slots[to] = table->slots[from];
+	set_ctrl(table, to, table->ctrl[from]);
+}
+
+/*
+	Backward-shift deletion. Every entry following the hole, up until the next empty slot, is
+	moved into the hole if the hole lies between it's home slot and where it currently resides.
+	This restores the invariant that no empty slot exists between an entry and it's home slot.
+	Returns whether any entry was moved, and if wrapped is not NULL, stores whether any of them
+	was moved from a slot which wraps around past the end of the table.
+*/
+static bool erase_slot(struct c_utils_map_table *table, size_t index, bool *wrapped) {
+	size_t hole = index;
+	bool moved = false;
+
+	if(wrapped)
+		*wrapped = false;
 
-	size_t index = hash % map->num_buckets;
+	for(size_t i = (index + 1) & table->mask; table->ctrl[i] != C_UTILS_MAP_CTRL_EMPTY; i = (i + 1) & table->mask) {
+		size_t home = table->slots[i].hash & table->mask;
 
-	size_t iterations = 0;
-	struct c_utils_bucket *bucket;
-	while(iterations++ < map->num_buckets && (bucket = map->buckets + (index++ % map->num_buckets))->in_use && bucket->hash == hash) {
-		if(key_cmp(map, key, bucket->key) == 0)
-			return bucket;
+		// Distance from it's home slot must be at least the distance from the hole.
+		if(((i - home) & table->mask) >= ((i - hole) & table->mask)) {
+			move_slot(table, i, hole);
+			hole = i;
+			moved = true;
+
+			if(wrapped && i < index)
+				*wrapped = true;
+		}
 	}
 
-	return NULL;
+	set_ctrl(table, hole, C_UTILS_MAP_CTRL_EMPTY);
+
+	return moved;
 }
 
+/// The capacity must be a power of two, and no smaller than a single group.
+static size_t round_capacity(size_t size) {
+	size_t capacity = C_UTILS_MAP_GROUP_WIDTH;
+	while(capacity < size)
+		capacity <<= 1;
 
-static struct c_utils_bucket *get_empty_bucket(const struct c_utils_map *map, const void *key) {
-	if(map->size == map->num_buckets)
-		return NULL;
+	return capacity;
+}
 
-	// Hash key, falling back on default if no hash function given.
-	uint32_t hash;
-	if(map->conf.callbacks.hash_function)
-		hash = map->conf.callbacks.hash_function(key);
-	else
-		hash = hash_key(key, get_key_size(map, key));
 
-	size_t index = hash % map->num_buckets;
 
-	size_t iterations = 0;
-	struct c_utils_bucket *bucket;
-	while(iterations++ < map->num_buckets && (bucket = map->buckets + (index++ % map->num_buckets))->in_use) {
-		// If the key is found, then that means it already exists.
-		if(key_cmp(map, key, bucket->key) == 0)
-			return NULL;
+/*
+	The shard is selected with a multiplicative (Fibonacci) hash, so that the upper bits we select it
+	with depend on every bit of the hash, rather than those that also select the slot.
+*/
+static inline struct c_utils_map_shard *get_shard(const struct c_utils_map *map, uint32_t hash) {
+	return map->shards + ((uint64_t) (uint32_t) (hash * 0x9E3779B9u) >> (32 - map->shard_bits));
+}
+
+/// If groups is not NULL, the amount of groups probed is added to it.
+static size_t find_slot(const struct c_utils_map *map, const struct c_utils_map_table *table, const void *key, uint32_t hash, size_t *groups) {
+	int8_t tag = C_UTILS_MAP_TAG(hash);
+	size_t pos = hash & table->mask;
+	size_t probed;
+
+	// The key most likely resides in it's home slot, so fetch it while we scan the control bytes.
+	__builtin_prefetch(table->slots + pos);
+
+	for(probed = 0; probed < table->capacity; probed += C_UTILS_MAP_GROUP_WIDTH) {
+		const int8_t *group = table->ctrl + pos;
+
+		for(uint32_t match = group_match(group, tag); match; match &= match - 1) {
+			size_t index = (pos + __builtin_ctz(match)) & table->mask;
+			if(table->slots[index].hash == hash && key_cmp(map, key, table->slots[index].key) == 0) {
+				if(groups)
+					*groups += probed / C_UTILS_MAP_GROUP_WIDTH + 1;
+
+				return index;
+			}
+		}
+
+		// As there are no tombstones, an empty slot means the key can not be any further.
+		if(group_match_empty(group))
+			break;
+
+		pos = (pos + C_UTILS_MAP_GROUP_WIDTH) & table->mask;
+	}
+
+	if(groups)
+		*groups += probed / C_UTILS_MAP_GROUP_WIDTH + 1;
+
+	return C_UTILS_MAP_NPOS;
+}
+
+/*
+	Probes for the key, and if it is not found, returns the first empty slot along the probe, which
+	is where the key belongs. Hence we only probe once to both check for duplicates and insert.
+*/
+static size_t find_or_prepare_insert(const struct c_utils_map *map, const struct c_utils_map_table *table, const void *key, uint32_t hash, bool *found) {
+	int8_t tag = C_UTILS_MAP_TAG(hash);
+	size_t pos = hash & table->mask;
+
+	for(size_t probed = 0; probed < table->capacity; probed += C_UTILS_MAP_GROUP_WIDTH) {
+		const int8_t *group = table->ctrl + pos;
+
+		for(uint32_t match = group_match(group, tag); match; match &= match - 1) {
+			size_t index = (pos + __builtin_ctz(match)) & table->mask;
+			if(table->slots[index].hash == hash && key_cmp(map, key, table->slots[index].key) == 0) {
+				*found = true;
+				return index;
+			}
+		}
+
+		uint32_t empty = group_match_empty(group);
+		if(empty) {
+			*found = false;
+			return (pos + __builtin_ctz(empty)) & table->mask;
+		}
+
+		pos = (pos + C_UTILS_MAP_GROUP_WIDTH) & table->mask;
 	}
 
-	bucket->hash = hash;
-	return bucket;
+	// Unreachable so long as we keep at least one slot empty.
+	*found = true;
+	return C_UTILS_MAP_NPOS;
 }
 
+/// Finds the first empty slot along the probe for a key which is known to not be present.
+static size_t find_empty(const struct c_utils_map_table *table, uint32_t hash) {
+	size_t pos = hash & table->mask;
+	uint32_t empty;
 
+	while(!(empty = group_match_empty(table->ctrl + pos)))
+		pos = (pos + C_UTILS_MAP_GROUP_WIDTH) & table->mask;
+
+	return (pos + __builtin_ctz(empty)) & table->mask;
+}
+
+/// Finds the key in either the shard's table, or the old table during a resize. Returns the table it resides in.
+static struct c_utils_map_table *lookup(const struct c_utils_map *map, const struct c_utils_map_shard *shard, const void *key, uint32_t hash, size_t *index, size_t *groups) {
+	if((*index = find_slot(map, shard->table, key, hash, groups)) != C_UTILS_MAP_NPOS)
+		return shard->table;
+
+	if(shard->old && (*index = find_slot(map, shard->old, key, hash, groups)) != C_UTILS_MAP_NPOS)
+		return shard->old;
+
+	return NULL;
+}
+
+
+
+static uint32_t get_hash(const struct c_utils_map *map, const void *key) {
+	// Hash key, falling back on default if no hash function given.
+	if(map->conf.callbacks.hash_function)
+		return map->conf.callbacks.hash_function(key);
+	else
+		return hash_key(key, get_key_size(map, key));
+}
 
 static size_t get_key_size(const struct c_utils_map *map, const void *key) {
 	return map->conf.length.key ? map->conf.length.key : strlen(key);
@@ -558,71 +1373,578 @@ static uint32_t hash_key(const void *key, size_t len) {
 	return hash;
 }
 
-static void *value_to_key(struct c_utils_map *map, const void *value) {
-	C_UTILS_SCOPED_RDLOCK(map->lock) {
-		size_t search = map->size;
-		for(size_t i = 0; search && i < map->num_buckets; i++) {
-			struct c_utils_bucket *bucket = map->buckets + i;
-			if(bucket->in_use) {
-				if(value_cmp(map, value, bucket->value) == 0)
-					return bucket->key;
+/// Must be called while holding at least the shard's reader lock.
+static void *value_to_key(struct c_utils_map *map, struct c_utils_map_shard *shard, const void *value) {
+	struct c_utils_map_table *tables[] = { shard->table, shard->old };
+	size_t search = shard->size;
 
-				search--;
-			}
+	for(int t = 0; t < 2 && tables[t]; t++) {
+		struct c_utils_map_table *table = tables[t];
+		for(size_t i = 0; search && i < table->capacity; i++) {
+			if(!is_full(table->ctrl[i]))
+				continue;
+
+			if(value_cmp(map, value, table->slots[i].value) == 0)
+				return table->slots[i].key;
+
+			search--;
 		}
+	}
+
+	return NULL;
+}
+
+
+
+/// Adds the pair to the shard, growing it if need be. Must be called while holding the shard's writer lock.
+static bool add_pair(struct c_utils_map *map, struct c_utils_map_shard *shard, void *key, void *value, uint32_t hash) {
+	bool found;
+	size_t index;
+	struct c_utils_map_table *table;
+
+	if(!find_or_reserve(map, shard, key, hash, &table, &index, &found) || found)
+		return false;
+
+	return insert_slot(map, shard, table, index, key, value, hash);
+}
+
+/*
+	Probes for the key once, growing the shard beforehand if adding a pair would trigger it. If found,
+	the table and index of it's slot are returned, otherwise those of the empty slot it belongs in, which
+	insert_slot fills. Returns false only if the shard is full. Must be called while holding the shard's
+	writer lock.
+*/
+static bool find_or_reserve(struct c_utils_map *map, struct c_utils_map_shard *shard, const void *key, uint32_t hash, struct c_utils_map_table **table, size_t *index, bool *found) {
+	migrate(map, shard, C_UTILS_MAP_MIGRATE_BUDGET);
+
+	// Would adding this pair trigger a growth? If so, grow before we probe for a slot.
+	if(((shard->size + 1) / (double)shard->table->capacity) >= map->conf.growth.trigger)
+		resize_shard(map, shard, shard->table->capacity * map->conf.growth.ratio);
+
+	// There must always be at least one empty slot to terminate a probe.
+	if(shard->size + 1 >= shard->table->capacity) {
+		C_UTILS_LOG_ERROR(map->conf.logger, "The map is full and unable to grow any further!");
+		return false;
+	}
+
+	// The key may still reside in the old table if it has not been migrated yet.
+	if(shard->old && (*index = find_slot(map, shard->old, key, hash, NULL)) != C_UTILS_MAP_NPOS) {
+		*table = shard->old;
+		*found = true;
+		return true;
+	}
+
+	*table = shard->table;
+	*index = find_or_prepare_insert(map, *table, key, hash, found);
+
+	return true;
+}
+
+/// Fills the empty slot reserved by find_or_reserve. Must be called while holding the shard's writer lock.
+static bool insert_slot(struct c_utils_map *map, struct c_utils_map_shard *shard, struct c_utils_map_table *table, size_t index, void *key, void *value, uint32_t hash) {
+	if(shard->reverse && !reverse_add(map, shard, key, value))
+		return false;
+
+	table->slots[index] = (struct c_utils_map_slot) { .key = key, .value = value, .hash = hash };
+	set_ctrl(table, index, C_UTILS_MAP_TAG(hash));
+	shard->size++;
+
+	if(shard->filter && !c_utils_filter_add(shard->filter, hash))
+		drop_filter(map, shard);
+
+	return true;
+}
 
+/// Releases our reference to the value if it is reference counted, otherwise invokes the destructor.
+static void release_value(struct c_utils_map *map, void *value) {
+	if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
+		C_UTILS_REF_DEC(value);
+	else
+		map->conf.callbacks.destructors.value(value);
+}
+
+/// Must be called while holding at least the shard's reader lock.
+static void *get_value(struct c_utils_map *map, struct c_utils_map_shard *shard, const void *key, uint32_t hash) {
+	size_t index, groups = 0;
+	struct c_utils_map_table *table = NULL;
+
+	// A definite miss probes no groups at all.
+	if(!shard->filter || c_utils_filter_contains(shard->filter, hash))
+		table = lookup(map, shard, key, hash, &index, map->counters ? &groups : NULL);
+
+	if(map->counters)
+		count_lookup(map, groups, table != NULL);
+
+	if(!table)
 		return NULL;
+
+	void *value = table->slots[index].value;
+
+	// The caller is obtaining a copy of the value, hence they gain a reference to it.
+	if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
+		C_UTILS_REF_INC(value);
+
+	return value;
+}
+
+/*
+	Probes the shard without taking it's lock, retrying whenever a writer intervened. The tables are
+	published as hazard pointers before they are probed, so that a writer which finishes migrating
+	the old table can not free it underneath us. Everything else we read may be stale or torn, but
+	it is only used if the sequence shows that no writer ran in the meantime.
+*/
+static void *get_value_optimistic(struct c_utils_map *map, struct c_utils_map_shard *shard, const void *key, uint32_t hash) {
+	for(;;) {
+		size_t sequence = c_utils_scoped_lock_seqlock_read_begin(shard->lock);
+
+		struct c_utils_map_table *table = __atomic_load_n(&shard->table, __ATOMIC_ACQUIRE);
+		struct c_utils_map_table *old = __atomic_load_n(&shard->old, __ATOMIC_ACQUIRE);
+		c_utils_hazard_acquire(C_UTILS_MAP_HP_TABLE, table);
+		if(old)
+			c_utils_hazard_acquire(C_UTILS_MAP_HP_OLD, old);
+
+		// The hazard pointers must be visible before we check that the tables were not replaced.
+		__sync_synchronize();
+
+		void *value = NULL;
+		size_t groups = 0;
+		size_t *probed = map->counters ? &groups : NULL;
+		if(!c_utils_scoped_lock_seqlock_read_retry(shard->lock, sequence)) {
+			size_t index;
+			if((index = find_slot(map, table, key, hash, probed)) != C_UTILS_MAP_NPOS)
+				value = table->slots[index].value;
+			else if(old && (index = find_slot(map, old, key, hash, probed)) != C_UTILS_MAP_NPOS)
+				value = old->slots[index].value;
+		}
+
+		// Only the tables are released, as the caller may hold hazard pointers of it's own.
+		c_utils_hazard_release(table, false);
+		if(old)
+			c_utils_hazard_release(old, false);
+
+		// Only the attempt which succeeds is counted.
+		if(!c_utils_scoped_lock_seqlock_read_retry(shard->lock, sequence)) {
+			if(map->counters)
+				count_lookup(map, groups, value != NULL);
+
+			return value;
+		}
 	}
+}
 
-	C_UTILS_UNACCESSIBLE;
+/// Tables which optimistic readers may still be probing are retired to the hazard pointers rather than freed.
+static void free_table(struct c_utils_map *map, struct c_utils_map_table *table) {
+	if(map->conf.flags & C_UTILS_MAP_OPTIMISTIC_READ)
+		c_utils_hazard_retire(table, free);
+	else
+		free(table);
+}
+
+/*
+	Hashes each key of the batch, and orders them by shard. As the batch is small, an insertion sort
+	is sufficient, and keeps keys of the same shard in their original order.
+*/
+static void prepare_batch(const struct c_utils_map *map, const void **keys, size_t n, struct c_utils_map_batch *batch) {
+	for(size_t i = 0; i < n; i++) {
+		batch->hashes[i] = keys[i] ? get_hash(map, keys[i]) : 0;
+		batch->shards[i] = get_shard(map, batch->hashes[i]) - map->shards;
+		batch->order[i] = i;
+	}
+
+	if(map->num_shards == 1)
+		return;
+
+	for(size_t i = 1; i < n; i++) {
+		uint8_t j = batch->order[i];
+		size_t k = i;
+
+		for(; k > 0 && batch->shards[batch->order[k - 1]] > batch->shards[j]; k--)
+			batch->order[k] = batch->order[k - 1];
+
+		batch->order[k] = j;
+	}
+}
+
+/*
+	Prefetches the control bytes and home slot of each key in the run, so that the cache misses for
+	every key are in flight at once, rather than being taken one at a time as each key is probed.
+	Must be called while holding the shard's lock.
+*/
+static void prefetch_batch(const struct c_utils_map_shard *shard, const struct c_utils_map_batch *batch, size_t start, size_t end) {
+	const struct c_utils_map_table *table = shard->table;
+
+	for(size_t i = start; i < end; i++) {
+		size_t pos = batch->hashes[batch->order[i]] & table->mask;
+		__builtin_prefetch(table->ctrl + pos);
+		__builtin_prefetch(table->slots + pos);
+	}
+}
+
+/// Returns the calling thread's stripe of the counters.
+static struct c_utils_map_counters *get_counters(const struct c_utils_map *map) {
+	static size_t next_stripe = 0;
+	static _Thread_local size_t stripe = SIZE_MAX;
+
+	if(stripe == SIZE_MAX)
+		stripe = __atomic_fetch_add(&next_stripe, 1, __ATOMIC_RELAXED) % C_UTILS_MAP_STATS_STRIPES;
+
+	return map->counters + stripe;
+}
+
+/*
+	Atomics are still needed as more than one thread may share a stripe, but as they seldom do, the
+	cache line is almost always already owned by the thread. The maximum is only written when it grows.
+*/
+static void count_lookup(const struct c_utils_map *map, size_t groups, bool found) {
+	struct c_utils_map_counters *counters = get_counters(map);
+	size_t bucket = groups < C_UTILS_MAP_STATS_HISTOGRAM ? groups - 1 : C_UTILS_MAP_STATS_HISTOGRAM - 1;
+
+	__atomic_fetch_add(&counters->lookups, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&counters->probes, groups, __ATOMIC_RELAXED);
+	__atomic_fetch_add(counters->histogram + bucket, 1, __ATOMIC_RELAXED);
+
+	if(!found)
+		__atomic_fetch_add(&counters->misses, 1, __ATOMIC_RELAXED);
+
+	size_t max = __atomic_load_n(&counters->max_probe, __ATOMIC_RELAXED);
+	while(groups > max && !__atomic_compare_exchange_n(&counters->max_probe, &max, groups, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+}
+
+static void count_resize_time(const struct c_utils_map *map, uint64_t start) {
+	__atomic_fetch_add(&get_counters(map)->resize_ns, get_time_ns() - start, __ATOMIC_RELAXED);
+}
+
+static uint64_t get_time_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*
+	Adds the probe length of every pair in the table to the histogram, and it's total to probes. A pair which is
+	displaced from it's home slot by d slots is found in the (d / group width + 1)th group probed.
+*/
+static void add_table_probes(const struct c_utils_map_table *table, struct c_utils_map_stats *stats, size_t *probes) {
+	for(size_t i = 0; i < table->capacity; i++) {
+		if(!is_full(table->ctrl[i]))
+			continue;
+
+		size_t groups = ((i - (table->slots[i].hash & table->mask)) & table->mask) / C_UTILS_MAP_GROUP_WIDTH + 1;
+		stats->probe.histogram[groups < C_UTILS_MAP_STATS_HISTOGRAM ? groups - 1 : C_UTILS_MAP_STATS_HISTOGRAM - 1]++;
+		*probes += groups;
+
+		if(groups > stats->probe.max)
+			stats->probe.max = groups;
+	}
+}
+
+/*
+	Values are hashed in the same way they are compared: by a custom hash function, by their bytes up to their
+	length, or by their address.
+*/
+static uint32_t get_value_hash(const struct c_utils_map *map, const void *value) {
+	if(map->conf.callbacks.value_hash_function)
+		return map->conf.callbacks.value_hash_function(value);
+	else if(map->conf.length.value)
+		return hash_key(value, map->conf.length.value);
+	else
+		return hash_key(&value, sizeof(value));
 }
 
+/*
+	Adds the pair to the reverse index, growing it if needed. As lookups on the index are the rare case,
+	the index is simply rehashed all at once when it grows. Must be called while holding the shard's writer lock.
+*/
+static bool reverse_add(struct c_utils_map *map, struct c_utils_map_shard *shard, void *key, void *value) {
+	struct c_utils_map_table *table = shard->reverse;
+
+	if(((shard->size + 1) / (double)table->capacity) >= map->conf.reverse.trigger) {
+		struct c_utils_map_table *new_table = create_table(table->capacity * 2, map->conf.logger);
+		if(!new_table)
+			return false;
+
+		for(size_t i = 0; i < table->capacity; i++) {
+			if(!is_full(table->ctrl[i]))
+				continue;
+
+			size_t index = find_empty(new_table, table->slots[i].hash);
+			new_table->slots[index] = table->slots[i];
+			set_ctrl(new_table, index, table->ctrl[i]);
+		}
+
+		free(table);
+		shard->reverse = table = new_table;
+	}
 
+	uint32_t hash = get_value_hash(map, value);
+	size_t index = find_empty(table, hash);
+	table->slots[index] = (struct c_utils_map_slot) { .key = value, .value = key, .hash = hash };
+	set_ctrl(table, index, C_UTILS_MAP_TAG(hash));
 
-static bool resize_map(struct c_utils_map *map, size_t size) {
-	C_UTILS_SCOPED_WRLOCK(map->lock){
-		if(map->num_buckets == map->conf.size.initial)
-			return true;
+	return true;
+}
 
-		if(size < map->conf.size.initial)
-			return true;
+/// Removes the exact pair from the reverse index. Must be called while holding the shard's writer lock.
+static void reverse_remove(struct c_utils_map_shard *shard, const void *key, const void *value, uint32_t hash) {
+	struct c_utils_map_table *table = shard->reverse;
+	int8_t tag = C_UTILS_MAP_TAG(hash);
+	size_t pos = hash & table->mask;
 
-		size_t used = map->size, index = 0;
-		void *keys[used];
-		void *values[used];
+	for(size_t probed = 0; probed < table->capacity; probed += C_UTILS_MAP_GROUP_WIDTH) {
+		const int8_t *group = table->ctrl + pos;
 
-		// Keep track of key-value pairs
-		for(size_t i = 0;i < map->num_buckets;) {
-			struct c_utils_bucket *bucket = map->buckets + i;
-			if(bucket->in_use) {
-				keys[index] = bucket->key;
-				values[index++] = bucket->value;
+		for(uint32_t match = group_match(group, tag); match; match &= match - 1) {
+			size_t index = (pos + __builtin_ctz(match)) & table->mask;
+			if(table->slots[index].key == value && table->slots[index].value == key) {
+				erase_slot(table, index, NULL);
+				return;
 			}
+		}
+
+		if(group_match_empty(group))
+			return;
+
+		pos = (pos + C_UTILS_MAP_GROUP_WIDTH) & table->mask;
+	}
+}
+
+/// Finds a key whose value is equal to the one given. Must be called while holding at least the shard's reader lock.
+static void *reverse_find(struct c_utils_map *map, struct c_utils_map_shard *shard, const void *value, uint32_t hash) {
+	struct c_utils_map_table *table = shard->reverse;
+	int8_t tag = C_UTILS_MAP_TAG(hash);
+	size_t pos = hash & table->mask;
 
-			bucket->in_use = false;
+	for(size_t probed = 0; probed < table->capacity; probed += C_UTILS_MAP_GROUP_WIDTH) {
+		const int8_t *group = table->ctrl + pos;
+
+		for(uint32_t match = group_match(group, tag); match; match &= match - 1) {
+			size_t index = (pos + __builtin_ctz(match)) & table->mask;
+			if(table->slots[index].hash == hash && value_cmp(map, value, table->slots[index].key) == 0)
+				return table->slots[index].value;
 		}
 
-		size_t new_size = size * sizeof(struct c_utils_bucket);
-		C_UTILS_ON_BAD_REALLOC(&map->buckets, map->conf.logger, new_size)
-			return false;
+		if(group_match_empty(group))
+			return NULL;
+
+		pos = (pos + C_UTILS_MAP_GROUP_WIDTH) & table->mask;
+	}
+
+	return NULL;
+}
+
+
+
+/*
+	Begins migrating the shard to a newly allocated table. Only the first few slots are migrated
+	here, and the rest are migrated as further writes are made to the shard; as we keep each key's
+	hash, we never need to invoke the hash function again. If a migration is already in progress,
+	it is finished first, so there are never more than two tables. Must be called while holding
+	the shard's writer lock.
+*/
+static bool resize_shard(struct c_utils_map *map, struct c_utils_map_shard *shard, size_t size) {
+	if(size > shard->max)
+		size = shard->max;
+
+	size_t capacity = round_capacity(size);
+
+	// The new table must be able to hold every pair with at least one empty slot to spare.
+	if(capacity == shard->table->capacity || capacity <= shard->size + 1)
+		return false;
+
+	// The migration is timed on it's own, so only the allocation of the new table is timed here.
+	uint64_t start = map->counters ? get_time_ns() : 0;
+	struct c_utils_map_table *new_table = create_table(capacity, map->conf.logger);
+	if(map->counters) {
+		count_resize_time(map, start);
+		__atomic_fetch_add(&get_counters(map)->resizes, new_table != NULL, __ATOMIC_RELAXED);
+	}
+
+	if(!new_table)
+		return false;
+
+	migrate(map, shard, SIZE_MAX);
+
+	if(shard->filter)
+		rebuild_filter(map, shard, capacity);
+
+	shard->old = shard->table;
+	shard->table = new_table;
+	shard->migrate_pos = 0;
+	shard->version++;
+	shard->erased = C_UTILS_MAP_NPOS;
+
+	migrate(map, shard, C_UTILS_MAP_MIGRATE_BUDGET);
+
+	return true;
+}
+
+/*
+	Migrates up to budget slots from the old table into the shard's table. The migration cursor
+	only moves forward, and as the old table is never shifted, every slot behind it has been
+	migrated. Must be called while holding the shard's writer lock.
+*/
+static void migrate(struct c_utils_map *map, struct c_utils_map_shard *shard, size_t budget) {
+	struct c_utils_map_table *old_table = shard->old;
+	if(!old_table)
+		return;
+
+	uint64_t start = map->counters ? get_time_ns() : 0;
+	struct c_utils_map_table *new_table = shard->table;
+	bool moved = false;
+	for(; budget && shard->migrate_pos < old_table->capacity; budget--, shard->migrate_pos++) {
+		size_t i = shard->migrate_pos;
+		if(!is_full(old_table->ctrl[i]))
+			continue;
+
+		// Every key is unique, so we only need to find the first empty slot.
+		size_t index = find_empty(new_table, old_table->slots[i].hash);
+		new_table->slots[index] = old_table->slots[i];
+		set_ctrl(new_table, index, old_table->ctrl[i]);
+		set_ctrl(old_table, i, C_UTILS_MAP_CTRL_MOVED);
+		moved = true;
+	}
+
+	if(shard->migrate_pos == old_table->capacity) {
+		shard->old = NULL;
+		free_table(map, old_table);
+	}
+
+	// Slots which were empty or already moved are skipped over, which iterators are unaffected by.
+	if(moved) {
+		shard->version++;
+		shard->erased = C_UTILS_MAP_NPOS;
+	}
+
+	if(map->counters)
+		count_resize_time(map, start);
+}
+
+/*
+	Shrinks the shard if enough space is free, but only if the shard would remain below half of
+	the growth trigger afterwards. Otherwise, a shard hovering around the shrink trigger would
+	bounce between shrinking and growing.
+*/
+static void shrink_shard(struct c_utils_map *map, struct c_utils_map_shard *shard) {
+	size_t capacity = shard->table->capacity;
+
+	if(shard->old || (shard->size / (double)capacity) > map->conf.shrink.trigger)
+		return;
+
+	size_t target = capacity * map->conf.shrink.ratio;
+	if(target < shard->min)
+		target = shard->min;
+
+	target = round_capacity(target);
+	if(target >= capacity || ((shard->size + 1) / (double)target) >= map->conf.growth.trigger / 2)
+		return;
+
+	resize_shard(map, shard, target);
+}
 
-		memset(&map->buckets, 0, new_size);
-		map->num_buckets = size;
+/// The filter holds as many keys as the table has slots, so it never fills before the table grows.
+static struct c_utils_filter *create_filter(size_t capacity, struct c_utils_logger *logger) {
+	struct c_utils_filter_conf conf =
+	{
+		.flags = C_UTILS_FILTER_CUCKOO,
+		.capacity = capacity,
+		.logger = logger
+	};
 
-		// Re-hash all key-value pairs
-		for(size_t i = 0; i < used; i++) {
-			struct c_utils_bucket *bucket = get_empty_bucket(map, keys[i]);
-			C_UTILS_ASSERT(bucket, map->conf.logger, "Duplicate key found in list!");
+	return c_utils_filter_create_conf(&conf);
+}
+
+/*
+	Replaces the shard's filter with one sized for the new capacity, filled from the hashes kept in
+	the table. Must be called while holding the shard's writer lock, after any migration is finished.
+*/
+static void rebuild_filter(struct c_utils_map *map, struct c_utils_map_shard *shard, size_t capacity) {
+	struct c_utils_filter *filter = create_filter(capacity, map->conf.logger);
+	if(!filter) {
+		drop_filter(map, shard);
+		return;
+	}
 
-			bucket->key = keys[i];
-			bucket->value = values[i];
-			bucket->in_use = true;
+	struct c_utils_map_table *table = shard->table;
+	for(size_t i = 0; i < table->capacity; i++)
+		if(is_full(table->ctrl[i]) && !c_utils_filter_add(filter, table->slots[i].hash)) {
+			c_utils_filter_destroy(filter);
+			drop_filter(map, shard);
+			return;
 		}
 
-		return true;
+	c_utils_filter_destroy(shard->filter);
+	shard->filter = filter;
+}
+
+/// A filter missing any key would yield false misses, so once it can not be kept complete, it is discarded.
+static void drop_filter(struct c_utils_map *map, struct c_utils_map_shard *shard) {
+	C_UTILS_LOG_WARNING(map->conf.logger, "The filter of a shard could not hold every key, so it has been dropped!");
+	c_utils_filter_destroy(shard->filter);
+	shard->filter = NULL;
+}
+
+/// Removes the slot from the table, shrinking the shard if necessary. Must be called while holding the shard's writer lock.
+static void remove_slot(struct c_utils_map *map, struct c_utils_map_shard *shard, struct c_utils_map_table *table, size_t index) {
+	if(shard->filter)
+		c_utils_filter_remove(shard->filter, table->slots[index].hash);
+
+	// The old table must not be shifted, so the slot is marked as moved instead.
+	if(table == shard->old) {
+		set_ctrl(table, index, C_UTILS_MAP_CTRL_MOVED);
+	} else {
+		bool wrapped;
+		if(erase_slot(table, index, &wrapped)) {
+			shard->version++;
+			shard->erased = wrapped ? C_UTILS_MAP_NPOS : index;
+		}
 	}
 
-	C_UTILS_UNACCESSIBLE;
+	shard->size--;
+
+	if(map->conf.flags & C_UTILS_MAP_SHRINK_ON_TRIGGER)
+		shrink_shard(map, shard);
+}
+
+/*
+	Removes every key-value pair from the shard, releasing our references to them. If delete is
+	true, the destructors are invoked on those which are not reference counted. Must be called
+	while holding the shard's writer lock.
+*/
+static void clear_shard(struct c_utils_map *map, struct c_utils_map_shard *shard, bool delete) {
+	// Finish any migration first, so that we only have one table to clear.
+	migrate(map, shard, SIZE_MAX);
+	shard->version++;
+	shard->erased = C_UTILS_MAP_NPOS;
+
+	if(shard->reverse)
+		memset(shard->reverse->ctrl, C_UTILS_MAP_CTRL_EMPTY, shard->reverse->capacity + C_UTILS_MAP_GROUP_WIDTH - 1);
+
+	if(shard->filter)
+		c_utils_filter_clear(shard->filter);
+
+	struct c_utils_map_table *table = shard->table;
+
+	for(size_t i = 0; shard->size && i < table->capacity; i++) {
+		if(!is_full(table->ctrl[i]))
+			continue;
+
+		// If we have a reference to the key, release it. Otherwise, invoke destructor
+		if(map->conf.flags & C_UTILS_MAP_RC_KEY)
+			C_UTILS_REF_DEC(table->slots[i].key);
+		else if(delete && map->conf.callbacks.destructors.key)
+			map->conf.callbacks.destructors.key(table->slots[i].key);
+
+		// If we have a reference to the value, release it. Otherwise, invoke destructor.
+		if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
+			C_UTILS_REF_DEC(table->slots[i].value);
+		else if(delete)
+			map->conf.callbacks.destructors.value(table->slots[i].value);
+
+		set_ctrl(table, i, C_UTILS_MAP_CTRL_EMPTY);
+		shard->size--;
+	}
 }
 
 static void configure(struct c_utils_map_conf *conf) {
@@ -635,20 +1957,61 @@ static void configure(struct c_utils_map_conf *conf) {
 	if(!conf->size.max)
 		conf->size.max = default_max;
 
-	if(!conf->growth.ratio <= 0)
+	if(conf->size.max < conf->size.initial)
+		conf->size.max = conf->size.initial;
+
+	if(conf->growth.ratio <= 1)
 		conf->growth.ratio = default_growth_rate;
 
-	if(!conf->growth.trigger <= 0)
+	if(conf->growth.trigger <= 0 || conf->growth.trigger >= 1)
 		conf->growth.trigger = default_growth_trigger;
 
 	if(conf->flags & C_UTILS_MAP_SHRINK_ON_TRIGGER) {
-		if(conf->shrink.ratio <= 0)
+		if(conf->shrink.ratio <= 0 || conf->shrink.ratio >= 1)
 			conf->shrink.ratio = default_shrink_rate;
 
 		if(conf->shrink.trigger <= 0)
 			conf->shrink.trigger = default_shrink_trigger;
 	}
 
+	if(conf->flags & C_UTILS_MAP_SHARDED && !conf->shards)
+		conf->shards = default_shards;
+
+	if(conf->flags & C_UTILS_MAP_REVERSE_INDEX) {
+		/*
+			Values which are equal according to a custom comparator must also hash equally, which we can
+			not guarantee without a hash function for them.
+		*/
+		if(conf->callbacks.comparators.value && !conf->callbacks.value_hash_function) {
+			C_UTILS_LOG_WARNING(conf->logger, "A value comparator was given without a value hash function, disabling the reverse index!");
+			conf->flags &= ~(C_UTILS_MAP_REVERSE_INDEX);
+		}
+
+		if(conf->reverse.trigger <= 0 || conf->reverse.trigger >= 1)
+			conf->reverse.trigger = default_reverse_trigger;
+	}
+
+	/*
+		An optimistic reader can not safely take a reference to a value which a writer may be releasing
+		concurrently, nor compare against a key whose last reference a writer may be releasing.
+	*/
+	if(conf->flags & C_UTILS_MAP_OPTIMISTIC_READ && conf->flags & (C_UTILS_MAP_RC_KEY | C_UTILS_MAP_RC_VALUE)) {
+		C_UTILS_LOG_WARNING(conf->logger, "Optimistic reads are not supported with reference counted keys or values, falling back to locked reads!");
+		conf->flags &= ~(C_UTILS_MAP_OPTIMISTIC_READ);
+		conf->flags |= C_UTILS_MAP_CONCURRENT;
+	}
+
+	/*
+		Nor against a key which c_utils_map_delete_all passes to it's destructor, as readers hold no hazard
+		pointer to the keys of the table they probe. Values are never dereferenced by a reader, so their
+		destructor is left alone.
+	*/
+	if(conf->flags & C_UTILS_MAP_OPTIMISTIC_READ && conf->callbacks.destructors.key) {
+		C_UTILS_LOG_WARNING(conf->logger, "Optimistic reads are not supported with a key destructor, falling back to locked reads!");
+		conf->flags &= ~(C_UTILS_MAP_OPTIMISTIC_READ);
+		conf->flags |= C_UTILS_MAP_CONCURRENT;
+	}
+
 	if(!conf->callbacks.destructors.value)
 		conf->callbacks.destructors.value = free;
 
@@ -658,32 +2021,41 @@ static void configure(struct c_utils_map_conf *conf) {
 static void map_destroy(void *map) {
 	struct c_utils_map *m = map;
 
-	for(size_t i = 0; m->size && i < m->num_buckets; i++) {
-		struct c_utils_bucket *bucket = m->buckets + i;
-
-		/*
-			If the bucket is in use, then that means that the key and value pairs need to be
-			cleaned up as well. In the case that they are reference counted, we release our reference
-			to it. If instead there is a destructor, it will invoke that instead.
-		*/
-		if(bucket->in_use) {
-			if(m->conf.flags & C_UTILS_MAP_RC_KEY)
-				C_UTILS_REF_DEC(bucket->key);
-			else if(m->conf.flags & C_UTILS_MAP_DELETE_ON_DESTROY && m->conf.callbacks.destructors.key)
-				m->conf.callbacks.destructors.key(bucket->key);
-
-			if(m->conf.flags & C_UTILS_MAP_RC_VALUE)
-				C_UTILS_REF_DEC(bucket->value);
-			else if(m->conf.flags & C_UTILS_MAP_DELETE_ON_DESTROY)
-				m->conf.callbacks.destructors.value(bucket->value);
-
-			m->size--;
+	for(size_t i = 0; i < m->num_shards; i++) {
+		struct c_utils_map_shard *shard = m->shards + i;
+		migrate(m, shard, SIZE_MAX);
+
+		struct c_utils_map_table *table = shard->table;
+
+		for(size_t j = 0; shard->size && j < table->capacity; j++) {
+			/*
+				If the slot is in use, then that means that the key and value pairs need to be
+				cleaned up as well. In the case that they are reference counted, we release our reference
+				to it. If instead there is a destructor, it will invoke that instead.
+			*/
+			if(is_full(table->ctrl[j])) {
+				if(m->conf.flags & C_UTILS_MAP_RC_KEY)
+					C_UTILS_REF_DEC(table->slots[j].key);
+				else if(m->conf.flags & C_UTILS_MAP_DELETE_ON_DESTROY && m->conf.callbacks.destructors.key)
+					m->conf.callbacks.destructors.key(table->slots[j].key);
+
+				if(m->conf.flags & C_UTILS_MAP_RC_VALUE)
+					C_UTILS_REF_DEC(table->slots[j].value);
+				else if(m->conf.flags & C_UTILS_MAP_DELETE_ON_DESTROY)
+					m->conf.callbacks.destructors.value(table->slots[j].value);
+
+				shard->size--;
+			}
 		}
-	}
 
-	c_utils_scoped_lock_destroy(m->lock);
+		c_utils_scoped_lock_destroy(shard->lock);
+		free(table);
+		free(shard->reverse);
+		c_utils_filter_destroy(shard->filter);
+	}
 
-	free(m->buckets);
+	free(m->shards);
+	free(m->counters);
 	free(m);
 }
 
@@ -735,50 +2107,45 @@ static int value_cmp(const struct c_utils_map *map, const void *a, const void *b
 
 
 static void *head(void *instance, void *pos) {
+	struct c_utils_map *map = instance;
 	struct _c_utils_map_iterator_position *position = pos;
 
-	if(!position->size)
-		return NULL;
+	position->shard = 0;
+	position->table = 0;
+	position->index = C_UTILS_MAP_NPOS;
+	position->in_shard = false;
 
-	return position->data[(position->index = 0)].value;
+	return map->conf.flags & C_UTILS_MAP_SNAPSHOT_ITERATOR ? seek_snapshot(map, position, true) : seek(map, position, true);
 }
 
 static void *tail(void *instance, void *pos) {
+	struct c_utils_map *map = instance;
 	struct _c_utils_map_iterator_position *position = pos;
 
-	if(!position->size)
-		return NULL;
+	position->shard = map->num_shards - 1;
+	position->table = 1;
+	position->index = C_UTILS_MAP_NPOS;
+	position->in_shard = false;
 
-	return position->data[(position->index = position->size - 1)].value;
+	return map->conf.flags & C_UTILS_MAP_SNAPSHOT_ITERATOR ? seek_snapshot(map, position, false) : seek(map, position, false);
 }
 
 static void *next(void *instance, void *pos) {
-	struct _c_utils_map_iterator_position *position = pos;
-
-	// If index is on last position, we cannot go further.
-	if(position->index + 1 >= position->size)
-		return NULL;
+	struct c_utils_map *map = instance;
 
-	return position->data[++position->index].value;
+	return map->conf.flags & C_UTILS_MAP_SNAPSHOT_ITERATOR ? seek_snapshot(map, pos, true) : seek(map, pos, true);
 }
 
 static void *prev(void *instance, void *pos) {
-	struct _c_utils_map_iterator_position *position = pos;
-
-	// If we are on the zero'th position, we cannot go back anymore without overflowing
-	if(!position->index)
-		return NULL;
+	struct c_utils_map *map = instance;
 
-	return position->data[--position->index].value;
+	return map->conf.flags & C_UTILS_MAP_SNAPSHOT_ITERATOR ? seek_snapshot(map, pos, false) : seek(map, pos, false);
 }
 
 static void *curr(void *instance, void *pos) {
 	struct _c_utils_map_iterator_position *position = pos;
 
-	if(!position->size)
-		return NULL;
-
-	return position->data[position->index].value;
+	return position->value;
 }
 
 static void finalize(void *instance, void *pos) {
@@ -786,20 +2153,154 @@ static void finalize(void *instance, void *pos) {
 	struct _c_utils_map_iterator_position *position = pos;
 	
 	/*
-		As the iterator will maintain a reference to the copied data (key-value pairs),
-		during finalization we must relinquish that reference as well. Of course, we also
-		relinquish the reference over the instance of the map itself too.
+		As the iterator will maintain a reference to the current key-value pair (or the copied data
+		in snapshot mode), during finalization we must relinquish that reference as well. Of course,
+		we also relinquish the reference over the instance of the map itself too.
 	*/
-	for(size_t i = 0; i < position->size; i++) {
-		if(map->conf.flags & C_UTILS_MAP_RC_KEY)
-			C_UTILS_REF_DEC(position->data[i].key);
+	if(map->conf.flags & C_UTILS_MAP_SNAPSHOT_ITERATOR) {
+		for(size_t i = 0; i < position->size; i++) {
+			if(map->conf.flags & C_UTILS_MAP_RC_KEY)
+				C_UTILS_REF_DEC(position->data[i].key);
 
-		if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
-			C_UTILS_REF_DEC(position->data[i].value);
+			if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
+				C_UTILS_REF_DEC(position->data[i].value);
+		}
+
+		free(position->data);
+	} else {
+		set_current(map, position, NULL, NULL);
 	}
 
 	if(map->conf.flags & C_UTILS_MAP_RC_INSTANCE)
 		C_UTILS_REF_DEC(map);
 
 	free(pos);
-}
\ No newline at end of file
+}
+
+/*
+	Moves the cursor to the next (or previous) full slot. The cursor orders slots by shard, then by
+	table (the shard's table followed by the table being migrated from, if any), then by slot.
+	Only the shard the cursor is in is locked, and only while it is moving.
+
+	If the shard has been modified in a way which moves pairs between slots since the cursor entered
+	it, the cursor may skip or revisit pairs, so rather than silently doing so, the iteration ends
+	and a warning is logged. The exception is the removal of the pair the cursor is on, as pairs are
+	then only shifted back into it's slot, which the cursor visits again when moving forward. Pairs
+	which are added after the cursor passes their slot are not seen.
+*/
+static void *seek(struct c_utils_map *map, struct _c_utils_map_iterator_position *pos, bool forward) {
+	void *key = NULL, *value = NULL;
+
+	while(pos->shard < map->num_shards) {
+		struct c_utils_map_shard *shard = map->shards + pos->shard;
+		bool found = false, invalidated = false, revisit = false;
+
+		C_UTILS_SCOPED_RDLOCK(shard->lock) {
+			if(pos->in_shard && pos->version != shard->version) {
+				/*
+					A single removal which only shifted pairs back into the slot it removed from is recoverable,
+					if the cursor is on that slot, or is in the old table which the removal did not touch.
+				*/
+				if(pos->version + 1 != shard->version || shard->erased == C_UTILS_MAP_NPOS || (pos->table == 0 && pos->index != shard->erased)) {
+					invalidated = true;
+					break;
+				}
+
+				revisit = forward && pos->table == 0;
+			}
+
+			pos->version = shard->version;
+			pos->in_shard = true;
+
+			struct c_utils_map_table *tables[] = { shard->table, shard->old };
+			for(; pos->table >= 0 && pos->table < 2; pos->table += forward ? 1 : -1, pos->index = C_UTILS_MAP_NPOS) {
+				struct c_utils_map_table *table = tables[pos->table];
+				if(!table)
+					continue;
+
+				size_t i;
+				if(forward)
+					i = pos->index == C_UTILS_MAP_NPOS ? 0 : pos->index + !revisit;
+				else
+					i = pos->index == C_UTILS_MAP_NPOS ? table->capacity - 1 : pos->index - 1;
+
+				// Note that when moving backwards, i underflows past 0, which also terminates the loop.
+				for(; i < table->capacity; forward ? i++ : i--) {
+					if(is_full(table->ctrl[i])) {
+						key = table->slots[i].key;
+						value = table->slots[i].value;
+
+						// We gain a reference to the pair while the cursor is on it.
+						if(map->conf.flags & C_UTILS_MAP_RC_KEY)
+							C_UTILS_REF_INC(key);
+
+						if(map->conf.flags & C_UTILS_MAP_RC_VALUE)
+							C_UTILS_REF_INC(value);
+
+						pos->index = i;
+						found = true;
+						break;
+					}
+				}
+
+				if(found)
+					break;
+			}
+		}
+
+		if(invalidated) {
+			C_UTILS_LOG_WARNING(map->conf.logger, "The map was modified during iteration, ending iteration!");
+			pos->shard = map->num_shards;
+			break;
+		}
+
+		if(found)
+			break;
+
+		// Move on to the next shard. Moving backwards, the shard index underflows, which ends the iteration.
+		pos->shard += forward ? 1 : -1;
+		pos->table = forward ? 0 : 1;
+		pos->index = C_UTILS_MAP_NPOS;
+		pos->in_shard = false;
+	}
+
+	set_current(map, pos, key, value);
+
+	return value;
+}
+
+static void *seek_snapshot(struct c_utils_map *map, struct _c_utils_map_iterator_position *pos, bool forward) {
+	if(!pos->size)
+		return NULL;
+
+	if(forward) {
+		// If index is on last position, we cannot go further.
+		if(pos->index != C_UTILS_MAP_NPOS && pos->index + 1 >= pos->size)
+			return NULL;
+
+		pos->index = pos->index == C_UTILS_MAP_NPOS ? 0 : pos->index + 1;
+	} else {
+		// If we are on the zero'th position, we cannot go back anymore without overflowing
+		if(!pos->index)
+			return NULL;
+
+		pos->index = pos->index == C_UTILS_MAP_NPOS ? pos->size - 1 : pos->index - 1;
+	}
+
+	pos->key = pos->data[pos->index].key;
+	pos->value = pos->data[pos->index].value;
+
+	return pos->value;
+}
+
+/// Replaces the pair the cursor is on, releasing our references to the previous pair outside of any lock.
+static void set_current(struct c_utils_map *map, struct _c_utils_map_iterator_position *pos, void *key, void *value) {
+	if(pos->key && map->conf.flags & C_UTILS_MAP_RC_KEY)
+		C_UTILS_REF_DEC(pos->key);
+
+	if(pos->value && map->conf.flags & C_UTILS_MAP_RC_VALUE)
+		C_UTILS_REF_DEC(pos->value);
+
+	pos->key = key;
+	pos->value = value;
+}
@@ -6,29 +6,51 @@
 #include <stddef.h>
 
 /*
-	A simple hash map implementation which can be made thread-safe by passing true for synchronized on construction.
+	A hash map implementation which can be made thread-safe by passing C_UTILS_MAP_CONCURRENT on construction.
 
 	Synchronicity is handled through a rwlock, allowing for multiple concurrent reader access, and is useful for a
-	Read-Often Write-Rarely map. The hash map as of current does not support resizing, but it does support infinite chaining, 
-	hence knowing the amount_of_buckets before hand is very important.
+	Read-Often Write-Rarely map. The map is an open-addressing table which keeps a packed array of 7-bit hash tags
+	alongside the key-value slots, so that a lookup can scan 16 slots at a time (with SSE2) before touching any key.
+	The amount of slots is always rounded up to a power of two, and the map grows once the growth trigger is reached.
+	Resizing is incremental: the old table is kept until every pair has been moved to the new one, a bounded amount of
+	slots per write, so no single insertion pays for rehashing the entire map.
 */
 struct c_utils_map;
 
+/*
+	The iterator is a cursor which walks the map in place, and so only ever holds onto the pair it is
+	currently on. If the map is modified in a way that moves pairs around (removal or resizing) while the
+	cursor is within the modified shard, the iteration ends early and a warning is logged. Removing the pair
+	the cursor is on, such as within C_UTILS_MAP_FOR_EACH_PAIR, is safe between two steps, unless a resize
+	is triggered or in progress. If a consistent snapshot is required, C_UTILS_MAP_SNAPSHOT_ITERATOR copies
+	every pair on creation instead.
+*/
 struct _c_utils_map_iterator_position {
-	/// Our current position in our data.
+	/// The shard the cursor is in.
+	size_t shard;
+	/// The table of the shard the cursor is in; 0 for it's table, 1 for the table being resized from.
+	int table;
+	/// The slot the cursor is on, or in snapshot mode, the index in our data.
 	size_t index;
-	/// The size of the data_copy
+	/// The version of the shard when the cursor entered it.
+	size_t version;
+	/// Whether or not version has been taken for the shard the cursor is in.
+	bool in_shard;
+	/// The pair the cursor is currently on.
+	void *key;
+	void *value;
+	/// The size of the data copy, only used in snapshot mode.
 	size_t size;
-	/// Copy of the data at time of creation.
+	/// Copy of the data at time of creation, only used in snapshot mode.
 	struct _c_utils_map_data {
 		void *key;
 		void *value;
-	} data[];
+	} *data;
 };
 
-#define _C_UTILS_MAP_GET_KEY(it) ((struct _c_utils_map_iterator_position *)it->pos)->data[((struct _c_utils_map_iterator_position *)it->pos)->index].key
+#define _C_UTILS_MAP_GET_KEY(it) ((struct _c_utils_map_iterator_position *)it->pos)->key
 
-#define _C_UTILS_MAP_GET_VALUE(it) ((struct _c_utils_map_iterator_position *)it->pos)->data[((struct _c_utils_map_iterator_position *)it->pos)->index].value
+#define _C_UTILS_MAP_GET_VALUE(it) ((struct _c_utils_map_iterator_position *)it->pos)->value
 
 #define C_UTILS_MAP_FOR_EACH_KEY(key, map) \
 	for(C_UTILS_AUTO_ITERATOR _this_it = c_utils_map_iterator(map); \
@@ -48,6 +70,12 @@ struct _c_utils_map_iterator_position {
 #define C_UTILS_MAP_RC_VALUE 1 << 3
 #define C_UTILS_MAP_DELETE_ON_DESTROY 1 << 4
 #define C_UTILS_MAP_SHRINK_ON_TRIGGER 1 << 5
+#define C_UTILS_MAP_SHARDED 1 << 6
+#define C_UTILS_MAP_SNAPSHOT_ITERATOR 1 << 7
+#define C_UTILS_MAP_REVERSE_INDEX 1 << 8
+#define C_UTILS_MAP_OPTIMISTIC_READ 1 << 9
+#define C_UTILS_MAP_STATS 1 << 10
+#define C_UTILS_MAP_FILTERED 1 << 11
 
 /*
 	concurrent:
@@ -58,12 +86,75 @@ struct _c_utils_map_iterator_position {
 			This way it will allow any iterators or map functions that do not mutate the list to proceed concurrently
 			in an efficient manor. If this is not specified, the map will not use a lock and hence any concurrent access
 			will yield undefined behavior. The default is good for if you do not need concurrent access.
+	sharded:
+		default:
+			false
+		note:
+			Splits the map into shards, each with it's own table, reader-writer lock and resizing, so that writers which
+			hash to different shards never contend with each other. This implies concurrent. The size of the map is then the
+			sum of each shard's size, and iteration visits each shard in turn, locking only one shard at a time.
+	snapshot_iterator:
+		default:
+			false
+		note:
+			By default, iterators walk the map in place, using O(1) memory, but end early if the map is modified
+			underneath them in a way which moves pairs around. If flagged, iterators instead copy every key-value
+			pair on creation (O(N) memory), and are unaffected by any modifications made afterwards.
+	reverse_index:
+		default:
+			false
+		note:
+			Maintains a secondary index from value to key, updated on every add, remove and delete, so that contains
+			is a hash lookup per shard rather than a scan over the entire map. Values are hashed with value_hash if
+			specified, otherwise by their bytes up to the value length, otherwise by their address. If a value comparator
+			is specified without value_hash, the index is disabled with a warning, as equal values may not hash equally.
+	optimistic_read:
+		default:
+			false
+		note:
+			Lookups take no lock at all: each shard keeps a sequence counter which writers bump on entry and exit, and
+			a lookup simply retries if the counter changed while it probed. Writers still serialize on the shard's lock,
+			and every other operation still takes the reader lock. This implies concurrent, and suits maps which are read
+			far more often than they are written, as readers no longer contend on the lock's reader count. As a lookup
+			may compare against a key which a writer is removing at that very moment, a key must remain valid for as long
+			as lookups may be in progress after it has been removed. Hence it is not supported with reference counted
+			keys or values, nor with a key destructor, and falls back to locked reads with a warning. Keys which are
+			removed must instead be freed by the caller once no lookup may still be comparing against them.
+	stats:
+		default:
+			false
+		note:
+			Counts every lookup, the amount of groups of slots it probed and whether it missed, as well as every resize
+			and the time spent resizing (including the incremental migration). Each thread adds to one of a fixed set of
+			counters, each on it's own cache line, which c_utils_map_stats sums, so that counting costs a few uncontended
+			atomic increments per lookup. Without this flag, c_utils_map_stats still reports everything which can be
+			derived from the tables themselves.
+	filtered:
+		default:
+			false
+		note:
+			Keeps a cuckoo filter of the hashes of each shard's keys in front of it's table, so that a lookup of a key
+			which is not present usually returns after testing a couple of 8-byte buckets, without probing the table
+			or comparing any keys. The filter is rebuilt whenever the shard resizes, and is dropped with a warning if it
+			ever fills up. Only lookups which take the lock consult it; an optimistic read probes the table directly.
+	reverse_trigger:
+		default:
+			.75
+		note:
+			The load factor at which the reverse index grows, which trades memory for probe length. At .75, the index
+			uses between 1.33x and 2.67x the memory of the slots it indexes.
+	shards:
+		default:
+			16
+		note:
+			The amount of shards to use if sharded, rounded up to a power of two. The initial, minimum and maximum amount of
+			buckets are split evenly between them.
 	num_buckets:
 		default:
 			64
 		note:
 			Sets the initial amount of buckets to prevent incessant resizing. Great for if you know exactly how many items the
-			map will hold, or can at least guess at such.
+			map will hold, or can at least guess at such. It is rounded up to the next power of two, and no less than 16.
 	ref_counted:
 		default:
 			false
@@ -131,17 +222,23 @@ struct c_utils_map_conf {
 		} comparators;
 		/// Hash function
 		uint32_t (*hash_function)(const void *key);
+		/// Value hash function, used by the reverse index.
+		uint32_t (*value_hash_function)(const void *value);
 	} callbacks;
 	struct {
-		/// What ratio should we grow at?
+		/// What ratio should we grow at? Defaults to 2.
 		double ratio;
-		/// When should we trigger?
+		/// At what load factor should we trigger? Defaults to .5.
 		double trigger;
 	} growth;
+	/*
+		Relevant only when MAP_SHRINK_ON_TRIGGER flagged. To prevent thrashing between shrinking and growing,
+		the map will only shrink if it's load factor afterwards would be less than half of the growth trigger.
+	*/
 	struct {
-		/// If so, at what rate?
+		/// If so, at what rate? Defaults to .5.
 		double ratio;
-		/// And when?
+		/// And at what load factor? Defaults to .1.
 		double trigger;
 	} shrink;
 	struct {
@@ -149,9 +246,16 @@ struct c_utils_map_conf {
 		size_t initial;
 		/// The minimum amount of buckets. Relavent only when MAP_SHRINK_ON_TRIGGER flagged.
 		size_t min;
-		/// The maximum amount of buckets the map can grow to.
+		/// The maximum amount of buckets the map can grow to. Unbounded by default.
 		size_t max;
 	} size;
+	/// The amount of shards. Relavent only when MAP_SHARDED flagged.
+	size_t shards;
+	/// Reverse index. Relavent only when MAP_REVERSE_INDEX flagged.
+	struct {
+		/// At what load factor should the index grow?
+		double trigger;
+	} reverse;
 	/// The respective sizes of the key-value pair, used for comparison and default hash function.
 	struct {
 		size_t key;
@@ -193,12 +297,53 @@ struct c_utils_map_conf {
 	};
 */
 
+/// Lookups which probe at least this many groups all fall into the last bucket of a histogram.
+#define C_UTILS_MAP_STATS_HISTOGRAM 8
+
+/*
+	A group is the amount of slots scanned at once (16 with SSE2); bucket i of a histogram counts
+	probes which scanned i + 1 groups.
+*/
+struct c_utils_map_stats {
+	/// The amount of pairs.
+	size_t size;
+	/// The amount of slots, excluding the table being resized from.
+	size_t capacity;
+	/// size / capacity.
+	double load_factor;
+	/*
+		The ratio of slots which are marked as moved to all slots. These only exist in the table being
+		resized from, as removal from the current table leaves no tombstones behind, hence this is only
+		non-zero during a resize.
+	*/
+	double tombstone_ratio;
+	/// The amount of groups a lookup of each pair in the map would probe, computed from the tables.
+	struct {
+		double average;
+		size_t max;
+		size_t histogram[C_UTILS_MAP_STATS_HISTOGRAM];
+	} probe;
+	/// Counted as the map is used, only if C_UTILS_MAP_STATS is flagged; otherwise all 0.
+	struct {
+		size_t lookups;
+		size_t misses;
+		/// Groups probed per lookup, including misses.
+		double average_probe;
+		size_t max_probe;
+		size_t histogram[C_UTILS_MAP_STATS_HISTOGRAM];
+		size_t resizes;
+		/// Time spent resizing and migrating, in nanoseconds.
+		size_t resize_ns;
+	} counters;
+};
+
 #ifdef NO_C_UTILS_PREFIX
 /*
 	Typedefs
 */
 typedef struct c_utils_map map_t;
 typedef struct c_utils_map_conf map_conf_t;
+typedef struct c_utils_map_stats map_stats_t;
 
 /*
 	Functions
@@ -207,6 +352,12 @@ typedef struct c_utils_map_conf map_conf_t;
 #define map_create_conf(...) c_utils_map_create_conf(__VA_ARGS__)
 #define map_add(...) c_utils_map_add(__VA_ARGS__)
 #define map_get(...) c_utils_map_get(__VA_ARGS__)
+#define map_upsert(...) c_utils_map_upsert(__VA_ARGS__)
+#define map_compute_if_absent(...) c_utils_map_compute_if_absent(__VA_ARGS__)
+#define map_merge(...) c_utils_map_merge(__VA_ARGS__)
+#define map_increment(...) c_utils_map_increment(__VA_ARGS__)
+#define map_get_batch(...) c_utils_map_get_batch(__VA_ARGS__)
+#define map_add_batch(...) c_utils_map_add_batch(__VA_ARGS__)
 #define map_remove(...) c_utils_map_remove(__VA_ARGS__)
 #define map_remove_all(...) c_utils_map_remove_all(__VA_ARGS__)
 #define map_delete(...) c_utils_map_delete(__VA_ARGS__)
@@ -217,17 +368,13 @@ typedef struct c_utils_map_conf map_conf_t;
 #define map_destroy(...) c_utils_map_destroy(__VA_ARGS__)
 #define map_key_value_to_string(...) c_utils_map_key_value_to_string(__VA_ARGS__)
 #define map_for_each(...) c_utils_map_for_each(__VA_ARGS__)
+#define map_stats(...) c_utils_map_stats(__VA_ARGS__)
 #endif
 
 /**
- * Creates a hash map with the initial amount of buckets. The hash map does not resize, so care should
- * be taken when declaring amount of buckets. If the hash map is full, it will chain it. The map is
- * synchronized if init_locks is non 0.
+ * Creates a hash map with the default configuration.
  *
- * Reader-Lock: Concurrent operation.
- * @param amount_of_buckets Amount of buckets.
- * @param synchronized Synchronized?
- * @return Map instance, or NULL if amount_of_buckets is 0, or an allocation error occurs.
+ * @return Map instance, or NULL if an allocation error occurs.
  */
 struct c_utils_map *c_utils_map_create();
 
@@ -244,6 +391,78 @@ struct c_utils_map *c_utils_map_create_conf(struct c_utils_map_conf *conf);
  */
 bool c_utils_map_add(struct c_utils_map *map, void *key, void *value);
 
+/**
+ * Adds each key-value pair, keys[i] to values[i], to the map. All keys are hashed up front, before any
+ * lock is taken, and each shard is locked once per batch of up to 64 keys rather than once per key.
+ *
+ * Writer-Lock: Not Concurrent, Is Thread Safe.
+ * @param map Instance.
+ * @param keys Keys.
+ * @param values Values.
+ * @param n Amount of key-value pairs.
+ * @return The amount of pairs added; pairs whose key is already present are not added.
+ */
+size_t c_utils_map_add_batch(struct c_utils_map *map, void **keys, void **values, size_t n);
+
+/**
+ * Adds the pair, or replaces the value if the key is already present, probing for the key only once.
+ * When replacing, the map keeps the key it already holds, so the key passed remains the caller's.
+ *
+ * Writer-Lock: Not Concurrent, Is Thread Safe.
+ * @param map Instance.
+ * @param key Key.
+ * @param value Value.
+ * @param old If not NULL, the value replaced is stored here and belongs to the caller, or NULL if the pair
+ * was added. Otherwise, the value replaced is released as it is on delete.
+ * @return True if added or replaced, false if the map is full or an allocation error occurs.
+ */
+bool c_utils_map_upsert(struct c_utils_map *map, void *key, void *value, void **old);
+
+/**
+ * Obtains the value associated with the key, or if not present, adds the pair of the key and the value
+ * computed from it. The callback is invoked while holding the writer lock, and so must not access the map.
+ *
+ * Writer-Lock: Not Concurrent, Is Thread Safe.
+ * @param map Instance.
+ * @param key Key, which the map takes only if the pair is added.
+ * @param compute Computes the value for an absent key; if it returns NULL, nothing is added.
+ * @param added If not NULL, set to whether the pair was added.
+ * @return The value present or added, or NULL if compute returned NULL or an error occurs.
+ */
+void *c_utils_map_compute_if_absent(struct c_utils_map *map, void *key, void *(*compute)(const void *key), bool *added);
+
+/**
+ * Adds the pair if the key is not present. Otherwise, merge is invoked with the value present and the
+ * value given, and the value present is replaced with what it returns; if that is NULL, the pair is removed.
+ * The map does not release either value itself, so merge is responsible for both. The callback is invoked
+ * while holding the writer lock, and so must not access the map.
+ *
+ * Writer-Lock: Not Concurrent, Is Thread Safe.
+ * @param map Instance.
+ * @param key Key, which the map takes only if the pair is added.
+ * @param value Value.
+ * @param merge Combines the value present with the value given.
+ * @param added If not NULL, set to whether the pair was added.
+ * @return The value now associated with the key, or NULL if removed or an error occurs.
+ */
+void *c_utils_map_merge(struct c_utils_map *map, void *key, void *value, void *(*merge)(void *old, void *value), bool *added);
+
+/**
+ * Atomically adds delta to the counter associated with the key, where each value is a pointer to an
+ * int64_t. Only the lock a lookup would take is taken, so concurrent increments proceed in parallel;
+ * with C_UTILS_MAP_OPTIMISTIC_READ, no lock is taken at all, in which case a counter must not be deleted
+ * or replaced while it may be incremented. Absent counters must first be added, for example through
+ * c_utils_map_compute_if_absent.
+ *
+ * Reader-Lock: Concurrent operation.
+ * @param map Instance.
+ * @param key Key.
+ * @param delta Amount to add.
+ * @param result If not NULL, the counter after the addition is stored here.
+ * @return True if the key is present.
+ */
+bool c_utils_map_increment(struct c_utils_map *map, const void *key, int64_t delta, int64_t *result);
+
 /**
  * Obtains the item from the map through it's key.
  *
@@ -254,6 +473,21 @@ bool c_utils_map_add(struct c_utils_map *map, void *key, void *value);
  */
 void *c_utils_map_get(struct c_utils_map *map, const void *key);
 
+/**
+ * Obtains the item for each key, storing the item for keys[i] in values[i], or NULL if not found.
+ * All keys are hashed up front, and each shard is locked once per batch of up to 64 keys. While
+ * holding the lock, the slots of every key are prefetched before any are probed, so that the
+ * cache misses of a batch overlap rather than being taken one after another.
+ *
+ * Reader-Lock: Concurrent operation.
+ * @param map Instance.
+ * @param keys Keys.
+ * @param values Where the items found are stored.
+ * @param n Amount of keys.
+ * @return The amount of items found.
+ */
+size_t c_utils_map_get_batch(struct c_utils_map *map, const void **keys, void **values, size_t n);
+
 /**
  * Removes the item from the map, optionally deleting it by invoking del on it if not null.
  *
@@ -302,6 +536,17 @@ bool c_utils_map_for_each(struct c_utils_map *map, void (*callback)(const void *
  */
 size_t c_utils_map_size(struct c_utils_map *map);
 
+/**
+ * Reports the shape of the tables and, if C_UTILS_MAP_STATS is flagged, the counters. As every slot
+ * is inspected, this is O(capacity), and each shard is locked in turn.
+ *
+ * Reader-Lock: Concurrent operation.
+ * @param map Instance
+ * @param stats Filled in with the statistics.
+ * @return True if map and stats are not null.
+ */
+bool c_utils_map_stats(struct c_utils_map *map, struct c_utils_map_stats *stats);
+
 struct c_utils_iterator *c_utils_map_iterator(struct c_utils_map *map);
 
 /**
@@ -0,0 +1,519 @@
+#include "map_file.h"
+
+#include "../misc/alloc_check.h"
+#include "../io/logger.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+	The file is laid out as follows:
+
+	[header][slots][arena records and abandoned slot tables, in order of allocation]
+
+	The header records where the current table of slots is, and how much of the file has been allocated
+	so far (end). The file itself is grown geometrically ahead of end, so that it does not need to be
+	truncated and remapped on every allocation; the space between end and the end of the file is zeroed.
+
+	A slot refers to it's key and value by their offset in the file. As the header is at offset 0, no
+	record can ever be at offset 0, hence a key offset of 0 marks an empty slot. The table is probed
+	linearly and uses backward-shift deletion, so there are no tombstones.
+*/
+#define C_UTILS_MAP_FILE_MAGIC 0x50414d5354554355ULL
+
+#define C_UTILS_MAP_FILE_VERSION 1
+
+#define C_UTILS_MAP_FILE_ALIGN 8
+
+#define C_UTILS_MAP_FILE_ALIGN_UP(n, align) (((n) + (align) - 1) & ~((size_t)(align) - 1))
+
+struct c_utils_map_file_header {
+	/// Identifies the file as a map file.
+	uint64_t magic;
+	/// Format version.
+	uint32_t version;
+	uint32_t reserved;
+	/// Fixed key and value lengths, or 0 for NUL-terminated strings.
+	uint64_t key_len;
+	uint64_t value_len;
+	/// The amount of slots in the table, always a power of two.
+	uint64_t capacity;
+	/// The amount of key-value pairs.
+	uint64_t size;
+	/// Offset of the table of slots.
+	uint64_t slots;
+	/// Offset of the first unallocated byte.
+	uint64_t end;
+};
+
+struct c_utils_map_file_slot {
+	/// Offset of the key record, or 0 if empty.
+	uint64_t key;
+	/// Offset of the value record.
+	uint64_t value;
+	/// Hash of the key, so we never need to rehash it.
+	uint32_t hash;
+	uint32_t padding;
+};
+
+struct c_utils_map_file_record {
+	/// Length of the data.
+	uint32_t length;
+	char data[];
+};
+
+struct c_utils_map_file {
+	/// File descriptor of the backing file.
+	int fd;
+	/// Start of the mapping.
+	char *base;
+	/// Length of the mapping, which is always the size of the file.
+	size_t length;
+	bool read_only;
+	/// What we need of the configuration.
+	uint32_t (*hash_function)(const void *key);
+	double growth_ratio;
+	double growth_trigger;
+	struct c_utils_logger *logger;
+};
+
+static const int default_initial = 64;
+static const double default_growth_rate = 2;
+static const double default_growth_trigger = .5;
+
+_Static_assert(sizeof(struct c_utils_map_file_header) == 64, "Map file header must remain 64 bytes!");
+_Static_assert(sizeof(struct c_utils_map_file_slot) == 24, "Map file slot must remain 24 bytes!");
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Map File Helper Functions                                   //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static struct c_utils_map_file_header *get_header(struct c_utils_map_file *map);
+
+static struct c_utils_map_file_slot *get_slots(struct c_utils_map_file *map);
+
+static struct c_utils_map_file_record *get_record(struct c_utils_map_file *map, uint64_t offset);
+
+static size_t get_length(size_t fixed, const void *data);
+
+static uint32_t get_hash(struct c_utils_map_file *map, const void *key);
+
+static uint32_t hash_key(const void *key, size_t len);
+
+static size_t find_slot(struct c_utils_map_file *map, const void *key, uint32_t hash);
+
+static uint64_t allocate(struct c_utils_map_file *map, size_t size);
+
+static uint64_t allocate_record(struct c_utils_map_file *map, const void *data, size_t length);
+
+static bool resize(struct c_utils_map_file *map, size_t capacity);
+
+static size_t round_capacity(size_t capacity);
+
+static bool validate(struct c_utils_map_file *map, struct c_utils_map_conf *conf);
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Map File Core Functions                                     //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+struct c_utils_map_file *c_utils_map_file_open(const char *path, int flags, struct c_utils_map_conf *conf) {
+	struct c_utils_map_conf default_conf = { 0 };
+	if(!conf)
+		conf = &default_conf;
+
+	if(!path) {
+		C_UTILS_LOG_ERROR(conf->logger, "No path was given!");
+		return NULL;
+	}
+
+	struct c_utils_map_file *map;
+	C_UTILS_ON_BAD_MALLOC(map, conf->logger, sizeof(*map))
+		return NULL;
+
+	map->read_only = flags & C_UTILS_MAP_FILE_READ_ONLY;
+	map->hash_function = conf->callbacks.hash_function;
+	map->growth_ratio = conf->growth.ratio > 1 ? conf->growth.ratio : default_growth_rate;
+	map->growth_trigger = conf->growth.trigger > 0 && conf->growth.trigger < 1 ?
+		conf->growth.trigger : default_growth_trigger;
+	map->logger = conf->logger;
+	map->base = NULL;
+
+	int oflags = map->read_only ? O_RDONLY : O_RDWR | O_CREAT;
+	if(!map->read_only && flags & C_UTILS_MAP_FILE_TRUNCATE)
+		oflags |= O_TRUNC;
+
+	map->fd = open(path, oflags, 0644);
+	if(map->fd == -1) {
+		C_UTILS_LOG_ERROR(conf->logger, "open: \"%s\"", strerror(errno));
+		goto err_open;
+	}
+
+	struct stat st;
+	if(fstat(map->fd, &st) == -1) {
+		C_UTILS_LOG_ERROR(conf->logger, "fstat: \"%s\"", strerror(errno));
+		goto err_map;
+	}
+
+	bool created = st.st_size == 0;
+	size_t capacity = round_capacity(conf->size.initial ? conf->size.initial : default_initial);
+	if(created) {
+		if(map->read_only) {
+			C_UTILS_LOG_ERROR(conf->logger, "\"%s\" is empty and can not be created when opened read-only!", path);
+			goto err_map;
+		}
+
+		size_t length = C_UTILS_MAP_FILE_ALIGN_UP(sizeof(struct c_utils_map_file_header) +
+			capacity * sizeof(struct c_utils_map_file_slot), sysconf(_SC_PAGESIZE));
+
+		if(ftruncate(map->fd, length) == -1) {
+			C_UTILS_LOG_ERROR(conf->logger, "ftruncate: \"%s\"", strerror(errno));
+			goto err_map;
+		}
+
+		st.st_size = length;
+	}
+
+	map->length = st.st_size;
+	map->base = mmap(NULL, map->length, map->read_only ? PROT_READ : PROT_READ | PROT_WRITE,
+		MAP_SHARED, map->fd, 0);
+	if(map->base == MAP_FAILED) {
+		C_UTILS_LOG_ERROR(conf->logger, "mmap: \"%s\"", strerror(errno));
+		map->base = NULL;
+		goto err_map;
+	}
+
+	if(created) {
+		// The file was just extended with zeroes, so the table is already empty.
+		struct c_utils_map_file_header *header = get_header(map);
+		header->magic = C_UTILS_MAP_FILE_MAGIC;
+		header->version = C_UTILS_MAP_FILE_VERSION;
+		header->key_len = conf->length.key;
+		header->value_len = conf->length.value;
+		header->capacity = capacity;
+		header->size = 0;
+		header->slots = sizeof(*header);
+		header->end = header->slots + header->capacity * sizeof(struct c_utils_map_file_slot);
+	} else if(!validate(map, conf)) {
+		C_UTILS_LOG_ERROR(conf->logger, "\"%s\" is not a valid map file!", path);
+		goto err_map;
+	}
+
+	return map;
+
+	err_map:
+		if(map->base)
+			munmap(map->base, map->length);
+		close(map->fd);
+	err_open:
+		free(map);
+		return NULL;
+}
+
+bool c_utils_map_file_add(struct c_utils_map_file *map, const void *key, const void *value) {
+	if(!map || !key || !value)
+		return false;
+
+	if(map->read_only) {
+		C_UTILS_LOG_ERROR(map->logger, "Attempt to add to a map file opened read-only!");
+		return false;
+	}
+
+	uint32_t hash = get_hash(map, key);
+	if(find_slot(map, key, hash) != SIZE_MAX)
+		return false;
+
+	struct c_utils_map_file_header *header = get_header(map);
+	if((header->size + 1) / (double)header->capacity >= map->growth_trigger
+		&& !resize(map, header->capacity * map->growth_ratio))
+		return false;
+
+	// Allocating may remap the file, so nothing within the mapping may be held onto across it.
+	uint64_t key_off = allocate_record(map, key, get_length(get_header(map)->key_len, key));
+	if(!key_off)
+		return false;
+
+	uint64_t value_off = allocate_record(map, value, get_length(get_header(map)->value_len, value));
+	if(!value_off)
+		return false;
+
+	header = get_header(map);
+	struct c_utils_map_file_slot *slots = get_slots(map);
+	size_t index = hash & (header->capacity - 1);
+	while(slots[index].key)
+		index = (index + 1) & (header->capacity - 1);
+
+	slots[index] = (struct c_utils_map_file_slot) { .key = key_off, .value = value_off, .hash = hash };
+	header->size++;
+
+	return true;
+}
+
+const void *c_utils_map_file_get(struct c_utils_map_file *map, const void *key) {
+	if(!map || !key)
+		return NULL;
+
+	size_t index = find_slot(map, key, get_hash(map, key));
+	if(index == SIZE_MAX)
+		return NULL;
+
+	return get_record(map, get_slots(map)[index].value)->data;
+}
+
+bool c_utils_map_file_remove(struct c_utils_map_file *map, const void *key) {
+	if(!map || !key)
+		return false;
+
+	if(map->read_only) {
+		C_UTILS_LOG_ERROR(map->logger, "Attempt to remove from a map file opened read-only!");
+		return false;
+	}
+
+	size_t index = find_slot(map, key, get_hash(map, key));
+	if(index == SIZE_MAX)
+		return false;
+
+	struct c_utils_map_file_header *header = get_header(map);
+	struct c_utils_map_file_slot *slots = get_slots(map);
+	size_t mask = header->capacity - 1;
+
+	// Backward-shift deletion: move any entry which is displaced past the hole back into it.
+	size_t hole = index;
+	for(size_t i = (hole + 1) & mask; slots[i].key; i = (i + 1) & mask) {
+		size_t home = slots[i].hash & mask;
+		if(((i - home) & mask) >= ((i - hole) & mask)) {
+			slots[hole] = slots[i];
+			hole = i;
+		}
+	}
+
+	slots[hole] = (struct c_utils_map_file_slot) { 0 };
+	header->size--;
+
+	return true;
+}
+
+size_t c_utils_map_file_size(struct c_utils_map_file *map) {
+	if(!map)
+		return 0;
+
+	return get_header(map)->size;
+}
+
+bool c_utils_map_file_sync(struct c_utils_map_file *map) {
+	if(!map)
+		return false;
+
+	if(map->read_only)
+		return true;
+
+	if(msync(map->base, map->length, MS_SYNC) == -1) {
+		C_UTILS_LOG_ERROR(map->logger, "msync: \"%s\"", strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+void c_utils_map_file_close(struct c_utils_map_file *map) {
+	if(!map)
+		return;
+
+	munmap(map->base, map->length);
+	close(map->fd);
+	free(map);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Map File Helper Functions                                   //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static struct c_utils_map_file_header *get_header(struct c_utils_map_file *map) {
+	return (struct c_utils_map_file_header *)map->base;
+}
+
+static struct c_utils_map_file_slot *get_slots(struct c_utils_map_file *map) {
+	return (struct c_utils_map_file_slot *)(map->base + get_header(map)->slots);
+}
+
+static struct c_utils_map_file_record *get_record(struct c_utils_map_file *map, uint64_t offset) {
+	return (struct c_utils_map_file_record *)(map->base + offset);
+}
+
+/// Strings are stored with their terminator, so that they can be used straight out of the mapping.
+static size_t get_length(size_t fixed, const void *data) {
+	return fixed ? fixed : strlen(data) + 1;
+}
+
+/// Hashes the same bytes as c_utils_map does, so that both agree on the default hash of a key.
+static uint32_t get_hash(struct c_utils_map_file *map, const void *key) {
+	if(map->hash_function)
+		return map->hash_function(key);
+
+	size_t key_len = get_header(map)->key_len;
+	return hash_key(key, key_len ? key_len : strlen(key));
+}
+
+/// Bob Jenkin's one-at-a-time hash, which is stable between runs.
+static uint32_t hash_key(const void *key, size_t len) {
+	const unsigned char *k = key;
+	uint32_t hash = 0;
+
+	for (uint32_t i = 0;i < len; ++i) {
+		hash += k[i];
+		hash += (hash << 10);
+		hash ^= (hash >> 6);
+	}
+
+	hash += (hash << 3);
+	hash ^= (hash >> 11);
+	hash += (hash << 15);
+
+	return hash;
+}
+
+/// Returns the index of the slot holding the key, or SIZE_MAX if it is not present.
+static size_t find_slot(struct c_utils_map_file *map, const void *key, uint32_t hash) {
+	struct c_utils_map_file_header *header = get_header(map);
+	struct c_utils_map_file_slot *slots = get_slots(map);
+	size_t mask = header->capacity - 1;
+	size_t length = get_length(header->key_len, key);
+
+	for(size_t i = hash & mask; slots[i].key; i = (i + 1) & mask) {
+		if(slots[i].hash != hash)
+			continue;
+
+		struct c_utils_map_file_record *record = get_record(map, slots[i].key);
+		if(record->length == length && memcmp(record->data, key, length) == 0)
+			return i;
+	}
+
+	return SIZE_MAX;
+}
+
+/// Allocates from the end of the file, growing it if needed. Returns 0 on failure.
+static uint64_t allocate(struct c_utils_map_file *map, size_t size) {
+	struct c_utils_map_file_header *header = get_header(map);
+	uint64_t offset = C_UTILS_MAP_FILE_ALIGN_UP(header->end, C_UTILS_MAP_FILE_ALIGN);
+	uint64_t end = offset + size;
+
+	if(end > map->length) {
+		size_t length = map->length * 2;
+		if(length < end)
+			length = C_UTILS_MAP_FILE_ALIGN_UP(end, sysconf(_SC_PAGESIZE));
+
+		if(ftruncate(map->fd, length) == -1) {
+			C_UTILS_LOG_ERROR(map->logger, "ftruncate: \"%s\"", strerror(errno));
+			return 0;
+		}
+
+		void *base = mremap(map->base, map->length, length, MREMAP_MAYMOVE);
+		if(base == MAP_FAILED) {
+			C_UTILS_LOG_ERROR(map->logger, "mremap: \"%s\"", strerror(errno));
+			return 0;
+		}
+
+		map->base = base;
+		map->length = length;
+		header = get_header(map);
+	}
+
+	header->end = end;
+	return offset;
+}
+
+static uint64_t allocate_record(struct c_utils_map_file *map, const void *data, size_t length) {
+	if(length > UINT32_MAX) {
+		C_UTILS_LOG_ERROR(map->logger, "A record of %zu bytes is too large!", length);
+		return 0;
+	}
+
+	uint64_t offset = allocate(map, sizeof(struct c_utils_map_file_record) + length);
+	if(!offset)
+		return 0;
+
+	struct c_utils_map_file_record *record = get_record(map, offset);
+	record->length = length;
+	memcpy(record->data, data, length);
+
+	return offset;
+}
+
+/*
+	Allocates a new table at the end of the file and moves every slot into it, using the stored hashes. The
+	old table is abandoned; as only offsets are stored, the records themselves never move.
+*/
+static bool resize(struct c_utils_map_file *map, size_t capacity) {
+	capacity = round_capacity(capacity);
+
+	uint64_t offset = allocate(map, capacity * sizeof(struct c_utils_map_file_slot));
+	if(!offset)
+		return false;
+
+	struct c_utils_map_file_header *header = get_header(map);
+	struct c_utils_map_file_slot *old_slots = get_slots(map);
+	struct c_utils_map_file_slot *new_slots = (struct c_utils_map_file_slot *)(map->base + offset);
+	size_t mask = capacity - 1;
+
+	for(size_t i = 0; i < header->capacity; i++) {
+		if(!old_slots[i].key)
+			continue;
+
+		size_t index = old_slots[i].hash & mask;
+		while(new_slots[index].key)
+			index = (index + 1) & mask;
+
+		new_slots[index] = old_slots[i];
+	}
+
+	header->slots = offset;
+	header->capacity = capacity;
+
+	return true;
+}
+
+static size_t round_capacity(size_t capacity) {
+	size_t rounded = 16;
+	while(rounded < capacity)
+		rounded <<= 1;
+
+	return rounded;
+}
+
+/// Ensures the header of an existing file is sane before we trust any offset within it.
+static bool validate(struct c_utils_map_file *map, struct c_utils_map_conf *conf) {
+	if(map->length < sizeof(struct c_utils_map_file_header))
+		return false;
+
+	struct c_utils_map_file_header *header = get_header(map);
+	if(header->magic != C_UTILS_MAP_FILE_MAGIC || header->version != C_UTILS_MAP_FILE_VERSION)
+		return false;
+
+	if((conf->length.key && conf->length.key != header->key_len) ||
+		(conf->length.value && conf->length.value != header->value_len)) {
+		C_UTILS_LOG_ERROR(map->logger, "Key and value lengths do not match those the file was created with!");
+		return false;
+	}
+
+	if(!header->capacity || (header->capacity & (header->capacity - 1)) || header->size >= header->capacity)
+		return false;
+
+	return header->end <= map->length && header->slots >= sizeof(*header) &&
+		header->slots + header->capacity * sizeof(struct c_utils_map_file_slot) <= header->end;
+}
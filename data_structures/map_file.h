@@ -0,0 +1,112 @@
+#ifndef C_UTILS_MAP_FILE_H
+#define C_UTILS_MAP_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "map.h"
+#include "../io/logger.h"
+
+/*
+	A persistent hash map which lives entirely inside of a memory-mapped file, so that it can be re-opened
+	without rebuilding or rehashing anything; opening it is a single mmap.
+
+	The file starts with a header, followed by regions which are bump-allocated from the end of the file:
+	the table of slots and an arena of key and value records. Every reference inside of the file is an offset
+	from the start of the file rather than a pointer, hence the file may be mapped at any address. A record in
+	the arena is a 32-bit length followed by it's bytes. Keys and values are fixed-size if length.key or
+	length.value of the configuration is specified, otherwise they are treated as NUL-terminated strings.
+
+	When the table grows, a new table is allocated at the end of the file and the old one is abandoned, and
+	removing a pair does not reclaim it's records in the arena, hence the file only ever grows. As the table
+	grows geometrically, the abandoned tables never add up to more than the size of the current table.
+
+	Opening with C_UTILS_MAP_FILE_READ_ONLY maps the file shared and read-only, so that every process which
+	opens the same file shares the same physical pages. The file is in native byte order and is not portable
+	between machines of different endianness. The hash function must be stable between runs, as the hashes are
+	persisted; the default hash is.
+
+	The map file is not thread-safe. As the file may be remapped whenever it grows, any pointer returned by
+	c_utils_map_file_get is only valid until the next modification.
+*/
+struct c_utils_map_file;
+
+#define C_UTILS_MAP_FILE_READ_ONLY 1 << 0
+#define C_UTILS_MAP_FILE_TRUNCATE 1 << 1
+
+#ifdef NO_C_UTILS_PREFIX
+/*
+	Typedefs
+*/
+typedef struct c_utils_map_file map_file_t;
+
+/*
+	Functions
+*/
+#define map_file_open(...) c_utils_map_file_open(__VA_ARGS__)
+#define map_file_add(...) c_utils_map_file_add(__VA_ARGS__)
+#define map_file_get(...) c_utils_map_file_get(__VA_ARGS__)
+#define map_file_remove(...) c_utils_map_file_remove(__VA_ARGS__)
+#define map_file_size(...) c_utils_map_file_size(__VA_ARGS__)
+#define map_file_sync(...) c_utils_map_file_sync(__VA_ARGS__)
+#define map_file_close(...) c_utils_map_file_close(__VA_ARGS__)
+#endif
+
+/**
+ * Opens the map file at the given path, creating it if it does not exist and it is not opened read-only.
+ * Only the key and value lengths, initial size, growth trigger, hash function and logger of the configuration
+ * are used. If the file already exists, the key and value lengths must match those it was created with.
+ *
+ * @param path Path to the file.
+ * @param flags C_UTILS_MAP_FILE_READ_ONLY and/or C_UTILS_MAP_FILE_TRUNCATE.
+ * @param conf Configuration, may be NULL for the defaults.
+ * @return Instance, or NULL if the file could not be opened, mapped, or is not a valid map file.
+ */
+struct c_utils_map_file *c_utils_map_file_open(const char *path, int flags, struct c_utils_map_conf *conf);
+
+/**
+ * Copies the key and value into the file.
+ *
+ * @param map Instance.
+ * @param key Key.
+ * @param value Value.
+ * @return True if added, false if the key is already present, read-only, or the file could not grow.
+ */
+bool c_utils_map_file_add(struct c_utils_map_file *map, const void *key, const void *value);
+
+/**
+ * Obtains the value associated with the key.
+ *
+ * @param map Instance.
+ * @param key Key.
+ * @return Pointer to the value inside of the mapping, valid until the next modification, or NULL if not found.
+ */
+const void *c_utils_map_file_get(struct c_utils_map_file *map, const void *key);
+
+/**
+ * Removes the key and it's value. Their records in the arena are not reclaimed.
+ *
+ * @param map Instance.
+ * @param key Key.
+ * @return True if removed, false if not found or read-only.
+ */
+bool c_utils_map_file_remove(struct c_utils_map_file *map, const void *key);
+
+size_t c_utils_map_file_size(struct c_utils_map_file *map);
+
+/**
+ * Flushes the mapping to disk, blocking until it has been written.
+ *
+ * @param map Instance.
+ * @return True if successful.
+ */
+bool c_utils_map_file_sync(struct c_utils_map_file *map);
+
+/**
+ * Unmaps and closes the file. Any changes not yet flushed are written back by the operating system.
+ *
+ * @param map Instance.
+ */
+void c_utils_map_file_close(struct c_utils_map_file *map);
+
+#endif /* C_UTILS_MAP_FILE_H */
@@ -0,0 +1,315 @@
+#ifndef C_UTILS_MAP_TEMPLATE_H
+#define C_UTILS_MAP_TEMPLATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+	A hash map specialized at compile time to concrete key and value types, for when the overhead of
+	c_utils_map's void pointers, runtime key lengths and callbacks matters more than it's features.
+
+	C_UTILS_MAP_DECLARE(name, K, V) declares struct name and a family of static inline functions prefixed
+	with name_, for example:
+
+		C_UTILS_MAP_DECLARE(conn_map, uint64_t, struct conn *)
+
+		struct conn_map *map = conn_map_create(0);
+		conn_map_add(map, id, conn);
+		struct conn **conn = conn_map_get(map, id);
+
+	Keys and values are stored inline in the table, so there is no allocation per pair, and the key's
+	hash and equality are inlined into each probe. By default, keys are hashed and compared by their bytes,
+	which is only correct for keys without padding or pointers to the data which should be compared;
+	C_UTILS_MAP_DECLARE_CUSTOM(name, K, V, hash, equal) takes a uint64_t hash(K) and a bool equal(K, K)
+	instead, which may be functions or macros.
+
+	The table has the same layout as c_utils_map's: a packed array of control bytes holding a 7-bit tag of
+	each key's hash, scanned a group at a time, and linear probing with backward-shift deletion. It does not
+	keep hashes, migrate incrementally or lock, so it is not thread-safe, and grows all at once when it is
+	7/8 full.
+*/
+
+#define C_UTILS_MAP_TEMPLATE_GROUP_WIDTH 16
+
+#define C_UTILS_MAP_TEMPLATE_CTRL_EMPTY ((int8_t) 0)
+
+#define C_UTILS_MAP_TEMPLATE_TAG(hash) ((int8_t) (((hash) >> 57) | 0x80))
+
+#define C_UTILS_MAP_TEMPLATE_DEFAULT_CAPACITY 16
+
+#ifdef NO_C_UTILS_PREFIX
+/*
+	Macros
+*/
+#define MAP_DECLARE(...) C_UTILS_MAP_DECLARE(__VA_ARGS__)
+#define MAP_DECLARE_CUSTOM(...) C_UTILS_MAP_DECLARE_CUSTOM(__VA_ARGS__)
+#endif
+
+/// Hashes size bytes a word at a time. As size is usually a constant, the loop is unrolled away entirely.
+static inline uint64_t _c_utils_map_template_hash(const void *key, size_t size) {
+	const unsigned char *bytes = key;
+	uint64_t hash = size * 0x9E3779B97F4A7C15ULL, word;
+
+	for(; size >= sizeof(word); size -= sizeof(word), bytes += sizeof(word)) {
+		memcpy(&word, bytes, sizeof(word));
+		hash = (hash ^ word) * 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 32;
+	}
+
+	if(size) {
+		word = 0;
+		memcpy(&word, bytes, size);
+		hash = (hash ^ word) * 0xff51afd7ed558ccdULL;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+static inline uint32_t _c_utils_map_template_match(const int8_t *group, int8_t tag) {
+#ifdef __SSE2__
+	__m128i ctrl = _mm_loadu_si128((const __m128i *) group);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl));
+#else
+	uint32_t mask = 0;
+	for(int i = 0; i < C_UTILS_MAP_TEMPLATE_GROUP_WIDTH; i++)
+		mask |= (uint32_t) (group[i] == tag) << i;
+
+	return mask;
+#endif
+}
+
+/// Sets the control byte, as well as it's clone if it is within the first group.
+static inline void _c_utils_map_template_set_ctrl(int8_t *ctrl, size_t capacity, size_t index, int8_t value) {
+	ctrl[index] = value;
+
+	if(index < C_UTILS_MAP_TEMPLATE_GROUP_WIDTH - 1)
+		ctrl[capacity + index] = value;
+}
+
+static inline size_t _c_utils_map_template_round_capacity(size_t size) {
+	size_t capacity = C_UTILS_MAP_TEMPLATE_GROUP_WIDTH;
+	while(capacity < size)
+		capacity <<= 1;
+
+	return capacity;
+}
+
+#define C_UTILS_MAP_DECLARE(name, K, V) \
+	static inline uint64_t name##_hash_bytes(K key) { \
+		return _c_utils_map_template_hash(&key, sizeof(K)); \
+	} \
+	\
+	static inline bool name##_equal_bytes(K a, K b) { \
+		return memcmp(&a, &b, sizeof(K)) == 0; \
+	} \
+	\
+	C_UTILS_MAP_DECLARE_CUSTOM(name, K, V, name##_hash_bytes, name##_equal_bytes)
+
+#define C_UTILS_MAP_DECLARE_CUSTOM(name, K, V, hash, equal) \
+	struct name##_slot { \
+		K key; \
+		V value; \
+	}; \
+	\
+	struct name { \
+		/* The amount of slots, always a power of two. */ \
+		size_t capacity; \
+		size_t mask; \
+		size_t size; \
+		/* Control bytes, one per slot plus a clone of the first group. */ \
+		int8_t *ctrl; \
+		struct name##_slot *slots; \
+	}; \
+	\
+	static inline bool name##_allocate(struct name *map, size_t capacity) { \
+		int8_t *ctrl = calloc(capacity + C_UTILS_MAP_TEMPLATE_GROUP_WIDTH - 1, sizeof(*ctrl)); \
+		struct name##_slot *slots = malloc(capacity * sizeof(*slots)); \
+		if(!ctrl || !slots) { \
+			free(ctrl); \
+			free(slots); \
+			return false; \
+		} \
+		\
+		map->capacity = capacity; \
+		map->mask = capacity - 1; \
+		map->ctrl = ctrl; \
+		map->slots = slots; \
+		\
+		return true; \
+	} \
+	\
+	/* Returns the index of the key, or capacity if not present. */ \
+	static inline size_t name##_find(const struct name *map, K key, uint64_t h) { \
+		int8_t tag = C_UTILS_MAP_TEMPLATE_TAG(h); \
+		size_t pos = h & map->mask; \
+		\
+		for(size_t probed = 0; probed < map->capacity; probed += C_UTILS_MAP_TEMPLATE_GROUP_WIDTH) { \
+			const int8_t *group = map->ctrl + pos; \
+			\
+			for(uint32_t match = _c_utils_map_template_match(group, tag); match; match &= match - 1) { \
+				size_t index = (pos + __builtin_ctz(match)) & map->mask; \
+				if(equal(map->slots[index].key, key)) \
+					return index; \
+			} \
+			\
+			if(_c_utils_map_template_match(group, C_UTILS_MAP_TEMPLATE_CTRL_EMPTY)) \
+				break; \
+			\
+			pos = (pos + C_UTILS_MAP_TEMPLATE_GROUP_WIDTH) & map->mask; \
+		} \
+		\
+		return map->capacity; \
+	} \
+	\
+	static inline size_t name##_find_empty(const struct name *map, uint64_t h) { \
+		size_t pos = h & map->mask; \
+		\
+		for(;;) { \
+			uint32_t empty = _c_utils_map_template_match(map->ctrl + pos, C_UTILS_MAP_TEMPLATE_CTRL_EMPTY); \
+			if(empty) \
+				return (pos + __builtin_ctz(empty)) & map->mask; \
+			\
+			pos = (pos + C_UTILS_MAP_TEMPLATE_GROUP_WIDTH) & map->mask; \
+		} \
+	} \
+	\
+	static inline bool name##_resize(struct name *map, size_t capacity) { \
+		struct name old = *map; \
+		if(!name##_allocate(map, capacity)) \
+			return false; \
+		\
+		for(size_t i = 0; i < old.capacity; i++) { \
+			if(old.ctrl[i] >= 0) \
+				continue; \
+			\
+			size_t index = name##_find_empty(map, hash(old.slots[i].key)); \
+			map->slots[index] = old.slots[i]; \
+			_c_utils_map_template_set_ctrl(map->ctrl, map->capacity, index, old.ctrl[i]); \
+		} \
+		\
+		free(old.ctrl); \
+		free(old.slots); \
+		\
+		return true; \
+	} \
+	\
+	/* Creates a map with room for at least initial pairs before it grows, or the default if 0. */ \
+	static inline struct name *name##_create(size_t initial) { \
+		struct name *map = malloc(sizeof(*map)); \
+		if(!map) \
+			return NULL; \
+		\
+		size_t capacity = _c_utils_map_template_round_capacity(initial ? initial + initial / 7 + 1 : C_UTILS_MAP_TEMPLATE_DEFAULT_CAPACITY); \
+		if(!name##_allocate(map, capacity)) { \
+			free(map); \
+			return NULL; \
+		} \
+		\
+		map->size = 0; \
+		\
+		return map; \
+	} \
+	\
+	/* Returns false if the key is already present, or the map was unable to grow. */ \
+	static inline bool name##_add(struct name *map, K key, V value) { \
+		uint64_t h = hash(key); \
+		if(name##_find(map, key, h) != map->capacity) \
+			return false; \
+		\
+		if((map->size + 1) * 8 > map->capacity * 7 && !name##_resize(map, map->capacity * 2)) \
+			return false; \
+		\
+		size_t index = name##_find_empty(map, h); \
+		map->slots[index] = (struct name##_slot) { .key = key, .value = value }; \
+		_c_utils_map_template_set_ctrl(map->ctrl, map->capacity, index, C_UTILS_MAP_TEMPLATE_TAG(h)); \
+		map->size++; \
+		\
+		return true; \
+	} \
+	\
+	/* Returns a pointer to the value stored in the map, valid until the next add or remove, or NULL. */ \
+	static inline V *name##_get(const struct name *map, K key) { \
+		size_t index = name##_find(map, key, hash(key)); \
+		return index != map->capacity ? &map->slots[index].value : NULL; \
+	} \
+	\
+	static inline bool name##_contains(const struct name *map, K key) { \
+		return name##_find(map, key, hash(key)) != map->capacity; \
+	} \
+	\
+	/* Removes the pair, storing it's value in value if not NULL. Returns false if not present. */ \
+	static inline bool name##_remove(struct name *map, K key, V *value) { \
+		size_t hole = name##_find(map, key, hash(key)); \
+		if(hole == map->capacity) \
+			return false; \
+		\
+		if(value) \
+			*value = map->slots[hole].value; \
+		\
+		/* Backward-shift deletion, as in c_utils_map, but rehashing each key to find it's home slot. */ \
+		for(size_t i = (hole + 1) & map->mask; map->ctrl[i] != C_UTILS_MAP_TEMPLATE_CTRL_EMPTY; i = (i + 1) & map->mask) { \
+			size_t home = hash(map->slots[i].key) & map->mask; \
+			if(((i - home) & map->mask) >= ((i - hole) & map->mask)) { \
+				map->slots[hole] = map->slots[i]; \
+				_c_utils_map_template_set_ctrl(map->ctrl, map->capacity, hole, map->ctrl[i]); \
+				hole = i; \
+			} \
+		} \
+		\
+		_c_utils_map_template_set_ctrl(map->ctrl, map->capacity, hole, C_UTILS_MAP_TEMPLATE_CTRL_EMPTY); \
+		map->size--; \
+		\
+		return true; \
+	} \
+	\
+	/* \
+		Iterates over every pair: pos must start at 0, and is advanced past each pair returned. Returns \
+		false once there are no more. The map must not be modified while iterating. \
+	*/ \
+	static inline bool name##_next(const struct name *map, size_t *pos, K *key, V *value) { \
+		for(; *pos < map->capacity; (*pos)++) { \
+			if(map->ctrl[*pos] >= 0) \
+				continue; \
+			\
+			if(key) \
+				*key = map->slots[*pos].key; \
+			if(value) \
+				*value = map->slots[*pos].value; \
+			\
+			(*pos)++; \
+			return true; \
+		} \
+		\
+		return false; \
+	} \
+	\
+	static inline size_t name##_size(const struct name *map) { \
+		return map->size; \
+	} \
+	\
+	static inline void name##_clear(struct name *map) { \
+		memset(map->ctrl, C_UTILS_MAP_TEMPLATE_CTRL_EMPTY, map->capacity + C_UTILS_MAP_TEMPLATE_GROUP_WIDTH - 1); \
+		map->size = 0; \
+	} \
+	\
+	static inline void name##_destroy(struct name *map) { \
+		if(!map) \
+			return; \
+		\
+		free(map->ctrl); \
+		free(map->slots); \
+		free(map); \
+	}
+
+#endif /* C_UTILS_MAP_TEMPLATE_H */
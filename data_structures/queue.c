@@ -5,6 +5,7 @@
 #include <pthread.h>
 
 #include "../memory/hazard.h"
+#include "../memory/node_pool.h"
 #include "../io/logger.h"
 #include "../misc/alloc_check.h"
 #include "../misc/argument_check.h"
@@ -13,20 +14,39 @@ struct c_utils_queue {
 	struct c_utils_node *head;
 	struct c_utils_node *tail;
 	volatile size_t size;
+	struct c_utils_queue_conf conf;
 };
 
 static struct c_utils_logger *logger = NULL;
 
 C_UTILS_LOGGER_AUTO_CREATE(logger, "./data_structures/logs/queue.log", "w", C_UTILS_LOG_LEVEL_ALL);
 
+static struct c_utils_node *create_node(struct c_utils_queue *queue);
+
+static void free_node(struct c_utils_queue *queue, struct c_utils_node *node);
+
 struct c_utils_queue *c_utils_queue_create(void) {
+	struct c_utils_queue_conf conf = {};
+	return c_utils_queue_create_conf(&conf);
+}
+
+struct c_utils_queue *c_utils_queue_create_conf(struct c_utils_queue_conf *conf) {
+	C_UTILS_ARG_CHECK(logger, NULL, conf);
+
+	if(conf->pool && c_utils_node_pool_node_size(conf->pool) < sizeof(struct c_utils_node)) {
+		C_UTILS_LOG_ERROR(logger, "The pool's nodes of %zu bytes are too small!", c_utils_node_pool_node_size(conf->pool));
+		goto err;
+	}
+
  	struct c_utils_queue *queue;
 	C_UTILS_ON_BAD_CALLOC(queue, logger, sizeof(*queue))
 		goto err;
 
+	queue->conf = *conf;
+
 	// Our dummy node, the queue will always contain one element.
-	struct c_utils_node *node;
-	C_UTILS_ON_BAD_CALLOC(node, logger, sizeof(*node))
+	struct c_utils_node *node = create_node(queue);
+	if(!node)
 		goto err_node;
 
 	queue->head = queue->tail = node;
@@ -42,8 +62,8 @@ struct c_utils_queue *c_utils_queue_create(void) {
 bool c_utils_queue_enqueue(struct c_utils_queue *queue, void *data) {
 	C_UTILS_ARG_CHECK(logger, false, queue);
 
-	struct c_utils_node *node;
-	C_UTILS_ON_BAD_CALLOC(node, logger, sizeof(*node))
+	struct c_utils_node *node = create_node(queue);
+	if(!node)
 		return false;
 	node->item = data;
 
@@ -51,7 +71,7 @@ bool c_utils_queue_enqueue(struct c_utils_queue *queue, void *data) {
 	struct c_utils_node *next;
 	while (true) {
 		tail = queue->tail;
-		c_utils_hazard_acquire(0, tail);
+		c_utils_hazard_acquire(C_UTILS_HAZARD_INDEX_QUEUE, tail);
 		// Sanity check.
 		if (tail != queue->tail) {
 			pthread_yield();
@@ -93,7 +113,7 @@ void *c_utils_queue_dequeue(struct c_utils_queue *queue) {
 	void *item;
 	while (true) {
 		head = queue->head;
-		c_utils_hazard_acquire(0, head);
+		c_utils_hazard_acquire(C_UTILS_HAZARD_INDEX_QUEUE, head);
 		// Sanity check.
 		if (head != queue->head) {
 			pthread_yield();
@@ -102,7 +122,9 @@ void *c_utils_queue_dequeue(struct c_utils_queue *queue) {
 		
 		tail = queue->tail;
 		next = head->next;
-		c_utils_hazard_acquire(1, next);
+		// An empty queue has no next node to protect, and acquiring NULL would only log an error.
+		if (next)
+			c_utils_hazard_acquire(C_UTILS_HAZARD_INDEX_QUEUE + 1, next);
 		// Sanity check.
 		if (head != queue->head) {
 			pthread_yield();
@@ -111,7 +133,9 @@ void *c_utils_queue_dequeue(struct c_utils_queue *queue) {
 		
 		// Is Empty.
 		if (next == NULL) {
-			c_utils_hazard_release_all(false);
+			// An earlier attempt may have left the next node of an outdated head protected.
+			c_utils_hazard_release_at(C_UTILS_HAZARD_INDEX_QUEUE, false);
+			c_utils_hazard_release_at(C_UTILS_HAZARD_INDEX_QUEUE + 1, false);
 			return NULL;
 		}
 		
@@ -131,7 +155,10 @@ void *c_utils_queue_dequeue(struct c_utils_queue *queue) {
 		pthread_yield();
 	}
 	// We make sure to retire the head (or old head) popped from the queue, but not the next node (or new head).
-	c_utils_hazard_release(head, true);
+	if(queue->conf.pool)
+		c_utils_node_pool_retire(head);
+	else
+		c_utils_hazard_release(head, true);
 	c_utils_hazard_release(next, false);
 	
 	return item;
@@ -140,18 +167,37 @@ void *c_utils_queue_dequeue(struct c_utils_queue *queue) {
 bool c_utils_queue_destroy(struct c_utils_queue *queue, c_utils_delete_cb del) {
 	C_UTILS_ARG_CHECK(logger, false, queue);
 	
-	c_utils_hazard_release_all(false);
+	c_utils_hazard_release_at(C_UTILS_HAZARD_INDEX_QUEUE, false);
+	c_utils_hazard_release_at(C_UTILS_HAZARD_INDEX_QUEUE + 1, false);
 	
 	struct c_utils_node *prev_node = NULL, *node;
 	for (node = queue->head; node; node = node->next) {
-		free(prev_node);
+		free_node(queue, prev_node);
 		if (del) 
 			del(node->item);
 
 		prev_node = node;
 	}
-	free(prev_node);
+	free_node(queue, prev_node);
 	free(queue);
 	
 	return true;
 }
+
+static struct c_utils_node *create_node(struct c_utils_queue *queue) {
+	if(queue->conf.pool)
+		return c_utils_node_pool_alloc(queue->conf.pool);
+
+	struct c_utils_node *node;
+	C_UTILS_ON_BAD_CALLOC(node, logger, sizeof(*node))
+		return NULL;
+
+	return node;
+}
+
+static void free_node(struct c_utils_queue *queue, struct c_utils_node *node) {
+	if(queue->conf.pool)
+		c_utils_node_pool_free(node);
+	else
+		free(node);
+}
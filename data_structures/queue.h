@@ -16,16 +16,25 @@
 */
 struct c_utils_queue;
 
+struct c_utils_node_pool;
+
+struct c_utils_queue_conf {
+	/// If specified, nodes are allocated from, and retired back to, the pool rather than with malloc.
+	struct c_utils_node_pool *pool;
+};
+
 #ifdef NO_C_UTILS_PREFIX
 /*
 	Typedefs
 */
 typedef struct c_utils_queue queue_t;
+typedef struct c_utils_queue_conf queue_conf_t;
 
 /*
 	Functions
 */
 #define queue_create(...) c_utils_queue_create(__VA_ARGS__)
+#define queue_create_conf(...) c_utils_queue_create_conf(__VA_ARGS__)
 #define queue_enqueue(...) c_utils_queue_enqueue(__VA_ARGS__)
 #define queue_dequeue(...) c_utils_queue_dequeue(__VA_ARGS__)
 #define queue_destroy(...) c_utils_queue_destroy(__VA_ARGS__)
@@ -37,6 +46,13 @@ typedef struct c_utils_queue queue_t;
  */
 struct c_utils_queue *c_utils_queue_create(void);
 
+/*
+ * Creates a new instance of the queue, which must be destroyed before the conf's pool.
+ * @param conf Configuration.
+ * @return A new instance, or NULL if failure in allocating memory for the queue, or if the pool's nodes are too small.
+ */
+struct c_utils_queue *c_utils_queue_create_conf(struct c_utils_queue_conf *conf);
+
 /*
  * Enqueue an item to the queue, with guarantee not to block. 
  * @param queue Instance of the queue.
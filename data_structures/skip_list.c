@@ -0,0 +1,353 @@
+#include "skip_list.h"
+
+#include "../memory/hazard.h"
+#include "../io/logger.h"
+#include "../misc/alloc_check.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/// The hazard pointers held while searching, on the node being compared and the node behind it.
+#define C_UTILS_SKIP_LIST_HP_CURR (C_UTILS_HAZARD_INDEX_SKIP_LIST + 0)
+#define C_UTILS_SKIP_LIST_HP_PRED (C_UTILS_HAZARD_INDEX_SKIP_LIST + 1)
+
+/// Set on a node's state once the thread adding it will no longer link it into any level.
+#define C_UTILS_SKIP_LIST_BUILT 1 << 0
+
+/// Set on a node's state once the thread removing it has unlinked it from every level it found it on.
+#define C_UTILS_SKIP_LIST_UNLINKED 1 << 1
+
+struct c_utils_skip_list_node {
+	void *item;
+	unsigned int height;
+	/// Whichever of the adding and removing thread sets the second flag retires the node.
+	volatile unsigned int state;
+	/// The next node on each level, marked by setting the lowest bit once this node is being removed.
+	struct c_utils_skip_list_node *next[];
+};
+
+struct c_utils_skip_list {
+	/// Sentinel as tall as a node may be, which is never removed, and so never needs a hazard pointer.
+	struct c_utils_skip_list_node *head;
+	/// The height of the tallest node ever added, which searches start from.
+	volatile unsigned int level;
+	volatile size_t size;
+	/// Configuration
+	struct c_utils_skip_list_conf conf;
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Skip List Helper Functions                                  //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static inline bool is_marked(struct c_utils_skip_list_node *node);
+
+static inline struct c_utils_skip_list_node *mark(struct c_utils_skip_list_node *node);
+
+static inline struct c_utils_skip_list_node *unmark(struct c_utils_skip_list_node *node);
+
+static unsigned int random_height(void);
+
+static struct c_utils_skip_list_node *create_node(void *item, unsigned int height);
+
+static bool find(struct c_utils_skip_list *list, const void *item, unsigned int level, struct c_utils_skip_list_node **pred_ptr, struct c_utils_skip_list_node **curr_ptr);
+
+static void finish(struct c_utils_skip_list_node *node, unsigned int flag);
+
+static void release(void);
+
+
+
+struct c_utils_skip_list *c_utils_skip_list_create(c_utils_comparator_cb compare) {
+	struct c_utils_skip_list_conf conf = { .callbacks.comparators.item = compare };
+	return c_utils_skip_list_create_conf(&conf);
+}
+
+struct c_utils_skip_list *c_utils_skip_list_create_conf(struct c_utils_skip_list_conf *conf) {
+	if(!conf)
+		return NULL;
+
+	if(!conf->callbacks.comparators.item) {
+		C_UTILS_LOG_ERROR(conf->logger, "A comparator must be specified!");
+		return NULL;
+	}
+
+	struct c_utils_skip_list *list;
+	C_UTILS_ON_BAD_CALLOC(list, conf->logger, sizeof(*list))
+		goto err;
+
+	list->head = create_node(NULL, C_UTILS_SKIP_LIST_LEVELS);
+	if(!list->head) {
+		C_UTILS_LOG_ERROR(conf->logger, "Was unable to allocate the head!");
+		goto err_head;
+	}
+
+	list->level = 1;
+	list->conf = *conf;
+
+	return list;
+
+	err_head:
+		free(list);
+	err:
+		return NULL;
+}
+
+bool c_utils_skip_list_add(struct c_utils_skip_list *list, void *item) {
+	if(!list)
+		return false;
+
+	struct c_utils_skip_list_node *node = create_node(item, random_height()), *pred, *succ;
+	if(!node) {
+		C_UTILS_LOG_ERROR(list->conf.logger, "Was unable to allocate a node!");
+		return false;
+	}
+
+	// Raised before the node is linked, so that searches which start after it is added will find it on it's top level.
+	unsigned int level = __atomic_load_n(&list->level, __ATOMIC_RELAXED);
+	while(level < node->height && !__atomic_compare_exchange_n(&list->level, &level, node->height, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+		;
+
+	// The item is added once the node is linked on the lowest level.
+	do {
+		if(find(list, item, 0, &pred, &succ)) {
+			release();
+			free(node);
+			return false;
+		}
+
+		node->next[0] = succ;
+	} while(!__atomic_compare_exchange_n(&pred->next[0], &succ, node, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	__atomic_add_fetch(&list->size, 1, __ATOMIC_RELAXED);
+
+	for(unsigned int i = 1; i < node->height; i++) {
+		while(true) {
+			find(list, item, i, &pred, &succ);
+
+			// Once a level is marked, the node is being removed, and must not be linked any further.
+			struct c_utils_skip_list_node *next = __atomic_load_n(&node->next[i], __ATOMIC_ACQUIRE);
+			if(is_marked(next))
+				goto done;
+
+			if(next != succ && !__atomic_compare_exchange_n(&node->next[i], &next, succ, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+				goto done;
+
+			if(__atomic_compare_exchange_n(&pred->next[i], &succ, node, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+				break;
+		}
+	}
+
+	done:
+		// If it was removed while being linked, it may have been linked on a level after it's remover had searched it.
+		if(is_marked(__atomic_load_n(&node->next[0], __ATOMIC_ACQUIRE)))
+			find(list, item, 0, &pred, &succ);
+
+		release();
+		finish(node, C_UTILS_SKIP_LIST_BUILT);
+
+		return true;
+}
+
+void *c_utils_skip_list_get(struct c_utils_skip_list *list, const void *key) {
+	if(!list)
+		return NULL;
+
+	struct c_utils_skip_list_node *pred, *curr;
+	void *item = find(list, key, 0, &pred, &curr) ? curr->item : NULL;
+	release();
+
+	return item;
+}
+
+bool c_utils_skip_list_contains(struct c_utils_skip_list *list, const void *key) {
+	if(!list)
+		return false;
+
+	struct c_utils_skip_list_node *pred, *curr;
+	bool found = find(list, key, 0, &pred, &curr);
+	release();
+
+	return found;
+}
+
+void *c_utils_skip_list_remove(struct c_utils_skip_list *list, const void *key) {
+	if(!list)
+		return NULL;
+
+	struct c_utils_skip_list_node *pred, *node, *next;
+	if(!find(list, key, 0, &pred, &node)) {
+		release();
+		return NULL;
+	}
+
+	// Marks from the top down, so that the node can no longer be linked on a level once it can be seen as removed.
+	for(unsigned int i = node->height - 1; i > 0; i--) {
+		next = __atomic_load_n(&node->next[i], __ATOMIC_RELAXED);
+		while(!is_marked(next) && !__atomic_compare_exchange_n(&node->next[i], &next, mark(next), false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+			;
+	}
+
+	// Only the thread which marks the lowest level has removed it.
+	next = __atomic_load_n(&node->next[0], __ATOMIC_RELAXED);
+	do {
+		if(is_marked(next)) {
+			release();
+			return NULL;
+		}
+	} while(!__atomic_compare_exchange_n(&node->next[0], &next, mark(next), false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+	void *item = node->item;
+	__atomic_sub_fetch(&list->size, 1, __ATOMIC_RELAXED);
+
+	// Searching for it unlinks it from each level it is found on.
+	find(list, key, 0, &pred, &next);
+	release();
+	finish(node, C_UTILS_SKIP_LIST_UNLINKED);
+
+	return item;
+}
+
+size_t c_utils_skip_list_size(struct c_utils_skip_list *list) {
+	if(!list)
+		return 0;
+
+	return __atomic_load_n(&list->size, __ATOMIC_RELAXED);
+}
+
+void c_utils_skip_list_destroy(struct c_utils_skip_list *list) {
+	if(!list)
+		return;
+
+	// Every removed node was unlinked by the thread which removed it, so each node left holds an item.
+	struct c_utils_skip_list_node *node = list->head->next[0];
+	while(node) {
+		struct c_utils_skip_list_node *next = node->next[0];
+
+		if(list->conf.callbacks.destructors.item)
+			list->conf.callbacks.destructors.item(node->item);
+
+		free(node);
+		node = next;
+	}
+
+	free(list->head);
+	free(list);
+}
+
+
+
+static inline bool is_marked(struct c_utils_skip_list_node *node) {
+	return (uintptr_t) node & 1;
+}
+
+static inline struct c_utils_skip_list_node *mark(struct c_utils_skip_list_node *node) {
+	return (struct c_utils_skip_list_node *) ((uintptr_t) node | 1);
+}
+
+static inline struct c_utils_skip_list_node *unmark(struct c_utils_skip_list_node *node) {
+	return (struct c_utils_skip_list_node *) ((uintptr_t) node & ~(uintptr_t) 1);
+}
+
+/// Each level is reached by one in four of the nodes on the level below it.
+static unsigned int random_height(void) {
+	// xorshift64*, seeded per thread so that adding never contends on a shared seed.
+	static _Thread_local uint64_t seed = 0;
+	if(!seed)
+		seed = ((uintptr_t) &seed ^ (uint64_t) time(NULL) << 32) | 1;
+
+	seed ^= seed >> 12;
+	seed ^= seed << 25;
+	seed ^= seed >> 27;
+	uint64_t rand = seed * 0x2545F4914F6CDD1DULL;
+
+	unsigned int height = 1;
+	while((rand & 3) == 0 && height < C_UTILS_SKIP_LIST_LEVELS) {
+		rand >>= 2;
+		height++;
+	}
+
+	return height;
+}
+
+static struct c_utils_skip_list_node *create_node(void *item, unsigned int height) {
+	struct c_utils_skip_list_node *node = calloc(1, sizeof(*node) + height * sizeof(*node->next));
+	if(!node)
+		return NULL;
+
+	node->item = item;
+	node->height = height;
+
+	return node;
+}
+
+/*
+	Finds the last node on the level whose item is less than the item, and the node after it, unlinking any
+	removed node along the way. Both are left protected by the hazard pointers until the caller releases them.
+	Returns true if the node after it holds an equal item.
+
+	A node is only stepped onto once it's predecessor, while protected, is seen to still point to it without
+	being marked, as it is then still linked, and so cannot have been retired before it was protected.
+*/
+static bool find(struct c_utils_skip_list *list, const void *item, unsigned int level, struct c_utils_skip_list_node **pred_ptr, struct c_utils_skip_list_node **curr_ptr) {
+	c_utils_comparator_cb compare = list->conf.callbacks.comparators.item;
+	struct c_utils_skip_list_node *pred, *curr = NULL, *next;
+
+	retry:
+		pred = list->head;
+
+		for(int i = __atomic_load_n(&list->level, __ATOMIC_ACQUIRE) - 1; i >= (int) level; i--) {
+			curr = __atomic_load_n(&pred->next[i], __ATOMIC_ACQUIRE);
+
+			while(true) {
+				// The predecessor is being removed, and may no longer be linked.
+				if(is_marked(curr))
+					goto retry;
+
+				if(!curr)
+					break;
+
+				c_utils_hazard_acquire(C_UTILS_SKIP_LIST_HP_CURR, curr);
+				if(__atomic_load_n(&pred->next[i], __ATOMIC_ACQUIRE) != curr)
+					goto retry;
+
+				next = __atomic_load_n(&curr->next[i], __ATOMIC_ACQUIRE);
+				if(is_marked(next)) {
+					struct c_utils_skip_list_node *expected = curr;
+					if(!__atomic_compare_exchange_n(&pred->next[i], &expected, unmark(next), false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+						goto retry;
+
+					curr = unmark(next);
+					continue;
+				}
+
+				if(compare(curr->item, item) >= 0)
+					break;
+
+				pred = curr;
+				c_utils_hazard_acquire(C_UTILS_SKIP_LIST_HP_PRED, pred);
+				curr = next;
+			}
+		}
+
+		*pred_ptr = pred;
+		*curr_ptr = curr;
+
+		return curr && compare(curr->item, item) == 0;
+}
+
+static void finish(struct c_utils_skip_list_node *node, unsigned int flag) {
+	if(__atomic_or_fetch(&node->state, flag, __ATOMIC_ACQ_REL) == (C_UTILS_SKIP_LIST_BUILT | C_UTILS_SKIP_LIST_UNLINKED))
+		c_utils_hazard_retire(node, free);
+}
+
+/// Releases only the hazard pointers find acquires, as the caller may be holding others of it's own.
+static void release(void) {
+	c_utils_hazard_release_at(C_UTILS_SKIP_LIST_HP_CURR, false);
+	c_utils_hazard_release_at(C_UTILS_SKIP_LIST_HP_PRED, false);
+}
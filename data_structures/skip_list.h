@@ -0,0 +1,153 @@
+#ifndef C_UTILS_SKIP_LIST_H
+#define C_UTILS_SKIP_LIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "helpers.h"
+
+/*
+	A lock-free sorted set, after Fraser's and Herlihy's skip lists, which holds at most one item comparing
+	equal to another. Any amount of threads may add, remove and find items at once without taking a lock,
+	and each operation takes O(log N) expected steps.
+
+	Each node has a random height, and is linked into every level below it. An item is removed by marking
+	each of it's node's links, from the highest level down, so that no more nodes may be linked after it;
+	marking the lowest level is what removes it, after which any thread which finds the node on it's way
+	unlinks it. Searching for an item hence helps unlink any removed node in it's path, and a search only
+	restarts when the node it stands on is removed, or another thread unlinks the node ahead of it first.
+
+	Nodes are protected by the hazard pointers while being traversed, and are only retired once they have been
+	unlinked from every level, which is only known once both the thread which added it has stopped linking it
+	and the thread which removed it has searched for it again. Each thread holds two hazard pointers.
+
+	As the items are only compared, each may be a key, or an entry of a key and value, to use the set as a map.
+*/
+struct c_utils_skip_list;
+
+/// The most levels a node may have. Each level holds a quarter as many nodes as the one below it.
+#define C_UTILS_SKIP_LIST_LEVELS 16
+
+/*
+	callbacks:
+		comparators:
+			item:
+				default:
+					None, and must be specified.
+				note:
+					Orders the items, and determines which items are equal to each other.
+		destructors:
+			item:
+				default:
+					NULL
+				note:
+					Called on each item still held when the set is destroyed.
+	logger:
+		default:
+			NULL
+		note:
+			Logs allocation failures.
+*/
+struct c_utils_skip_list_conf {
+	/// Grouping of callback functions
+	struct {
+		struct {
+			c_utils_comparator_cb item;
+		} comparators;
+		struct {
+			c_utils_delete_cb item;
+		} destructors;
+	} callbacks;
+	/// Logger
+	struct c_utils_logger *logger;
+};
+
+#ifdef NO_C_UTILS_PREFIX
+/*
+	Typedefs
+*/
+typedef struct c_utils_skip_list skip_list_t;
+typedef struct c_utils_skip_list_conf skip_list_conf_t;
+
+/*
+	Macros
+*/
+#define SKIP_LIST_LEVELS C_UTILS_SKIP_LIST_LEVELS
+
+/*
+	Functions
+*/
+#define skip_list_create(...) c_utils_skip_list_create(__VA_ARGS__)
+#define skip_list_create_conf(...) c_utils_skip_list_create_conf(__VA_ARGS__)
+#define skip_list_add(...) c_utils_skip_list_add(__VA_ARGS__)
+#define skip_list_get(...) c_utils_skip_list_get(__VA_ARGS__)
+#define skip_list_contains(...) c_utils_skip_list_contains(__VA_ARGS__)
+#define skip_list_remove(...) c_utils_skip_list_remove(__VA_ARGS__)
+#define skip_list_size(...) c_utils_skip_list_size(__VA_ARGS__)
+#define skip_list_destroy(...) c_utils_skip_list_destroy(__VA_ARGS__)
+#endif
+
+/**
+ * Creates a set ordered by the comparator.
+ *
+ * @param compare Comparator.
+ * @return Instance, or NULL if compare is NULL or an allocation error occurs.
+ */
+struct c_utils_skip_list *c_utils_skip_list_create(c_utils_comparator_cb compare);
+
+struct c_utils_skip_list *c_utils_skip_list_create_conf(struct c_utils_skip_list_conf *conf);
+
+/**
+ * Adds the item, unless an item comparing equal to it is already held.
+ *
+ * Lock-Free: Concurrent, Is Thread Safe.
+ * @param list Instance.
+ * @param item Item.
+ * @return true if added, false if an equal item is held or an allocation error occurs.
+ */
+bool c_utils_skip_list_add(struct c_utils_skip_list *list, void *item);
+
+/**
+ * Finds the item which compares equal to the key, which need only be as complete as the comparator requires.
+ * The item is not protected from being removed and destroyed by another thread after it has been returned.
+ *
+ * Lock-Free: Concurrent, Is Thread Safe.
+ * @param list Instance.
+ * @param key Key compared against each item.
+ * @return The equal item, or NULL if there is none.
+ */
+void *c_utils_skip_list_get(struct c_utils_skip_list *list, const void *key);
+
+/**
+ * Lock-Free: Concurrent, Is Thread Safe.
+ * @param list Instance.
+ * @param key Key compared against each item.
+ * @return If an item comparing equal to the key is held.
+ */
+bool c_utils_skip_list_contains(struct c_utils_skip_list *list, const void *key);
+
+/**
+ * Removes the item which compares equal to the key. When several threads remove the same item, only one of them
+ * returns it, and it need not call the item destructor.
+ *
+ * Lock-Free: Concurrent, Is Thread Safe.
+ * @param list Instance.
+ * @param key Key compared against each item.
+ * @return The removed item, or NULL if there is none.
+ */
+void *c_utils_skip_list_remove(struct c_utils_skip_list *list, const void *key);
+
+/**
+ * @param list Instance.
+ * @return The amount of items, which may be stale by the time it is returned.
+ */
+size_t c_utils_skip_list_size(struct c_utils_skip_list *list);
+
+/**
+ * Destroys the set, calling the item destructor on each item still held. No thread may still be using it.
+ *
+ * @param list Instance.
+ */
+void c_utils_skip_list_destroy(struct c_utils_skip_list *list);
+
+#endif /* C_UTILS_SKIP_LIST_H */
@@ -0,0 +1,205 @@
+#include "sort.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// Ranges this small are finished with an insertion sort.
+#define C_UTILS_SORT_INSERTION_MAX 16
+
+/// The bits of the key sorted on by each pass of the radix sort.
+#define C_UTILS_SORT_RADIX_BITS 8
+
+#define C_UTILS_SORT_RADIX_BUCKETS (1 << C_UTILS_SORT_RADIX_BITS)
+
+#define C_UTILS_SORT_RADIX_PASSES (64 / C_UTILS_SORT_RADIX_BITS)
+
+struct c_utils_sort_entry {
+	uint64_t key;
+	void *item;
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Introsort Helper Functions                                  //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static inline void swap(void **array, size_t first, size_t second);
+
+static void insertion_sort(void **array, size_t size, c_utils_comparator_cb compare);
+
+static void heap_sort(void **array, size_t size, c_utils_comparator_cb compare);
+
+static size_t partition(void **array, size_t size, c_utils_comparator_cb compare);
+
+static void introsort(void **array, size_t size, c_utils_comparator_cb compare, unsigned int depth);
+
+
+
+void c_utils_sort(void **array, size_t size, c_utils_comparator_cb compare) {
+	if(!array || !compare || size < 2)
+		return;
+
+	unsigned int depth = 0;
+	for(size_t i = size; i > 1; i >>= 1)
+		depth += 2;
+
+	introsort(array, size, compare, depth);
+}
+
+bool c_utils_sort_radix(void **array, size_t size, c_utils_sort_key_cb key) {
+	if(!array || !key)
+		return false;
+
+	if(size < 2)
+		return true;
+
+	struct c_utils_sort_entry *entries = malloc(2 * size * sizeof(*entries));
+	if(!entries)
+		return false;
+
+	// Each byte of every key is counted in a single pass, rather than once per pass.
+	size_t (*counts)[C_UTILS_SORT_RADIX_BUCKETS] = calloc(C_UTILS_SORT_RADIX_PASSES, sizeof(*counts));
+	if(!counts) {
+		free(entries);
+		return false;
+	}
+
+	struct c_utils_sort_entry *src = entries, *dst = entries + size;
+	for(size_t i = 0; i < size; i++) {
+		src[i] = (struct c_utils_sort_entry) { .key = key(array[i]), .item = array[i] };
+
+		for(unsigned int pass = 0; pass < C_UTILS_SORT_RADIX_PASSES; pass++)
+			counts[pass][(src[i].key >> (pass * C_UTILS_SORT_RADIX_BITS)) & (C_UTILS_SORT_RADIX_BUCKETS - 1)]++;
+	}
+
+	for(unsigned int pass = 0; pass < C_UTILS_SORT_RADIX_PASSES; pass++) {
+		unsigned int shift = pass * C_UTILS_SORT_RADIX_BITS;
+
+		// A byte which every key shares would leave them in the same order, such as the upper bytes of small keys.
+		if(counts[pass][(src[0].key >> shift) & (C_UTILS_SORT_RADIX_BUCKETS - 1)] == size)
+			continue;
+
+		size_t offset = 0;
+		for(unsigned int bucket = 0; bucket < C_UTILS_SORT_RADIX_BUCKETS; bucket++) {
+			size_t count = counts[pass][bucket];
+			counts[pass][bucket] = offset;
+			offset += count;
+		}
+
+		for(size_t i = 0; i < size; i++)
+			dst[counts[pass][(src[i].key >> shift) & (C_UTILS_SORT_RADIX_BUCKETS - 1)]++] = src[i];
+
+		struct c_utils_sort_entry *tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	for(size_t i = 0; i < size; i++)
+		array[i] = src[i].item;
+
+	free(counts);
+	free(entries);
+
+	return true;
+}
+
+static inline void swap(void **array, size_t first, size_t second) {
+	void *item = array[first];
+	array[first] = array[second];
+	array[second] = item;
+}
+
+static void insertion_sort(void **array, size_t size, c_utils_comparator_cb compare) {
+	for(size_t i = 1; i < size; i++) {
+		void *item = array[i];
+		size_t j = i;
+
+		for(; j > 0 && compare(item, array[j - 1]) < 0; j--)
+			array[j] = array[j - 1];
+
+		array[j] = item;
+	}
+}
+
+static void heap_sort(void **array, size_t size, c_utils_comparator_cb compare) {
+	for(size_t end = size, start = size / 2; end > 1;) {
+		size_t root;
+
+		// First builds the heap from the bottom up, then repeatedly moves it's max to the end.
+		if(start > 0) {
+			root = --start;
+		} else {
+			swap(array, 0, --end);
+			root = 0;
+		}
+
+		for(size_t child; (child = root * 2 + 1) < end; root = child) {
+			if(child + 1 < end && compare(array[child], array[child + 1]) < 0)
+				child++;
+
+			if(compare(array[root], array[child]) >= 0)
+				break;
+
+			swap(array, root, child);
+		}
+	}
+}
+
+/*
+	Partitions around the median of the first, middle and last items, which, once ordered, also bound both scans
+	so that neither needs to check it's index. Returns the index of the first item of the upper partition, which
+	is never 0 nor size, so that both partitions are smaller.
+*/
+static size_t partition(void **array, size_t size, c_utils_comparator_cb compare) {
+	size_t mid = size / 2, last = size - 1;
+
+	if(compare(array[mid], array[0]) < 0)
+		swap(array, mid, 0);
+	if(compare(array[last], array[mid]) < 0) {
+		swap(array, last, mid);
+		if(compare(array[mid], array[0]) < 0)
+			swap(array, mid, 0);
+	}
+
+	void *pivot = array[mid];
+	size_t i = 0, j = last;
+
+	while(true) {
+		while(compare(array[++i], pivot) < 0)
+			;
+
+		while(compare(pivot, array[--j]) < 0)
+			;
+
+		if(i >= j)
+			return i;
+
+		swap(array, i, j);
+	}
+}
+
+static void introsort(void **array, size_t size, c_utils_comparator_cb compare, unsigned int depth) {
+	while(size > C_UTILS_SORT_INSERTION_MAX) {
+		if(!depth--) {
+			heap_sort(array, size, compare);
+			return;
+		}
+
+		size_t split = partition(array, size, compare);
+
+		// Recurses into the smaller partition only, so the stack is at most O(log N) deep.
+		if(split < size - split) {
+			introsort(array, split, compare, depth);
+			array += split;
+			size -= split;
+		} else {
+			introsort(array + split, size - split, compare, depth);
+			size = split;
+		}
+	}
+
+	insertion_sort(array, size, compare);
+}
@@ -0,0 +1,85 @@
+#ifndef C_UTILS_SORT_H
+#define C_UTILS_SORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "helpers.h"
+
+struct c_utils_thread_pool;
+
+/*
+	Sorting of arrays of items, as returned by c_utils_list_as_array, by a comparator or by an integer key.
+
+	c_utils_sort is an introsort: a quicksort on the median of three, which falls back to a heapsort once it has
+	recursed deeper than twice the logarithm of the size, so it is O(N log N) even for inputs which defeat the
+	pivot, and to an insertion sort for small ranges. It sorts in place, and is not stable.
+
+	c_utils_sort_radix is a least significant digit radix sort on an unsigned 64-bit key taken from each item,
+	a byte at a time, which takes O(N) for each byte in which the keys differ rather than O(N log N) comparisons.
+	It is stable, but needs a buffer twice the size of the array, so it may fail to allocate.
+
+	c_utils_sort_parallel is a merge sort which splits the array into a part for each thread of the pool, sorts
+	each part with c_utils_sort, and merges them pairwise in rounds. Each merge is split at evenly spaced points
+	of it's output, found by a binary search of where they fall in either part, so that every thread has work in
+	each round, including the last. Only the caller waits on the tasks, so the pool may be shared. It lives in
+	sort_parallel.c, so that only it's users need to link the thread pool.
+*/
+
+/// Arrays smaller than this are sorted on the calling thread by c_utils_sort_parallel.
+#define C_UTILS_SORT_PARALLEL_MIN (1 << 14)
+
+/// Obtains the key an item is sorted on by c_utils_sort_radix, in ascending order.
+typedef uint64_t (*c_utils_sort_key_cb)(const void *item);
+
+#ifdef NO_C_UTILS_PREFIX
+/*
+	Typedefs
+*/
+typedef c_utils_sort_key_cb sort_key_cb;
+
+/*
+	Macros
+*/
+#define SORT_PARALLEL_MIN C_UTILS_SORT_PARALLEL_MIN
+
+/*
+	Functions
+*/
+#define sort(...) c_utils_sort(__VA_ARGS__)
+#define sort_radix(...) c_utils_sort_radix(__VA_ARGS__)
+#define sort_parallel(...) c_utils_sort_parallel(__VA_ARGS__)
+#endif
+
+/**
+ * Sorts the items in ascending order of the comparator.
+ *
+ * @param array Items.
+ * @param size Amount of items.
+ * @param compare Comparator.
+ */
+void c_utils_sort(void **array, size_t size, c_utils_comparator_cb compare);
+
+/**
+ * Sorts the items in ascending order of their keys, keeping items with equal keys in the same order.
+ *
+ * @param array Items.
+ * @param size Amount of items.
+ * @param key Obtains the key of an item, called once for each.
+ * @return true if sorted, false if the buffer could not be allocated, in which case the array is unchanged.
+ */
+bool c_utils_sort_radix(void **array, size_t size, c_utils_sort_key_cb key);
+
+/**
+ * Sorts the items in ascending order of the comparator, across the threads of the pool, blocking until done.
+ *
+ * @param array Items.
+ * @param size Amount of items.
+ * @param compare Comparator, which must be thread-safe.
+ * @param pool Thread pool, or NULL to sort on the calling thread.
+ * @return true if sorted, false if the buffer could not be allocated, in which case the array is unchanged.
+ */
+bool c_utils_sort_parallel(void **array, size_t size, c_utils_comparator_cb compare, struct c_utils_thread_pool *pool);
+
+#endif /* C_UTILS_SORT_H */
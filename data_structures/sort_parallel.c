@@ -0,0 +1,187 @@
+#include "sort.h"
+#include "../threading/thread_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+	A part of the array for a thread of the pool to sort, or a piece of the merge of two sorted runs of src, a
+	and b, into dst, starting at out.
+*/
+struct c_utils_sort_task {
+	void **src;
+	void **dst;
+	size_t a_start;
+	size_t a_end;
+	size_t b_start;
+	size_t b_end;
+	size_t out;
+	c_utils_comparator_cb compare;
+	struct c_utils_result *result;
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Parallel Merge Sort Helper Functions                        //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static size_t merge_split(void **a, size_t a_size, void **b, size_t b_size, size_t diagonal, c_utils_comparator_cb compare);
+
+static void *sort_part(void *task);
+
+static void *merge_piece(void *task);
+
+static void run_tasks(struct c_utils_thread_pool *pool, struct c_utils_sort_task *tasks, size_t num_tasks, void *(*callback)(void *));
+
+
+
+bool c_utils_sort_parallel(void **array, size_t size, c_utils_comparator_cb compare, struct c_utils_thread_pool *pool) {
+	if(!array || !compare)
+		return false;
+
+	size_t parts = pool ? c_utils_thread_pool_num_threads(pool) : 1;
+	if(parts < 2 || size < C_UTILS_SORT_PARALLEL_MIN) {
+		c_utils_sort(array, size, compare);
+		return true;
+	}
+
+	void **buffer = malloc(size * sizeof(*buffer));
+	if(!buffer)
+		return false;
+
+	struct c_utils_sort_task *tasks = calloc(parts, sizeof(*tasks));
+	size_t *bounds = malloc((parts + 1) * sizeof(*bounds));
+	if(!tasks || !bounds) {
+		free(buffer);
+		free(tasks);
+		free(bounds);
+		return false;
+	}
+
+	for(size_t i = 0; i <= parts; i++)
+		bounds[i] = size * i / parts;
+
+	for(size_t i = 0; i < parts; i++)
+		tasks[i] = (struct c_utils_sort_task) { .src = array, .a_start = bounds[i], .a_end = bounds[i + 1], .compare = compare };
+
+	run_tasks(pool, tasks, parts, sort_part);
+
+	/*
+		Each round merges every pair of neighbouring runs, splitting each merge into as many pieces as there are
+		threads for it, and a run left without a neighbour is merged with nothing, which only copies it over.
+	*/
+	void **src = array, **dst = buffer;
+	for(size_t runs = parts; runs > 1; runs = (runs + 1) / 2) {
+		size_t pairs = (runs + 1) / 2, pieces = parts / pairs ? parts / pairs : 1, num_tasks = 0;
+
+		for(size_t pair = 0; pair < pairs; pair++) {
+			size_t a_start = bounds[pair * 2], a_end = bounds[pair * 2 + 1];
+			size_t b_end = pair * 2 + 2 <= runs ? bounds[pair * 2 + 2] : a_end;
+			size_t a_size = a_end - a_start, b_size = b_end - a_end, total = a_size + b_size;
+
+			for(size_t piece = 0; piece < pieces; piece++) {
+				size_t start = total * piece / pieces, end = total * (piece + 1) / pieces;
+				size_t a_from = merge_split(src + a_start, a_size, src + a_end, b_size, start, compare);
+				size_t a_to = merge_split(src + a_start, a_size, src + a_end, b_size, end, compare);
+
+				if(num_tasks == parts) {
+					run_tasks(pool, tasks, num_tasks, merge_piece);
+					num_tasks = 0;
+				}
+
+				tasks[num_tasks++] = (struct c_utils_sort_task) {
+					.src = src,
+					.dst = dst,
+					.a_start = a_start + a_from,
+					.a_end = a_start + a_to,
+					.b_start = a_end + (start - a_from),
+					.b_end = a_end + (end - a_to),
+					.out = a_start + start,
+					.compare = compare
+				};
+			}
+
+			bounds[pair] = a_start;
+		}
+
+		run_tasks(pool, tasks, num_tasks, merge_piece);
+		bounds[pairs] = size;
+
+		void **tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	if(src != array)
+		memcpy(array, src, size * sizeof(*array));
+
+	free(bounds);
+	free(tasks);
+	free(buffer);
+
+	return true;
+}
+
+
+
+/*
+	Finds how many of the first diagonal items of the merge of a and b are taken from a, where an item of a is
+	taken before an equal item of b, so that every piece of the merge can be found without merging up to it.
+*/
+static size_t merge_split(void **a, size_t a_size, void **b, size_t b_size, size_t diagonal, c_utils_comparator_cb compare) {
+	size_t low = diagonal > b_size ? diagonal - b_size : 0, high = diagonal < a_size ? diagonal : a_size;
+
+	while(low < high) {
+		size_t mid = low + (high - low) / 2;
+
+		if(compare(a[mid], b[diagonal - mid - 1]) <= 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+static void *sort_part(void *task) {
+	struct c_utils_sort_task *part = task;
+	c_utils_sort(part->src + part->a_start, part->a_end - part->a_start, part->compare);
+
+	return NULL;
+}
+
+static void *merge_piece(void *task) {
+	struct c_utils_sort_task *piece = task;
+	void **src = piece->src, **out = piece->dst + piece->out;
+	size_t a = piece->a_start, b = piece->b_start;
+
+	while(a < piece->a_end && b < piece->b_end)
+		*out++ = piece->compare(src[b], src[a]) < 0 ? src[b++] : src[a++];
+
+	memcpy(out, src + a, (piece->a_end - a) * sizeof(*out));
+	out += piece->a_end - a;
+	memcpy(out, src + b, (piece->b_end - b) * sizeof(*out));
+
+	return NULL;
+}
+
+/// Runs each task on the pool, or on the calling thread if it can not be added, and waits for all of them.
+static void run_tasks(struct c_utils_thread_pool *pool, struct c_utils_sort_task *tasks, size_t num_tasks, void *(*callback)(void *)) {
+	for(size_t i = 0; i < num_tasks; i++) {
+		tasks[i].result = c_utils_thread_pool_add_for_result(pool, callback, tasks + i, C_UTILS_THREAD_POOL_PRIORITY_MEDIUM);
+		if(!tasks[i].result)
+			callback(tasks + i);
+	}
+
+	for(size_t i = 0; i < num_tasks; i++) {
+		if(!tasks[i].result)
+			continue;
+
+		c_utils_result_get(tasks[i].result, C_UTILS_THREAD_POOL_NO_TIMEOUT);
+		c_utils_result_destroy(tasks[i].result);
+		tasks[i].result = NULL;
+	}
+}
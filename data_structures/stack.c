@@ -5,6 +5,7 @@
 #include <pthread.h>
 
 #include "../memory/hazard.h"
+#include "../memory/node_pool.h"
 #include "../io/logger.h"
 #include "../misc/alloc_check.h"
 #include "../misc/argument_check.h"
@@ -25,10 +26,12 @@ static void *pop(struct c_utils_stack *stack);
 
 static void *lock_free_pop(struct c_utils_stack *stack);
 
+static void free_node(struct c_utils_stack *stack, struct c_utils_node *node);
+
 
 
 struct c_utils_stack *c_utils_stack_create(void) {
-	struct c_utils_stack_conf conf;
+	struct c_utils_stack_conf conf = {};
 	return c_utils_stack_create_conf(&conf);
 }
 
@@ -36,6 +39,11 @@ struct c_utils_stack *c_utils_stack_create_conf(struct c_utils_stack_conf *conf)
 	if(!conf)
 		return NULL;
 
+	if(conf->pool && c_utils_node_pool_node_size(conf->pool) < sizeof(struct c_utils_node)) {
+		C_UTILS_LOG_ERROR(conf->logger, "The pool's nodes of %zu bytes are too small!", c_utils_node_pool_node_size(conf->pool));
+		return NULL;
+	}
+
 	struct c_utils_stack *stack;
 	C_UTILS_ON_BAD_CALLOC(stack, conf->logger, sizeof(*stack))
 		return NULL;
@@ -54,8 +62,14 @@ bool c_utils_stack_push(struct c_utils_stack *stack, void *item) {
 	}
 
 	struct c_utils_node *node;
-	C_UTILS_ON_BAD_CALLOC(node, stack->conf.logger, sizeof(*node))
-		return false;
+	if(stack->conf.pool) {
+		node = c_utils_node_pool_alloc(stack->conf.pool);
+		if(!node)
+			return false;
+	} else {
+		C_UTILS_ON_BAD_CALLOC(node, stack->conf.logger, sizeof(*node))
+			return false;
+	}
 	node->item = item;
 
 	if(stack->conf.lock_free)
@@ -81,17 +95,17 @@ bool c_utils_stack_destroy(struct c_utils_stack *stack) {
 		return NULL;
 	
 	if(stack->conf.lock_free)
-		c_utils_hazard_release_all(false);
+		c_utils_hazard_release_at(C_UTILS_HAZARD_INDEX_STACK, false);
 	
 	struct c_utils_node *prev_node = NULL;
 	for (struct c_utils_node *node = stack->head; node; node = node->next) {
-		free(prev_node);
+		free_node(stack, prev_node);
 		if (stack->conf.del)
 			stack->conf.del(node->item);
 		
 		prev_node = node;
 	}
-	free(prev_node);
+	free_node(stack, prev_node);
 	free(stack);
 	
 	return true;
@@ -110,7 +124,7 @@ static void lock_free_push(struct c_utils_stack *stack, struct c_utils_node *nod
 	while (true) {
 		head = stack->head;
 		if (head) 
-			c_utils_hazard_acquire(0, head);
+			c_utils_hazard_acquire(C_UTILS_HAZARD_INDEX_STACK, head);
 
 		// Ensures head isn't freed before it was tagged by hazard pointer.
 		if (head != stack->head) {
@@ -138,7 +152,7 @@ static void *pop(struct c_utils_stack *stack) {
 	void *item = head->item;
 
 	stack->head = head->next;
-	free(head);
+	free_node(stack, head);
 	stack->size--;
 
 	return item;
@@ -151,7 +165,7 @@ static void *lock_free_pop(struct c_utils_stack *stack) {
 		if (!head)
 			return NULL;
 
-		c_utils_hazard_acquire(0, head);
+		c_utils_hazard_acquire(C_UTILS_HAZARD_INDEX_STACK, head);
 		if (head != stack->head) {
 			pthread_yield();
 			continue;
@@ -164,8 +178,18 @@ static void *lock_free_pop(struct c_utils_stack *stack) {
 	}
 	void *data = head->item;
 
-	c_utils_hazard_release(head, true);
+	if(stack->conf.pool)
+		c_utils_node_pool_retire(head);
+	else
+		c_utils_hazard_release(head, true);
 	__sync_fetch_and_sub(&stack->size, 1);
 
 	return data;
 }
+
+static void free_node(struct c_utils_stack *stack, struct c_utils_node *node) {
+	if(stack->conf.pool)
+		c_utils_node_pool_free(node);
+	else
+		free(node);
+}
\ No newline at end of file
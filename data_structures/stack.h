@@ -11,11 +11,15 @@
 */
 struct c_utils_stack;
 
+struct c_utils_node_pool;
+
 struct c_utils_stack_conf {
 	/// If the stack acts as a lock-free one.
 	bool lock_free;
 	/// Called on each item after stack is destroyed if it isn't empty.
 	c_utils_delete_cb del;
+	/// If specified, nodes are allocated from the pool rather than with malloc, and retired back to it if lock_free.
+	struct c_utils_node_pool *pool;
 	/// Logger
 	struct c_utils_logger *logger;
 };
@@ -30,6 +34,7 @@ struct c_utils_stack_conf {
 	Functions
 */
 #define stack_create(...) c_utils_stack_create(__VA_ARGS__)
+#define stack_create_conf(...) c_utils_stack_create_conf(__VA_ARGS__)
 #define stack_push(...) c_utils_stack_push(__VA_ARGS__)
 #define stack_pop(...) c_utils_stack_pop(__VA_ARGS__)
 #define stack_destroy(...) c_utils_stack_destroy(__VA_ARGS__)
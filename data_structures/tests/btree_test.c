@@ -0,0 +1,149 @@
+#define NO_C_UTILS_PREFIX
+#include "../btree.h"
+#include "../../io/logger.h"
+#include <stdlib.h>
+
+static struct c_utils_logger *logger = NULL;
+static const int num_keys = 10000;
+static int keys[10000];
+
+static int compare_ints(const void *first, const void *second) {
+	int a = *(const int *) first, b = *(const int *) second;
+	return (a > b) - (a < b);
+}
+
+static void shuffle(int **arr, int len) {
+	for (int i = len - 1; i > 0; i--) {
+		int j = rand() % (i + 1);
+		int *tmp = arr[i];
+		arr[i] = arr[j];
+		arr[j] = tmp;
+	}
+}
+
+/// Checks that every key still in the tree is iterated in order, and that there are as many as expected.
+static void check_order(btree_t *tree, int step, int expected) {
+	int *key, *value, last = -1, count = 0;
+	BTREE_FOR_EACH_PAIR(key, value, tree) {
+		ASSERT((*key > last), logger, "c_utils_btree_iterator: \"Key %d came after key %d!\"", *key, last);
+		ASSERT((*key % step == 0), logger, "c_utils_btree_iterator: \"Removed key %d is still present!\"", *key);
+		ASSERT((key == value), logger, "c_utils_btree_iterator: \"Wrong value for key %d!\"", *key);
+		last = *key;
+		count++;
+	}
+
+	ASSERT((count == expected), logger, "c_utils_btree_iterator: \"Expected %d pairs, but iterated %d!\"", expected, count);
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/btree_test.log", "w", LOG_LEVEL_ALL);
+	assert(logger);
+
+	// Every key is even, so that the odd numbers between them can be used to test seeking to absent keys.
+	int *shuffled[10000];
+	for (int i = 0; i < num_keys; i++) {
+		keys[i] = i * 2;
+		shuffled[i] = &keys[i];
+	}
+	shuffle(shuffled, num_keys);
+
+	LOG_INFO(logger, "Adding %d keys in random order...", num_keys);
+	btree_conf_t conf = { .logger = logger };
+	btree_t *tree = btree_create_conf(compare_ints, &conf);
+	ASSERT(tree, logger, "c_utils_btree_create: \"Was unable to create btree!\"");
+
+	for (int i = 0; i < num_keys; i++)
+		ASSERT(btree_add(tree, shuffled[i], shuffled[i]), logger, "c_utils_btree_add: \"Was unable to add key: %d!\"", *shuffled[i]);
+
+	ASSERT(!btree_add(tree, &keys[0], &keys[0]), logger, "c_utils_btree_add: \"Added duplicate key!\"");
+	ASSERT((btree_size(tree) == (size_t)num_keys), logger, "c_utils_btree_size: \"Expected %d, but received %zu\"", num_keys, btree_size(tree));
+	check_order(tree, 2, num_keys);
+
+	for (int i = 0; i < num_keys; i++) {
+		int odd = i * 2 + 1;
+		int *value = btree_get(tree, &keys[i]);
+		ASSERT((value == &keys[i]), logger, "c_utils_btree_get: \"Wrong value for key: %d!\"", keys[i]);
+		ASSERT(!btree_get(tree, &odd), logger, "c_utils_btree_get: \"Found absent key: %d!\"", odd);
+	}
+
+	LOG_INFO(logger, "Seeking to bounds...");
+	for (int i = 1; i < num_keys - 1; i += 97) {
+		int odd = keys[i] + 1;
+
+		iterator_t *it = btree_lower_bound(tree, &odd);
+		int *value = iterator_next(it);
+		ASSERT((value && *value == keys[i + 1]), logger, "c_utils_btree_lower_bound: \"Expected %d after %d!\"", keys[i + 1], odd);
+		iterator_destroy(it);
+
+		it = btree_lower_bound(tree, &keys[i]);
+		value = iterator_prev(it);
+		ASSERT((value && *value == keys[i - 1]), logger, "c_utils_btree_lower_bound: \"Expected %d before %d!\"", keys[i - 1], keys[i]);
+		iterator_destroy(it);
+
+		it = btree_upper_bound(tree, &keys[i]);
+		value = iterator_next(it);
+		ASSERT((value && *value == keys[i + 1]), logger, "c_utils_btree_upper_bound: \"Expected %d after %d!\"", keys[i + 1], keys[i]);
+		iterator_destroy(it);
+	}
+
+	int last = keys[num_keys - 1], *key, *value, count = 0;
+	iterator_t *it = btree_upper_bound(tree, &last);
+	ASSERT(!iterator_next(it), logger, "c_utils_btree_upper_bound: \"Found a key past the last!\"");
+	value = iterator_prev(it);
+	ASSERT((value && *value == last), logger, "c_utils_btree_upper_bound: \"Expected the last key before the end!\"");
+	iterator_destroy(it);
+
+	int low = num_keys;
+	BTREE_FOR_EACH_FROM(key, value, tree, &low)
+		count++;
+	ASSERT((count == num_keys / 2), logger, "C_UTILS_BTREE_FOR_EACH_FROM: \"Expected %d pairs, but iterated %d!\"", num_keys / 2, count);
+
+	LOG_INFO(logger, "Removing every key not a multiple of 4 in random order...");
+	shuffle(shuffled, num_keys);
+	for (int i = 0; i < num_keys; i++) {
+		if (*shuffled[i] % 4 == 0)
+			continue;
+
+		value = btree_remove(tree, shuffled[i]);
+		ASSERT((value == shuffled[i]), logger, "c_utils_btree_remove: \"Was unable to remove key: %d!\"", *shuffled[i]);
+	}
+
+	ASSERT(!btree_remove(tree, &keys[1]), logger, "c_utils_btree_remove: \"Removed key %d twice!\"", keys[1]);
+	check_order(tree, 4, num_keys / 2);
+	btree_destroy(tree);
+
+	LOG_INFO(logger, "Bulk loading %d keys...", num_keys);
+	void *sorted[10000];
+	for (int i = 0; i < num_keys; i++)
+		sorted[i] = &keys[i];
+
+	tree = btree_create_from_conf(compare_ints, sorted, sorted, num_keys, &conf);
+	ASSERT(tree, logger, "c_utils_btree_create_from: \"Was unable to bulk load btree!\"");
+	check_order(tree, 2, num_keys);
+
+	for (int i = 0; i < num_keys; i++)
+		ASSERT((btree_get(tree, &keys[i]) == &keys[i]), logger, "c_utils_btree_get: \"Wrong value for key: %d!\"", keys[i]);
+
+	LOG_INFO(logger, "Removing every key from bulk loaded btree...");
+	shuffle(shuffled, num_keys);
+	for (int i = 0; i < num_keys; i++)
+		ASSERT(btree_remove(tree, shuffled[i]), logger, "c_utils_btree_remove: \"Was unable to remove key: %d!\"", *shuffled[i]);
+
+	ASSERT((btree_size(tree) == 0), logger, "c_utils_btree_size: \"Expected 0, but received %zu\"", btree_size(tree));
+	check_order(tree, 2, 0);
+
+	ASSERT(btree_add(tree, &keys[0], &keys[0]), logger, "c_utils_btree_add: \"Was unable to add to emptied btree!\"");
+	btree_destroy(tree);
+
+	LOG_INFO(logger, "Rejecting unsorted keys...");
+	void *tmp = sorted[0];
+	sorted[0] = sorted[1];
+	sorted[1] = tmp;
+	tree = btree_create_from_conf(compare_ints, sorted, sorted, num_keys, &conf);
+	ASSERT(!tree, logger, "c_utils_btree_create_from: \"Bulk loaded unsorted keys!\"");
+
+	LOG_INFO(logger, "All tests passed!");
+	logger_destroy(logger);
+
+	return 0;
+}
@@ -0,0 +1,181 @@
+#define NO_C_UTILS_PREFIX
+#include "../cache.h"
+#include "../../io/logger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+static struct c_utils_logger *logger = NULL;
+static const int capacity = 100;
+static const int num_hot = 10;
+static const int num_rounds = 10000;
+static const int num_threads = 4;
+static int destroyed = 0;
+
+static int *create_int(int i) {
+	int *ptr = malloc(sizeof(int));
+	*ptr = i;
+	return ptr;
+}
+
+static void destroy_int(void *ptr) {
+	destroyed++;
+	free(ptr);
+}
+
+static size_t charge_string(const void *key, const void *value) {
+	return strlen(value) + 1;
+}
+
+static void *hammer(void *cache) {
+	static int values[1000];
+
+	for (int i = 0; i < num_rounds; i++) {
+		int key = rand() % 1000, *value = cache_get(cache, &key);
+		if (!value) {
+			// Another thread may have added it in the meantime, in which case the key is still ours.
+			int *new_key = create_int(key);
+			if (!cache_add(cache, new_key, &values[key]))
+				free(new_key);
+			continue;
+		}
+
+		ASSERT((value == &values[key]), logger, "c_utils_cache_get: \"Wrong value for key: %d!\"", key);
+	}
+
+	return NULL;
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/cache_test.log", "w", LOG_LEVEL_ALL);
+	assert(logger);
+
+	LOG_INFO(logger, "Creating cache with a capacity of %d...", capacity);
+	cache_conf_t conf =
+	{
+		.flags = CACHE_DELETE_ON_DESTROY,
+		.capacity = capacity,
+		.key_length = sizeof(int),
+		.callbacks.destructors =
+		{
+			.key = destroy_int,
+			.value = destroy_int
+		},
+		.logger = logger
+	};
+
+	cache_t *cache = cache_create_conf(&conf);
+	ASSERT(cache, logger, "c_utils_cache_create: \"Was unable to create cache!\"");
+
+	int hot_lookups = 0, hot_hits = 0;
+	for (int i = 0; i < num_rounds; i++) {
+		for (int j = 0; j < num_hot; j++) {
+			int *value = cache_get(cache, &j);
+			hot_lookups++;
+			if (value) {
+				hot_hits++;
+				ASSERT((*value == j), logger, "c_utils_cache_get: \"Wrong value for key: %d!\"", j);
+				continue;
+			}
+
+			ASSERT(cache_add(cache, create_int(j), create_int(j)), logger, "c_utils_cache_add: \"Was unable to add key: %d!\"", j);
+		}
+
+		int key = num_hot + i;
+		ASSERT(cache_add(cache, create_int(key), create_int(key)), logger, "c_utils_cache_add: \"Was unable to add key: %d!\"", key);
+		ASSERT((cache_size(cache) <= (size_t)capacity), logger, "c_utils_cache_size: \"Exceeded capacity with %zu entries!\"", cache_size(cache));
+	}
+
+	cache_stats_t stats;
+	cache_stats(cache, &stats);
+	LOG_INFO(logger, "Hits: %zu, Misses: %zu, Evictions: %zu, Hot hit ratio: %.3f",
+		stats.hits, stats.misses, stats.evictions, (double) hot_hits / hot_lookups);
+
+	ASSERT((hot_hits > hot_lookups * 9 / 10), logger, "c_utils_cache: \"Only %d of %d lookups of hot keys hit!\"", hot_hits, hot_lookups);
+	ASSERT((stats.hits == (size_t)hot_hits && stats.misses == (size_t)(hot_lookups - hot_hits)), logger,
+		"c_utils_cache_stats: \"Counted %zu hits and %zu misses, expected %d and %d!\"", stats.hits, stats.misses, hot_hits, hot_lookups - hot_hits);
+	ASSERT((stats.size == (size_t)capacity && stats.charge == (size_t)capacity), logger,
+		"c_utils_cache_stats: \"Expected %d entries, but found %zu!\"", capacity, stats.size);
+	ASSERT(((size_t)destroyed == stats.evictions * 2), logger,
+		"c_utils_cache: \"Destroyed %d keys and values for %zu evictions!\"", destroyed, stats.evictions);
+
+	int key = num_hot + num_rounds - 1;
+	int *duplicate = create_int(key);
+	ASSERT(!cache_add(cache, duplicate, duplicate), logger, "c_utils_cache_add: \"Added duplicate key: %d!\"", key);
+	free(duplicate);
+
+	// The caller gets back the value but keeps ownership of the key, so we hold onto it.
+	int *removed_key = create_int(-1);
+	ASSERT(cache_add(cache, removed_key, create_int(-1)), logger, "c_utils_cache_add: \"Was unable to add key: -1!\"");
+	int *value = cache_remove(cache, removed_key);
+	ASSERT((value && *value == -1), logger, "c_utils_cache_remove: \"Was unable to remove key: -1!\"");
+	free(removed_key);
+	free(value);
+
+	ASSERT(cache_delete(cache, &key), logger, "c_utils_cache_delete: \"Was unable to delete key: %d!\"", key);
+	ASSERT(!cache_get(cache, &key), logger, "c_utils_cache_get: \"Deleted key %d is still present!\"", key);
+	ASSERT((cache_size(cache) == (size_t)capacity - 2), logger, "c_utils_cache_size: \"Expected %d, but received %zu\"", capacity - 2, cache_size(cache));
+	cache_destroy(cache);
+
+	LOG_INFO(logger, "Creating cache with a capacity of 64 bytes...");
+	cache_conf_t byte_conf =
+	{
+		.capacity = 64,
+		.callbacks.charge = charge_string,
+		.logger = logger
+	};
+
+	cache = cache_create_conf(&byte_conf);
+	ASSERT(cache, logger, "c_utils_cache_create: \"Was unable to create cache!\"");
+
+	char *keys[] = { "a", "b", "c", "d", "e" };
+	char *values[] = { "0123456789", "0123456789", "0123456789", "0123456789", "0123456789012345678901234567890" };
+	for (int i = 0; i < 4; i++)
+		ASSERT(cache_add(cache, keys[i], values[i]), logger, "c_utils_cache_add: \"Was unable to add key: %s!\"", keys[i]);
+
+	cache_stats(cache, &stats);
+	ASSERT((stats.charge == 44 && stats.evictions == 0), logger, "c_utils_cache_stats: \"Expected a charge of 44, but received %zu\"", stats.charge);
+
+	ASSERT(cache_add(cache, keys[4], values[4]), logger, "c_utils_cache_add: \"Was unable to add key: %s!\"", keys[4]);
+	cache_stats(cache, &stats);
+	// The last value is charged 32, so two of the others must go to make room.
+	ASSERT((stats.charge == 54 && stats.evictions == 2), logger, "c_utils_cache_stats: \"Expected a charge of 54 after two evictions, but received %zu after %zu\"",
+		stats.charge, stats.evictions);
+
+	char too_large[65];
+	memset(too_large, 'x', 64);
+	too_large[64] = '\0';
+	ASSERT(!cache_add(cache, "f", too_large), logger, "c_utils_cache_add: \"Added an entry larger than the capacity!\"");
+	cache_destroy(cache);
+
+	LOG_INFO(logger, "Hammering concurrent cache with %d threads...", num_threads);
+	cache_conf_t concurrent_conf =
+	{
+		.flags = CACHE_CONCURRENT | CACHE_DELETE_ON_DESTROY,
+		.capacity = capacity,
+		.key_length = sizeof(int),
+		.callbacks.destructors.key = free,
+		.logger = logger
+	};
+
+	cache = cache_create_conf(&concurrent_conf);
+	ASSERT(cache, logger, "c_utils_cache_create: \"Was unable to create cache!\"");
+
+	pthread_t threads[num_threads];
+	for (int i = 0; i < num_threads; i++)
+		pthread_create(threads + i, NULL, hammer, cache);
+
+	for (int i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	cache_stats(cache, &stats);
+	ASSERT((stats.hits + stats.misses == (size_t)num_threads * num_rounds), logger,
+		"c_utils_cache_stats: \"Counted %zu lookups, expected %d!\"", stats.hits + stats.misses, num_threads * num_rounds);
+	ASSERT((stats.size <= (size_t)capacity + 15), logger, "c_utils_cache_stats: \"Exceeded capacity with %zu entries!\"", stats.size);
+	cache_destroy(cache);
+
+	LOG_INFO(logger, "All tests passed!");
+	logger_destroy(logger);
+
+	return 0;
+}
@@ -0,0 +1,170 @@
+#define NO_C_UTILS_PREFIX
+#include "../cow_array.h"
+#include "../list.h"
+#include "../../io/logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+/*
+	Compares taking a snapshot of a collection as the event loop does on each poll, by copying a concurrent
+	c_utils_list out with list_as_array and freeing it, against acquiring and releasing a snapshot of the
+	c_utils_cow_array, for several amounts of reader threads. A writer adds and removes an item every
+	WRITE_INTERVAL snapshots, as sources are rarely changed compared to how often they are polled.
+*/
+
+static struct c_utils_logger *logger = NULL;
+
+#define ITEMS 64
+#define SNAPSHOTS_PER_THREAD 200000
+#define WRITE_INTERVAL 1000
+
+static int values[ITEMS + 1];
+
+static uint64_t summed = 0;
+
+struct ops {
+	void *instance;
+	void **(*acquire)(void *instance, size_t *size);
+	void (*release)(void **items);
+	bool (*add)(void *instance, void *item);
+	void (*remove)(void *instance, void *item);
+	volatile bool *done;
+};
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void **list_acquire(void *list, size_t *size) {
+	return list_as_array(list, size);
+}
+
+static void list_release(void **items) {
+	free(items);
+}
+
+static bool locked_add(void *list, void *item) {
+	return list_add(list, item);
+}
+
+static void locked_remove(void *list, void *item) {
+	list_remove(list, item);
+}
+
+static void **snapshot_acquire(void *array, size_t *size) {
+	return cow_array_acquire(array, size);
+}
+
+static void snapshot_release(void **items) {
+	cow_array_release(items);
+}
+
+static bool snapshot_add(void *array, void *item) {
+	return cow_array_add(array, item);
+}
+
+static void snapshot_remove(void *array, void *item) {
+	cow_array_remove(array, item);
+}
+
+static void *read_snapshots(void *data) {
+	struct ops *ops = data;
+	uint64_t sum = 0;
+
+	for (int i = 0; i < SNAPSHOTS_PER_THREAD; i++) {
+		size_t size;
+		void **items = ops->acquire(ops->instance, &size);
+
+		for (size_t j = 0; j < size; j++)
+			sum += *(int *) items[j];
+
+		ops->release(items);
+	}
+
+	__atomic_add_fetch(&summed, sum, __ATOMIC_RELAXED);
+	return NULL;
+}
+
+static void *write_rarely(void *data) {
+	struct ops *ops = data;
+
+	while (!__atomic_load_n(ops->done, __ATOMIC_RELAXED)) {
+		ops->add(ops->instance, values + ITEMS);
+		ops->remove(ops->instance, values + ITEMS);
+
+		// Yields for roughly as long as WRITE_INTERVAL snapshots take.
+		for (int i = 0; i < WRITE_INTERVAL && !__atomic_load_n(ops->done, __ATOMIC_RELAXED); i++)
+			sched_yield();
+	}
+
+	return NULL;
+}
+
+static double bench(struct ops *ops, int num_threads) {
+	pthread_t threads[num_threads], writer;
+	volatile bool done = false;
+
+	for (int i = 0; i < ITEMS; i++)
+		ops->add(ops->instance, values + i);
+
+	ops->done = &done;
+
+	double start = now();
+	pthread_create(&writer, NULL, write_rarely, ops);
+	for (int i = 0; i < num_threads; i++)
+		pthread_create(threads + i, NULL, read_snapshots, ops);
+
+	for (int i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	double elapsed = now() - start;
+
+	__atomic_store_n(&done, true, __ATOMIC_RELAXED);
+	pthread_join(writer, NULL);
+
+	return (double) SNAPSHOTS_PER_THREAD * num_threads / elapsed / 1e6;
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/cow_array_bench.log", "w", LOG_LEVEL_INFO);
+	assert(logger);
+
+	for (int i = 0; i <= ITEMS; i++)
+		values[i] = i;
+
+	int thread_counts[] = { 1, 2, 4 };
+	printf("%d items, %d snapshots per thread\n", ITEMS, SNAPSHOTS_PER_THREAD);
+	printf("%-8s %20s %20s\n", "threads", "list M snapshots/s", "cow M snapshots/s");
+
+	for (size_t i = 0; i < sizeof(thread_counts) / sizeof(*thread_counts); i++) {
+		list_conf_t conf = { .flags = LIST_CONCURRENT, .logger = logger };
+		struct ops list_ops = { .acquire = list_acquire, .release = list_release, .add = locked_add, .remove = locked_remove };
+		list_ops.instance = list_create_conf(&conf);
+		ASSERT(list_ops.instance, logger, "Was unable to create the list!");
+
+		double list_result = bench(&list_ops, thread_counts[i]);
+		list_destroy(list_ops.instance);
+
+		cow_array_conf_t array_conf = { .logger = logger };
+		struct ops array_ops = { .acquire = snapshot_acquire, .release = snapshot_release, .add = snapshot_add, .remove = snapshot_remove };
+		array_ops.instance = cow_array_create_conf(&array_conf);
+		ASSERT(array_ops.instance, logger, "Was unable to create the array!");
+
+		double array_result = bench(&array_ops, thread_counts[i]);
+		cow_array_destroy(array_ops.instance, NULL);
+
+		printf("%-8d %20.2f %20.2f\n", thread_counts[i], list_result, array_result);
+	}
+
+	// So that the reads are not optimized away.
+	LOG_INFO(logger, "Summed: %lu", summed);
+	logger_destroy(logger);
+
+	return EXIT_SUCCESS;
+}
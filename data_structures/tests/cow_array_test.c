@@ -0,0 +1,155 @@
+#define NO_C_UTILS_PREFIX
+#include "../cow_array.h"
+#include "../../io/logger.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+
+static struct c_utils_logger *logger = NULL;
+
+#define NUM_ITEMS 1000
+
+static const int num_readers = 4;
+
+static int values[NUM_ITEMS];
+
+static int deleted = 0;
+
+static void count_delete(void *item) {
+	deleted++;
+}
+
+static void test_basic(void) {
+	cow_array_conf_t conf = { .logger = logger };
+	cow_array_t *array = cow_array_create_conf(&conf);
+	ASSERT(array, logger, "cow_array_create_conf: \"Was unable to create array!\"");
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT(cow_array_add(array, values + i), logger, "cow_array_add: \"Was unable to add item %d!\"", i);
+
+	ASSERT(!cow_array_add(array, NULL), logger, "cow_array_add: \"Added a NULL item!\"");
+	ASSERT((cow_array_size(array) == NUM_ITEMS), logger, "cow_array_size: \"Expected %d items, but found %zu!\"", NUM_ITEMS, cow_array_size(array));
+
+	// A snapshot is unchanged by anything published after it was acquired.
+	size_t size;
+	void **before = cow_array_acquire(array, &size);
+	ASSERT((before && size == NUM_ITEMS), logger, "cow_array_acquire: \"Expected %d items, but found %zu!\"", NUM_ITEMS, size);
+
+	for (int i = 0; i < NUM_ITEMS; i += 2)
+		ASSERT(cow_array_remove(array, values + i), logger, "cow_array_remove: \"Was unable to remove item %d!\"", i);
+
+	ASSERT(!cow_array_remove(array, values), logger, "cow_array_remove: \"Removed an item which was not held!\"");
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT((before[i] == values + i), logger, "cow_array_acquire: \"Snapshot changed at index %d!\"", i);
+
+	// The items keep their order as others are removed around them.
+	size_t after_size;
+	void **after = cow_array_acquire(array, &after_size);
+	ASSERT((after_size == NUM_ITEMS / 2), logger, "cow_array_remove: \"Expected %d items, but found %zu!\"", NUM_ITEMS / 2, after_size);
+
+	for (size_t i = 0; i < after_size; i++)
+		ASSERT((after[i] == values + i * 2 + 1), logger, "cow_array_remove: \"Expected %zu at index %zu!\"", i * 2 + 1, i);
+
+	cow_array_release(before);
+	cow_array_release(after);
+
+	int *item, count = 0;
+	COW_ARRAY_FOR_EACH(item, array) {
+		ASSERT((*item % 2), logger, "COW_ARRAY_FOR_EACH: \"Found removed item %d!\"", *item);
+		if (++count == 10)
+			break;
+	}
+
+	ASSERT((count == 10), logger, "COW_ARRAY_FOR_EACH: \"Did not break after 10 items!\"");
+
+	count = 0;
+	COW_ARRAY_FOR_EACH(item, array)
+		count++;
+
+	ASSERT((count == NUM_ITEMS / 2), logger, "COW_ARRAY_FOR_EACH: \"Iterated over %d items!\"", count);
+
+	void **emptied = cow_array_acquire(array, &size);
+	ASSERT(cow_array_remove_all(array), logger, "cow_array_remove_all: \"Was unable to empty the array!\"");
+	ASSERT((cow_array_size(array) == 0 && size == NUM_ITEMS / 2), logger, "cow_array_remove_all: \"Did not empty only the array!\"");
+	cow_array_release(emptied);
+
+	for (int i = 0; i < 10; i++)
+		cow_array_add(array, values + i);
+
+	deleted = 0;
+	cow_array_destroy(array, count_delete);
+	ASSERT((deleted == 10), logger, "cow_array_destroy: \"Deleted %d items!\"", deleted);
+}
+
+struct workload {
+	cow_array_t *array;
+	volatile bool *done;
+};
+
+/// Every snapshot must hold a contiguous run of the items, as the writer adds at the end and removes from the front.
+static void *read_snapshots(void *data) {
+	struct workload *work = data;
+
+	while (!__atomic_load_n(work->done, __ATOMIC_RELAXED)) {
+		size_t size;
+		int **items = (int **) cow_array_acquire(work->array, &size);
+
+		for (size_t j = 1; j < size; j++)
+			ASSERT((items[j] == items[j - 1] + 1), logger, "cow_array_acquire: \"Snapshot of %zu items is not contiguous at %zu!\"", size, j);
+
+		cow_array_release((void **) items);
+	}
+
+	return NULL;
+}
+
+static void test_concurrent(void) {
+	cow_array_t *array = cow_array_create();
+	ASSERT(array, logger, "cow_array_create: \"Was unable to create array!\"");
+
+	volatile bool done = false;
+	struct workload work = { .array = array, .done = &done };
+
+	pthread_t threads[num_readers];
+	for (int i = 0; i < num_readers; i++)
+		pthread_create(threads + i, NULL, read_snapshots, &work);
+
+	// Slides a window of 16 items along the values, over and over.
+	for (int round = 0; round < 10; round++) {
+		for (int i = 0; i < NUM_ITEMS; i++) {
+			cow_array_add(array, values + i);
+			if (i >= 16)
+				cow_array_remove(array, values + i - 16);
+		}
+
+		for (int i = NUM_ITEMS - 16; i < NUM_ITEMS; i++)
+			cow_array_remove(array, values + i);
+	}
+
+	__atomic_store_n(&done, true, __ATOMIC_RELAXED);
+	for (int i = 0; i < num_readers; i++)
+		pthread_join(threads[i], NULL);
+
+	ASSERT((cow_array_size(array) == 0), logger, "cow_array: \"Expected no items, but found %zu!\"", cow_array_size(array));
+	cow_array_destroy(array, NULL);
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/cow_array_test.log", "w", LOG_LEVEL_INFO);
+	assert(logger);
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		values[i] = i;
+
+	LOG_INFO(logger, "Testing adding, removing and snapshots...");
+	test_basic();
+
+	LOG_INFO(logger, "Testing %d readers while the array is written to...", num_readers);
+	test_concurrent();
+
+	LOG_INFO(logger, "All tests passed!");
+	logger_destroy(logger);
+
+	return 0;
+}
@@ -0,0 +1,106 @@
+#define NO_C_UTILS_PREFIX
+#include "../filter.h"
+#include "../map.h"
+#include "../../io/logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+	Measures the false positive rate and lookup throughput of both kinds of filter, and then the throughput
+	of lookups of absent keys in a map with and without C_UTILS_MAP_FILTERED, at a few sizes so that the
+	table falls out of cache while the filter does not. Present keys are looked up as well, as the filter
+	is pure overhead for them.
+*/
+
+static struct c_utils_logger *logger = NULL;
+
+#define KEYS (1 << 20)
+#define LOOKUPS (4 * KEYS)
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void noop(void *ptr) {}
+
+static void bench_filter(const char *name, int flags, const uint64_t *hashes) {
+	filter_t *filter = filter_create(flags, KEYS);
+	ASSERT(filter, logger, "Was unable to create the filter!");
+
+	double start = now();
+	for(size_t i = 0; i < KEYS; i++)
+		filter_add(filter, hashes[i]);
+	double add = now() - start;
+
+	size_t false_positives = 0;
+	start = now();
+	for(size_t i = 0; i < LOOKUPS; i++)
+		false_positives += filter_contains(filter, hashes[KEYS + (i * 7919) % KEYS]);
+	double contains = now() - start;
+
+	printf("%-8s %12.2f %16.2f %10.5f\n", name, KEYS / add / 1e6, LOOKUPS / contains / 1e6, (double) false_positives / LOOKUPS);
+	filter_destroy(filter);
+}
+
+static void bench_map(size_t n, int flags, const uint64_t *keys) {
+	map_conf_t conf =
+	{
+		.flags = flags,
+		.size.initial = n * 2,
+		.callbacks.destructors.value = noop,
+		.length.key = sizeof(uint64_t),
+		.logger = logger
+	};
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "Was unable to create the map!");
+
+	for(size_t i = 0; i < n; i++)
+		map_add(map, (void *) (keys + i), (void *) (keys + i));
+
+	volatile uintptr_t sink = 0;
+	double start = now();
+	for(size_t i = 0; i < LOOKUPS; i++)
+		sink += (uintptr_t) map_get(map, keys + KEYS + (i * 7919) % n);
+	double miss = now() - start;
+
+	start = now();
+	for(size_t i = 0; i < LOOKUPS; i++)
+		sink += (uintptr_t) map_get(map, keys + (i * 7919) % n);
+	double hit = now() - start;
+
+	printf("%-10zu %-9s %14.2f %14.2f\n", n, flags & C_UTILS_MAP_FILTERED ? "filtered" : "plain", LOOKUPS / miss / 1e6, LOOKUPS / hit / 1e6);
+	map_destroy(map);
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/filter_bench.log", "w", LOG_LEVEL_ALL);
+	assert(logger);
+
+	// The first half is added, and the second half is only ever looked up.
+	uint64_t *keys = malloc(sizeof(*keys) * KEYS * 2);
+	assert(keys);
+
+	srand(0);
+	for(size_t i = 0; i < KEYS * 2; i++)
+		keys[i] = ((uint64_t) rand() << 32) ^ rand() ^ i;
+
+	printf("%-8s %12s %16s %10s\n", "filter", "add Mops/s", "contains Mops/s", "FPR");
+	bench_filter("bloom", C_UTILS_FILTER_BLOOM, keys);
+	bench_filter("cuckoo", C_UTILS_FILTER_CUCKOO, keys);
+
+	printf("\n%-10s %-9s %14s %14s\n", "keys", "map", "miss Mops/s", "hit Mops/s");
+	for(size_t n = KEYS >> 6; n <= KEYS; n <<= 3) {
+		bench_map(n, 0, keys);
+		bench_map(n, C_UTILS_MAP_FILTERED, keys);
+	}
+
+	free(keys);
+	logger_destroy(logger);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+#define NO_C_UTILS_PREFIX
+#include "../filter.h"
+#include "../map.h"
+#include "../../io/logger.h"
+#include <stdlib.h>
+
+static struct c_utils_logger *logger = NULL;
+static const int num_keys = 10000;
+static const int num_probes = 100000;
+
+/// Sequential keys, so that a weak hash would show up as a high false positive rate.
+static void test_filter(int flags, double max_fpr) {
+	filter_t *filter = filter_create(flags, num_keys);
+	ASSERT(filter, logger, "c_utils_filter_create: \"Was unable to create filter!\"");
+
+	for (uint64_t i = 0; i < (uint64_t)num_keys; i++)
+		ASSERT(filter_add(filter, i), logger, "c_utils_filter_add: \"Was unable to add hash: %lu!\"", i);
+
+	ASSERT((filter_size(filter) == (size_t)num_keys), logger, "c_utils_filter_size: \"Expected %d, but received %zu\"", num_keys, filter_size(filter));
+
+	for (uint64_t i = 0; i < (uint64_t)num_keys; i++)
+		ASSERT(filter_contains(filter, i), logger, "c_utils_filter_contains: \"False negative for hash: %lu!\"", i);
+
+	int false_positives = 0;
+	for (uint64_t i = num_keys; i < (uint64_t)(num_keys + num_probes); i++)
+		false_positives += filter_contains(filter, i);
+
+	double fpr = (double) false_positives / num_probes;
+	LOG_INFO(logger, "%s filter: false positive rate of %.5f", flags & FILTER_CUCKOO ? "Cuckoo" : "Bloom", fpr);
+	ASSERT((fpr <= max_fpr), logger, "c_utils_filter_contains: \"False positive rate of %.5f exceeds %.5f!\"", fpr, max_fpr);
+
+	if (flags & FILTER_CUCKOO) {
+		for (uint64_t i = 0; i < (uint64_t)num_keys; i += 2)
+			ASSERT(filter_remove(filter, i), logger, "c_utils_filter_remove: \"Was unable to remove hash: %lu!\"", i);
+
+		for (uint64_t i = 1; i < (uint64_t)num_keys; i += 2)
+			ASSERT(filter_contains(filter, i), logger, "c_utils_filter_contains: \"False negative for hash: %lu after removal!\"", i);
+
+		ASSERT((filter_size(filter) == (size_t)num_keys / 2), logger, "c_utils_filter_size: \"Expected %d, but received %zu\"", num_keys / 2, filter_size(filter));
+	} else {
+		ASSERT(!filter_remove(filter, 0), logger, "c_utils_filter_remove: \"Removed from a Bloom filter!\"");
+	}
+
+	filter_clear(filter);
+	ASSERT((filter_size(filter) == 0), logger, "c_utils_filter_clear: \"Size is %zu after clear!\"", filter_size(filter));
+	ASSERT(!filter_contains(filter, 1), logger, "c_utils_filter_clear: \"Hash still present after clear!\"");
+
+	filter_destroy(filter);
+}
+
+/// Keys are added and removed across several resizes, which rebuild each shard's filter.
+static void test_map(int flags) {
+	map_conf_t conf =
+	{
+		.flags = C_UTILS_MAP_FILTERED | flags,
+		.length.key = sizeof(int),
+		.shards = 4,
+		.size.initial = 16,
+		.callbacks.destructors.value = free,
+		.logger = logger
+	};
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "c_utils_map_create: \"Was unable to create map!\"");
+
+	int *keys = malloc(sizeof(int) * num_keys);
+	for (int i = 0; i < num_keys; i++) {
+		keys[i] = i;
+		int *value = malloc(sizeof(int));
+		*value = i;
+		ASSERT(map_add(map, keys + i, value), logger, "c_utils_map_add: \"Was unable to add key: %d!\"", i);
+	}
+
+	for (int i = 0; i < num_keys; i++) {
+		int *value = map_get(map, keys + i);
+		ASSERT((value && *value == i), logger, "c_utils_map_get: \"Filtered map lost key: %d!\"", i);
+	}
+
+	for (int i = num_keys; i < num_keys * 2; i++)
+		ASSERT(!map_get(map, &i), logger, "c_utils_map_get: \"Found key %d which was never added!\"", i);
+
+	for (int i = 0; i < num_keys; i += 2)
+		ASSERT(map_delete(map, keys + i), logger, "c_utils_map_delete: \"Was unable to delete key: %d!\"", i);
+
+	for (int i = 0; i < num_keys; i++) {
+		int *value = map_get(map, keys + i);
+		ASSERT(((i % 2) ? value && *value == i : !value), logger, "c_utils_map_get: \"Wrong result for key %d after deletion!\"", i);
+	}
+
+	map_delete_all(map);
+	ASSERT(!map_get(map, keys + 1), logger, "c_utils_map_delete_all: \"Key 1 still present after delete_all!\"");
+
+	int *value = malloc(sizeof(int));
+	*value = 1;
+	ASSERT(map_add(map, keys + 1, value), logger, "c_utils_map_add: \"Was unable to re-add key 1 after delete_all!\"");
+	ASSERT((map_get(map, keys + 1) == value), logger, "c_utils_map_get: \"Lost key 1 after delete_all!\"");
+
+	map_delete(map, keys + 1);
+	map_destroy(map);
+	free(keys);
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/filter_test.log", "w", LOG_LEVEL_ALL);
+	assert(logger);
+
+	LOG_INFO(logger, "Testing Bloom filter with %d keys...", num_keys);
+	test_filter(FILTER_BLOOM, .02);
+
+	LOG_INFO(logger, "Testing cuckoo filter with %d keys...", num_keys);
+	test_filter(FILTER_CUCKOO, .001);
+
+	LOG_INFO(logger, "Testing filtered map...");
+	test_map(0);
+
+	LOG_INFO(logger, "Testing filtered, sharded and shrinking map...");
+	test_map(C_UTILS_MAP_SHARDED | C_UTILS_MAP_SHRINK_ON_TRIGGER);
+
+	LOG_INFO(logger, "All tests passed!");
+	logger_destroy(logger);
+
+	return 0;
+}
@@ -0,0 +1,149 @@
+#define NO_C_UTILS_PREFIX
+#include "../heap.h"
+#include "../../io/logger.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+/*
+	Models a scheduler's heap of timers: it is filled to a million timers with random deadlines, then each hold
+	operation removes the earliest and reschedules it to a later deadline, and finally it is drained. This is run
+	for binary, 4-ary and 8-ary heaps, each comparing the timers through the comparator, and through a copied key.
+	Then, as a timeout manager would, an indexed heap of a million timers has random timers rescheduled, and
+	random timers cancelled and added again, through their handles.
+*/
+
+static struct c_utils_logger *logger = NULL;
+
+#define NUM_TIMERS (1 << 20)
+
+#define NUM_HOLDS (1 << 21)
+
+struct timer {
+	uint64_t deadline;
+	void *data;
+};
+
+static struct timer timers[NUM_TIMERS];
+
+static heap_handle_t *handles[NUM_TIMERS];
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// The heap keeps the greatest at the top, so the earliest deadline must compare, and key, as the greatest.
+static int compare_timers(const void *item_one, const void *item_two) {
+	uint64_t one = ((struct timer *) item_one)->deadline, two = ((struct timer *) item_two)->deadline;
+	return (one < two) - (one > two);
+}
+
+static uint64_t timer_key(const void *item) {
+	return UINT64_MAX - ((struct timer *) item)->deadline;
+}
+
+static void bench(size_t arity, bool keyed) {
+	unsigned int seed = NUM_TIMERS;
+	for (size_t i = 0; i < NUM_TIMERS; i++)
+		timers[i].deadline = rand_r(&seed);
+
+	heap_conf_t conf = { .arity = arity, .callbacks.keys.item = keyed ? timer_key : NULL, .logger = logger };
+	heap_t *heap = heap_create_conf(compare_timers, &conf);
+	ASSERT(heap, logger, "Was unable to create the heap!");
+
+	double start = now();
+	for (size_t i = 0; i < NUM_TIMERS; i++)
+		heap_insert(heap, timers + i);
+	double fill = now() - start;
+
+	start = now();
+	uint64_t last = 0;
+	for (size_t i = 0; i < NUM_HOLDS; i++) {
+		struct timer *timer = heap_remove(heap);
+		ASSERT((timer->deadline >= last), logger, "Timers were removed out of order!");
+
+		last = timer->deadline;
+		timer->deadline += rand_r(&seed) % (1 << 20) + 1;
+		heap_insert(heap, timer);
+	}
+	double hold = now() - start;
+
+	start = now();
+	while (heap_remove(heap))
+		;
+	double drain = now() - start;
+
+	heap_destroy(heap);
+
+	printf("%-6zu %-6s %12.1f %12.1f %12.1f\n", arity, keyed ? "yes" : "no", fill / NUM_TIMERS * 1e9, hold / NUM_HOLDS * 1e9, drain / NUM_TIMERS * 1e9);
+}
+
+static void bench_indexed(size_t arity) {
+	unsigned int seed = NUM_TIMERS;
+	for (size_t i = 0; i < NUM_TIMERS; i++)
+		timers[i].deadline = rand_r(&seed);
+
+	heap_conf_t conf = { .flags = HEAP_INDEXED, .arity = arity, .callbacks.keys.item = timer_key, .logger = logger };
+	heap_t *heap = heap_create_conf(compare_timers, &conf);
+	ASSERT(heap, logger, "Was unable to create the heap!");
+
+	double start = now();
+	for (size_t i = 0; i < NUM_TIMERS; i++)
+		handles[i] = heap_insert_handle(heap, timers + i);
+	double fill = now() - start;
+
+	start = now();
+	for (size_t i = 0; i < NUM_HOLDS; i++) {
+		size_t victim = rand_r(&seed) % NUM_TIMERS;
+		timers[victim].deadline += rand_r(&seed) % (1 << 20) + 1;
+		heap_update_priority(heap, handles[victim]);
+	}
+	double update = now() - start;
+
+	start = now();
+	for (size_t i = 0; i < NUM_HOLDS; i++) {
+		size_t victim = rand_r(&seed) % NUM_TIMERS;
+		ASSERT((heap_remove_handle(heap, handles[victim]) == timers + victim), logger, "The wrong timer was cancelled!");
+		heap_handle_destroy(heap, handles[victim]);
+		handles[victim] = heap_insert_handle(heap, timers + victim);
+	}
+	double cancel = now() - start;
+
+	uint64_t last = 0;
+	struct timer *timer;
+	while ((timer = heap_remove(heap))) {
+		ASSERT((timer->deadline >= last), logger, "Timers were removed out of order!");
+		last = timer->deadline;
+	}
+
+	for (size_t i = 0; i < NUM_TIMERS; i++)
+		heap_handle_destroy(heap, handles[i]);
+
+	heap_destroy(heap);
+
+	printf("%-6zu %12.1f %12.1f %12.1f\n", arity, fill / NUM_TIMERS * 1e9, update / NUM_HOLDS * 1e9, cancel / NUM_HOLDS * 1e9);
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/heap_bench.log", "w", LOG_LEVEL_INFO);
+	assert(logger);
+
+	printf("%-6s %-6s %12s %12s %12s\n", "arity", "keyed", "ns/insert", "ns/hold", "ns/remove");
+
+	size_t arities[] = { 2, 4, 8 };
+	for (size_t i = 0; i < sizeof(arities) / sizeof(*arities); i++) {
+		bench(arities[i], false);
+		bench(arities[i], true);
+	}
+
+	printf("\n%-6s %12s %12s %12s\n", "arity", "ns/insert", "ns/update", "ns/cancel");
+
+	for (size_t i = 0; i < sizeof(arities) / sizeof(*arities); i++)
+		bench_indexed(arities[i]);
+
+	logger_destroy(logger);
+
+	return EXIT_SUCCESS;
+}
@@ -12,31 +12,42 @@ static int compare_ints(const void *f, const void *s) {
 	return *(int *)f - *(int *)s;
 }
 
+static uint64_t int_key(const void *item) {
+	return *(int *)item;
+}
+
 static logger_t *logger;
 
 LOGGER_AUTO_CREATE(logger, "data_structures/logs/heap_test.log", "w", LOG_LEVEL_ALL);
 
-int main(void) {
+static void test_heap(size_t arity, bool keyed) {
 	heap_conf_t conf =
 	{
+		.arity = arity,
+		.callbacks.keys.item = keyed ? int_key : NULL,
 		.logger = logger
 	};
 
 	heap_t *heap = heap_create_conf(compare_ints, &conf);
 	int arr[C_UTILS_HEAP_TEST_MAX_SIZE] = {0};
+	void *batch[C_UTILS_HEAP_TEST_MAX_SIZE / 2];
 
-	srand(time(NULL));
-
-	for(int i = 0; i < C_UTILS_HEAP_TEST_MAX_SIZE; i++) {
+	for(int i = 0; i < C_UTILS_HEAP_TEST_MAX_SIZE; i++)
 		arr[i] = rand() % 100 + 1;
+
+	// Half are inserted one at a time, and the other half as a batch.
+	for(int i = 0; i < C_UTILS_HEAP_TEST_MAX_SIZE / 2; i++) {
 		heap_insert(heap, arr + i);
+		batch[i] = arr + C_UTILS_HEAP_TEST_MAX_SIZE / 2 + i;
 	}
 
+	heap_insert_all(heap, batch, C_UTILS_HEAP_TEST_MAX_SIZE / 2);
+	assert(heap_size(heap) == C_UTILS_HEAP_TEST_MAX_SIZE);
+
 	int last = 0;
 	for(int i = 0; i < C_UTILS_HEAP_TEST_MAX_SIZE; i++) {
 		void *item = heap_remove(heap);
-		if(!item)
-			break;
+		assert(item);
 
 		int curr = *(int *) item;
 		if(last)
@@ -47,5 +58,128 @@ int main(void) {
 		C_UTILS_DEBUG("%d\n", curr);
 	}
 
+	assert(!heap_remove(heap));
 	heap_destroy(heap);
-}
\ No newline at end of file
+}
+
+static void test_indexed(size_t arity, bool keyed) {
+	heap_conf_t conf =
+	{
+		.flags = HEAP_INDEXED,
+		.arity = arity,
+		.callbacks.keys.item = keyed ? int_key : NULL,
+		.logger = logger
+	};
+
+	heap_t *heap = heap_create_conf(compare_ints, &conf);
+	int arr[C_UTILS_HEAP_TEST_MAX_SIZE] = {0};
+	heap_handle_t *handles[C_UTILS_HEAP_TEST_MAX_SIZE];
+
+	for(int i = 0; i < C_UTILS_HEAP_TEST_MAX_SIZE; i++) {
+		arr[i] = rand() % 100 + 1;
+		handles[i] = heap_insert_handle(heap, arr + i);
+		assert(handles[i]);
+	}
+
+	// Every other item has it's priority raised or lowered.
+	for(int i = 0; i < C_UTILS_HEAP_TEST_MAX_SIZE; i += 2) {
+		arr[i] = rand() % 100 + 1;
+		assert(heap_update_priority(heap, handles[i]));
+	}
+
+	// And every third is removed from wherever it is.
+	size_t removed = 0;
+	for(int i = 0; i < C_UTILS_HEAP_TEST_MAX_SIZE; i += 3) {
+		assert(heap_remove_handle(heap, handles[i]) == arr + i);
+		removed++;
+	}
+
+	assert(heap_size(heap) == C_UTILS_HEAP_TEST_MAX_SIZE - removed);
+
+	int last = 0;
+	for(size_t i = 0; i < C_UTILS_HEAP_TEST_MAX_SIZE - removed; i++) {
+		int *item = heap_remove(heap);
+		assert(item);
+		assert((item - arr) % 3);
+
+		if(last)
+			assert(*item <= last);
+
+		last = *item;
+	}
+
+	assert(!heap_remove(heap));
+
+	// Every item has left the heap, so each handle is only good for being destroyed.
+	for(int i = 0; i < C_UTILS_HEAP_TEST_MAX_SIZE; i++) {
+		assert(!heap_update_priority(heap, handles[i]));
+		assert(!heap_remove_handle(heap, handles[i]));
+		heap_handle_destroy(heap, handles[i]);
+	}
+
+	// A handle must not be usable with another heap, nor obtained from one which is not indexed.
+	heap_handle_t *handle = heap_insert_handle(heap, arr);
+	heap_t *other = heap_create_conf(compare_ints, &conf);
+	assert(!heap_update_priority(other, handle));
+	assert(!heap_remove_handle(other, handle));
+	heap_destroy(other);
+
+	conf = (heap_conf_t) { .logger = logger };
+	other = heap_create_conf(compare_ints, &conf);
+	assert(!heap_insert_handle(other, arr));
+	heap_destroy(other);
+
+	heap_remove_all(heap);
+	assert(!heap_remove_handle(heap, handle));
+	heap_handle_destroy(heap, handle);
+	heap_destroy(heap);
+}
+
+static void test_stale_handles(void) {
+	heap_conf_t conf = { .flags = HEAP_INDEXED, .logger = logger };
+	heap_t *heap = heap_create_conf(compare_ints, &conf);
+	int arr[] = { 3, 2, 1 };
+	heap_handle_t *handles[3];
+
+	for(int i = 0; i < 3; i++)
+		handles[i] = heap_insert_handle(heap, arr + i);
+
+	// The greatest is popped, after which it's handle must neither move nor remove anything.
+	assert(heap_remove(heap) == arr);
+	arr[0] = 10;
+	assert(!heap_update_priority(heap, handles[0]));
+	assert(!heap_remove_handle(heap, handles[0]));
+	assert(heap_size(heap) == 2);
+	assert(heap_get(heap) == arr + 1);
+
+	// Once removed through it's handle, so too for the next.
+	assert(heap_remove_handle(heap, handles[1]) == arr + 1);
+	assert(!heap_remove_handle(heap, handles[1]));
+	assert(heap_size(heap) == 1);
+
+	// A handle destroyed while it's item is still in the heap leaves the item behind.
+	heap_handle_destroy(heap, handles[2]);
+	assert(heap_remove(heap) == arr + 2);
+
+	heap_handle_destroy(heap, handles[0]);
+	heap_handle_destroy(heap, handles[1]);
+
+	// Destroying the heap detaches any handles still in it.
+	heap_handle_t *handle = heap_insert_handle(heap, arr);
+	heap_destroy(heap);
+	heap_handle_destroy(NULL, handle);
+}
+
+int main(void) {
+	srand(time(NULL));
+
+	size_t arities[] = { 2, 3, 4, 8 };
+	for(size_t i = 0; i < sizeof(arities) / sizeof(*arities); i++) {
+		test_heap(arities[i], false);
+		test_heap(arities[i], true);
+		test_indexed(arities[i], false);
+		test_indexed(arities[i], true);
+	}
+
+	test_stale_handles();
+}
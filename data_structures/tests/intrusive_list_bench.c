@@ -0,0 +1,104 @@
+#define NO_C_UTILS_PREFIX
+#include "../intrusive_list.h"
+#include "../list.h"
+#include "../../io/logger.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+/*
+	Compares removing items by value from a c_utils_list, which must first find the node holding the item,
+	against removing them from a c_utils_intrusive_list, which finds the link within the item itself, for
+	several sizes of list. The items are removed in a random order, as connections and timers would be.
+*/
+
+static struct c_utils_logger *logger = NULL;
+
+#define MAX_ITEMS (1 << 14)
+
+struct connection {
+	int fd;
+	intrusive_link_t link;
+};
+
+static struct connection connections[MAX_ITEMS];
+
+static int order[MAX_ITEMS];
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void shuffle(int size) {
+	unsigned int seed = size;
+
+	for (int i = 0; i < size; i++)
+		order[i] = i;
+
+	for (int i = size - 1; i > 0; i--) {
+		int j = rand_r(&seed) % (i + 1), tmp = order[i];
+		order[i] = order[j];
+		order[j] = tmp;
+	}
+}
+
+static double bench_list(int size) {
+	list_conf_t conf = { .flags = LIST_CONCURRENT, .logger = logger };
+	list_t *list = list_create_conf(&conf);
+	ASSERT(list, logger, "Was unable to create the list!");
+
+	for (int i = 0; i < size; i++)
+		list_add(list, connections + i);
+
+	double start = now();
+	for (int i = 0; i < size; i++)
+		list_remove(list, connections + order[i]);
+
+	double elapsed = now() - start;
+	list_destroy(list);
+
+	return elapsed / size * 1e9;
+}
+
+static double bench_intrusive(int size) {
+	intrusive_list_conf_t conf = { .flags = INTRUSIVE_LIST_CONCURRENT, .offset = offsetof(struct connection, link), .logger = logger };
+	intrusive_list_t *list = intrusive_list_create_conf(&conf);
+	ASSERT(list, logger, "Was unable to create the list!");
+
+	for (int i = 0; i < size; i++)
+		intrusive_list_add(list, connections + i);
+
+	double start = now();
+	for (int i = 0; i < size; i++)
+		intrusive_list_remove(list, connections + order[i]);
+
+	double elapsed = now() - start;
+	intrusive_list_destroy(list);
+
+	return elapsed / size * 1e9;
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/intrusive_list_bench.log", "w", LOG_LEVEL_INFO);
+	assert(logger);
+
+	for (int i = 0; i < MAX_ITEMS; i++)
+		connections[i].fd = i;
+
+	printf("%-8s %20s %20s\n", "items", "list ns/remove", "intrusive ns/remove");
+
+	for (int size = 1 << 8; size <= MAX_ITEMS; size <<= 2) {
+		shuffle(size);
+
+		double list_result = bench_list(size);
+		double intrusive_result = bench_intrusive(size);
+
+		printf("%-8d %20.1f %20.1f\n", size, list_result, intrusive_result);
+	}
+
+	logger_destroy(logger);
+
+	return EXIT_SUCCESS;
+}
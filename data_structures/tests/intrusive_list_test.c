@@ -0,0 +1,288 @@
+#define NO_C_UTILS_PREFIX
+#include "../intrusive_list.h"
+#include "../../io/logger.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+
+static struct c_utils_logger *logger = NULL;
+
+#define NUM_ITEMS 10000
+
+#define NUM_ROUNDS 20
+
+static const int num_threads = 4;
+
+struct timer {
+	int value;
+	intrusive_link_t link;
+};
+
+static struct timer timers[NUM_ITEMS];
+
+static volatile int deleted = 0;
+
+static int compare_timers(const void *item_one, const void *item_two) {
+	return ((struct timer *) item_one)->value - ((struct timer *) item_two)->value;
+}
+
+static void count_delete(void *item) {
+	__atomic_add_fetch(&deleted, 1, __ATOMIC_RELAXED);
+}
+
+static int counted = 0;
+
+static void count_item(void *item) {
+	counted++;
+}
+
+static void test_basic(intrusive_list_conf_t *conf) {
+	intrusive_list_t *list = intrusive_list_create_conf(conf);
+	ASSERT(list, logger, "intrusive_list_create_conf: \"Was unable to create list!\"");
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT(intrusive_list_add(list, timers + i), logger, "intrusive_list_add: \"Was unable to add item %d!\"", i);
+
+	ASSERT(!intrusive_list_add(list, timers), logger, "intrusive_list_add: \"Added an item already on the list!\"");
+	ASSERT((intrusive_list_size(list) == NUM_ITEMS), logger, "intrusive_list_size: \"Expected %d items, but found %zu!\"", NUM_ITEMS, intrusive_list_size(list));
+	ASSERT((intrusive_list_head(list) == timers && intrusive_list_tail(list) == timers + NUM_ITEMS - 1), logger, "intrusive_list_head: \"Items were not added at the tail!\"");
+
+	// Removes every odd item, which is found through it's own link.
+	for (int i = 1; i < NUM_ITEMS; i += 2)
+		ASSERT(intrusive_list_remove(list, timers + i), logger, "intrusive_list_remove: \"Was unable to remove item %d!\"", i);
+
+	ASSERT(!intrusive_list_remove(list, timers + 1), logger, "intrusive_list_remove: \"Removed an item not on the list!\"");
+	ASSERT((intrusive_list_size(list) == NUM_ITEMS / 2), logger, "intrusive_list_remove: \"Expected %d items, but found %zu!\"", NUM_ITEMS / 2, intrusive_list_size(list));
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT((intrusive_list_contains(list, timers + i) == !(i % 2)), logger, "intrusive_list_contains: \"Was wrong about item %d!\"", i);
+
+	// Another list may take the removed items.
+	intrusive_list_t *other = intrusive_list_create(offsetof(struct timer, link));
+	for (int i = 1; i < NUM_ITEMS; i += 2)
+		ASSERT(intrusive_list_add(other, timers + i), logger, "intrusive_list_add: \"Was unable to add a removed item to another list!\"");
+
+	ASSERT(!intrusive_list_contains(list, timers + 1), logger, "intrusive_list_contains: \"Found an item on another list!\"");
+	ASSERT(!intrusive_list_remove(list, timers + 1), logger, "intrusive_list_remove: \"Removed an item on another list!\"");
+
+	intrusive_list_destroy(other);
+	ASSERT(!timers[1].link.list, logger, "intrusive_list_destroy: \"Left an item linked!\"");
+
+	int i = 0;
+	struct timer *timer;
+	INTRUSIVE_LIST_FOR_EACH(timer, list) {
+		ASSERT((timer == timers + i), logger, "INTRUSIVE_LIST_FOR_EACH: \"Expected %d, but found %d!\"", i, timer->value);
+		i += 2;
+	}
+
+	ASSERT((i == NUM_ITEMS), logger, "INTRUSIVE_LIST_FOR_EACH: \"Iterated over %d items!\"", i / 2);
+
+	INTRUSIVE_LIST_FOR_EACH_REV(timer, list) {
+		i -= 2;
+		ASSERT((timer == timers + i), logger, "INTRUSIVE_LIST_FOR_EACH_REV: \"Expected %d, but found %d!\"", i, timer->value);
+	}
+
+	counted = 0;
+	intrusive_list_for_each(list, count_item);
+	ASSERT((counted == NUM_ITEMS / 2), logger, "intrusive_list_for_each: \"Was called on %d items!\"", counted);
+
+	ASSERT((intrusive_list_remove_head(list) == timers && intrusive_list_head(list) == timers + 2), logger, "intrusive_list_remove_head: \"Did not remove the head!\"");
+
+	deleted = 0;
+	ASSERT(intrusive_list_delete(list, timers + 2), logger, "intrusive_list_delete: \"Was unable to delete an item!\"");
+	ASSERT((deleted == 1), logger, "intrusive_list_delete: \"Did not call the destructor!\"");
+
+	intrusive_list_remove_all(list);
+	ASSERT((intrusive_list_size(list) == 0 && !intrusive_list_head(list) && !intrusive_list_tail(list)), logger, "intrusive_list_remove_all: \"Left %zu items!\"", intrusive_list_size(list));
+
+	// Destroying the list deletes each item still on it.
+	for (int i = 0; i < NUM_ITEMS; i++)
+		intrusive_list_add(list, timers + i);
+
+	deleted = 0;
+	intrusive_list_destroy(list);
+	ASSERT((deleted == NUM_ITEMS), logger, "intrusive_list_destroy: \"Deleted %d items!\"", deleted);
+}
+
+static void test_sorted(intrusive_list_conf_t *conf) {
+	conf->callbacks.comparators.item = compare_timers;
+	intrusive_list_t *list = intrusive_list_create_conf(conf);
+	ASSERT(list, logger, "intrusive_list_create_conf: \"Was unable to create list!\"");
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT(intrusive_list_add(list, timers + (i * 7919) % NUM_ITEMS), logger, "intrusive_list_add: \"Was unable to add item!\"");
+
+	int i = 0;
+	struct timer *timer;
+	INTRUSIVE_LIST_FOR_EACH(timer, list) {
+		ASSERT((timer->value == i), logger, "intrusive_list_add: \"Expected %d at index %d, but found %d!\"", i, i, timer->value);
+		i++;
+	}
+
+	// The earliest timer is always at the head.
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		timer = intrusive_list_remove_head(list);
+		ASSERT((timer == timers + i), logger, "intrusive_list_remove_head: \"Expected %d, but found %d!\"", i, timer ? timer->value : -1);
+	}
+
+	iterator_t *it = intrusive_list_iterator(list);
+	ASSERT(!iterator_append(it, timers), logger, "iterator_append: \"Appended to a sorted list!\"");
+	iterator_destroy(it);
+
+	intrusive_list_destroy(list);
+	conf->callbacks.comparators.item = NULL;
+}
+
+static void test_iterator(intrusive_list_conf_t *conf) {
+	intrusive_list_t *list = intrusive_list_create_conf(conf);
+	ASSERT(list, logger, "intrusive_list_create_conf: \"Was unable to create list!\"");
+
+	iterator_t *it = intrusive_list_iterator(list);
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT(iterator_append(it, timers + i), logger, "iterator_append: \"Was unable to append item %d!\"", i);
+
+	// Removing the item the iterator is on, through either, continues on from where it was.
+	int i = 0;
+	for (struct timer *timer = iterator_head(it); timer; timer = iterator_next(it), i++) {
+		ASSERT((timer == timers + i), logger, "iterator_next: \"Expected %d, but found %d!\"", i, timer->value);
+
+		if (i % 4 == 1)
+			iterator_remove(it);
+		else if (i % 4 == 3)
+			intrusive_list_remove(list, timer);
+	}
+
+	ASSERT((i == NUM_ITEMS && intrusive_list_size(list) == NUM_ITEMS / 2), logger, "iterator_remove: \"Expected %d items, but found %zu!\"", NUM_ITEMS / 2, intrusive_list_size(list));
+
+	// Removing the items on either side of the removed item it was on still leaves it where it was.
+	iterator_head(it);
+	iterator_next(it);
+	intrusive_list_remove(list, timers + 2);
+	ASSERT(!iterator_curr(it), logger, "iterator_curr: \"Returned a removed item!\"");
+
+	intrusive_list_remove(list, timers);
+	intrusive_list_remove(list, timers + 4);
+	ASSERT((iterator_next(it) == timers + 6), logger, "iterator_next: \"Did not continue from where the removed item was!\"");
+
+	intrusive_list_remove(list, timers + 6);
+	ASSERT(!iterator_prev(it), logger, "iterator_prev: \"Returned an item before the head!\"");
+
+	// Once removed, the item is inserted where it was.
+	iterator_head(it);
+	intrusive_list_remove(list, timers + 8);
+	ASSERT(iterator_prepend(it, timers + 1), logger, "iterator_prepend: \"Was unable to prepend where the removed item was!\"");
+	ASSERT((intrusive_list_head(list) == timers + 1 && iterator_next(it) == timers + 10), logger, "iterator_prepend: \"Did not prepend where the removed item was!\"");
+
+	iterator_destroy(it);
+	intrusive_list_destroy(list);
+}
+
+struct workload {
+	intrusive_list_t *list;
+	int id;
+	pthread_barrier_t *barrier;
+	volatile bool *done;
+};
+
+/// Each thread adds and removes only it's own share of the items, so that it knows which it must find.
+static void *add_and_remove(void *data) {
+	struct workload *work = data;
+
+	for (int round = 0; round < NUM_ROUNDS; round++) {
+		pthread_barrier_wait(work->barrier);
+
+		for (int i = work->id; i < NUM_ITEMS; i += num_threads)
+			ASSERT(intrusive_list_add(work->list, timers + i), logger, "intrusive_list_add: \"Was unable to add item %d!\"", i);
+
+		for (int i = work->id; i < NUM_ITEMS; i += num_threads)
+			ASSERT(intrusive_list_remove(work->list, timers + i), logger, "intrusive_list_remove: \"Was unable to remove item %d!\"", i);
+
+		pthread_barrier_wait(work->barrier);
+	}
+
+	return NULL;
+}
+
+/// Iterates while the items around it are removed, and every item it returns must still be on the list.
+static void *iterate(void *data) {
+	struct workload *work = data;
+
+	while (!__atomic_load_n(work->done, __ATOMIC_RELAXED)) {
+		struct timer *timer;
+		INTRUSIVE_LIST_FOR_EACH(timer, work->list)
+			ASSERT((timer >= timers && timer < timers + NUM_ITEMS), logger, "iterator_next: \"Returned an item which was never added!\"");
+	}
+
+	return NULL;
+}
+
+static void test_concurrent(intrusive_list_conf_t *conf) {
+	conf->flags |= INTRUSIVE_LIST_CONCURRENT | INTRUSIVE_LIST_RC_INSTANCE;
+	intrusive_list_t *list = intrusive_list_create_conf(conf);
+	ASSERT(list, logger, "intrusive_list_create_conf: \"Was unable to create list!\"");
+
+	pthread_barrier_t barrier;
+	pthread_barrier_init(&barrier, NULL, num_threads + 1);
+
+	volatile bool done = false;
+	pthread_t threads[num_threads + 1];
+	struct workload work[num_threads + 1];
+	for (int i = 0; i <= num_threads; i++) {
+		work[i] = (struct workload) { .list = list, .id = i, .barrier = &barrier, .done = &done };
+		pthread_create(threads + i, NULL, i < num_threads ? add_and_remove : iterate, work + i);
+	}
+
+	for (int round = 0; round < NUM_ROUNDS; round++) {
+		pthread_barrier_wait(&barrier);
+		pthread_barrier_wait(&barrier);
+
+		ASSERT((intrusive_list_size(list) == 0), logger, "intrusive_list: \"Expected no items, but found %zu in round #%d!\"", intrusive_list_size(list), round);
+	}
+
+	__atomic_store_n(&done, true, __ATOMIC_RELAXED);
+	for (int i = 0; i <= num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	pthread_barrier_destroy(&barrier);
+
+	// The iterator keeps the list alive after it is destroyed.
+	iterator_t *it = intrusive_list_iterator(list);
+	intrusive_list_destroy(list);
+	ASSERT(!iterator_next(it), logger, "iterator_next: \"Returned an item from an empty list!\"");
+	iterator_destroy(it);
+
+	conf->flags &= ~(INTRUSIVE_LIST_CONCURRENT | INTRUSIVE_LIST_RC_INSTANCE);
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/intrusive_list_test.log", "w", LOG_LEVEL_INFO);
+	assert(logger);
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		timers[i].value = i;
+
+	intrusive_list_conf_t conf =
+	{
+		.flags = INTRUSIVE_LIST_DELETE_ON_DESTROY,
+		.offset = offsetof(struct timer, link),
+		.callbacks.destructors.item = count_delete,
+		.logger = logger
+	};
+
+	LOG_INFO(logger, "Testing adding and removing...");
+	test_basic(&conf);
+
+	LOG_INFO(logger, "Testing sorted list...");
+	test_sorted(&conf);
+
+	LOG_INFO(logger, "Testing iterator...");
+	test_iterator(&conf);
+
+	LOG_INFO(logger, "Testing %d threads adding and removing while another iterates...", num_threads);
+	test_concurrent(&conf);
+
+	LOG_INFO(logger, "All tests passed!");
+	logger_destroy(logger);
+
+	return 0;
+}
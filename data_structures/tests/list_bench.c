@@ -0,0 +1,150 @@
+#define NO_C_UTILS_PREFIX
+#include "../list.h"
+#include "../../io/logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+	Compares c_utils_list_for_each and c_utils_list_contains over a list of a node per item against one with
+	LIST_UNROLLED, for chunks of several sizes. Each item is allocated separately, between the list's own
+	allocations, as it would be by a caller adding items as they are created.
+
+	Then compares c_utils_list_get, c_utils_list_remove_at and adding to a sorted list at random positions
+	against one with LIST_INDEXED, which is only a smaller list as the nodes take O(N) steps for each.
+*/
+
+static struct c_utils_logger *logger = NULL;
+
+#define ITEMS (1 << 20)
+#define PASSES 20
+#define LOOKUPS 50
+#define INDEXED_ITEMS (1 << 16)
+#define INDEXED_OPS 10000
+
+static uint64_t sum = 0;
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void noop(void *item) {}
+
+static void add_to_sum(void *item) {
+	sum += *(int *) item;
+}
+
+static void bench(const char *name, list_conf_t *conf, int **items) {
+	double start, add, for_each, contains;
+
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "Was unable to create the list!");
+
+	start = now();
+	for (int i = 0; i < ITEMS; i++) {
+		items[i] = malloc(sizeof(int));
+		*items[i] = i;
+		list_add(list, items[i]);
+	}
+	add = now() - start;
+
+	start = now();
+	for (int i = 0; i < PASSES; i++)
+		list_for_each(list, add_to_sum);
+	for_each = now() - start;
+
+	// Half are found at random positions, and half are never found, which must scan the entire list.
+	int miss;
+	start = now();
+	for (int i = 0; i < LOOKUPS; i++)
+		sum += list_contains(list, i % 2 ? items[(i * 7919) % ITEMS] : &miss);
+	contains = now() - start;
+
+	printf("%-14s %12.2f %16.2f %16.2f\n", name, ITEMS / add / 1e6, (double) ITEMS * PASSES / for_each / 1e6, LOOKUPS / contains);
+
+	list_destroy(list);
+	for (int i = 0; i < ITEMS; i++)
+		free(items[i]);
+}
+
+static int compare_ints(const void *item_one, const void *item_two) {
+	return *(int *) item_one - *(int *) item_two;
+}
+
+static void bench_indexed(const char *name, list_conf_t *conf, int **items) {
+	double start, sorted, get, remove_at;
+
+	conf->callbacks.comparators.item = compare_ints;
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "Was unable to create the list!");
+
+	start = now();
+	for (int i = 0; i < INDEXED_ITEMS; i++)
+		list_add(list, items[(i * 7919L) % INDEXED_ITEMS]);
+	sorted = now() - start;
+
+	start = now();
+	for (int i = 0; i < INDEXED_OPS; i++)
+		sum += *(int *) list_get(list, (i * 7919L) % INDEXED_ITEMS);
+	get = now() - start;
+
+	start = now();
+	for (int i = 0; i < INDEXED_OPS; i++)
+		sum += *(int *) list_remove_at(list, (i * 7919L) % (INDEXED_ITEMS - i));
+	remove_at = now() - start;
+
+	printf("%-14s %12.2f %16.2f %16.2f\n", name, INDEXED_ITEMS / sorted / 1e3, INDEXED_OPS / get / 1e3, INDEXED_OPS / remove_at / 1e3);
+
+	list_destroy(list);
+	conf->callbacks.comparators.item = NULL;
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/list_bench.log", "w", LOG_LEVEL_INFO);
+	assert(logger);
+
+	int **items = malloc(sizeof(*items) * ITEMS);
+	assert(items);
+
+	printf("%d items\n", ITEMS);
+	printf("%-14s %12s %16s %16s\n", "list", "add Mops/s", "for_each Mitem/s", "contains ops/s");
+
+	list_conf_t conf = { .callbacks.destructors.item = noop, .logger = logger };
+	bench("nodes", &conf, items);
+
+	conf.flags = LIST_UNROLLED;
+	size_t chunk_sizes[] = { 3, 0, 59 };
+	const char *names[] = { "unrolled 1CL", "unrolled 4CL", "unrolled 8CL" };
+	for (size_t i = 0; i < sizeof(chunk_sizes) / sizeof(*chunk_sizes); i++) {
+		conf.size.chunk = chunk_sizes[i];
+		bench(names[i], &conf, items);
+	}
+
+	printf("\n%d items\n", INDEXED_ITEMS);
+	printf("%-14s %12s %16s %16s\n", "list", "sorted Kops/s", "get Kops/s", "remove_at Kops/s");
+
+	for (int i = 0; i < INDEXED_ITEMS; i++) {
+		items[i] = malloc(sizeof(int));
+		*items[i] = i;
+	}
+
+	conf.flags = 0;
+	bench_indexed("nodes", &conf, items);
+
+	conf.flags = LIST_INDEXED;
+	bench_indexed("indexed", &conf, items);
+
+	for (int i = 0; i < INDEXED_ITEMS; i++)
+		free(items[i]);
+
+	// So that the passes are not optimized away.
+	LOG_INFO(logger, "Sum: %lu", sum);
+
+	free(items);
+	logger_destroy(logger);
+
+	return EXIT_SUCCESS;
+}
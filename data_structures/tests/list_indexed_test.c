@@ -0,0 +1,282 @@
+#define NO_C_UTILS_PREFIX
+#include "../list.h"
+#include "../../io/logger.h"
+
+// Included rather than linked, so that the span of each link can be checked directly.
+#include "../list.c"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+static struct c_utils_logger *logger = NULL;
+
+#define NUM_ITEMS 10000
+
+static const int num_threads = 4;
+
+static int values[NUM_ITEMS * 2];
+
+static int deleted = 0;
+
+static int compare_ints(const void *item_one, const void *item_two) {
+	return *(int *) item_one - *(int *) item_two;
+}
+
+static void count_delete(void *item) {
+	deleted++;
+}
+
+/// Asserts that each link on every level spans exactly the nodes up to the next on it's level, or up to the end of the list.
+static void check_spans(list_t *list) {
+	for (unsigned int level = 1; level < list->skip.level; level++) {
+		struct c_utils_list_skip_link *link = skip_link(list, NULL, level);
+		size_t rank = 0, last = 0;
+
+		for (struct c_utils_node *node = list->head; node; node = node->next) {
+			rank++;
+			if (skip_height(node) <= level)
+				continue;
+
+			ASSERT((link->next == node && last + link->span == rank), logger, "skip_insert: \"Link at rank %zu on level %u spans %zu rather than %zu!\"",
+				last, level, link->span, rank - last);
+
+			link = skip_link(list, node, level);
+			last = rank;
+		}
+
+		ASSERT((!link->next && last + link->span == list->size), logger, "skip_insert: \"Last link on level %u spans %zu rather than %zu!\"",
+			level, link->span, list->size - last);
+	}
+}
+
+/// Asserts that every index of the list holds the same item as the array, which checks the span of every link along the way.
+static void check_index(list_t *list, int **expected, size_t size) {
+	ASSERT((list_size(list) == size), logger, "list_size: \"Expected %zu items, but found %zu!\"", size, list_size(list));
+	check_spans(list);
+
+	for (size_t i = 0; i < size; i++) {
+		int *item = list_get(list, i);
+		ASSERT((item == expected[i]), logger, "list_get: \"Expected %d at index %zu, but found %d!\"", *expected[i], i, item ? *item : -1);
+	}
+
+	ASSERT(!list_get(list, size), logger, "list_get: \"Found an item out of bounds!\"");
+}
+
+static void test_basic(list_conf_t *conf) {
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list!\"");
+
+	static int *expected[NUM_ITEMS];
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		ASSERT(list_add(list, values + i), logger, "list_add: \"Was unable to add item %d!\"", i);
+		expected[i] = values + i;
+	}
+
+	check_index(list, expected, NUM_ITEMS);
+
+	LOG_INFO(logger, "Removing items at random indexes...");
+	size_t size = NUM_ITEMS;
+	srand(0);
+	while (size > NUM_ITEMS / 4) {
+		size_t index = rand() % size;
+		int *item = list_remove_at(list, index);
+		ASSERT((item == expected[index]), logger, "list_remove_at: \"Removed the wrong item at index %zu!\"", index);
+
+		memmove(expected + index, expected + index + 1, (--size - index) * sizeof(*expected));
+
+		// Removing by item unlinks the node from each of it's levels as well.
+		if (size % 3 == 0) {
+			index = rand() % size;
+			list_remove(list, expected[index]);
+			memmove(expected + index, expected + index + 1, (--size - index) * sizeof(*expected));
+		}
+	}
+
+	check_index(list, expected, size);
+
+	LOG_INFO(logger, "Deleting all items...");
+	deleted = 0;
+	list_delete_all(list);
+	ASSERT((deleted == (int) size && list_size(list) == 0), logger, "list_delete_all: \"Deleted %d items!\"", deleted);
+	ASSERT(!list_get(list, 0), logger, "list_get: \"Found an item in an empty list!\"");
+
+	ASSERT(list_add(list, values), logger, "list_add: \"Was unable to add to an emptied list!\"");
+	expected[0] = values;
+	check_index(list, expected, 1);
+
+	list_destroy(list);
+}
+
+static void test_sorted(list_conf_t *conf) {
+	conf->callbacks.comparators.item = compare_ints;
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list!\"");
+
+	// Every value is added twice, from distinct items which compare equal, in a scattered order.
+	for (int i = 0; i < NUM_ITEMS * 2; i++)
+		ASSERT(list_add(list, values + (i * 7919) % (NUM_ITEMS * 2)), logger, "list_add: \"Was unable to add item!\"");
+
+	static int duplicates[NUM_ITEMS];
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		duplicates[i] = values[i];
+		list_add(list, duplicates + i);
+	}
+
+	check_spans(list);
+
+	for (int i = 0; i < NUM_ITEMS * 3; i++) {
+		int *item = list_get(list, i);
+		int value = i < NUM_ITEMS * 2 ? i / 2 : i - NUM_ITEMS;
+		ASSERT((item && *item == value), logger, "list_get: \"Expected %d at index %d, but found %d!\"", value, i, item ? *item : -1);
+	}
+
+	// Only the item itself is removed, not the other which compares equal to it.
+	for (int i = 0; i < NUM_ITEMS; i += 2)
+		list_remove(list, duplicates + i);
+
+	ASSERT((list_size(list) == NUM_ITEMS * 5 / 2), logger, "list_remove: \"Expected %d items, but found %zu!\"", NUM_ITEMS * 5 / 2, list_size(list));
+	ASSERT(list_contains(list, values + 2), logger, "list_contains: \"Removed the item which compared equal!\"");
+	ASSERT(!list_contains(list, duplicates + 2), logger, "list_contains: \"Found removed item!\"");
+	ASSERT(list_contains(list, duplicates + 3), logger, "list_contains: \"Did not find duplicate item!\"");
+
+	// Each even value below NUM_ITEMS is now held once, and each odd value twice.
+	int index = 0;
+	for (int value = 0; value < NUM_ITEMS * 2; value++) {
+		for (int copies = value < NUM_ITEMS && value % 2 ? 2 : 1; copies; copies--, index++) {
+			int *item = list_get(list, index);
+			ASSERT((item && *item == value), logger, "list_get: \"Expected %d at index %d, but found %d!\"", value, index, item ? *item : -1);
+		}
+	}
+
+	iterator_t *it = list_iterator(list);
+	ASSERT(!iterator_append(it, values), logger, "iterator_append: \"Appended to a sorted list!\"");
+	iterator_destroy(it);
+
+	list_destroy(list);
+	conf->callbacks.comparators.item = NULL;
+}
+
+static void test_iterator(list_conf_t *conf) {
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list!\"");
+
+	LOG_INFO(logger, "Appending and prepending through the iterator...");
+	iterator_t *it = list_iterator(list);
+	for (int i = 0; i < NUM_ITEMS; i += 2)
+		ASSERT(iterator_append(it, values + i), logger, "iterator_append: \"Was unable to append item %d!\"", i);
+
+	// Inserts each odd item before it's successor, which must shift the index of every item after it.
+	iterator_head(it);
+	for (int i = 1; i < NUM_ITEMS - 1; i += 2) {
+		iterator_next(it);
+		ASSERT(iterator_prepend(it, values + i), logger, "iterator_prepend: \"Was unable to prepend item %d!\"", i);
+		iterator_next(it);
+	}
+
+	ASSERT(iterator_append(it, values + NUM_ITEMS - 1), logger, "iterator_append: \"Was unable to append last item!\"");
+
+	static int *expected[NUM_ITEMS];
+	for (int i = 0; i < NUM_ITEMS; i++)
+		expected[i] = values + i;
+
+	check_index(list, expected, NUM_ITEMS);
+
+	LOG_INFO(logger, "Removing through the iterator...");
+	iterator_destroy(it);
+	it = list_iterator(list);
+
+	size_t size = 0;
+	for (int *item = iterator_next(it); item; item = iterator_next(it)) {
+		if (*item % 3)
+			iterator_remove(it);
+		else
+			expected[size++] = item;
+	}
+
+	check_index(list, expected, size);
+
+	iterator_destroy(it);
+	list_destroy(list);
+}
+
+static void *index_randomly(void *list) {
+	unsigned int seed = (unsigned int) pthread_self();
+
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		size_t size = list_size(list);
+		if (!size)
+			break;
+
+		int *item = list_get(list, rand_r(&seed) % size);
+		ASSERT((!item || *item % 3 == 0 || *item < NUM_ITEMS * 2), logger, "list_get: \"Found an item which was never added!\"");
+	}
+
+	return NULL;
+}
+
+static void test_concurrent(list_conf_t *conf) {
+	conf->flags |= LIST_CONCURRENT | LIST_RC_INSTANCE;
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list!\"");
+
+	for (int i = 0; i < NUM_ITEMS * 2; i++)
+		list_add(list, values + i);
+
+	pthread_t threads[num_threads];
+	for (int i = 0; i < num_threads; i++)
+		pthread_create(threads + i, NULL, index_randomly, list);
+
+	for (int i = 0; i < NUM_ITEMS * 2; i++)
+		if (i % 3)
+			list_remove(list, values + i);
+
+	for (int i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	static int *expected[NUM_ITEMS];
+	size_t size = 0;
+	for (int i = 0; i < NUM_ITEMS * 2; i += 3)
+		expected[size++] = values + i;
+
+	check_index(list, expected, size);
+
+	list_destroy(list);
+	conf->flags &= ~(LIST_CONCURRENT | LIST_RC_INSTANCE);
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/list_indexed_test.log", "w", LOG_LEVEL_INFO);
+	assert(logger);
+
+	for (int i = 0; i < NUM_ITEMS * 2; i++)
+		values[i] = i;
+
+	list_conf_t conf =
+	{
+		.flags = LIST_INDEXED,
+		.callbacks.destructors.item = count_delete,
+		.logger = logger
+	};
+
+	conf.flags |= LIST_UNROLLED;
+	ASSERT(!list_create_conf(&conf), logger, "list_create_conf: \"Accepted both LIST_INDEXED and LIST_UNROLLED!\"");
+	conf.flags &= ~LIST_UNROLLED;
+
+	LOG_INFO(logger, "Testing indexing...");
+	test_basic(&conf);
+
+	LOG_INFO(logger, "Testing sorted list...");
+	test_sorted(&conf);
+
+	LOG_INFO(logger, "Testing iterator...");
+	test_iterator(&conf);
+
+	LOG_INFO(logger, "Testing concurrent indexing...");
+	test_concurrent(&conf);
+
+	LOG_INFO(logger, "All tests passed!");
+	logger_destroy(logger);
+
+	return 0;
+}
@@ -0,0 +1,291 @@
+#define NO_C_UTILS_PREFIX
+#include "../list.h"
+#include "../../io/logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+static struct c_utils_logger *logger = NULL;
+
+#define NUM_ITEMS 10000
+
+/// Each search is O(N), so fewer items are added and removed concurrently.
+#define NUM_CONCURRENT_ITEMS (NUM_ITEMS / 4)
+
+#define NUM_ROUNDS 4
+
+static const int num_threads = 4;
+
+static int values[NUM_ITEMS];
+
+static volatile int deleted = 0;
+
+static int compare_ints(const void *item_one, const void *item_two) {
+	return *(int *) item_one - *(int *) item_two;
+}
+
+static void count_delete(void *item) {
+	__atomic_add_fetch(&deleted, 1, __ATOMIC_RELAXED);
+}
+
+static volatile int counted = 0;
+
+static void count_item(void *item) {
+	counted++;
+}
+
+static void test_basic(list_conf_t *conf) {
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list!\"");
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT(list_add(list, values + i), logger, "list_add: \"Was unable to add item %d!\"", i);
+
+	ASSERT((list_size(list) == NUM_ITEMS), logger, "list_size: \"Expected %d items, but found %zu!\"", NUM_ITEMS, list_size(list));
+
+	// Unsorted items are added at the head.
+	for (int i = 0; i < NUM_ITEMS; i += 97) {
+		int *item = list_get(list, i);
+		ASSERT((item == values + NUM_ITEMS - 1 - i), logger, "list_get: \"Expected %d at index %d, but found %d!\"", NUM_ITEMS - 1 - i, i, item ? *item : -1);
+	}
+
+	ASSERT(!list_get(list, NUM_ITEMS), logger, "list_get: \"Found an item out of bounds!\"");
+
+	// Removes every odd item, by item and by index alike.
+	for (int i = 1; i < NUM_ITEMS / 2; i += 2)
+		list_remove(list, values + i);
+
+	// Each odd item in the upper half is behind half as many even items as there are items above it.
+	for (int i = NUM_ITEMS - 1; i >= NUM_ITEMS / 2; i -= 2) {
+		int *item = list_remove_at(list, (NUM_ITEMS - 1 - i) / 2);
+		ASSERT((item == values + i), logger, "list_remove_at: \"Expected %d, but removed %d!\"", i, item ? *item : -1);
+	}
+
+	ASSERT((list_size(list) == NUM_ITEMS / 2), logger, "list_remove: \"Expected %d items, but found %zu!\"", NUM_ITEMS / 2, list_size(list));
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT((list_contains(list, values + i) == !(i % 2)), logger, "list_contains: \"Was wrong about item %d!\"", i);
+
+	size_t size;
+	int **array = list_as_array(list, &size);
+	ASSERT((array && size == NUM_ITEMS / 2), logger, "list_as_array: \"Expected %d items, but found %zu!\"", NUM_ITEMS / 2, size);
+
+	for (size_t i = 0; i < size; i++)
+		ASSERT(!(*array[i] % 2), logger, "list_as_array: \"Found removed item %d!\"", *array[i]);
+
+	free(array);
+
+	counted = 0;
+	list_for_each(list, count_item);
+	ASSERT((counted == NUM_ITEMS / 2), logger, "list_for_each: \"Was called on %d items!\"", counted);
+
+	int *item;
+	counted = 0;
+	LIST_FOR_EACH(item, list)
+		counted++;
+
+	ASSERT((counted == NUM_ITEMS / 2), logger, "LIST_FOR_EACH: \"Iterated over %d items!\"", counted);
+
+	LIST_FOR_EACH_REV(item, list)
+		ASSERT(false, logger, "LIST_FOR_EACH_REV: \"Iterated backwards over a list only linked forwards!\"");
+
+	list_remove_all(list);
+	ASSERT((list_size(list) == 0 && !list_get(list, 0)), logger, "list_remove_all: \"Left %zu items!\"", list_size(list));
+
+	// Destroying the list deletes each item at once, as no other thread may be using it.
+	for (int i = 0; i < NUM_ITEMS; i++)
+		list_add(list, values + i);
+
+	deleted = 0;
+	list_destroy(list);
+	ASSERT((deleted == NUM_ITEMS), logger, "list_destroy: \"Deleted %d items!\"", deleted);
+}
+
+static void test_sorted(list_conf_t *conf) {
+	conf->callbacks.comparators.item = compare_ints;
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list!\"");
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT(list_add(list, values + (i * 7919) % NUM_ITEMS), logger, "list_add: \"Was unable to add item!\"");
+
+	for (int i = 0; i < NUM_ITEMS; i += 97) {
+		int *item = list_get(list, i);
+		ASSERT((item == values + i), logger, "list_get: \"Expected %d at index %d, but found %d!\"", i, i, item ? *item : -1);
+	}
+
+	iterator_t *it = list_iterator(list);
+	ASSERT(!iterator_append(it, values), logger, "iterator_append: \"Appended to a sorted list!\"");
+	iterator_destroy(it);
+
+	list_destroy(list);
+	conf->callbacks.comparators.item = NULL;
+}
+
+static void test_iterator(list_conf_t *conf) {
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list!\"");
+
+	iterator_t *it = list_iterator(list);
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT(iterator_append(it, values + i), logger, "iterator_append: \"Was unable to append item %d!\"", i);
+
+	ASSERT(!iterator_prev(it) && !iterator_tail(it) && !iterator_prepend(it, values), logger, "iterator: \"Moved backwards through a list only linked forwards!\"");
+
+	// Appending after the current node keeps the items in order.
+	int i = 0;
+	for (int *item = iterator_head(it); item; item = iterator_next(it), i++) {
+		ASSERT((item == values + i), logger, "iterator_next: \"Expected %d, but found %d!\"", i, *item);
+
+		if (i % 2)
+			iterator_remove(it);
+	}
+
+	ASSERT((i == NUM_ITEMS && list_size(list) == NUM_ITEMS / 2), logger, "iterator_remove: \"Expected %d items, but found %zu!\"", NUM_ITEMS / 2, list_size(list));
+
+	// The node the iterator is positioned on is removed along with every node after it, yet it may still step past them.
+	iterator_head(it);
+	iterator_next(it);
+	list_remove_all(list);
+	ASSERT(!iterator_curr(it), logger, "iterator_curr: \"Returned a removed item!\"");
+	ASSERT(!iterator_next(it), logger, "iterator_next: \"Returned a removed item!\"");
+
+	// Once removed, items appended after it are linked at the head instead.
+	iterator_head(it);
+	list_add(list, values);
+	iterator_next(it);
+	list_remove(list, values);
+	ASSERT(iterator_append(it, values + 1), logger, "iterator_append: \"Was unable to append after a removed item!\"");
+	ASSERT((list_get(list, 0) == values + 1 && iterator_curr(it) == values + 1), logger, "iterator_append: \"Did not append at the head!\"");
+
+	iterator_destroy(it);
+	list_destroy(list);
+}
+
+struct workload {
+	list_t *list;
+	int id;
+	pthread_barrier_t *barrier;
+	volatile bool *done;
+};
+
+/// Each thread adds and removes only it's own share of the items, so that it knows which it must find.
+static void *add_and_remove(void *data) {
+	struct workload *work = data;
+
+	for (int round = 0; round < NUM_ROUNDS; round++) {
+		pthread_barrier_wait(work->barrier);
+
+		for (int i = work->id; i < NUM_CONCURRENT_ITEMS; i += num_threads)
+			ASSERT(list_add(work->list, values + i), logger, "list_add: \"Was unable to add item %d!\"", i);
+
+		for (int i = work->id; i < NUM_CONCURRENT_ITEMS; i += num_threads)
+			ASSERT(list_contains(work->list, values + i), logger, "list_contains: \"Did not find item %d!\"", i);
+
+		// Removes half by item and the other half by deleting them through an iterator.
+		for (int i = work->id; i < NUM_CONCURRENT_ITEMS; i += num_threads * 2)
+			list_remove(work->list, values + i);
+
+		for (int i = work->id; i < NUM_CONCURRENT_ITEMS; i += num_threads * 2)
+			ASSERT(!list_contains(work->list, values + i), logger, "list_remove: \"Found removed item %d!\"", i);
+
+		iterator_t *it = list_iterator(work->list);
+		for (int *item = iterator_next(it); item; item = iterator_next(it))
+			if ((*item - work->id) % num_threads == 0)
+				iterator_delete(it);
+
+		iterator_destroy(it);
+
+		pthread_barrier_wait(work->barrier);
+	}
+
+	return NULL;
+}
+
+/// Iterates while the nodes it stands on are unlinked beneath it, and every item it returns must have been added.
+static void *iterate(void *data) {
+	struct workload *work = data;
+
+	while (!__atomic_load_n(work->done, __ATOMIC_RELAXED)) {
+		iterator_t *it = list_iterator(work->list);
+		for (int *item = iterator_next(it); item; item = iterator_next(it))
+			ASSERT((item >= values && item < values + NUM_ITEMS), logger, "iterator_next: \"Returned an item which was never added!\"");
+
+		iterator_destroy(it);
+
+		int *item = list_get(work->list, 0);
+		ASSERT((!item || (item >= values && item < values + NUM_ITEMS)), logger, "list_get: \"Returned an item which was never added!\"");
+	}
+
+	return NULL;
+}
+
+static void test_concurrent(list_conf_t *conf) {
+	conf->flags |= LIST_RC_INSTANCE;
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list!\"");
+
+	pthread_barrier_t barrier;
+	pthread_barrier_init(&barrier, NULL, num_threads + 1);
+
+	volatile bool done = false;
+	pthread_t threads[num_threads + 1];
+	struct workload work[num_threads + 1];
+	for (int i = 0; i <= num_threads; i++) {
+		work[i] = (struct workload) { .list = list, .id = i, .barrier = &barrier, .done = &done };
+		pthread_create(threads + i, NULL, i < num_threads ? add_and_remove : iterate, work + i);
+	}
+
+	for (int round = 0; round < NUM_ROUNDS; round++) {
+		pthread_barrier_wait(&barrier);
+		pthread_barrier_wait(&barrier);
+
+		ASSERT((list_size(list) == 0), logger, "list: \"Expected no items, but found %zu in round #%d!\"", list_size(list), round);
+		ASSERT(!list_get(list, 0), logger, "list: \"Found an item after round #%d!\"", round);
+	}
+
+	__atomic_store_n(&done, true, __ATOMIC_RELAXED);
+	for (int i = 0; i <= num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	pthread_barrier_destroy(&barrier);
+	list_destroy(list);
+	conf->flags &= ~(LIST_RC_INSTANCE);
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/list_lock_free_test.log", "w", LOG_LEVEL_INFO);
+	assert(logger);
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		values[i] = i;
+
+	list_conf_t conf =
+	{
+		.flags = LIST_LOCK_FREE | LIST_DELETE_ON_DESTROY,
+		.callbacks.destructors.item = count_delete,
+		.logger = logger
+	};
+
+	conf.flags |= LIST_INDEXED;
+	ASSERT(!list_create_conf(&conf), logger, "list_create_conf: \"Accepted both LIST_LOCK_FREE and LIST_INDEXED!\"");
+	conf.flags &= ~(LIST_INDEXED);
+
+	LOG_INFO(logger, "Testing adding and removing...");
+	test_basic(&conf);
+
+	LOG_INFO(logger, "Testing sorted list...");
+	test_sorted(&conf);
+
+	LOG_INFO(logger, "Testing iterator...");
+	test_iterator(&conf);
+
+	LOG_INFO(logger, "Testing %d threads adding and removing while another iterates...", num_threads);
+	test_concurrent(&conf);
+
+	LOG_INFO(logger, "All tests passed!");
+	logger_destroy(logger);
+
+	return 0;
+}
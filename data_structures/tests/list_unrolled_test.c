@@ -0,0 +1,241 @@
+#define NO_C_UTILS_PREFIX
+#include "../list.h"
+#include "../../io/logger.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+
+static struct c_utils_logger *logger = NULL;
+
+#define NUM_ITEMS 10000
+
+static const int num_threads = 4;
+
+static int values[NUM_ITEMS * 2];
+
+static int deleted = 0;
+
+static long long sum = 0;
+
+static int compare_ints(const void *item_one, const void *item_two) {
+	return *(int *) item_one - *(int *) item_two;
+}
+
+static void count_delete(void *item) {
+	deleted++;
+}
+
+static void add_to_sum(void *item) {
+	sum += *(int *) item;
+}
+
+/// Asserts that the list holds exactly the values from start to end, stepping by step, in order.
+static void check_order(list_t *list, int start, int end, int step) {
+	size_t size;
+	int **array = list_as_array(list, &size);
+	ASSERT(array, logger, "list_as_array: \"Was unable to allocate array!\"");
+
+	size_t expected = 0;
+	for (int i = start; i < end; i += step) {
+		ASSERT((expected < size && *array[expected] == i), logger, "list_as_array: \"Expected %d at index %zu!\"", i, expected);
+		expected++;
+	}
+
+	ASSERT((size == expected && list_size(list) == expected), logger, "list_size: \"Expected %zu items, but found %zu!\"", expected, size);
+	free(array);
+}
+
+static void test_basic(list_conf_t *conf) {
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list!\"");
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT(list_add(list, values + i), logger, "list_add: \"Was unable to add item %d!\"", i);
+
+	check_order(list, 0, NUM_ITEMS, 1);
+
+	for (int i = 0; i < NUM_ITEMS; i += 997) {
+		int *item = list_get(list, i);
+		ASSERT((item && *item == i), logger, "list_get: \"Wrong item at index %d!\"", i);
+		ASSERT(list_contains(list, values + i), logger, "list_contains: \"Did not find item %d!\"", i);
+	}
+
+	ASSERT(!list_get(list, NUM_ITEMS), logger, "list_get: \"Found an item out of bounds!\"");
+	ASSERT(!list_contains(list, values + NUM_ITEMS), logger, "list_contains: \"Found an item which was never added!\"");
+
+	sum = 0;
+	list_for_each(list, add_to_sum);
+	ASSERT((sum == (long long) NUM_ITEMS * (NUM_ITEMS - 1) / 2), logger, "list_for_each: \"Sum of items was %lld!\"", sum);
+
+	LOG_INFO(logger, "Removing all odd items by item and by index...");
+	for (int i = 1; i < NUM_ITEMS / 2; i += 2)
+		list_remove(list, values + i);
+
+	// The items from index NUM_ITEMS / 4 alternate between even and odd, and each removal shifts the next odd item down.
+	for (int i = NUM_ITEMS / 4 + 1; i <= NUM_ITEMS / 2; i++) {
+		int *item = list_remove_at(list, i);
+		ASSERT((item && *item % 2 == 1), logger, "list_remove_at: \"Removed even item %d!\"", item ? *item : -1);
+	}
+
+	check_order(list, 0, NUM_ITEMS, 2);
+	ASSERT(!list_contains(list, values + 1), logger, "list_contains: \"Found removed item!\"");
+
+	LOG_INFO(logger, "Deleting all items...");
+	deleted = 0;
+	list_delete_all(list);
+	ASSERT((deleted == NUM_ITEMS / 2 && list_size(list) == 0), logger, "list_delete_all: \"Deleted %d items!\"", deleted);
+	ASSERT(!list_get(list, 0), logger, "list_get: \"Found an item in an empty list!\"");
+
+	ASSERT(list_add(list, values), logger, "list_add: \"Was unable to add to an emptied list!\"");
+	check_order(list, 0, 1, 1);
+
+	list_destroy(list);
+}
+
+static void test_sorted(list_conf_t *conf) {
+	conf->callbacks.comparators.item = compare_ints;
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list!\"");
+
+	// Adds all items in a scattered order, which fill the chunks from the middle.
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT(list_add(list, values + (i * 7919) % NUM_ITEMS), logger, "list_add: \"Was unable to add item!\"");
+
+	check_order(list, 0, NUM_ITEMS, 1);
+
+	iterator_t *it = list_iterator(list);
+	ASSERT(!iterator_append(it, values), logger, "iterator_append: \"Appended to a sorted list!\"");
+	iterator_destroy(it);
+
+	list_destroy(list);
+	conf->callbacks.comparators.item = NULL;
+}
+
+static void test_iterator(list_conf_t *conf) {
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list!\"");
+
+	LOG_INFO(logger, "Appending and prepending through the iterator...");
+	iterator_t *it = list_iterator(list);
+	for (int i = 0; i < NUM_ITEMS; i += 2)
+		ASSERT(iterator_append(it, values + i), logger, "iterator_append: \"Was unable to append item %d!\"", i);
+
+	// Inserts each odd item before it's successor, splitting every chunk along the way.
+	iterator_head(it);
+	for (int i = 1; i < NUM_ITEMS - 1; i += 2) {
+		int *item = iterator_next(it);
+		ASSERT((item && *item == i + 1), logger, "iterator_next: \"Expected %d, but found %d!\"", i + 1, item ? *item : -1);
+		ASSERT(iterator_prepend(it, values + i), logger, "iterator_prepend: \"Was unable to prepend item %d!\"", i);
+		ASSERT((*(int *) iterator_curr(it) == i), logger, "iterator_curr: \"Not positioned on prepended item!\"");
+		iterator_next(it);
+	}
+
+	ASSERT(iterator_append(it, values + NUM_ITEMS - 1), logger, "iterator_append: \"Was unable to append last item!\"");
+	check_order(list, 0, NUM_ITEMS, 1);
+
+	LOG_INFO(logger, "Removing from the list while iterating...");
+	iterator_destroy(it);
+	it = list_iterator(list);
+
+	// Removing the current item, and the item after the next, merges the chunks out from under the iterator.
+	int *item = iterator_next(it);
+	for (int i = 0; i < NUM_ITEMS; i += 4) {
+		ASSERT((item && *item == i), logger, "iterator_next: \"Expected %d, but found %d!\"", i, item ? *item : -1);
+		list_remove(list, values + i);
+		list_remove(list, values + i + 2);
+
+		ASSERT(!iterator_curr(it), logger, "iterator_curr: \"Found removed item!\"");
+
+		item = iterator_next(it);
+		ASSERT((item && *item == i + 1), logger, "iterator_next: \"Was not corrected after removal of %d!\"", i);
+
+		item = iterator_next(it);
+		ASSERT((item && *item == i + 3), logger, "iterator_next: \"Expected %d, but found %d!\"", i + 3, item ? *item : -1);
+
+		item = iterator_next(it);
+	}
+
+	ASSERT(!item, logger, "iterator_next: \"Iterated past the tail!\"");
+	check_order(list, 1, NUM_ITEMS, 2);
+
+	LOG_INFO(logger, "Clearing the list through the iterator...");
+	deleted = 0;
+	LIST_FOR_EACH_REV(item, list)
+		iterator_delete(_this_iterator);
+
+	ASSERT((list_size(list) == 0 && deleted == NUM_ITEMS / 2), logger, "iterator_delete: \"List still has %zu items!\"", list_size(list));
+	ASSERT(!iterator_next(it), logger, "iterator_next: \"Found item in empty list!\"");
+
+	iterator_destroy(it);
+	list_destroy(list);
+}
+
+static void *iterate(void *list) {
+	for (int round = 0; round < 16; round++) {
+		int *item, last = -1;
+
+		LIST_FOR_EACH(item, list) {
+			ASSERT((*item > last), logger, "iterator_next: \"%d was iterated after %d!\"", *item, last);
+			last = *item;
+		}
+	}
+
+	return NULL;
+}
+
+static void test_concurrent(list_conf_t *conf) {
+	conf->flags |= LIST_CONCURRENT | LIST_RC_INSTANCE;
+	list_t *list = list_create_conf(conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list!\"");
+
+	for (int i = 0; i < NUM_ITEMS * 2; i++)
+		list_add(list, values + i);
+
+	pthread_t threads[num_threads];
+	for (int i = 0; i < num_threads; i++)
+		pthread_create(threads + i, NULL, iterate, list);
+
+	// The iterators should never go backwards or see an item twice, regardless of which chunks are merged.
+	for (int i = 0; i < NUM_ITEMS * 2; i++)
+		if (i % 3)
+			list_remove(list, values + i);
+
+	for (int i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	check_order(list, 0, NUM_ITEMS * 2, 3);
+
+	list_destroy(list);
+	conf->flags &= ~(LIST_CONCURRENT | LIST_RC_INSTANCE);
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/list_unrolled_test.log", "w", LOG_LEVEL_INFO);
+	assert(logger);
+
+	for (int i = 0; i < NUM_ITEMS * 2; i++)
+		values[i] = i;
+
+	list_conf_t conf =
+	{
+		.flags = LIST_UNROLLED,
+		.callbacks.destructors.item = count_delete,
+		.logger = logger
+	};
+
+	size_t chunk_sizes[] = { 0, 1, 8, 100 };
+	for (size_t i = 0; i < sizeof(chunk_sizes) / sizeof(*chunk_sizes); i++) {
+		conf.size.chunk = chunk_sizes[i];
+		LOG_INFO(logger, "Testing chunks of %zu items...", chunk_sizes[i]);
+
+		test_basic(&conf);
+		test_sorted(&conf);
+		test_iterator(&conf);
+		test_concurrent(&conf);
+	}
+
+	LOG_INFO(logger, "All tests passed!");
+	logger_destroy(logger);
+
+	return 0;
+}
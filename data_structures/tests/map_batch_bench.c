@@ -0,0 +1,110 @@
+#define NO_C_UTILS_PREFIX
+#include "../map.h"
+#include "../../io/logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+	Compares a loop of single gets against get_batch on a map which is far larger than the last level
+	cache, so that nearly every lookup misses. Batches are of random keys, as they would be when looking
+	up every session id of a batch of requests.
+*/
+
+static struct c_utils_logger *logger = NULL;
+
+#define KEYS (1 << 22)
+#define LOOKUPS (1 << 23)
+#define BATCH 128
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void noop(void *ptr) {}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/map_batch_bench.log", "w", LOG_LEVEL_ERROR);
+	assert(logger);
+
+	uint64_t *keys = malloc(sizeof(*keys) * KEYS);
+	const void **batch_keys = malloc(sizeof(*batch_keys) * LOOKUPS);
+	void **batch_values = malloc(sizeof(*batch_values) * BATCH);
+	assert(keys && batch_keys && batch_values);
+
+	for(size_t i = 0; i < KEYS; i++)
+		keys[i] = i * 0x9E3779B97F4A7C15ull;
+
+	srand(0);
+	for(size_t i = 0; i < LOOKUPS; i++)
+		batch_keys[i] = keys + ((size_t) rand() * RAND_MAX + rand()) % KEYS;
+
+	printf("%-10s %14s %14s\n", "mode", "get Mops/s", "batch Mops/s");
+
+	const int modes[] = { C_UTILS_MAP_CONCURRENT, C_UTILS_MAP_SHARDED };
+	const char *names[] = { "rwlock", "sharded" };
+	for(int m = 0; m < 2; m++) {
+		map_conf_t conf =
+		{
+			.flags = modes[m],
+			.size =
+			{
+				.initial = KEYS * 2
+			},
+			.callbacks =
+			{
+				.destructors =
+				{
+					.value = noop
+				}
+			},
+			.length =
+			{
+				.key = sizeof(uint64_t)
+			},
+			.logger = logger
+		};
+
+		map_t *map = map_create_conf(&conf);
+		ASSERT(map, logger, "Was unable to create the map!");
+
+		void **pairs = malloc(sizeof(*pairs) * KEYS);
+		assert(pairs);
+
+		for(size_t i = 0; i < KEYS; i++)
+			pairs[i] = keys + i;
+
+		// Keys double as their values.
+		size_t added = map_add_batch(map, pairs, pairs, KEYS);
+		ASSERT((added == KEYS), logger, "Expected to add %d keys, but only added %zu!", KEYS, added);
+		free(pairs);
+
+		volatile uintptr_t sink = 0;
+
+		double start = now();
+		for(size_t i = 0; i < LOOKUPS; i++)
+			sink += (uintptr_t) map_get(map, batch_keys[i]);
+		double single = now() - start;
+
+		size_t found = 0;
+		start = now();
+		for(size_t i = 0; i < LOOKUPS; i += BATCH)
+			found += map_get_batch(map, batch_keys + i, batch_values, BATCH);
+		double batched = now() - start;
+
+		ASSERT((found == LOOKUPS), logger, "Expected to find %d keys, but only found %zu!", LOOKUPS, found);
+
+		printf("%-10s %14.2f %14.2f\n", names[m], LOOKUPS / single / 1e6, LOOKUPS / batched / 1e6);
+		map_destroy(map);
+	}
+
+	free(batch_values);
+	free(batch_keys);
+	free(keys);
+	logger_destroy(logger);
+
+	return EXIT_SUCCESS;
+}
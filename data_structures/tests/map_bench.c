@@ -0,0 +1,179 @@
+#define NO_C_UTILS_PREFIX
+#include "../map.h"
+#include "../../io/logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+	Compares insertion and lookup throughput of the map against the bucket-at-a-time linear probe
+	it replaced, at varying load factors. The legacy table below mirrors the old 32-byte bucket
+	layout (hash, key, value, in-use flag) and uses the same hash function, so only the probing
+	differs, and is kept out of line so it pays for the same calls the map does. Keys are 64-bit
+	integers stored by address, with length.key set accordingly.
+*/
+
+static struct c_utils_logger *logger = NULL;
+
+#define CAPACITY (1 << 20)
+#define LOOKUPS (4 * CAPACITY)
+
+struct legacy_bucket {
+	uint32_t hash;
+	void *key;
+	void *value;
+	bool in_use;
+};
+
+struct legacy_map {
+	struct legacy_bucket *buckets;
+	size_t num_buckets;
+	size_t key_length;
+};
+
+static __attribute__((noinline)) uint32_t hash_key(const void *key, size_t len) {
+	const unsigned char *k = key;
+	uint32_t hash = 0;
+
+	for (uint32_t i = 0;i < len; ++i) {
+		hash += k[i];
+		hash += (hash << 10);
+		hash ^= (hash >> 6);
+	}
+
+	hash += (hash << 3);
+	hash ^= (hash >> 11);
+	hash += (hash << 15);
+
+	return hash;
+}
+
+static __attribute__((noinline)) bool legacy_add(struct legacy_map *map, void *key, void *value) {
+	uint32_t hash = hash_key(key, map->key_length);
+	size_t index = hash % map->num_buckets;
+
+	for(size_t i = 0; i < map->num_buckets; i++, index = (index + 1) % map->num_buckets) {
+		struct legacy_bucket *bucket = map->buckets + index;
+		if(!bucket->in_use) {
+			bucket->hash = hash;
+			bucket->key = key;
+			bucket->value = value;
+			bucket->in_use = true;
+			return true;
+		}
+
+		if(bucket->hash == hash && memcmp(bucket->key, key, map->key_length) == 0)
+			return false;
+	}
+
+	return false;
+}
+
+static __attribute__((noinline)) void *legacy_get(struct legacy_map *map, const void *key) {
+	uint32_t hash = hash_key(key, map->key_length);
+	size_t index = hash % map->num_buckets;
+
+	for(size_t i = 0; i < map->num_buckets; i++, index = (index + 1) % map->num_buckets) {
+		struct legacy_bucket *bucket = map->buckets + index;
+		if(!bucket->in_use)
+			return NULL;
+
+		if(bucket->hash == hash && memcmp(bucket->key, key, map->key_length) == 0)
+			return bucket->value;
+	}
+
+	return NULL;
+}
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void noop(void *ptr) {}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/map_bench.log", "w", LOG_LEVEL_ALL);
+	assert(logger);
+
+	uint64_t *keys = malloc(sizeof(*keys) * CAPACITY);
+	assert(keys);
+
+	srand(0);
+	for(size_t i = 0; i < CAPACITY; i++)
+		keys[i] = ((uint64_t) rand() << 32) ^ rand() ^ i;
+
+	printf("%-6s %-8s %14s %14s\n", "load", "engine", "insert Mops/s", "lookup Mops/s");
+
+	const double loads[] = { .5, .6, .7, .8, .9 };
+	for(size_t l = 0; l < sizeof(loads) / sizeof(*loads); l++) {
+		size_t n = CAPACITY * loads[l];
+		volatile uintptr_t sink = 0;
+		double start, insert, lookup;
+
+		struct legacy_map legacy = { .buckets = calloc(CAPACITY, sizeof(struct legacy_bucket)), .num_buckets = CAPACITY, .key_length = sizeof(uint64_t) };
+		assert(legacy.buckets);
+
+		start = now();
+		for(size_t i = 0; i < n; i++)
+			legacy_add(&legacy, keys + i, keys + i);
+		insert = now() - start;
+
+		start = now();
+		for(size_t i = 0; i < LOOKUPS; i++)
+			sink += (uintptr_t) legacy_get(&legacy, keys + (i * 7919) % n);
+		lookup = now() - start;
+
+		printf("%-6.1f %-8s %14.2f %14.2f\n", loads[l], "legacy", n / insert / 1e6, LOOKUPS / lookup / 1e6);
+		free(legacy.buckets);
+
+		map_conf_t conf =
+		{
+			.size =
+			{
+				.initial = CAPACITY,
+				.max = CAPACITY
+			},
+			.growth =
+			{
+				.trigger = .99
+			},
+			.callbacks =
+			{
+				.destructors =
+				{
+					.value = noop
+				}
+			},
+			.length =
+			{
+				.key = sizeof(uint64_t)
+			},
+			.logger = logger
+		};
+
+		map_t *map = map_create_conf(&conf);
+		ASSERT(map, logger, "Was unable to create the map!");
+
+		start = now();
+		for(size_t i = 0; i < n; i++)
+			map_add(map, keys + i, keys + i);
+		insert = now() - start;
+
+		start = now();
+		for(size_t i = 0; i < LOOKUPS; i++)
+			sink += (uintptr_t) map_get(map, keys + (i * 7919) % n);
+		lookup = now() - start;
+
+		printf("%-6.1f %-8s %14.2f %14.2f\n", loads[l], "map", n / insert / 1e6, LOOKUPS / lookup / 1e6);
+		map_destroy(map);
+	}
+
+	free(keys);
+	logger_destroy(logger);
+
+	return EXIT_SUCCESS;
+}
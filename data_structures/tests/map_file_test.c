@@ -0,0 +1,105 @@
+#define NO_C_UTILS_PREFIX
+#include "../map_file.h"
+#include "../../io/logger.h"
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+
+static struct c_utils_logger *logger = NULL;
+static const char *path = "./data_structures/logs/map_file_test.map";
+static const int num_pairs = 10000;
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/map_file_test.log", "w", LOG_LEVEL_ALL);
+	assert(logger);
+
+	char *keys[] = {
+		"Host",
+		"User-Agent",
+		"Cache-Control",
+		"Accept"
+	};
+
+	char *values[] = {
+		"net.tutsplus.com",
+		"Mozilla/5.0 (Windows; U; Windows NT 6.1; en-US; rv:1.9.1.5) Gecko",
+		"no-cache",
+		"text/html,application/xhtml+xml,application/xml;q=0.9,*/"
+	};
+
+	LOG_INFO(logger, "Creating string map file...");
+	map_conf_t conf = { .logger = logger };
+	map_file_t *map = map_file_open(path, C_UTILS_MAP_FILE_TRUNCATE, &conf);
+	ASSERT(map, logger, "c_utils_map_file_open: \"Was unable to create map file!\"");
+
+	for (int i = 0; i < 4; i++)
+		ASSERT(map_file_add(map, keys[i], values[i]), logger, "c_utils_map_file_add: \"Was unable to add key: \"%s\"!\"", keys[i]);
+
+	ASSERT(!map_file_add(map, keys[0], values[1]), logger, "c_utils_map_file_add: \"Added duplicate key: \"%s\"!\"", keys[0]);
+	ASSERT(map_file_remove(map, keys[1]), logger, "c_utils_map_file_remove: \"Was unable to remove key: \"%s\"!\"", keys[1]);
+	map_file_close(map);
+
+	LOG_INFO(logger, "Reopening string map file read-only...");
+	map = map_file_open(path, C_UTILS_MAP_FILE_READ_ONLY, &conf);
+	ASSERT(map, logger, "c_utils_map_file_open: \"Was unable to reopen map file!\"");
+	ASSERT((map_file_size(map) == 3), logger, "c_utils_map_file_size: \"Expected 3, but received %zu\"", map_file_size(map));
+
+	for (int i = 0; i < 4; i++) {
+		const char *value = map_file_get(map, keys[i]);
+		if (i == 1) {
+			ASSERT(!value, logger, "c_utils_map_file_get: \"Removed key \"%s\" is still present!\"", keys[i]);
+			continue;
+		}
+
+		ASSERT(value && strcmp(value, values[i]) == 0, logger,
+			"c_utils_map_file_get: \"Expected: \"%s\", but received \"%s\"!\"", values[i], value ? value : "NULL");
+	}
+
+	ASSERT(!map_file_add(map, keys[1], values[1]), logger, "c_utils_map_file_add: \"Added to a read-only map file!\"");
+	map_file_close(map);
+
+	LOG_INFO(logger, "Creating fixed-size map file with %d pairs...", num_pairs);
+	conf.length.key = sizeof(int);
+	conf.length.value = sizeof(int);
+	map = map_file_open(path, C_UTILS_MAP_FILE_TRUNCATE, &conf);
+	ASSERT(map, logger, "c_utils_map_file_open: \"Was unable to create map file!\"");
+
+	for (int i = 0; i < num_pairs; i++) {
+		int value = i * 2;
+		ASSERT(map_file_add(map, &i, &value), logger, "c_utils_map_file_add: \"Was unable to add key: %d!\"", i);
+	}
+
+	for (int i = 0; i < num_pairs; i += 2)
+		ASSERT(map_file_remove(map, &i), logger, "c_utils_map_file_remove: \"Was unable to remove key: %d!\"", i);
+
+	ASSERT(map_file_sync(map), logger, "c_utils_map_file_sync: \"Was unable to sync map file!\"");
+	map_file_close(map);
+
+	map = map_file_open(path, 0, &conf);
+	ASSERT(map, logger, "c_utils_map_file_open: \"Was unable to reopen map file!\"");
+	ASSERT((map_file_size(map) == (size_t)num_pairs / 2), logger, "c_utils_map_file_size: \"Expected %d, but received %zu\"",
+		num_pairs / 2, map_file_size(map));
+
+	for (int i = 0; i < num_pairs; i++) {
+		const int *value = map_file_get(map, &i);
+		if (i % 2 == 0) {
+			ASSERT(!value, logger, "c_utils_map_file_get: \"Removed key %d is still present!\"", i);
+			continue;
+		}
+
+		ASSERT(value && *value == i * 2, logger, "c_utils_map_file_get: \"Wrong value for key: %d!\"", i);
+	}
+
+	map_file_close(map);
+
+	LOG_INFO(logger, "Rejecting mismatched record lengths...");
+	conf.length.value = sizeof(long);
+	map = map_file_open(path, C_UTILS_MAP_FILE_READ_ONLY, &conf);
+	ASSERT(!map, logger, "c_utils_map_file_open: \"Opened map file with mismatched value length!\"");
+
+	unlink(path);
+	LOG_INFO(logger, "All tests passed!");
+	logger_destroy(logger);
+
+	return 0;
+}
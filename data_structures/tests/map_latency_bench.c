@@ -0,0 +1,88 @@
+#define NO_C_UTILS_PREFIX
+#include "../map.h"
+#include "../../io/logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+	Measures the latency of each insertion while the map grows from it's initial 64 buckets up
+	to the amount of keys requested (10M by default). As resizing is incremental, the tail latency
+	should stay flat rather than spiking whenever the map has to grow.
+
+	Usage: ./map_latency_bench [keys]
+*/
+
+static struct c_utils_logger *logger = NULL;
+
+static uint64_t now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int cmp_latency(const void *a, const void *b) {
+	uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+	return (x > y) - (x < y);
+}
+
+static void noop(void *ptr) {}
+
+int main(int argc, char *argv[]) {
+	logger = logger_create("./data_structures/logs/map_latency_bench.log", "w", LOG_LEVEL_ERROR);
+	assert(logger);
+
+	size_t num_keys = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+
+	uint64_t *keys = malloc(sizeof(*keys) * num_keys);
+	uint32_t *latencies = malloc(sizeof(*latencies) * num_keys);
+	assert(keys && latencies);
+
+	for(size_t i = 0; i < num_keys; i++)
+		keys[i] = i * 0x9E3779B97F4A7C15ull;
+
+	map_conf_t conf =
+	{
+		.callbacks =
+		{
+			.destructors =
+			{
+				.value = noop
+			}
+		},
+		.length =
+		{
+			.key = sizeof(uint64_t)
+		},
+		.logger = logger
+	};
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "Was unable to create the map!");
+
+	uint64_t start = now_ns();
+	for(size_t i = 0; i < num_keys; i++) {
+		uint64_t before = now_ns();
+		map_add(map, keys + i, keys + i);
+		uint64_t elapsed = now_ns() - before;
+		latencies[i] = elapsed > UINT32_MAX ? UINT32_MAX : elapsed;
+	}
+	uint64_t total = now_ns() - start;
+
+	ASSERT((map_size(map) == num_keys), logger, "Expected %zu keys, but map holds %zu!", num_keys, map_size(map));
+
+	qsort(latencies, num_keys, sizeof(*latencies), cmp_latency);
+
+	printf("Inserted %zu keys in %.2fs\n", num_keys, total / 1e9);
+	printf("p50: %uns, p99: %uns, p99.9: %uns, p99.99: %uns, max: %uns\n",
+		latencies[num_keys / 2], latencies[(size_t) (num_keys * .99)], latencies[(size_t) (num_keys * .999)],
+		latencies[(size_t) (num_keys * .9999)], latencies[num_keys - 1]);
+
+	map_destroy(map);
+	free(latencies);
+	free(keys);
+	logger_destroy(logger);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,160 @@
+#define NO_C_UTILS_PREFIX
+#include "../map.h"
+#include "../../io/logger.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+	Read-mostly benchmark: reader threads look up random keys while a single writer continuously
+	removes and re-adds a small subset of them, roughly one write for every thousand reads. We report
+	the aggregate read throughput of the rwlock (MAP_CONCURRENT) against MAP_OPTIMISTIC_READ as the
+	amount of readers increases.
+*/
+
+static struct c_utils_logger *logger = NULL;
+
+#define KEYS (1 << 20)
+#define READS_PER_THREAD (1 << 20)
+#define READS_PER_WRITE 1000
+#define MAX_THREADS 32
+
+static uint64_t *keys;
+
+static volatile bool done;
+
+static volatile size_t reads;
+
+struct reader {
+	pthread_t thread;
+	map_t *map;
+	uint64_t seed;
+	size_t found;
+};
+
+static uint64_t next_random(uint64_t *seed) {
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 7;
+	*seed ^= *seed << 17;
+	return *seed;
+}
+
+static void *read_keys(void *args) {
+	struct reader *reader = args;
+
+	for(size_t i = 0; i < READS_PER_THREAD; i++)
+		reader->found += map_get(reader->map, keys + next_random(&reader->seed) % KEYS) != NULL;
+
+	__sync_fetch_and_add(&reads, READS_PER_THREAD);
+	return NULL;
+}
+
+static void *write_keys(void *args) {
+	map_t *map = args;
+	uint64_t seed = 0x2545F4914F6CDD1Dull;
+	size_t writes = 0;
+
+	// Pace the writer against the readers, so the ratio holds no matter how many readers there are.
+	while(!done) {
+		if(writes * READS_PER_WRITE > reads + READS_PER_THREAD) {
+			sched_yield();
+			continue;
+		}
+
+		uint64_t *key = keys + next_random(&seed) % KEYS;
+		map_remove(map, key);
+		map_add(map, key, key);
+		writes++;
+	}
+
+	return NULL;
+}
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void noop(void *ptr) {}
+
+static double run(int flags, size_t num_threads) {
+	map_conf_t conf =
+	{
+		.flags = flags,
+		.size =
+		{
+			.initial = KEYS * 2
+		},
+		.callbacks =
+		{
+			.destructors =
+			{
+				.value = noop
+			}
+		},
+		.length =
+		{
+			.key = sizeof(uint64_t)
+		},
+		.logger = logger
+	};
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "Was unable to create the map!");
+
+	for(size_t i = 0; i < KEYS; i++)
+		map_add(map, keys + i, keys + i);
+
+	done = false;
+	reads = 0;
+
+	pthread_t writer;
+	pthread_create(&writer, NULL, write_keys, map);
+
+	struct reader readers[MAX_THREADS];
+	double start = now();
+
+	for(size_t i = 0; i < num_threads; i++) {
+		readers[i].map = map;
+		readers[i].seed = 0x9E3779B97F4A7C15ull * (i + 1);
+		readers[i].found = 0;
+		pthread_create(&readers[i].thread, NULL, read_keys, readers + i);
+	}
+
+	for(size_t i = 0; i < num_threads; i++)
+		pthread_join(readers[i].thread, NULL);
+
+	double elapsed = now() - start;
+
+	done = true;
+	pthread_join(writer, NULL);
+
+	ASSERT((map_size(map) == KEYS), logger, "Expected %d keys, but map holds %zu!", KEYS, map_size(map));
+	map_destroy(map);
+
+	return READS_PER_THREAD * num_threads / elapsed / 1e6;
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/map_read_bench.log", "w", LOG_LEVEL_ERROR);
+	assert(logger);
+
+	keys = malloc(sizeof(*keys) * KEYS);
+	assert(keys);
+
+	for(size_t i = 0; i < KEYS; i++)
+		keys[i] = i * 0x9E3779B97F4A7C15ull;
+
+	printf("%-8s %18s %18s\n", "readers", "rwlock Mops/s", "seqlock Mops/s");
+
+	for(size_t num_threads = 1; num_threads <= MAX_THREADS; num_threads <<= 1)
+		printf("%-8zu %18.2f %18.2f\n", num_threads, run(C_UTILS_MAP_CONCURRENT, num_threads), run(C_UTILS_MAP_OPTIMISTIC_READ, num_threads));
+
+	free(keys);
+	logger_destroy(logger);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,115 @@
+#define NO_C_UTILS_PREFIX
+#include "../map.h"
+#include "../../io/logger.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+	Multi-writer benchmark: each thread inserts a disjoint range of keys into the same map, and we
+	report the aggregate write throughput of a single rwlock (MAP_CONCURRENT) against MAP_SHARDED as
+	the amount of writers increases. Ideally the sharded map scales close to linearly, so long as
+	there are more shards than there are writers.
+*/
+
+static struct c_utils_logger *logger = NULL;
+
+#define KEYS (1 << 21)
+#define MAX_THREADS 32
+
+static uint64_t *keys;
+
+struct writer {
+	pthread_t thread;
+	map_t *map;
+	size_t start;
+	size_t end;
+};
+
+static void *write_keys(void *args) {
+	struct writer *writer = args;
+
+	for(size_t i = writer->start; i < writer->end; i++)
+		map_add(writer->map, keys + i, keys + i);
+
+	return NULL;
+}
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void noop(void *ptr) {}
+
+static double run(int flags, size_t num_threads) {
+	map_conf_t conf =
+	{
+		.flags = flags,
+		.size =
+		{
+			.initial = KEYS * 2,
+			.max = KEYS * 4
+		},
+		.shards = 64,
+		.callbacks =
+		{
+			.destructors =
+			{
+				.value = noop
+			}
+		},
+		.length =
+		{
+			.key = sizeof(uint64_t)
+		},
+		.logger = logger
+	};
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "Was unable to create the map!");
+
+	struct writer writers[MAX_THREADS];
+	double start = now();
+
+	for(size_t i = 0; i < num_threads; i++) {
+		writers[i].map = map;
+		writers[i].start = KEYS / num_threads * i;
+		writers[i].end = i + 1 == num_threads ? KEYS : KEYS / num_threads * (i + 1);
+		pthread_create(&writers[i].thread, NULL, write_keys, writers + i);
+	}
+
+	for(size_t i = 0; i < num_threads; i++)
+		pthread_join(writers[i].thread, NULL);
+
+	double elapsed = now() - start;
+
+	ASSERT((map_size(map) == KEYS), logger, "Expected %d keys, but map holds %zu!", KEYS, map_size(map));
+	map_destroy(map);
+
+	return KEYS / elapsed / 1e6;
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/map_shard_bench.log", "w", LOG_LEVEL_ERROR);
+	assert(logger);
+
+	keys = malloc(sizeof(*keys) * KEYS);
+	assert(keys);
+
+	for(size_t i = 0; i < KEYS; i++)
+		keys[i] = i * 0x9E3779B97F4A7C15ull;
+
+	printf("%-8s %18s %18s\n", "threads", "rwlock Mops/s", "sharded Mops/s");
+
+	for(size_t num_threads = 1; num_threads <= MAX_THREADS; num_threads <<= 1)
+		printf("%-8zu %18.2f %18.2f\n", num_threads, run(C_UTILS_MAP_CONCURRENT, num_threads), run(C_UTILS_MAP_SHARDED, num_threads));
+
+	free(keys);
+	logger_destroy(logger);
+
+	return EXIT_SUCCESS;
+}
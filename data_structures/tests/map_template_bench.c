@@ -0,0 +1,104 @@
+#define NO_C_UTILS_PREFIX
+#include "../map.h"
+#include "../map_template.h"
+#include "../../io/logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+	Compares insertion, hit and miss throughput of a map declared with C_UTILS_MAP_DECLARE for 64-bit
+	integer keys and values against c_utils_map configured as tightly as it allows: keys stored by address
+	with length.key set, no locking, and a table presized so that neither map resizes during lookups.
+*/
+
+static struct c_utils_logger *logger = NULL;
+
+#define KEYS (1 << 20)
+#define LOOKUPS (4 * KEYS)
+
+MAP_DECLARE(u64_map, uint64_t, uint64_t)
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void noop(void *ptr) {}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/map_template_bench.log", "w", LOG_LEVEL_ALL);
+	assert(logger);
+
+	// The first half is added, and the second half is only ever looked up.
+	uint64_t *keys = malloc(sizeof(*keys) * KEYS * 2);
+	assert(keys);
+
+	srand(0);
+	for(size_t i = 0; i < KEYS * 2; i++)
+		keys[i] = ((uint64_t) rand() << 32) ^ rand() ^ i;
+
+	printf("%-10s %-9s %14s %14s %14s\n", "keys", "map", "insert Mops/s", "hit Mops/s", "miss Mops/s");
+
+	for(size_t n = KEYS >> 6; n <= KEYS; n <<= 3) {
+		volatile uint64_t sink = 0;
+		double start, insert, hit, miss;
+
+		map_conf_t conf =
+		{
+			.size.initial = n * 2,
+			.callbacks.destructors.value = noop,
+			.length.key = sizeof(uint64_t),
+			.logger = logger
+		};
+
+		map_t *map = map_create_conf(&conf);
+		ASSERT(map, logger, "Was unable to create the map!");
+
+		start = now();
+		for(size_t i = 0; i < n; i++)
+			map_add(map, keys + i, keys + i);
+		insert = now() - start;
+
+		start = now();
+		for(size_t i = 0; i < LOOKUPS; i++)
+			sink += *(uint64_t *) map_get(map, keys + (i * 7919) % n);
+		hit = now() - start;
+
+		start = now();
+		for(size_t i = 0; i < LOOKUPS; i++)
+			sink += (uintptr_t) map_get(map, keys + KEYS + (i * 7919) % n);
+		miss = now() - start;
+
+		printf("%-10zu %-9s %14.2f %14.2f %14.2f\n", n, "generic", n / insert / 1e6, LOOKUPS / hit / 1e6, LOOKUPS / miss / 1e6);
+		map_destroy(map);
+
+		struct u64_map *specialized = u64_map_create(n);
+		ASSERT(specialized, logger, "Was unable to create the specialized map!");
+
+		start = now();
+		for(size_t i = 0; i < n; i++)
+			u64_map_add(specialized, keys[i], keys[i]);
+		insert = now() - start;
+
+		start = now();
+		for(size_t i = 0; i < LOOKUPS; i++)
+			sink += *u64_map_get(specialized, keys[(i * 7919) % n]);
+		hit = now() - start;
+
+		start = now();
+		for(size_t i = 0; i < LOOKUPS; i++)
+			sink += (uintptr_t) u64_map_get(specialized, keys[KEYS + (i * 7919) % n]);
+		miss = now() - start;
+
+		printf("%-10zu %-9s %14.2f %14.2f %14.2f\n", n, "declared", n / insert / 1e6, LOOKUPS / hit / 1e6, LOOKUPS / miss / 1e6);
+		u64_map_destroy(specialized);
+	}
+
+	free(keys);
+	logger_destroy(logger);
+
+	return EXIT_SUCCESS;
+}
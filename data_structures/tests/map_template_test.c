@@ -0,0 +1,93 @@
+#define NO_C_UTILS_PREFIX
+#include "../map_template.h"
+#include "../../io/logger.h"
+
+static struct c_utils_logger *logger = NULL;
+static const int num_keys = 100000;
+
+struct point {
+	int x;
+	int y;
+};
+
+static inline uint64_t hash_string(const char *str) {
+	return _c_utils_map_template_hash(str, strlen(str));
+}
+
+#define equal_string(a, b) (strcmp(a, b) == 0)
+
+MAP_DECLARE(int_map, uint64_t, uint64_t)
+MAP_DECLARE(point_map, struct point, const char *)
+MAP_DECLARE_CUSTOM(string_map, const char *, int, hash_string, equal_string)
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/map_template_test.log", "w", LOG_LEVEL_ALL);
+	assert(logger);
+
+	LOG_INFO(logger, "Adding %d integer keys...", num_keys);
+	struct int_map *map = int_map_create(0);
+	ASSERT(map, logger, "int_map_create: \"Was unable to create map!\"");
+
+	for (uint64_t i = 0; i < (uint64_t)num_keys; i++)
+		ASSERT(int_map_add(map, i, i * 2), logger, "int_map_add: \"Was unable to add key: %lu!\"", i);
+
+	ASSERT(!int_map_add(map, 0, 0), logger, "int_map_add: \"Added duplicate key: 0!\"");
+	ASSERT((int_map_size(map) == (size_t)num_keys), logger, "int_map_size: \"Expected %d, but received %zu\"", num_keys, int_map_size(map));
+
+	for (uint64_t i = 0; i < (uint64_t)num_keys; i++) {
+		uint64_t *value = int_map_get(map, i);
+		ASSERT((value && *value == i * 2), logger, "int_map_get: \"Wrong value for key: %lu!\"", i);
+	}
+
+	ASSERT(!int_map_get(map, num_keys), logger, "int_map_get: \"Found key %d which was never added!\"", num_keys);
+
+	LOG_INFO(logger, "Removing every other key...");
+	for (uint64_t i = 0; i < (uint64_t)num_keys; i += 2) {
+		uint64_t value;
+		ASSERT((int_map_remove(map, i, &value) && value == i * 2), logger, "int_map_remove: \"Was unable to remove key: %lu!\"", i);
+	}
+
+	for (uint64_t i = 0; i < (uint64_t)num_keys; i++)
+		ASSERT((int_map_contains(map, i) == (i % 2 == 1)), logger, "int_map_contains: \"Wrong result for key %lu after removal!\"", i);
+
+	LOG_INFO(logger, "Iterating...");
+	size_t pos = 0, count = 0;
+	uint64_t key, value;
+	while (int_map_next(map, &pos, &key, &value)) {
+		ASSERT((key % 2 == 1 && value == key * 2), logger, "int_map_next: \"Wrong pair: (%lu, %lu)!\"", key, value);
+		count++;
+	}
+
+	ASSERT((count == (size_t)num_keys / 2), logger, "int_map_next: \"Iterated over %zu pairs, expected %d!\"", count, num_keys / 2);
+
+	int_map_clear(map);
+	ASSERT((int_map_size(map) == 0 && !int_map_contains(map, 1)), logger, "int_map_clear: \"Map is not empty after clear!\"");
+	int_map_destroy(map);
+
+	LOG_INFO(logger, "Testing struct keys...");
+	struct point_map *points = point_map_create(4);
+	ASSERT(points, logger, "point_map_create: \"Was unable to create map!\"");
+	ASSERT(point_map_add(points, (struct point) { 1, 2 }, "a"), logger, "point_map_add: \"Was unable to add point!\"");
+	ASSERT(point_map_add(points, (struct point) { 2, 1 }, "b"), logger, "point_map_add: \"Was unable to add point!\"");
+
+	const char **name = point_map_get(points, (struct point) { 2, 1 });
+	ASSERT((name && strcmp(*name, "b") == 0), logger, "point_map_get: \"Wrong value for point (2, 1)!\"");
+	point_map_destroy(points);
+
+	LOG_INFO(logger, "Testing string keys...");
+	struct string_map *strings = string_map_create(0);
+	ASSERT(strings, logger, "string_map_create: \"Was unable to create map!\"");
+
+	char buffer[] = "key";
+	ASSERT(string_map_add(strings, "key", 1), logger, "string_map_add: \"Was unable to add key!\"");
+	ASSERT(!string_map_add(strings, buffer, 2), logger, "string_map_add: \"Added an equal string twice!\"");
+
+	int *number = string_map_get(strings, buffer);
+	ASSERT((number && *number == 1), logger, "string_map_get: \"Was unable to find an equal string!\"");
+	string_map_destroy(strings);
+
+	LOG_INFO(logger, "All tests passed!");
+	logger_destroy(logger);
+
+	return 0;
+}
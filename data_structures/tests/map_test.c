@@ -3,10 +3,524 @@
 #include "../../io/logger.h"
 #include "../../string/string_buffer.h"
 #include <string.h>
+#include <pthread.h>
 
 static struct c_utils_logger *logger = NULL;
 const int buckets = 31;
 const int synchronized = 0;
+static const int num_counters = 64;
+static const int num_increments = 100000;
+static const int num_threads = 4;
+
+// The keys outlive the map, as optimistic reads do not support a key destructor.
+static int counter_keys[64];
+
+static void *create_counter(const void *key) {
+	int64_t *counter = malloc(sizeof(*counter));
+	*counter = 0;
+	return counter;
+}
+
+static void *sum_counters(void *old, void *value) {
+	*(int64_t *) old += *(int64_t *) value;
+	free(value);
+	return old;
+}
+
+static void *drop_counter(void *old, void *value) {
+	free(old);
+	free(value);
+	return NULL;
+}
+
+static void *count_events(void *map) {
+	for (int i = 0; i < num_increments; i++) {
+		int key = i % num_counters;
+		if (map_increment(map, &key, 1, NULL))
+			continue;
+
+		// The first thread to see the key adds it's counter.
+		map_compute_if_absent(map, counter_keys + key, create_counter, NULL);
+
+		map_increment(map, &key, 1, NULL);
+	}
+
+	return NULL;
+}
+
+static void test_counting(int flags) {
+	map_conf_t conf =
+	{
+		.flags = flags | C_UTILS_MAP_DELETE_ON_DESTROY,
+		.length.key = sizeof(int),
+		.logger = logger
+	};
+
+	for (int i = 0; i < num_counters; i++)
+		counter_keys[i] = i;
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "c_utils_map_create: \"Was unable to allocate hash map!\"");
+	ASSERT(((conf.flags & flags) == flags), logger, "c_utils_map_create: \"Fell back from the flags %d!\"", flags);
+
+	pthread_t threads[num_threads];
+	for (int i = 0; i < num_threads; i++)
+		pthread_create(threads + i, NULL, count_events, map);
+
+	for (int i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	ASSERT((map_size(map) == (size_t)num_counters), logger, "c_utils_map_compute_if_absent: \"Expected %d counters, but found %zu!\"", num_counters, map_size(map));
+	for (int i = 0; i < num_counters; i++) {
+		int64_t count;
+		ASSERT(map_increment(map, &i, 0, &count), logger, "c_utils_map_increment: \"Counter %d is missing!\"", i);
+		ASSERT((count == num_threads * (num_increments / num_counters + (i < num_increments % num_counters))), logger,
+			"c_utils_map_increment: \"Counter %d is %ld!\"", i, count);
+	}
+
+	map_destroy(map);
+}
+
+/// Every key hashes alike, so each key collides with every other.
+static uint32_t colliding_hash(const void *key) {
+	return 42;
+}
+
+static void test_colliding_keys(void) {
+	map_conf_t conf =
+	{
+		.length.key = sizeof(int),
+		.callbacks.hash_function = colliding_hash,
+		.logger = logger
+	};
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "c_utils_map_create: \"Was unable to allocate hash map!\"");
+
+	static int ints[64];
+	for (int i = 0; i < 64; i++) {
+		ints[i] = i;
+		ASSERT(map_add(map, ints + i, ints + i), logger, "c_utils_map_add: \"Was unable to add colliding key: %d!\"", i);
+	}
+
+	int duplicate = 7;
+	ASSERT(!map_add(map, &duplicate, &duplicate), logger, "c_utils_map_add: \"Added duplicate colliding key: %d!\"", duplicate);
+
+	for (int i = 0; i < 64; i++)
+		ASSERT((map_get(map, &i) == ints + i), logger, "c_utils_map_get: \"Colliding key: %d was lost!\"", i);
+
+	for (int i = 0; i < 64; i += 2)
+		ASSERT((map_remove(map, &i) == ints + i), logger, "c_utils_map_remove: \"Was unable to remove colliding key: %d!\"", i);
+
+	for (int i = 0; i < 64; i++)
+		ASSERT((map_get(map, &i) == (i % 2 ? ints + i : NULL)), logger, "c_utils_map_get: \"Wrong value for colliding key: %d after removals!\"", i);
+
+	ASSERT((map_size(map) == 32), logger, "c_utils_map_size: \"Expected 32 colliding keys, but found %zu!\"", map_size(map));
+	map_destroy(map);
+}
+
+/// Checks that every key is visited exactly once, returning how many were visited.
+static size_t count_visits(map_t *map, bool *seen, int num_keys) {
+	memset(seen, 0, num_keys * sizeof(*seen));
+
+	int *key, *value;
+	size_t visited = 0;
+	C_UTILS_MAP_FOR_EACH_PAIR(key, value, map) {
+		ASSERT((*key >= 0 && *key < num_keys && !seen[*key] && value == key), logger, "c_utils_map_iterator: \"Visited key: %d twice or with the wrong value!\"", *key);
+		seen[*key] = true;
+		visited++;
+	}
+
+	return visited;
+}
+
+static void test_shards(void) {
+	map_conf_t conf =
+	{
+		.flags = C_UTILS_MAP_SHARDED,
+		.shards = 8,
+		.length.key = sizeof(int),
+		.logger = logger
+	};
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "c_utils_map_create: \"Was unable to allocate hash map!\"");
+
+	static int ints[1000];
+	static bool seen[1000];
+	for (int i = 0; i < 1000; i++) {
+		ints[i] = i;
+		map_add(map, ints + i, ints + i);
+	}
+
+	ASSERT((map_size(map) == 1000), logger, "c_utils_map_size: \"Expected 1000 pairs across shards, but found %zu!\"", map_size(map));
+	size_t visited = count_visits(map, seen, 1000);
+	ASSERT((visited == 1000), logger, "c_utils_map_iterator: \"Visited %zu of 1000 pairs across shards!\"", visited);
+
+	for (int i = 0; i < 1000; i += 2)
+		map_remove(map, &i);
+
+	ASSERT((map_size(map) == 500), logger, "c_utils_map_size: \"Expected 500 pairs across shards, but found %zu!\"", map_size(map));
+	visited = count_visits(map, seen, 1000);
+	ASSERT((visited == 500), logger, "c_utils_map_iterator: \"Visited %zu of 500 pairs across shards!\"", visited);
+	for (int i = 1; i < 1000; i += 2)
+		ASSERT(seen[i], logger, "c_utils_map_iterator: \"Key: %d was not visited!\"", i);
+
+	map_destroy(map);
+}
+
+static void test_resizing(void) {
+	// Shrinking by half at a load factor of .3 would leave the map above the growth trigger, unless held back.
+	map_conf_t conf =
+	{
+		.flags = C_UTILS_MAP_STATS | C_UTILS_MAP_SHRINK_ON_TRIGGER,
+		.shrink.trigger = .3,
+		.length.key = sizeof(int),
+		.logger = logger
+	};
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "c_utils_map_create: \"Was unable to allocate hash map!\"");
+
+	static int ints[1000];
+	map_stats_t stats;
+	int migrating = 0;
+	for (int i = 0; i < 1000; i++) {
+		ints[i] = i;
+		map_add(map, ints + i, ints + i);
+
+		// Moved slots only exist while the old table is still being migrated from.
+		map_stats(map, &stats);
+		if (stats.tombstone_ratio == 0)
+			continue;
+
+		migrating++;
+		for (int j = 0; j <= i; j++)
+			ASSERT((map_get(map, &j) == ints + j), logger, "c_utils_map_get: \"Key: %d was lost while migrating!\"", j);
+	}
+
+	ASSERT(migrating, logger, "c_utils_map_add: \"The map was never seen in the middle of a migration!\"");
+
+	// Removes keys until the map shrinks once.
+	map_stats(map, &stats);
+	size_t capacity = stats.capacity;
+	int removed = 0;
+	while (stats.capacity == capacity && removed < 1000) {
+		map_remove(map, &removed);
+		removed++;
+		map_stats(map, &stats);
+	}
+
+	ASSERT((stats.capacity < capacity), logger, "c_utils_map_remove: \"The map never shrunk!\"");
+
+	// Adding and removing a couple of keys right where it shrunk must not make it grow or shrink again.
+	size_t resizes = stats.counters.resizes;
+	for (int i = 0; i < 100; i++) {
+		for (int key = removed - 2; key < removed; key++)
+			map_add(map, ints + key, ints + key);
+
+		for (int key = removed - 2; key < removed; key++)
+			map_remove(map, &key);
+	}
+
+	map_stats(map, &stats);
+	ASSERT((stats.counters.resizes == resizes), logger, "c_utils_map_remove: \"The map resized %zu more times around the shrink trigger!\"", stats.counters.resizes - resizes);
+
+	for (int i = removed; i < 1000; i++)
+		ASSERT((map_get(map, &i) == ints + i), logger, "c_utils_map_get: \"Key: %d was lost after shrinking!\"", i);
+
+	map_destroy(map);
+}
+
+/// Marks the key of the value as seen, failing if it was already seen.
+static void visit(bool *seen, int *value) {
+	ASSERT(!seen[*value], logger, "c_utils_map_iterator: \"Visited key: %d twice!\"", *value);
+	seen[*value] = true;
+}
+
+/*
+	Walks a sharded map forwards and backwards, then grows it underneath an iterator halfway through. A snapshot
+	iterator must still visit exactly the pairs it was created with; a cursor must end early rather than revisit any.
+*/
+static void test_iterators(int flags) {
+	map_conf_t conf =
+	{
+		.flags = flags | C_UTILS_MAP_SHARDED,
+		.shards = 4,
+		.length.key = sizeof(int),
+		.logger = logger
+	};
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "c_utils_map_create: \"Was unable to allocate hash map!\"");
+
+	static int ints[1100];
+	static bool seen[1100];
+	for (int i = 0; i < 1100; i++)
+		ints[i] = i;
+
+	for (int i = 0; i < 100; i++)
+		map_add(map, ints + i, ints + i);
+
+	int *value;
+	size_t visited = 0;
+	memset(seen, 0, sizeof(seen));
+	struct c_utils_iterator *it = c_utils_map_iterator(map);
+	while ((value = iterator_next(it))) {
+		visit(seen, value);
+		visited++;
+	}
+	iterator_destroy(it);
+	ASSERT((visited == 100), logger, "c_utils_map_iterator: \"Visited %zu of 100 pairs forwards!\"", visited);
+
+	visited = 0;
+	memset(seen, 0, sizeof(seen));
+	it = c_utils_map_iterator(map);
+	for (value = iterator_tail(it); value; value = iterator_prev(it)) {
+		visit(seen, value);
+		visited++;
+	}
+	iterator_destroy(it);
+	ASSERT((visited == 100), logger, "c_utils_map_iterator: \"Visited %zu of 100 pairs backwards!\"", visited);
+
+	visited = 0;
+	memset(seen, 0, sizeof(seen));
+	it = c_utils_map_iterator(map);
+	for (; visited < 50 && (value = iterator_next(it)); visited++)
+		visit(seen, value);
+
+	for (int i = 100; i < 1100; i++)
+		map_add(map, ints + i, ints + i);
+
+	for (; (value = iterator_next(it)); visited++)
+		visit(seen, value);
+	iterator_destroy(it);
+
+	if (flags & C_UTILS_MAP_SNAPSHOT_ITERATOR) {
+		ASSERT((visited == 100), logger, "c_utils_map_iterator: \"Snapshot visited %zu of 100 pairs!\"", visited);
+		for (int i = 0; i < 100; i++)
+			ASSERT(seen[i], logger, "c_utils_map_iterator: \"Snapshot did not visit key: %d!\"", i);
+	} else {
+		ASSERT((visited < 1100), logger, "c_utils_map_iterator: \"Cursor did not end after the map grew underneath it!\"");
+	}
+
+	map_destroy(map);
+}
+
+/// Batches span several shards and more than one batch of 64 keys, with some keys present beforehand.
+static void test_batches(int flags) {
+	map_conf_t conf =
+	{
+		.flags = flags,
+		.shards = 4,
+		.length.key = sizeof(int),
+		.logger = logger
+	};
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "c_utils_map_create: \"Was unable to allocate hash map!\"");
+
+	static int ints[300];
+	void *keys[300], *values[300];
+	for (int i = 0; i < 300; i++) {
+		ints[i] = i;
+		keys[i] = ints + i;
+	}
+
+	for (int i = 0; i < 200; i += 10)
+		map_add(map, ints + i, ints + i);
+
+	// Keys 0 to 199, of which the 20 multiples of 10 are already present.
+	size_t added = map_add_batch(map, keys, keys, 200);
+	ASSERT((added == 180 && map_size(map) == 200), logger, "c_utils_map_add_batch: \"Expected 180 added and 200 pairs, but found %zu and %zu!\"",
+		added, map_size(map));
+
+	// Keys 100 to 299, of which only 100 to 199 are present.
+	size_t found = map_get_batch(map, (const void **) keys + 100, values, 200);
+	ASSERT((found == 100), logger, "c_utils_map_get_batch: \"Expected 100 found, but found %zu!\"", found);
+	for (int i = 0; i < 200; i++)
+		ASSERT((values[i] == (i < 100 ? ints + 100 + i : NULL)), logger, "c_utils_map_get_batch: \"Wrong value for key: %d!\"", 100 + i);
+
+	map_destroy(map);
+}
+
+static const int num_stable = 100;
+static const int num_transient = 20000;
+static int racing_ints[20100];
+static bool writing;
+
+/// Reads without locking, while the writer grows and shrinks the map underneath.
+static void *read_optimistic(void *map) {
+	for (int round = 0; __atomic_load_n(&writing, __ATOMIC_ACQUIRE); round++) {
+		for (int i = 0; i < num_stable; i++)
+			ASSERT((map_get(map, &i) == racing_ints + i), logger, "c_utils_map_get: \"Key: %d was lost during a resize!\"", i);
+
+		int key = num_stable + round % num_transient;
+		void *value = map_get(map, &key);
+		ASSERT((!value || value == racing_ints + key), logger, "c_utils_map_get: \"Wrong value for key: %d during a resize!\"", key);
+	}
+
+	return NULL;
+}
+
+static void test_optimistic_reads(void) {
+	map_conf_t conf =
+	{
+		.flags = C_UTILS_MAP_OPTIMISTIC_READ | C_UTILS_MAP_SHARDED | C_UTILS_MAP_SHRINK_ON_TRIGGER | C_UTILS_MAP_STATS,
+		.length.key = sizeof(int),
+		.logger = logger
+	};
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "c_utils_map_create: \"Was unable to allocate hash map!\"");
+
+	for (int i = 0; i < num_stable + num_transient; i++)
+		racing_ints[i] = i;
+
+	for (int i = 0; i < num_stable; i++)
+		map_add(map, racing_ints + i, racing_ints + i);
+
+	__atomic_store_n(&writing, true, __ATOMIC_RELEASE);
+	pthread_t threads[num_threads];
+	for (int i = 0; i < num_threads; i++)
+		pthread_create(threads + i, NULL, read_optimistic, map);
+
+	for (int round = 0; round < 3; round++) {
+		for (int i = num_stable; i < num_stable + num_transient; i++)
+			map_add(map, racing_ints + i, racing_ints + i);
+
+		for (int i = num_stable; i < num_stable + num_transient; i++)
+			map_remove(map, &i);
+	}
+
+	__atomic_store_n(&writing, false, __ATOMIC_RELEASE);
+	for (int i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	map_stats_t stats;
+	map_stats(map, &stats);
+	ASSERT((stats.size == (size_t) num_stable && stats.counters.resizes > 0), logger,
+		"c_utils_map_stats: \"Expected %d pairs after resizing, but found %zu after %zu resizes!\"", num_stable, stats.size, stats.counters.resizes);
+
+	map_destroy(map);
+
+	// A key destructor could free a key which a reader is comparing against, so the map falls back to locked reads.
+	conf = (map_conf_t) { .flags = C_UTILS_MAP_OPTIMISTIC_READ, .callbacks.destructors.key = free, .logger = logger };
+	map = map_create_conf(&conf);
+	ASSERT(map, logger, "c_utils_map_create: \"Was unable to allocate hash map!\"");
+	ASSERT((!(conf.flags & C_UTILS_MAP_OPTIMISTIC_READ) && conf.flags & C_UTILS_MAP_CONCURRENT), logger,
+		"c_utils_map_create: \"Optimistic reads were kept along with a key destructor!\"");
+
+	map_destroy(map);
+}
+
+/// Every four consecutive keys share a home slot, so removals shift the pairs after them back.
+static uint32_t clustered_hash(const void *key) {
+	return *(const int *) key / 4;
+}
+
+static void test_remove_while_iterating(void) {
+	map_conf_t conf =
+	{
+		.length.key = sizeof(int),
+		.callbacks.hash_function = clustered_hash,
+		.size.initial = 1024,
+		.logger = logger
+	};
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "c_utils_map_create: \"Was unable to allocate hash map!\"");
+
+	static int ints[256];
+	bool seen[256] = { false };
+	for (int i = 0; i < 256; i++) {
+		ints[i] = i;
+		map_add(map, ints + i, ints + i);
+	}
+
+	int *key, *value;
+	size_t visited = 0;
+	C_UTILS_MAP_FOR_EACH_PAIR(key, value, map) {
+		ASSERT(!seen[*key], logger, "c_utils_map_iterator: \"Visited key: %d twice!\"", *key);
+		seen[*key] = true;
+		visited++;
+
+		if (*key % 2 == 0)
+			ASSERT((map_remove(map, key) == value), logger, "c_utils_map_remove: \"Was unable to remove key: %d!\"", *key);
+	}
+
+	ASSERT((visited == 256 && map_size(map) == 128), logger, "c_utils_map_iterator: \"Visited %zu of 256 keys, leaving %zu!\"", visited, map_size(map));
+	map_destroy(map);
+}
+
+static int reverse_ints[64];
+
+static void keep_value(void *value) {}
+
+static int compare_ints(const void *first, const void *second) {
+	return *(const int *) first - *(const int *) second;
+}
+
+static void test_reverse_index(void) {
+	map_conf_t conf =
+	{
+		.flags = C_UTILS_MAP_REVERSE_INDEX,
+		.size.initial = 8,
+		.reverse.trigger = .5,
+		.callbacks.destructors.value = keep_value,
+		.length = { .key = sizeof(int), .value = sizeof(int) },
+		.logger = logger
+	};
+
+	for (int i = 0; i < 64; i++)
+		reverse_ints[i] = i;
+
+	map_t *map = map_create_conf(&conf);
+	ASSERT(map, logger, "c_utils_map_create: \"Was unable to allocate hash map!\"");
+
+	// Each key is it's own value, and so many more than the index starts with are added, that it must grow several times over.
+	for (int i = 0; i < 64; i++)
+		ASSERT(map_add(map, reverse_ints + i, reverse_ints + i), logger, "c_utils_map_add: \"Was unable to add key: %d!\"", i);
+
+	for (int i = 0; i < 64; i++)
+		ASSERT((map_contains(map, reverse_ints + i) == reverse_ints + i), logger, "c_utils_map_contains: \"Lost value %d after the index grew!\"", i);
+
+	ASSERT((map_remove(map, reverse_ints) == reverse_ints && !map_contains(map, reverse_ints)), logger,
+		"c_utils_map_remove: \"Removed value is still indexed!\"");
+	ASSERT((map_delete(map, reverse_ints + 1) && !map_contains(map, reverse_ints + 1)), logger, "c_utils_map_delete: \"Deleted value is still indexed!\"");
+	ASSERT((map_contains(map, reverse_ints + 2) == reverse_ints + 2), logger, "c_utils_map_contains: \"Lost a value which was not removed!\"");
+
+	map_delete_all(map);
+	for (int i = 0; i < 64; i++)
+		ASSERT(!map_contains(map, reverse_ints + i), logger, "c_utils_map_delete_all: \"Value %d is still indexed!\"", i);
+
+	// Several keys map to the same value, which must be found for as long as any of them remains.
+	for (int i = 0; i < 4; i++)
+		map_add(map, reverse_ints + i, reverse_ints + 63);
+
+	for (int i = 0; i < 4; i++) {
+		const int *key = map_contains(map, reverse_ints + 63);
+		ASSERT((key && *key >= i && *key < 4), logger, "c_utils_map_contains: \"Expected one of the remaining keys, but found %d!\"", key ? *key : -1);
+
+		map_remove(map, reverse_ints + i);
+	}
+
+	ASSERT(!map_contains(map, reverse_ints + 63), logger, "c_utils_map_contains: \"Value is still indexed after removing every key!\"");
+	map_destroy(map);
+
+	// Without a value hash, values equal by the comparator may not hash equally, so the index falls back to a scan.
+	conf = (map_conf_t) { .flags = C_UTILS_MAP_REVERSE_INDEX, .callbacks.comparators.value = compare_ints, .length.key = sizeof(int), .logger = logger };
+	map = map_create_conf(&conf);
+	ASSERT((map && !(conf.flags & C_UTILS_MAP_REVERSE_INDEX)), logger, "c_utils_map_create: \"Kept the index without a value hash!\"");
+
+	int equal = 5;
+	map_add(map, reverse_ints, reverse_ints + 5);
+	ASSERT((map_contains(map, &equal) == reverse_ints), logger, "c_utils_map_contains: \"The scan did not use the value comparator!\"");
+	map_remove(map, reverse_ints);
+	ASSERT(!map_contains(map, &equal), logger, "c_utils_map_contains: \"Removed value is still found by the scan!\"");
+
+	map_destroy(map);
+}
 
 int main(void) {
 	logger = logger_create("./data_structures/logs/map_test.log", "w", LOG_LEVEL_ALL);
@@ -94,6 +608,114 @@ int main(void) {
 	LOG_INFO(logger, "Testing retrieval of key by value...");
 	ASSERT(strcmp(keys[1], c_utils_map_contains(map, values[1])) == 0, logger, "c_utils_map_contains: \"Was unable to find value inside of map!\"");
 	
+	LOG_INFO(logger, "Testing statistics...");
+	map_conf_t stats_conf =
+	{
+		.flags = C_UTILS_MAP_STATS,
+		.length.key = sizeof(int),
+		.logger = logger
+	};
+
+	map_t *stats_map = map_create_conf(&stats_conf);
+	ASSERT(stats_map, logger, "c_utils_map_create: \"Was unable to allocate hash map!\"");
+
+	static int ints[1000];
+	for (int i = 0; i < 1000; i++) {
+		ints[i] = i;
+		map_add(stats_map, ints + i, ints + i);
+	}
+
+	for (int i = 0; i < 2000; i++)
+		map_get(stats_map, &i);
+
+	map_stats_t stats;
+	ASSERT(map_stats(stats_map, &stats), logger, "c_utils_map_stats: \"Was unable to obtain statistics!\"");
+	LOG_INFO(logger, "Size: %zu, Capacity: %zu, Load Factor: %.3f, Average Probe: %.3f, Max Probe: %zu, Lookups: %zu, Misses: %zu, Resizes: %zu, Resize Time: %zuns",
+		stats.size, stats.capacity, stats.load_factor, stats.probe.average, stats.probe.max, stats.counters.lookups,
+		stats.counters.misses, stats.counters.resizes, stats.counters.resize_ns);
+
+	size_t histogram_total = 0;
+	for (int i = 0; i < C_UTILS_MAP_STATS_HISTOGRAM; i++)
+		histogram_total += stats.probe.histogram[i];
+
+	ASSERT((stats.size == 1000 && histogram_total == 1000), logger, "c_utils_map_stats: \"Expected 1000 pairs, but found %zu!\"", stats.size);
+	ASSERT((stats.load_factor > 0 && stats.load_factor < .5 && stats.probe.average >= 1), logger, "c_utils_map_stats: \"Bad load factor or probe length!\"");
+	ASSERT((stats.counters.lookups == 2000 && stats.counters.misses == 1000), logger,
+		"c_utils_map_stats: \"Expected 2000 lookups and 1000 misses, but counted %zu and %zu!\"", stats.counters.lookups, stats.counters.misses);
+	ASSERT((stats.counters.resizes > 0 && stats.counters.average_probe >= 1), logger, "c_utils_map_stats: \"Resizes or lookups were not counted!\"");
+	map_destroy(stats_map);
+
+	LOG_INFO(logger, "Testing upsert, compute_if_absent and merge...");
+	map_conf_t merge_conf =
+	{
+		.flags = C_UTILS_MAP_REVERSE_INDEX,
+		.length = { .key = sizeof(int), .value = sizeof(int64_t) },
+		.logger = logger
+	};
+
+	map_t *merge_map = map_create_conf(&merge_conf);
+	ASSERT(merge_map, logger, "c_utils_map_create: \"Was unable to allocate hash map!\"");
+
+	static int merge_keys[] = { 0, 1 };
+	int64_t *counter = create_counter(NULL), *replaced;
+	ASSERT((map_upsert(merge_map, merge_keys, counter, (void **) &replaced) && !replaced), logger, "c_utils_map_upsert: \"Was unable to add key: 0!\"");
+
+	int64_t *other = create_counter(NULL);
+	*other = 5;
+	ASSERT((map_upsert(merge_map, merge_keys, other, (void **) &replaced) && replaced == counter), logger, "c_utils_map_upsert: \"Did not replace key: 0!\"");
+	ASSERT((map_get(merge_map, merge_keys) == other && map_contains(merge_map, other) == merge_keys), logger, "c_utils_map_upsert: \"Replaced value is not found!\"");
+	ASSERT(!map_contains(merge_map, replaced), logger, "c_utils_map_upsert: \"Old value is still indexed!\"");
+	free(replaced);
+
+	bool added;
+	ASSERT((map_compute_if_absent(merge_map, merge_keys, create_counter, &added) == other && !added), logger, "c_utils_map_compute_if_absent: \"Computed a present key!\"");
+	int64_t *computed = map_compute_if_absent(merge_map, merge_keys + 1, create_counter, &added);
+	ASSERT((computed && *computed == 0 && added), logger, "c_utils_map_compute_if_absent: \"Was unable to compute key: 1!\"");
+
+	int64_t *amount = create_counter(NULL);
+	*amount = 3;
+	int64_t *merged = map_merge(merge_map, merge_keys, amount, sum_counters, &added);
+	ASSERT((merged == other && *merged == 8 && !added), logger, "c_utils_map_merge: \"Expected 8, but received %ld!\"", merged ? *merged : -1);
+	ASSERT((map_merge(merge_map, merge_keys + 1, create_counter(NULL), drop_counter, NULL) == NULL && !map_get(merge_map, merge_keys + 1)), logger,
+		"c_utils_map_merge: \"Was unable to remove key: 1!\"");
+
+	int64_t sum;
+	ASSERT((map_increment(merge_map, merge_keys, 2, &sum) && sum == 10), logger, "c_utils_map_increment: \"Expected 10, but received %ld!\"", sum);
+	ASSERT(!map_increment(merge_map, merge_keys + 1, 1, NULL), logger, "c_utils_map_increment: \"Incremented a missing key!\"");
+	map_delete_all(merge_map);
+	map_destroy(merge_map);
+
+	LOG_INFO(logger, "Testing the reverse index...");
+	test_reverse_index();
+
+	LOG_INFO(logger, "Testing colliding keys...");
+	test_colliding_keys();
+
+	LOG_INFO(logger, "Testing size and iteration across shards...");
+	test_shards();
+
+	LOG_INFO(logger, "Testing growing and shrinking...");
+	test_resizing();
+
+	LOG_INFO(logger, "Testing cursor and snapshot iterators...");
+	test_iterators(0);
+	test_iterators(C_UTILS_MAP_SNAPSHOT_ITERATOR);
+
+	LOG_INFO(logger, "Testing batches...");
+	test_batches(0);
+	test_batches(C_UTILS_MAP_SHARDED);
+
+	LOG_INFO(logger, "Testing optimistic reads during resizes with %d threads...", num_threads);
+	test_optimistic_reads();
+
+	LOG_INFO(logger, "Testing removal of the current pair while iterating...");
+	test_remove_while_iterating();
+
+	LOG_INFO(logger, "Counting with %d threads...", num_threads);
+	test_counting(C_UTILS_MAP_CONCURRENT);
+	test_counting(C_UTILS_MAP_SHARDED);
+	test_counting(C_UTILS_MAP_OPTIMISTIC_READ | C_UTILS_MAP_SHARDED);
+
 	LOG_INFO(logger, "Destroy Hash Map...");
 	
 	LOG_INFO(logger, "Success!");
@@ -0,0 +1,162 @@
+#define NO_C_UTILS_PREFIX
+#include "../skip_list.h"
+#include "../list.h"
+#include "../../io/logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+/*
+	Compares the lock-free skip list against a sorted c_utils_list behind it's rwlock, both with a node per
+	item and with LIST_INDEXED, for several amounts of threads. Each thread adds, removes and looks up random
+	keys, of which 10% are adds, 10% are removes, and the rest lookups. The set starts half full, and the list
+	accepts duplicates, so both stay about that size throughout.
+*/
+
+static struct c_utils_logger *logger = NULL;
+
+#define KEYS (1 << 12)
+#define OPS_PER_THREAD 20000
+
+static int values[KEYS];
+
+static uint64_t found = 0;
+
+struct ops {
+	void *instance;
+	bool (*add)(void *instance, void *item);
+	void (*remove)(void *instance, void *item);
+	bool (*contains)(void *instance, void *item);
+	unsigned int seed;
+};
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void noop(void *item) {}
+
+static int compare_ints(const void *item_one, const void *item_two) {
+	return *(int *) item_one - *(int *) item_two;
+}
+
+static bool set_add(void *set, void *item) {
+	return skip_list_add(set, item);
+}
+
+static void set_remove(void *set, void *item) {
+	skip_list_remove(set, item);
+}
+
+static bool set_contains(void *set, void *item) {
+	return skip_list_contains(set, item);
+}
+
+static bool locked_add(void *list, void *item) {
+	return list_add(list, item);
+}
+
+static void locked_remove(void *list, void *item) {
+	list_remove(list, item);
+}
+
+static bool locked_contains(void *list, void *item) {
+	return list_contains(list, item);
+}
+
+static void *run(void *data) {
+	struct ops *ops = data;
+	uint64_t hits = 0;
+
+	for (int i = 0; i < OPS_PER_THREAD; i++) {
+		unsigned int rand = rand_r(&ops->seed);
+		void *item = values + (rand >> 4) % KEYS;
+
+		switch (rand % 10) {
+			case 0:
+				ops->add(ops->instance, item);
+				break;
+			case 1:
+				ops->remove(ops->instance, item);
+				break;
+			default:
+				hits += ops->contains(ops->instance, item);
+		}
+	}
+
+	__atomic_add_fetch(&found, hits, __ATOMIC_RELAXED);
+	return NULL;
+}
+
+static double bench(struct ops *prototype, int num_threads) {
+	pthread_t threads[num_threads];
+	struct ops ops[num_threads];
+
+	for (int i = 0; i < KEYS; i += 2)
+		prototype->add(prototype->instance, values + i);
+
+	double start = now();
+	for (int i = 0; i < num_threads; i++) {
+		ops[i] = *prototype;
+		ops[i].seed = i + 1;
+		pthread_create(threads + i, NULL, run, ops + i);
+	}
+
+	for (int i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	return (double) OPS_PER_THREAD * num_threads / (now() - start) / 1e6;
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/skip_list_bench.log", "w", LOG_LEVEL_INFO);
+	assert(logger);
+
+	for (int i = 0; i < KEYS; i++)
+		values[i] = i;
+
+	int thread_counts[] = { 1, 2, 4, 8 };
+	printf("%d keys, %d ops per thread\n", KEYS, OPS_PER_THREAD);
+	printf("%-8s %16s %16s %16s\n", "threads", "list Mops/s", "indexed Mops/s", "skip_list Mops/s");
+
+	for (size_t i = 0; i < sizeof(thread_counts) / sizeof(*thread_counts); i++) {
+		double results[3];
+
+		for (int j = 0; j < 2; j++) {
+			list_conf_t conf =
+			{
+				.flags = LIST_CONCURRENT | (j ? LIST_INDEXED : 0),
+				.callbacks.comparators.item = compare_ints,
+				.callbacks.destructors.item = noop,
+				.logger = logger
+			};
+
+			struct ops ops = { .add = locked_add, .remove = locked_remove, .contains = locked_contains };
+			ops.instance = list_create_conf(&conf);
+			ASSERT(ops.instance, logger, "Was unable to create the list!");
+
+			results[j] = bench(&ops, thread_counts[i]);
+			list_destroy(ops.instance);
+		}
+
+		skip_list_conf_t conf = { .callbacks.comparators.item = compare_ints, .logger = logger };
+		struct ops ops = { .add = set_add, .remove = set_remove, .contains = set_contains };
+		ops.instance = skip_list_create_conf(&conf);
+		ASSERT(ops.instance, logger, "Was unable to create the skip list!");
+
+		results[2] = bench(&ops, thread_counts[i]);
+		skip_list_destroy(ops.instance);
+
+		printf("%-8d %16.2f %16.2f %16.2f\n", thread_counts[i], results[0], results[1], results[2]);
+	}
+
+	// So that the lookups are not optimized away.
+	LOG_INFO(logger, "Found: %lu", found);
+	logger_destroy(logger);
+
+	return EXIT_SUCCESS;
+}
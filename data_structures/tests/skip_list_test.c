@@ -0,0 +1,164 @@
+#define NO_C_UTILS_PREFIX
+#include "../skip_list.h"
+#include "../../io/logger.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+
+static struct c_utils_logger *logger = NULL;
+
+#define NUM_ITEMS 100000
+
+static const int num_threads = 4;
+
+static int values[NUM_ITEMS];
+
+static volatile int deleted = 0;
+
+static int compare_ints(const void *item_one, const void *item_two) {
+	return *(int *) item_one - *(int *) item_two;
+}
+
+static void count_delete(void *item) {
+	deleted++;
+}
+
+static void test_basic(skip_list_conf_t *conf) {
+	skip_list_t *list = skip_list_create_conf(conf);
+	ASSERT(list, logger, "skip_list_create_conf: \"Was unable to create set!\"");
+
+	// Adds every item in a scattered order.
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT(skip_list_add(list, values + (i * 7919L) % NUM_ITEMS), logger, "skip_list_add: \"Was unable to add item!\"");
+
+	ASSERT((skip_list_size(list) == NUM_ITEMS), logger, "skip_list_size: \"Expected %d items, but found %zu!\"", NUM_ITEMS, skip_list_size(list));
+
+	// A distinct item which compares equal to one already held.
+	int duplicate = 5;
+	ASSERT(!skip_list_add(list, &duplicate), logger, "skip_list_add: \"Added an item equal to one already held!\"");
+	ASSERT((skip_list_get(list, &duplicate) == values + 5), logger, "skip_list_get: \"Did not find the item equal to the key!\"");
+
+	int missing = NUM_ITEMS;
+	ASSERT(!skip_list_get(list, &missing), logger, "skip_list_get: \"Found an item which was never added!\"");
+
+	for (int i = 0; i < NUM_ITEMS; i += 2)
+		ASSERT((skip_list_remove(list, values + i) == values + i), logger, "skip_list_remove: \"Did not remove item %d!\"", i);
+
+	ASSERT(!skip_list_remove(list, values), logger, "skip_list_remove: \"Removed an item twice!\"");
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		ASSERT((skip_list_contains(list, values + i) == (i % 2)), logger, "skip_list_contains: \"Wrong result for item %d!\"", i);
+
+	deleted = 0;
+	skip_list_destroy(list);
+	ASSERT((deleted == NUM_ITEMS / 2), logger, "skip_list_destroy: \"Deleted %d items!\"", deleted);
+}
+
+struct workload {
+	skip_list_t *list;
+	int id;
+	volatile int removed;
+};
+
+/// Each thread adds it's own share of the items, while removing every item from the share of the thread before it.
+static void *add_and_remove(void *data) {
+	struct workload *work = data;
+	int prev = (work->id + num_threads - 1) % num_threads;
+
+	for (int i = work->id; i < NUM_ITEMS; i += num_threads)
+		ASSERT(skip_list_add(work->list, values + i), logger, "skip_list_add: \"Was unable to add item %d!\"", i);
+
+	for (int i = prev; i < NUM_ITEMS; i += num_threads)
+		if (i % 3 && skip_list_remove(work->list, values + i))
+			work->removed++;
+
+	// Multiples of 3 are never removed, so each this thread added must still be held.
+	for (int i = work->id; i < NUM_ITEMS; i += num_threads)
+		ASSERT((i % 3 || skip_list_contains(work->list, values + i)), logger, "skip_list_contains: \"Lost item %d!\"", i);
+
+	return NULL;
+}
+
+/// Every thread removes every item, so that each is only removed by one of them.
+static void *remove_all(void *data) {
+	struct workload *work = data;
+
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		int *item = skip_list_remove(work->list, values + i);
+		if (item) {
+			ASSERT((item == values + i), logger, "skip_list_remove: \"Removed the wrong item!\"");
+			work->removed++;
+		}
+	}
+
+	return NULL;
+}
+
+static void run(skip_list_t *list, void *(*callback)(void *), struct workload *work) {
+	pthread_t threads[num_threads];
+
+	for (int i = 0; i < num_threads; i++) {
+		work[i] = (struct workload) { .list = list, .id = i };
+		pthread_create(threads + i, NULL, callback, work + i);
+	}
+
+	for (int i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+}
+
+static void test_concurrent(skip_list_conf_t *conf) {
+	skip_list_t *list = skip_list_create_conf(conf);
+	ASSERT(list, logger, "skip_list_create_conf: \"Was unable to create set!\"");
+
+	struct workload work[num_threads];
+
+	// Each item which is not a multiple of 3 is removed, though possibly before it was added, and then not at all.
+	for (int round = 0; round < 4; round++) {
+		run(list, add_and_remove, work);
+
+		for (int i = 0; i < NUM_ITEMS; i++)
+			if (i % 3)
+				skip_list_remove(list, values + i);
+
+		ASSERT((skip_list_size(list) == (NUM_ITEMS + 2) / 3), logger, "skip_list_size: \"Expected %d items, but found %zu!\"", (NUM_ITEMS + 2) / 3, skip_list_size(list));
+
+		run(list, remove_all, work);
+
+		int removed = 0;
+		for (int i = 0; i < num_threads; i++)
+			removed += work[i].removed;
+
+		ASSERT((removed == (NUM_ITEMS + 2) / 3), logger, "skip_list_remove: \"Removed %d items!\"", removed);
+		ASSERT((skip_list_size(list) == 0), logger, "skip_list_size: \"%zu items were left!\"", skip_list_size(list));
+	}
+
+	skip_list_destroy(list);
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/skip_list_test.log", "w", LOG_LEVEL_INFO);
+	assert(logger);
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+		values[i] = i;
+
+	skip_list_conf_t conf =
+	{
+		.callbacks.comparators.item = compare_ints,
+		.callbacks.destructors.item = count_delete,
+		.logger = logger
+	};
+
+	ASSERT(!skip_list_create(NULL), logger, "skip_list_create: \"Created a set without a comparator!\"");
+
+	LOG_INFO(logger, "Testing basic operations...");
+	test_basic(&conf);
+
+	LOG_INFO(logger, "Testing with %d threads...", num_threads);
+	test_concurrent(&conf);
+
+	LOG_INFO(logger, "All tests passed!");
+	logger_destroy(logger);
+
+	return 0;
+}
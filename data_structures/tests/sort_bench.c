@@ -0,0 +1,108 @@
+#define NO_C_UTILS_PREFIX
+#include "../sort.h"
+#include "../../threading/thread_pool.h"
+#include "../../io/logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+	Compares sorting an array of pointers to random integers, as c_utils_list_as_array would return, by qsort,
+	c_utils_sort, c_utils_sort_radix and c_utils_sort_parallel on pools of an increasing amount of threads. Each
+	sorts the same shuffled copy, and is checked against the result of qsort.
+*/
+
+static struct c_utils_logger *logger = NULL;
+
+#define NUM_ITEMS 10000000
+
+#define MAX_THREADS 8
+
+static unsigned int values[NUM_ITEMS];
+
+static void *original[NUM_ITEMS];
+
+static void *expected[NUM_ITEMS];
+
+static void *array[NUM_ITEMS];
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int compare_values(const void *item_one, const void *item_two) {
+	unsigned int one = *(unsigned int *) item_one, two = *(unsigned int *) item_two;
+	return (one > two) - (one < two);
+}
+
+static int compare_ptrs(const void *ptr_one, const void *ptr_two) {
+	return compare_values(*(void **) ptr_one, *(void **) ptr_two);
+}
+
+static uint64_t value_key(const void *item) {
+	return *(unsigned int *) item;
+}
+
+static void check(const char *name) {
+	for (size_t i = 0; i < NUM_ITEMS; i++)
+		ASSERT((*(unsigned int *) array[i] == *(unsigned int *) expected[i]), logger, "%s: \"Item %zu differs from qsort!\"", name, i);
+}
+
+static void report(const char *name, double elapsed, double baseline) {
+	printf("%-20s %12.1f %12.2fx\n", name, elapsed * 1e3, baseline / elapsed);
+}
+
+int main(void) {
+	logger = logger_create("./data_structures/logs/sort_bench.log", "w", LOG_LEVEL_INFO);
+	assert(logger);
+
+	unsigned int seed = NUM_ITEMS;
+	for (size_t i = 0; i < NUM_ITEMS; i++) {
+		values[i] = rand_r(&seed);
+		original[i] = values + i;
+	}
+
+	printf("%-20s %12s %12s\n", "sort", "ms", "vs qsort");
+
+	memcpy(expected, original, sizeof(original));
+	double start = now();
+	qsort(expected, NUM_ITEMS, sizeof(void *), compare_ptrs);
+	double baseline = now() - start;
+	report("qsort", baseline, baseline);
+
+	memcpy(array, original, sizeof(original));
+	start = now();
+	sort(array, NUM_ITEMS, compare_values);
+	report("sort", now() - start, baseline);
+	check("sort");
+
+	memcpy(array, original, sizeof(original));
+	start = now();
+	ASSERT(sort_radix(array, NUM_ITEMS, value_key), logger, "sort_radix: \"Was unable to sort!\"");
+	report("sort_radix", now() - start, baseline);
+	check("sort_radix");
+
+	for (size_t threads = 1; threads <= MAX_THREADS; threads <<= 1) {
+		struct c_utils_thread_pool_conf conf = { .num_threads = threads, .logger = logger };
+		struct c_utils_thread_pool *pool = c_utils_thread_pool_create_conf(&conf);
+		ASSERT(pool, logger, "thread_pool_create_conf: \"Was unable to create a pool of %zu threads!\"", threads);
+
+		char name[32];
+		snprintf(name, sizeof(name), "sort_parallel (%zu)", threads);
+
+		memcpy(array, original, sizeof(original));
+		start = now();
+		ASSERT(sort_parallel(array, NUM_ITEMS, compare_values, pool), logger, "sort_parallel: \"Was unable to sort!\"");
+		report(name, now() - start, baseline);
+		check(name);
+
+		c_utils_thread_pool_destroy(pool);
+	}
+
+	logger_destroy(logger);
+
+	return EXIT_SUCCESS;
+}
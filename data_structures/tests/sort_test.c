@@ -0,0 +1,212 @@
+#define NO_C_UTILS_PREFIX
+#include "../sort.h"
+#include "../list.h"
+#include "../heap.h"
+#include "../../threading/thread_pool.h"
+#include "../../io/logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static struct c_utils_logger *logger = NULL;
+
+#define NUM_ITEMS 100000
+
+static const int num_threads = 4;
+
+struct record {
+	unsigned int key;
+	unsigned int order;
+};
+
+static int values[NUM_ITEMS];
+
+static struct record records[NUM_ITEMS];
+
+static void *array[NUM_ITEMS];
+
+static int compare_ints(const void *item_one, const void *item_two) {
+	int one = *(int *) item_one, two = *(int *) item_two;
+	return (one > two) - (one < two);
+}
+
+static int compare_ptrs(const void *ptr_one, const void *ptr_two) {
+	return compare_ints(*(void **) ptr_one, *(void **) ptr_two);
+}
+
+static uint64_t record_key(const void *item) {
+	return ((struct record *) item)->key;
+}
+
+static void fill(int max) {
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		values[i] = max ? rand() % max : 0;
+		array[i] = values + i;
+	}
+}
+
+static void check_sorted(void **items, size_t size, const char *what) {
+	for (size_t i = 1; i < size; i++)
+		ASSERT((compare_ints(items[i - 1], items[i]) <= 0), logger, "%s: \"Items %zu and %zu are out of order!\"", what, i - 1, i);
+}
+
+static void test_sort(void) {
+	// Random, with many duplicates, and all equal.
+	int maxes[] = { RAND_MAX, 100, 0 };
+	for (size_t i = 0; i < sizeof(maxes) / sizeof(*maxes); i++) {
+		fill(maxes[i]);
+		sort(array, NUM_ITEMS, compare_ints);
+		check_sorted(array, NUM_ITEMS, "sort");
+	}
+
+	// Already sorted, and then reversed, which defeat a naive pivot.
+	fill(RAND_MAX);
+	sort(array, NUM_ITEMS, compare_ints);
+	sort(array, NUM_ITEMS, compare_ints);
+	check_sorted(array, NUM_ITEMS, "sort");
+
+	for (int i = 0; i < NUM_ITEMS / 2; i++) {
+		void *tmp = array[i];
+		array[i] = array[NUM_ITEMS - 1 - i];
+		array[NUM_ITEMS - 1 - i] = tmp;
+	}
+	sort(array, NUM_ITEMS, compare_ints);
+	check_sorted(array, NUM_ITEMS, "sort");
+
+	// Small sizes are finished by the insertion sort alone.
+	for (size_t size = 0; size < 20; size++) {
+		fill(RAND_MAX);
+		sort(array, size, compare_ints);
+		check_sorted(array, size, "sort");
+	}
+}
+
+static void test_radix(void) {
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		records[i] = (struct record) { .key = rand() % 1000, .order = i };
+		array[i] = records + i;
+	}
+
+	ASSERT(sort_radix(array, NUM_ITEMS, record_key), logger, "sort_radix: \"Was unable to sort!\"");
+
+	for (int i = 1; i < NUM_ITEMS; i++) {
+		struct record *prev = array[i - 1], *curr = array[i];
+		ASSERT((prev->key < curr->key || (prev->key == curr->key && prev->order < curr->order)), logger, "sort_radix: \"Records %d and %d are out of order!\"", i - 1, i);
+	}
+}
+
+static void test_parallel(struct c_utils_thread_pool *pool) {
+	static void *expected[NUM_ITEMS];
+
+	// Sizes around the minimum, and ones which do not split evenly across the threads.
+	size_t sizes[] = { 0, 1, SORT_PARALLEL_MIN - 1, SORT_PARALLEL_MIN + 1, NUM_ITEMS - 3, NUM_ITEMS };
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(*sizes); i++) {
+		fill(i % 2 ? RAND_MAX : 1000);
+
+		memcpy(expected, array, sizeof(array));
+		qsort(expected, sizes[i], sizeof(void *), compare_ptrs);
+
+		ASSERT(sort_parallel(array, sizes[i], compare_ints, pool), logger, "sort_parallel: \"Was unable to sort %zu items!\"", sizes[i]);
+
+		for (size_t j = 0; j < sizes[i]; j++)
+			ASSERT((*(int *) array[j] == *(int *) expected[j]), logger, "sort_parallel: \"Item %zu differs from qsort for %zu items!\"", j, sizes[i]);
+	}
+}
+
+static void test_list_sort(int flags) {
+	list_conf_t conf = { .flags = flags };
+	list_t *list = list_create_conf(&conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list with flags %d!\"", flags);
+
+	fill(RAND_MAX);
+	for (int i = 0; i < NUM_ITEMS / 10; i++)
+		ASSERT(list_add(list, values + i), logger, "list_add: \"Was unable to add item %d!\"", i);
+
+	ASSERT(list_sort(list, compare_ints), logger, "list_sort: \"Was unable to sort list with flags %d!\"", flags);
+	ASSERT((list_size(list) == NUM_ITEMS / 10), logger, "list_sort: \"Expected %d items, but found %zu!\"", NUM_ITEMS / 10, list_size(list));
+
+	size_t size;
+	void **items = list_as_array(list, &size);
+	check_sorted(items, size, "list_sort");
+
+	// Indexing must follow the new order, including the express lanes of an indexed list.
+	for (unsigned int i = 0; i < size; i += 97)
+		ASSERT((list_get(list, i) == items[i]), logger, "list_get: \"Item %u is not where it was sorted to!\"", i);
+
+	// And items added afterwards must still be found.
+	ASSERT(list_add(list, values + NUM_ITEMS - 1), logger, "list_add: \"Was unable to add after sorting!\"");
+	ASSERT(list_contains(list, values + NUM_ITEMS - 1), logger, "list_contains: \"Was unable to find item added after sorting!\"");
+
+	free(items);
+	list_destroy(list);
+}
+
+static void test_list_sort_rejected(void) {
+	list_conf_t conf = { .flags = LIST_LOCK_FREE };
+	list_t *list = list_create_conf(&conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create lock-free list!\"");
+	ASSERT(!list_sort(list, compare_ints), logger, "list_sort: \"Sorted a lock-free list!\"");
+	list_destroy(list);
+
+	conf = (list_conf_t) { .callbacks.comparators.item = compare_ints };
+	list = list_create_conf(&conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create sorted list!\"");
+	ASSERT(list_sort(list, compare_ints), logger, "list_sort: \"Rejected the list's own comparator!\"");
+	ASSERT(!list_sort(list, compare_ptrs), logger, "list_sort: \"Sorted a sorted list by another comparator!\"");
+	list_destroy(list);
+}
+
+static void test_heap(void) {
+	fill(RAND_MAX);
+
+	heap_t *heap = heap_create_from(compare_ints, array, NUM_ITEMS / 2);
+	ASSERT(heap, logger, "heap_create_from: \"Was unable to create heap!\"");
+
+	// A smaller batch is moved up one at a time, and a larger one rebuilds the heap.
+	ASSERT(heap_insert_all(heap, array + NUM_ITEMS / 2, 10), logger, "heap_insert_all: \"Was unable to insert a small batch!\"");
+	ASSERT(heap_insert_all(heap, array + NUM_ITEMS / 2 + 10, NUM_ITEMS / 2 - 10), logger, "heap_insert_all: \"Was unable to insert a large batch!\"");
+	ASSERT((heap_size(heap) == NUM_ITEMS), logger, "heap_insert_all: \"Expected %d items, but found %zu!\"", NUM_ITEMS, heap_size(heap));
+
+	// Removed in descending order.
+	int *prev = heap_remove(heap);
+	for (int i = 1; i < NUM_ITEMS; i++) {
+		int *curr = heap_remove(heap);
+		ASSERT((curr && *curr <= *prev), logger, "heap_remove: \"Item %d was removed out of order!\"", i);
+		prev = curr;
+	}
+
+	ASSERT(!heap_remove(heap), logger, "heap_remove: \"Heap was not empty!\"");
+	heap_destroy(heap);
+}
+
+LOGGER_AUTO_CREATE(logger, "data_structures/logs/sort_test.log", "w", LOG_LEVEL_ALL);
+
+int main(void) {
+	srand(0);
+
+	test_sort();
+	LOG_INFO(logger, "Introsort Test Passed!");
+
+	test_radix();
+	LOG_INFO(logger, "Radix Sort Test Passed!");
+
+	struct c_utils_thread_pool_conf pool_conf = { .num_threads = num_threads };
+	struct c_utils_thread_pool *pool = c_utils_thread_pool_create_conf(&pool_conf);
+	ASSERT(pool, logger, "thread_pool_create_conf: \"Was unable to create thread pool!\"");
+
+	test_parallel(pool);
+	test_parallel(NULL);
+	c_utils_thread_pool_destroy(pool);
+	LOG_INFO(logger, "Parallel Sort Test Passed!");
+
+	test_list_sort(0);
+	test_list_sort(LIST_INDEXED);
+	test_list_sort(LIST_UNROLLED);
+	test_list_sort_rejected();
+	LOG_INFO(logger, "List Sort Test Passed!");
+
+	test_heap();
+	LOG_INFO(logger, "Heap Bulk Load Test Passed!");
+
+	return 0;
+}
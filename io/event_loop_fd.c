@@ -1,5 +1,6 @@
 #include "event_loop_fd.h"
 #include "../data_structures/list.h"
+#include "../data_structures/cow_array.h"
 #include "logger.h"
 #include "../memory/ref_count.h"
 #include "../misc/argument_check.h"
@@ -30,8 +31,8 @@ struct c_utils_event_loop_fd {
 	struct c_utils_list *add_sources;
 	/// Synchronized list of sources to remove from the original list.
 	struct c_utils_list *remove_sources;
-	/// Synchronized list of sources currently polling on.
-	struct c_utils_list *sources;
+	/// Sources currently polling on, only changed by the loop itself, and read through a snapshot each iteration.
+	struct c_utils_cow_array *sources;
 	/// Configuration
 	struct c_utils_event_loop_fd_conf conf;
 };
@@ -140,11 +141,12 @@ static inline bool is_bad_fd(struct c_utils_logger *logger, struct pollfd *fd, c
 
 /*
 	Where we poll the pollfd array, check them when woken to see any are ready, and if they are,
-	dispatch them through their dispatcher callback.
+	dispatch them through their dispatcher callback. The sources are the same snapshot the pollfd
+	array was built from, so each source lines up with it's file descriptor.
 */
-static void poll_fds(struct c_utils_event_loop_fd *loop, struct pollfd *fds, int size) {
+static void poll_fds(struct c_utils_event_loop_fd *loop, struct pollfd *fds, struct c_utils_event_source_fd **sources, size_t num_sources) {
 	int retval;
-	C_UTILS_TEMP_FAILURE_RETRY(retval, poll(fds, size, -1));
+	C_UTILS_TEMP_FAILURE_RETRY(retval, poll(fds, num_sources + 1, -1));
 	if (retval == -1) {
 		C_UTILS_LOG_ERROR(loop->conf.logger, "poll: \"%s\"", strerror(errno));
 		loop->running = false;
@@ -163,9 +165,6 @@ static void poll_fds(struct c_utils_event_loop_fd *loop, struct pollfd *fds, int
 		}
 	}
 
-	size_t num_sources;
-	struct c_utils_event_source_fd **sources = (void *) c_utils_list_as_array(loop->sources, &num_sources);
-
 	// Skip the first as it is the wake_fd, loop while we have more left and not at end.
 	for(int i = 1; retval && i <= num_sources; i++) {
 		struct c_utils_event_source_fd *source = sources[i-1];
@@ -183,8 +182,6 @@ static void poll_fds(struct c_utils_event_loop_fd *loop, struct pollfd *fds, int
 			retval--;
 		}
 	}
-
-	free(sources);
 }
 
 /*
@@ -205,12 +202,12 @@ static void update_loop_sources(struct c_utils_event_loop_fd *loop) {
 
 	// First, we add any new_sources to the list of sources.
 	C_UTILS_LIST_FOR_EACH(source, loop->add_sources)
-		c_utils_list_add(loop->sources, source);
+		c_utils_cow_array_add(loop->sources, source);
 	c_utils_list_remove_all(loop->add_sources);
 
 	// Then we clear sources of any removed_sources.
 	C_UTILS_LIST_FOR_EACH(source, loop->remove_sources)
-		c_utils_list_remove(loop->add_sources, source);
+		c_utils_cow_array_remove(loop->sources, source);
 	c_utils_list_delete_all(loop->remove_sources);
 }
 
@@ -232,12 +229,19 @@ static void start_loop(struct c_utils_event_loop_fd *loop) {
 		if(!loop->running)
 			break;
 
+		/*
+			The sources rarely change, so rather than copying them under a lock on each iteration, we take
+			the current snapshot, which is only a reference, and build the pollfd array from it.
+		*/
+		size_t num_sources;
+		struct c_utils_event_source_fd **sources = (void *) c_utils_cow_array_acquire(loop->sources, &num_sources);
+
 		/*
 			We add the wake_fd first to guarantee ease of retrieval when we are polling. The wake_fd is used
 			to wake up the event_loop to add more sources if there is no new data to poll on currently.
 		*/
 		int index = 0;
-		struct pollfd fds[c_utils_list_size(loop->sources) + 1];
+		struct pollfd fds[num_sources + 1];
 		fds[index++] = (struct pollfd) {
 			.fd = loop->wake_fd,
 			.events = POLLIN
@@ -246,19 +250,27 @@ static void start_loop(struct c_utils_event_loop_fd *loop) {
 		/*
 			And below, we add the rest of the event_source file descriptors to be polled on.
 		*/
-		struct c_utils_event_source_fd *source;
-		C_UTILS_LIST_FOR_EACH(source, loop->sources)
+		for(size_t i = 0; i < num_sources; i++)
 			fds[index++] = (struct pollfd) {
-				.fd =source->fd,
+				.fd = sources[i]->fd,
 				.events =
-					((source->conf.type & C_UTILS_EVENT_SOURCE_TYPE_READ) ? POLLIN : 0) |
-				  ((source->conf.type & C_UTILS_EVENT_SOURCE_TYPE_WRITE) ? POLLOUT : 0)
+					((sources[i]->conf.type & C_UTILS_EVENT_SOURCE_TYPE_READ) ? POLLIN : 0) |
+				  ((sources[i]->conf.type & C_UTILS_EVENT_SOURCE_TYPE_WRITE) ? POLLOUT : 0)
 
 			};
 
-		poll_fds(loop, fds, index);
+		poll_fds(loop, fds, sources, num_sources);
+		c_utils_cow_array_release((void **) sources);
 	}
 
-	c_utils_list_delete_all(loop->sources);
+	// No snapshot is held any longer, so each remaining source can be finished with.
+	size_t num_sources;
+	struct c_utils_event_source_fd **sources = (void *) c_utils_cow_array_acquire(loop->sources, &num_sources);
+	c_utils_cow_array_remove_all(loop->sources);
+
+	for(size_t i = 0; i < num_sources; i++)
+		finished_with_source(sources[i]);
+
+	c_utils_cow_array_release((void **) sources);
 }
 
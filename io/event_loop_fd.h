@@ -47,10 +47,9 @@ struct c_utils_event_source_fd;
 	handle finalizing the user_data by calling finalizer if it is passed, and if user_data is
 	not NULL.
 
-	Due to the underlying list using a RWLock, and it's iterator with node-correction, it will
-	allow a more effiicent way of iteration through the list. Removing a the source can be done immediately
-	as the node-correction algorithm will simply jump to the next one. Once can also add sources safely between
-	iterations due to the iterator. Sometimes the source will be checked twice, but that is no real issue.
+	The sources are held in a copy-on-write array, so each poll acquires a snapshot of them with a single
+	atomic load rather than copying them out from under a lock. Adding or removing a source publishes a new
+	snapshot, which is seen on the next iteration, while the snapshot being polled stays valid until it is released.
 
 	When the source's dispatcher returns true, it will decrement it's own reference count. This mean, if the user
 	wishes to use it in another (or even the same) event_loop at a later time, they may do so as it will not be
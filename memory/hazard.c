@@ -1,22 +1,35 @@
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
 
 #include "hazard.h"
 #include "../io/logger.h"
-#include "../data_structures/list.h"
 #include "../misc/alloc_check.h"
-#include "../misc/argument_check.h"
+
+struct c_utils_hazard_retired {
+	void *data;
+	void (*destructor)(void *);
+};
 
 struct c_utils_hazard {
 	volatile bool in_use;
 	size_t id;
-	struct c_utils_list *retired;
 	void *owned[C_UTILS_HAZARD_PER_THREAD];
-	void (*destructor)(void *);
+	/// Pointers retired by this thread which may still be in use, along with how to destroy each.
+	struct c_utils_hazard_retired *retired;
+	size_t num_retired;
+	size_t max_retired;
+	/// Reused by each scan to take a snapshot of every hazard pointer, so that scanning does not allocate.
+	void **snapshot;
+	size_t max_snapshot;
 	struct c_utils_hazard *next;
 };
 
 struct c_utils_hazard_list {
 	struct c_utils_hazard *head;
+	/// The amount of hazard pointers across all threads.
 	volatile size_t size;
 	void (*destructor)(void *);
 };
@@ -27,10 +40,10 @@ static pthread_key_t tls;
 
 static struct c_utils_logger *logger = NULL;
 
-static const int max_hazard_pointers = C_UTILS_HAZARD_THREADS * C_UTILS_HAZARD_PER_THREAD;
-
 C_UTILS_LOGGER_AUTO_CREATE(logger, "./memory/logs/hazard.log", "w", C_UTILS_LOG_LEVEL_INFO);
 
+static void release_hp(void *hp);
+
 __attribute__((constructor)) static void init_hazard_table(void) {
 	C_UTILS_ON_BAD_CALLOC(hazard_table, logger, sizeof(*hazard_table))
 		return;
@@ -40,166 +53,227 @@ __attribute__((constructor)) static void init_hazard_table(void) {
 }
 
 __attribute__((constructor)) static void init_tls_key(void) {
-	pthread_key_create(&tls, NULL);
+	pthread_key_create(&tls, release_hp);
 }
 
 /*
-	TODO: Major, please optimize this thing, I can't even tell it's complexity. I think
-	O(N^3)? Regardless, it's awfully inefficient, and a hash table would at least make it O(N).
+	At exit, no thread may still be using what was retired, so everything is destroyed regardless of
+	the hazard pointers.
 */
 __attribute__((destructor)) static void destroy_hazard_table(void) {
-	struct c_utils_hazard *prev_hp = NULL;
-	struct c_utils_list *del_list = c_utils_list_create(false);
-
-	for (struct c_utils_hazard *hp = hazard_table->head; hp; hp = hp->next) {
-		free(prev_hp);
-		struct c_utils_iterator *it = c_utils_list_iterator(hp->retired);
-
-		for (int i = 0; i < C_UTILS_HAZARD_PER_THREAD; i++)
-			if (hp->owned[i] && !c_utils_list_contains(del_list, hp->owned[i]))
-				c_utils_list_add(del_list, hp->owned[i], NULL);
-
-		void *ptr;
-		while ((ptr = c_utils_iterator_next(it)))
-			if (!c_utils_list_contains(del_list, ptr))
-				c_utils_list_add(del_list, ptr, NULL);
-		
-		prev_hp = hp;
-		c_utils_list_destroy(hp->retired, NULL);
-		free(it);
+	struct c_utils_hazard *hp = hazard_table->head;
+	while (hp) {
+		struct c_utils_hazard *next = hp->next;
+
+		for (size_t i = 0; i < hp->num_retired; i++)
+			hp->retired[i].destructor(hp->retired[i].data);
+
+		free(hp->retired);
+		free(hp->snapshot);
+		free(hp);
+		hp = next;
 	}
-	free(prev_hp);
-	c_utils_list_destroy(del_list, hazard_table->destructor);
+
 	free(hazard_table);
 	pthread_key_delete(tls);
 }
 
+/// When a thread exits, it's hazard pointers are cleared and handed to the next thread which needs them.
+static void release_hp(void *data) {
+	struct c_utils_hazard *hp = data;
+
+	for (int i = 0; i < C_UTILS_HAZARD_PER_THREAD; i++)
+		__atomic_store_n(&hp->owned[i], NULL, __ATOMIC_RELEASE);
+
+	__atomic_store_n(&hp->in_use, false, __ATOMIC_RELEASE);
+}
+
+static int compare_ptrs(const void *first, const void *second) {
+	uintptr_t a = (uintptr_t) *(void **) first, b = (uintptr_t) *(void **) second;
+	return (a > b) - (a < b);
+}
+
+/*
+	Destroys each pointer retired by this thread which is not held as a hazard pointer by any thread. The
+	hazard pointers are sorted, so that this takes O(R log H) rather than O(R * H), for R retired and H
+	hazard pointers.
+*/
 static void scan(struct c_utils_hazard *hp) {
-	struct c_utils_list *private_list = c_utils_list_create(false);
-	/*
-		Loop through the hazard pointers owned by each thread. Add them to the private if they
-		are non-NULL, hence in use.
-	*/
-	for (struct c_utils_hazard *tmp_hp = hazard_table->head; tmp_hp; tmp_hp = tmp_hp->next)
-		for (int i = 0; i < C_UTILS_HAZARD_PER_THREAD; i++)
-			if (tmp_hp->owned[i])
-				c_utils_list_add(private_list, tmp_hp->owned[i], NULL);
-	
-	size_t arr_size = 0, tmp_arr_size = 0;
-	void **tmp_arr = c_utils_list_as_array(hp->retired, &arr_size);
-	c_utils_list_clear(hp->retired, NULL);
-	
-	/*
-		Since each thread has it's own list of retired pointers, we check to see
-		if this thread's "retired" is no longer in the list of hazard pointers, hence
-		no longer in use and can be freed.
-	*/
-	tmp_arr_size = arr_size;
-	for (int i = 0; i < arr_size; i++)
-		if (c_utils_list_contains(private_list, tmp_arr[i])) {
-			C_UTILS_LOG_TRACE(logger, "Added data to retirement from hazard table for HP #%zu!", hp->id);
-			c_utils_list_add(hp->retired, tmp_arr[i], NULL);
+	size_t size = 0;
+
+	// Every hazard pointer must have been published before we read them.
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	for (struct c_utils_hazard *tmp_hp = __atomic_load_n(&hazard_table->head, __ATOMIC_ACQUIRE); tmp_hp; tmp_hp = tmp_hp->next)
+		for (int i = 0; i < C_UTILS_HAZARD_PER_THREAD; i++) {
+			void *data = __atomic_load_n(&tmp_hp->owned[i], __ATOMIC_ACQUIRE);
+			if (!data)
+				continue;
+
+			// Only grows when more threads have started using hazard pointers since the last scan.
+			if (size == hp->max_snapshot) {
+				size_t max = hp->max_snapshot ? hp->max_snapshot * 2 : C_UTILS_HAZARD_THREADS * C_UTILS_HAZARD_PER_THREAD;
+				C_UTILS_ON_BAD_REALLOC(&hp->snapshot, logger, max * sizeof(*hp->snapshot)) {
+					C_UTILS_LOG_ERROR(logger, "Was unable to grow the snapshot, so nothing can be destroyed by this scan!");
+					return;
+				}
+
+				hp->max_snapshot = max;
+			}
+
+			hp->snapshot[size++] = data;
+		}
+
+	// If no thread holds a hazard pointer, the snapshot may not even be allocated yet, and everything is destroyed.
+	if (size)
+		qsort(hp->snapshot, size, sizeof(*hp->snapshot), compare_ptrs);
+
+	size_t kept = 0;
+	for (size_t i = 0; i < hp->num_retired; i++) {
+		struct c_utils_hazard_retired retired = hp->retired[i];
+
+		if (size && bsearch(&retired.data, hp->snapshot, size, sizeof(*hp->snapshot), compare_ptrs)) {
+			hp->retired[kept++] = retired;
 		} else {
-			hazard_table->destructor(tmp_arr[i]);
-			C_UTILS_LOG_TRACE(logger, "Deleted data from hazard table #%zu! Size: %zu!", hp->id, --tmp_arr_size);
+			retired.destructor(retired.data);
+			C_UTILS_LOG_TRACE(logger, "Deleted data from hazard table #%zu!", hp->id);
 		}
+	}
 
-	free(tmp_arr);
-	c_utils_list_destroy(private_list, NULL);
+	hp->num_retired = kept;
 }
 
+/// Only grows when more threads have started using hazard pointers, or when help_scan takes on another thread's.
+static bool push_retired(struct c_utils_hazard *hp, void *data, void (*destructor)(void *)) {
+	if (hp->num_retired == hp->max_retired) {
+		size_t max = hp->max_retired ? hp->max_retired * 2 : 2 * C_UTILS_HAZARD_THREADS * C_UTILS_HAZARD_PER_THREAD;
+		C_UTILS_ON_BAD_REALLOC(&hp->retired, logger, max * sizeof(*hp->retired)) {
+			C_UTILS_LOG_ERROR(logger, "Was unable to grow the retirement list, so the data will be leaked!");
+			return false;
+		}
+
+		hp->max_retired = max;
+	}
+
+	hp->retired[hp->num_retired++] = (struct c_utils_hazard_retired) { data, destructor };
+	C_UTILS_LOG_TRACE(logger, "Added data to retirement list for HP #%zu with size: %zu!", hp->id, hp->num_retired);
+
+	return true;
+}
+
+/// Takes on what threads which have since exited had retired, so that it is not held onto forever.
 static void help_scan(struct c_utils_hazard *hp) {
-	for (struct c_utils_hazard *tmp_hp = hazard_table->head; tmp_hp; tmp_hp = tmp_hp->next) {
+	for (struct c_utils_hazard *tmp_hp = __atomic_load_n(&hazard_table->head, __ATOMIC_ACQUIRE); tmp_hp; tmp_hp = tmp_hp->next) {
 		// If we fail to mark the hazard pointer as active, then it's already in use.
-		if (tmp_hp->in_use || !__sync_bool_compare_and_swap(&tmp_hp->in_use, false, true)) 
+		if (tmp_hp->in_use || !__sync_bool_compare_and_swap(&tmp_hp->in_use, false, true))
 			continue;
 
-		void *data;
-		while ((data = c_utils_list_remove_at(tmp_hp->retired, 0, NULL))) {
-			c_utils_list_add(hp->retired, data, NULL);
-			
-			if (c_utils_list_size(hp->retired) >= max_hazard_pointers) 
-				scan(hp);
+		while (tmp_hp->num_retired) {
+			struct c_utils_hazard_retired retired = tmp_hp->retired[tmp_hp->num_retired - 1];
+			if (!push_retired(hp, retired.data, retired.destructor))
+				break;
+
+			tmp_hp->num_retired--;
 		}
 
-		tmp_hp->in_use = false;
+		__atomic_store_n(&tmp_hp->in_use, false, __ATOMIC_RELEASE);
+	}
+}
+
+/*
+	Scans once this thread has retired twice as many pointers as there are hazard pointers, so that at
+	least half of them are destroyed by each scan, and the retirement list stops growing once every thread
+	has started.
+*/
+static void retire(struct c_utils_hazard *hp, void *data, void (*destructor)(void *)) {
+	if (!push_retired(hp, data, destructor))
+		return;
+
+	if (hp->num_retired >= 2 * hazard_table->size) {
+		C_UTILS_LOG_TRACE(logger, "Retirement list filled for HP #%zu, scanning...", hp->id);
+		help_scan(hp);
+		scan(hp);
 	}
 }
 
 static struct c_utils_hazard *create() {
 	struct c_utils_hazard *hp;
 	C_UTILS_ON_BAD_CALLOC(hp, logger, sizeof(*hp))
-		goto err;
+		return NULL;
+
 	hp->in_use = true;
-	
-	hp->retired = c_utils_list_create(false);
-	if (!hp->retired) {
-		C_UTILS_LOG_ERROR(logger, "c_utils_list_create: '%s'", strerror(errno));
-		goto err_list;
-	}
-	
-	return hp;
 
-	err_list:
-		free(hp);
-	err:
-		return NULL;
+	return hp;
 }
 
 static void init_tls_hp(void) {
 	static volatile int index = 0;
 	for (struct c_utils_hazard *tmp_hp = hazard_table->head; tmp_hp; tmp_hp = tmp_hp->next) {
-		if (tmp_hp->in_use || __sync_bool_compare_and_swap(&tmp_hp->in_use, false, true)) 
+		if (tmp_hp->in_use || !__sync_bool_compare_and_swap(&tmp_hp->in_use, false, true))
 			continue;
-		
+
 		pthread_setspecific(tls, tmp_hp);
 		C_UTILS_LOG_TRACE(logger, "Was able to reclaim a previous hazard pointer!");
-		
+
 		return;
 	}
-	
+
 	struct c_utils_hazard *hp = create();
 	if (!hp) {
 		C_UTILS_LOG_ERROR(logger, "create_hp: 'Was unable to allocate a Hazard Pointer!");
 		return;
 	}
-	hp->id = index++;
+	hp->id = __sync_fetch_and_add(&index, 1);
 	C_UTILS_LOG_TRACE(logger, "Was unable to reclaim a previous hazard pointer, successfully created a new one!");
-	
+
 	struct c_utils_hazard *old_head;
 	do {
 		old_head = hazard_table->head;
 		hp->next = old_head;
 	} while (!__sync_bool_compare_and_swap(&hazard_table->head, old_head, hp));
 	__sync_fetch_and_add(&hazard_table->size, C_UTILS_HAZARD_PER_THREAD);
-	
+
 	pthread_setspecific(tls, hp);
 	C_UTILS_LOG_TRACE(logger, "Was successful in adding hazard pointer #%zu to hazard table!", hp->id);
 }
 
-bool c_utils_hazard_acquire(unsigned int index, void *data) {
-	C_UTILS_ARG_CHECK(logger, false, data, index <= C_UTILS_HAZARD_PER_THREAD);
-	
-	// Get the hazard pointer from thread-local storage if it is allocated.
+/// Get the hazard pointer from thread-local storage, allocating it if this thread has not yet.
+static struct c_utils_hazard *get_hp(void) {
 	struct c_utils_hazard *hp = pthread_getspecific(tls);
-	// If it hasn't been allocated, then we allocate it here.
-	if (!hp) {
-		C_UTILS_LOG_TRACE(logger, "Hazard Pointer for this thread not allocated! Initializing...");
-		init_tls_hp();
-		
-		hp = pthread_getspecific(tls);
-		if (!hp) {
-			C_UTILS_LOG_ERROR(logger, "init_tls_hp: 'Was unable initialize thread-local storage!'");
-			return false;
-		}
+	if (hp)
+		return hp;
+
+	C_UTILS_LOG_TRACE(logger, "Hazard Pointer for this thread not allocated! Initializing...");
+	init_tls_hp();
+
+	hp = pthread_getspecific(tls);
+	if (!hp)
+		C_UTILS_LOG_ERROR(logger, "init_tls_hp: 'Was unable initialize thread-local storage!'");
+
+	return hp;
+}
+
+/*
+	Called for every node a lock-free structure steps onto, so it neither traces nor checks it's arguments through
+	C_UTILS_ARG_CHECK, which passes pointers through varargs as an int, and so rejects any whose lower half is 0.
+*/
+bool c_utils_hazard_acquire(unsigned int index, void *data) {
+	if (!data || index >= C_UTILS_HAZARD_PER_THREAD) {
+		C_UTILS_LOG_ERROR(logger, "Invalid Arguments=> { data: %p; index: %u }", data, index);
+		return false;
 	}
-	hp->owned[index] = data;
-	
-	C_UTILS_LOG_TRACE(logger, "Hazard Pointer #%zu has acquired pointer to data at index %d!", hp->id, index);
+
+	struct c_utils_hazard *hp = get_hp();
+	if (!hp)
+		return false;
+
+	// Sequentially consistent, so that the caller's following check that data is still reachable can not be reordered before it.
+	__atomic_store_n(&hp->owned[index], data, __ATOMIC_SEQ_CST);
+
 	return true;
 }
 
-bool c_utils_hazard_release_all(bool retire) {
+bool c_utils_hazard_release_all(bool retire_data) {
 	// Get the hazard pointer from thread-local storage if it is allocated.
 	struct c_utils_hazard *hp = pthread_getspecific(tls);
 	// If it hasn't been allocated, then surely the current thread never acquired anything.
@@ -207,51 +281,60 @@ bool c_utils_hazard_release_all(bool retire) {
 		C_UTILS_LOG_TRACE(logger, "Attempt to release all data when no thread-local storage was allocated!");
 		return false;
 	}
-	
+
 	for (int i = 0; i < C_UTILS_HAZARD_PER_THREAD; i++) {
 		void *data = hp->owned[i];
 		if (data) {
-			hp->owned[i] = NULL;
-			if (retire) {
-				c_utils_list_add(hp->retired, data, NULL);
-				C_UTILS_LOG_TRACE(logger, "Added data to retirement list for HP #%zu with size: %zu!", hp->id, c_utils_list_size(hp->retired));
-				
-				if (c_utils_list_size(hp->retired) >= C_UTILS_HAZARD_PER_THREAD) {
-					C_UTILS_LOG_TRACE(logger, "Retirement list filled for HP #%zu, scanning...", hp->id);
-					scan(hp);
-					
-					C_UTILS_LOG_TRACE(logger, "Retirement list filled for HP #%zu, help_scanning...", hp->id);
-					help_scan(hp);
-				}
-			}
+			__atomic_store_n(&hp->owned[i], NULL, __ATOMIC_RELEASE);
+			if (retire_data)
+				retire(hp, data, hazard_table->destructor);
 		}
 	}
 
 	return true;
 }
 
-bool c_utils_hazard_release(void *data, bool retire) {
-	C_UTILS_ARG_CHECK(logger, false, data);
-	
+bool c_utils_hazard_release_at(unsigned int index, bool retire_data) {
+	if (index >= C_UTILS_HAZARD_PER_THREAD) {
+		C_UTILS_LOG_ERROR(logger, "Invalid Arguments=> { index: %u }", index);
+		return false;
+	}
+
+	// Get the hazard pointer from thread-local storage if it is allocated.
+	struct c_utils_hazard *hp = pthread_getspecific(tls);
+	// If it hasn't been allocated, then surely the current thread never acquired anything.
+	if (!hp)
+		return false;
+
+	void *data = hp->owned[index];
+	if (data) {
+		__atomic_store_n(&hp->owned[index], NULL, __ATOMIC_RELEASE);
+		if (retire_data)
+			retire(hp, data, hazard_table->destructor);
+	}
+
+	return true;
+}
+
+bool c_utils_hazard_release(void *data, bool retire_data) {
+	// As with c_utils_hazard_acquire, C_UTILS_ARG_CHECK would reject a pointer whose lower half is 0.
+	if (!data) {
+		C_UTILS_LOG_ERROR(logger, "Invalid Arguments=> { data: %p }", data);
+		return false;
+	}
+
 	// Get the hazard pointer from thread-local storage if it is allocated.
 	struct c_utils_hazard *hp = pthread_getspecific(tls);
 	// If it hasn't been allocated, then surely the current thread never acquired anything.
 	if (!hp)
 		return false;
-	
+
 	for (int i = 0; i < C_UTILS_HAZARD_PER_THREAD; i++) {
 		if (hp->owned[i] == data) {
-			hp->owned[i] = NULL;
-			if (retire) {
-				c_utils_list_add(hp->retired, data, NULL);
-				C_UTILS_LOG_TRACE(logger, "Added data to retirement list for HP #%zu with size: %zu!", hp->id, c_utils_list_size(hp->retired));
-				if (c_utils_list_size(hp->retired) >= C_UTILS_HAZARD_PER_THREAD) {
-					C_UTILS_LOG_TRACE(logger, "Retirement list filled for HP #%zu, scanning...", hp->id);
-					scan(hp);
-					
-					C_UTILS_LOG_TRACE(logger, "Retirement list filled for HP #%zu, help_scanning...", hp->id);
-					help_scan(hp);
-				}
+			__atomic_store_n(&hp->owned[i], NULL, __ATOMIC_RELEASE);
+			if (retire_data) {
+				retire(hp, data, hazard_table->destructor);
+				retire_data = false;
 			}
 		}
 	}
@@ -259,9 +342,31 @@ bool c_utils_hazard_release(void *data, bool retire) {
 	return true;
 }
 
+bool c_utils_hazard_retire(void *data, void (*destructor)(void *)) {
+	if (!data || !destructor) {
+		C_UTILS_LOG_ERROR(logger, "Invalid Arguments=> { data: %p; destructor: %p }", data, (void *) destructor);
+		return false;
+	}
+
+	struct c_utils_hazard *hp = get_hp();
+	if (!hp)
+		return false;
+
+	for (int i = 0; i < C_UTILS_HAZARD_PER_THREAD; i++)
+		if (hp->owned[i] == data)
+			__atomic_store_n(&hp->owned[i], NULL, __ATOMIC_RELEASE);
+
+	retire(hp, data, destructor);
+
+	return true;
+}
+
 bool c_utils_hazard_register_destructor(void (*destructor)(void *)) {
-	C_UTILS_ARG_CHECK(logger, false, destructor);
-	
+	if (!destructor) {
+		C_UTILS_LOG_ERROR(logger, "Invalid Arguments=> { destructor: %p }", (void *) destructor);
+		return false;
+	}
+
 	hazard_table->destructor = destructor;
 	return true;
 }
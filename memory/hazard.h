@@ -7,6 +7,8 @@
 #define hazard_acquire(...) c_utils_hazard_acquire(__VA_ARGS__)
 #define hazard_release(...) c_utils_hazard_release(__VA_ARGS__)
 #define hazard_release_all(...) c_utils_hazard_release_all(__VA_ARGS__)
+#define hazard_release_at(...) c_utils_hazard_release_at(__VA_ARGS__)
+#define hazard_retire(...) c_utils_hazard_retire(__VA_ARGS__)
 #define hazard_register_destructor(...) c_utils_hazard_register_destructor(__VA_ARGS__)
 #endif
 
@@ -19,7 +21,25 @@
 #ifdef C_UTILS_HAZARD_MAX_PER_THREAD
 #define C_UTILS_HAZARD_PER_THREAD C_UTILS_HAZARD_MAX_PER_THREAD
 #else
-#define C_UTILS_HAZARD_PER_THREAD 4
+#define C_UTILS_HAZARD_PER_THREAD 16
+#endif
+
+/*
+	The indexes owned by each structure which uses hazard pointers, each starting a range as long as the amount it
+	holds at once. A structure only ever releases the indexes it acquired, so that a thread may use one while it holds
+	hazard pointers of another, such as from the callback of c_utils_list_for_each on a lock-free list. Indexes from
+	C_UTILS_HAZARD_INDEX_FREE onwards are left to the caller.
+*/
+#define C_UTILS_HAZARD_INDEX_QUEUE 0
+#define C_UTILS_HAZARD_INDEX_STACK 2
+#define C_UTILS_HAZARD_INDEX_LIST 3
+#define C_UTILS_HAZARD_INDEX_SKIP_LIST 6
+#define C_UTILS_HAZARD_INDEX_MAP 8
+#define C_UTILS_HAZARD_INDEX_COW_ARRAY 10
+#define C_UTILS_HAZARD_INDEX_FREE 11
+
+#if C_UTILS_HAZARD_PER_THREAD < C_UTILS_HAZARD_INDEX_FREE
+#error "C_UTILS_HAZARD_MAX_PER_THREAD must leave room for the indexes owned by each structure!"
 #endif
 
 /*
@@ -43,8 +63,21 @@ bool c_utils_hazard_register_destructor(void (*destructor)(void *));
 bool c_utils_hazard_release(void *data, bool retire);
 
 /*
-	Releases all ptrs, much like c_utils_hazard_release.
+	Releases the ptr held at the given index, if any, much like c_utils_hazard_release, leaving those at other indexes held.
+*/
+bool c_utils_hazard_release_at(unsigned int index, bool retire);
+
+/*
+	Releases all ptrs, much like c_utils_hazard_release. This includes those held by any structure this thread is in the middle of
+	using, so it should only be called when none is.
 */
 bool c_utils_hazard_release_all(bool retire);
 
+/*
+	Releases the ptr if this thread had acquired it, and retires it to be destroyed with the given destructor
+	rather than the hazard table's, once no thread holds a hazard pointer to it. Retiring does not allocate once
+	the retirement list has grown to twice the amount of hazard pointers, which it does as threads start using them.
+*/
+bool c_utils_hazard_retire(void *data, void (*destructor)(void *));
+
 #endif /* endif C_UTILS_HazardS_H */
\ No newline at end of file
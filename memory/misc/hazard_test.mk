@@ -3,7 +3,7 @@ PRESENT_DIRECTORY = $(filter %/, $(wildcard ./*/))
 CFLAGS=-g -D_GNU_SOURCE -Wall -std=c11
 LDFLAGS=-pthread
 FLAGS=$(CFLAGS) $(LDFLAGS)
-SOURCES=list.c logger.c iterator.c alloc_check.c scoped_lock.c argument_check.c hazard.c hazard_test.c
+SOURCES=logger.c alloc_check.c scoped_lock.c argument_check.c hazard.c hazard_test.c
 OBJECTS=$(notdir $(SOURCES:.c=.o))
 TARGET=hazard_test
 DEPS=$(addprefix -I, $(PRESENT_DIRECTORY))
@@ -0,0 +1,28 @@
+CC=gcc
+PRESENT_DIRECTORY = $(filter %/, $(wildcard ./*/))
+CFLAGS=-g -D_GNU_SOURCE -Wall -std=c11
+LDFLAGS=-pthread -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=aligned_alloc
+FLAGS=$(CFLAGS) $(LDFLAGS)
+SOURCES=logger.c alloc_check.c scoped_lock.c argument_check.c hazard.c ref_count.c node_pool.c list.c iterator.c string_buffer.c queue.c stack.c sort.c node_pool_test.c
+OBJECTS=$(notdir $(SOURCES:.c=.o))
+TARGET=node_pool_test
+DEPS=$(addprefix -I, $(PRESENT_DIRECTORY))
+VPATH=./memory/ ./io/ ./misc/ ./memory/tests ./data_structures/ ./threading/ ./string/
+
+all: $(TARGET)
+
+$(TARGET): $(OBJECTS)
+	$(CC) $(CFLAGS) $(DEPS) $(OBJECTS) -o $(TARGET) $(LDFLAGS)
+
+%.o: %.c
+	$(CC) $(CFLAGS) $(DEPS) -c $< -o $@
+
+.PHONY: depend clean
+
+depend: $(SOURCES)
+	makedepend $(DEPS) $^
+
+clean: 
+	$(RM) $(TARGET) *.o *~
+
+# DO NOT DELETE THIS LINE -- make depend depends on it.
@@ -0,0 +1,380 @@
+#include "node_pool.h"
+#include "hazard.h"
+#include "ref_count.h"
+
+#include "../data_structures/helpers.h"
+#include "../misc/alloc_check.h"
+#include "../io/logger.h"
+#include "../threading/scoped_lock.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/// Nodes start on the first cache line after the slab's header.
+#define C_UTILS_NODE_POOL_HEADER_SIZE 64
+
+/// Nodes are aligned to this, and are never smaller than it, so a free node can hold a thread's cache.
+#define C_UTILS_NODE_POOL_ALIGN 16
+
+struct c_utils_node_pool_slab {
+	/// The pool the slab's nodes belong to.
+	struct c_utils_node_pool *pool;
+	/// The slab allocated before this one.
+	struct c_utils_node_pool_slab *next;
+};
+
+/// A node while it is free, in either a thread's cache or a batch on the free-list.
+struct c_utils_node_pool_free_node {
+	/// The next node of the cache or batch.
+	struct c_utils_node_pool_free_node *next;
+	/// The next batch, if this is the first node of a batch on the free-list.
+	struct c_utils_node_pool_free_node *next_batch;
+};
+
+/// Each thread's cache is itself carved from the pool, and so is freed along with the slabs.
+struct c_utils_node_pool_cache {
+	struct c_utils_node_pool *pool;
+	struct c_utils_node_pool_free_node *head;
+	size_t count;
+};
+
+struct c_utils_node_pool {
+	/// Batches of nodes flushed by threads' caches, which are pushed without a lock.
+	struct c_utils_node_pool_free_node *free_list;
+	/// The slab currently being carved from, followed by every slab before it.
+	struct c_utils_node_pool_slab *slabs;
+	/// The amount of bytes of the current slab already carved.
+	size_t carved;
+	/// Guards the slabs, and serializes popping from the free-list, which is what rules out ABA.
+	struct c_utils_scoped_lock *lock;
+	/// Each thread's cache.
+	pthread_key_t cache_key;
+	/// Set once destroyed, after which the cache_key may no longer be used.
+	volatile bool destroyed;
+	/// The owner's reference, and one for each node which is retired.
+	volatile unsigned int refs;
+	/// Configuration
+	struct c_utils_node_pool_conf conf;
+};
+
+static const size_t default_cache_size = 64;
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Node Pool Helper Functions                                  //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static struct c_utils_node_pool_slab *slab_of(void *node);
+
+static void push_batch(struct c_utils_node_pool *pool, struct c_utils_node_pool_free_node *batch);
+
+static struct c_utils_node_pool_free_node *pop_batch(struct c_utils_node_pool *pool, size_t *count);
+
+static struct c_utils_node_pool_free_node *carve(struct c_utils_node_pool *pool, size_t amount, size_t *carved);
+
+static struct c_utils_node_pool_cache *get_cache(struct c_utils_node_pool *pool);
+
+static void flush_cache(void *cache);
+
+static void reclaim(void *node);
+
+static void unref(struct c_utils_node_pool *pool);
+
+static void configure(struct c_utils_node_pool_conf *conf);
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Node Pool Core Functions                                    //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+struct c_utils_node_pool *c_utils_node_pool_create(void) {
+	struct c_utils_node_pool_conf conf = {};
+	return c_utils_node_pool_create_conf(&conf);
+}
+
+struct c_utils_node_pool *c_utils_node_pool_create_conf(struct c_utils_node_pool_conf *conf) {
+	if(!conf)
+		return NULL;
+
+	configure(conf);
+
+	if(conf->size.node > C_UTILS_NODE_POOL_SLAB_SIZE - C_UTILS_NODE_POOL_HEADER_SIZE) {
+		C_UTILS_LOG_ERROR(conf->logger, "Nodes of %zu bytes do not fit in a slab!", conf->size.node);
+		goto err;
+	}
+
+	struct c_utils_node_pool *pool;
+	C_UTILS_ON_BAD_CALLOC(pool, conf->logger, sizeof(*pool))
+		goto err;
+
+	pool->lock = c_utils_scoped_lock_spinlock(0, conf->logger);
+	if(!pool->lock) {
+		C_UTILS_LOG_ERROR(conf->logger, "Was unable to create the scoped_lock!");
+		goto err_lock;
+	}
+
+	int failure = pthread_key_create(&pool->cache_key, flush_cache);
+	if(failure) {
+		C_UTILS_LOG_ERROR(conf->logger, "pthread_key_create: \"%s\"", strerror(failure));
+		goto err_key;
+	}
+
+	pool->refs = 1;
+	pool->conf = *conf;
+
+	return pool;
+
+	err_key:
+		c_utils_scoped_lock_destroy(pool->lock);
+	err_lock:
+		free(pool);
+	err:
+		return NULL;
+}
+
+void *c_utils_node_pool_alloc(struct c_utils_node_pool *pool) {
+	if(!pool)
+		return NULL;
+
+	struct c_utils_node_pool_cache *cache = get_cache(pool);
+	if(!cache)
+		return NULL;
+
+	if(!cache->head) {
+		cache->head = pop_batch(pool, &cache->count);
+		if(!cache->head)
+			return NULL;
+	}
+
+	struct c_utils_node_pool_free_node *node = cache->head;
+	cache->head = node->next;
+	cache->count--;
+
+	memset(node, 0, pool->conf.size.node);
+
+	return node;
+}
+
+void c_utils_node_pool_free(void *node) {
+	if(!node)
+		return;
+
+	struct c_utils_node_pool *pool = slab_of(node)->pool;
+	struct c_utils_node_pool_free_node *free_node = node;
+
+	// A thread which only ever frees, such as a consumer, still needs a cache to gather it's nodes into batches.
+	struct c_utils_node_pool_cache *cache = get_cache(pool);
+	if(!cache) {
+		free_node->next = NULL;
+		push_batch(pool, free_node);
+		return;
+	}
+
+	free_node->next = cache->head;
+	cache->head = free_node;
+
+	// Keeps the most recently freed half, which are the most likely to still be cached by the CPU.
+	if(++cache->count == 2 * pool->conf.size.cache) {
+		struct c_utils_node_pool_free_node *tail = cache->head;
+		for(size_t i = 1; i < pool->conf.size.cache; i++)
+			tail = tail->next;
+
+		push_batch(pool, tail->next);
+		tail->next = NULL;
+		cache->count = pool->conf.size.cache;
+	}
+}
+
+bool c_utils_node_pool_retire(void *node) {
+	if(!node)
+		return false;
+
+	struct c_utils_node_pool *pool = slab_of(node)->pool;
+
+	// The pool must outlive every node retired from it, as the hazard pointers may reclaim them after it is destroyed.
+	__atomic_add_fetch(&pool->refs, 1, __ATOMIC_RELAXED);
+
+	if(!c_utils_hazard_retire(node, reclaim)) {
+		unref(pool);
+		return false;
+	}
+
+	return true;
+}
+
+size_t c_utils_node_pool_node_size(struct c_utils_node_pool *pool) {
+	if(!pool)
+		return 0;
+
+	return pool->conf.size.node;
+}
+
+void c_utils_node_pool_destroy(struct c_utils_node_pool *pool) {
+	if(!pool)
+		return;
+
+	// No thread may flush it's cache into the slabs once they are freed.
+	__atomic_store_n(&pool->destroyed, true, __ATOMIC_RELEASE);
+	pthread_key_delete(pool->cache_key);
+
+	unref(pool);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Node Pool Helper Functions                                  //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static struct c_utils_node_pool_slab *slab_of(void *node) {
+	return (struct c_utils_node_pool_slab *) ((uintptr_t) node & ~(uintptr_t) (C_UTILS_NODE_POOL_SLAB_SIZE - 1));
+}
+
+static void push_batch(struct c_utils_node_pool *pool, struct c_utils_node_pool_free_node *batch) {
+	struct c_utils_node_pool_free_node *head = __atomic_load_n(&pool->free_list, __ATOMIC_RELAXED);
+	do {
+		batch->next_batch = head;
+	} while(!__atomic_compare_exchange_n(&pool->free_list, &head, batch, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/*
+	Pops a batch from the free-list, or carves a new one if it is empty. As only one thread may pop at a time, the
+	first batch can not be popped and pushed back between reading it and swapping it out, so there is no ABA.
+*/
+static struct c_utils_node_pool_free_node *pop_batch(struct c_utils_node_pool *pool, size_t *count) {
+	C_UTILS_SCOPED_LOCK(pool->lock) {
+		struct c_utils_node_pool_free_node *batch = __atomic_load_n(&pool->free_list, __ATOMIC_ACQUIRE);
+		while(batch && !__atomic_compare_exchange_n(&pool->free_list, &batch, batch->next_batch, true, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+			;
+
+		if(!batch)
+			return carve(pool, pool->conf.size.cache, count);
+
+		*count = 0;
+		for(struct c_utils_node_pool_free_node *node = batch; node; node = node->next)
+			(*count)++;
+
+		return batch;
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+/*
+	Carves up to amount nodes from the current slab, starting a new slab if it has none left, and returns them
+	chained together with how many there are. Must be called under the pool's lock.
+*/
+static struct c_utils_node_pool_free_node *carve(struct c_utils_node_pool *pool, size_t amount, size_t *carved) {
+	size_t node_size = pool->conf.size.node;
+
+	if(!pool->slabs || pool->carved + node_size > C_UTILS_NODE_POOL_SLAB_SIZE) {
+		struct c_utils_node_pool_slab *slab = aligned_alloc(C_UTILS_NODE_POOL_SLAB_SIZE, C_UTILS_NODE_POOL_SLAB_SIZE);
+		if(!slab) {
+			C_UTILS_LOG_ERROR(pool->conf.logger, "aligned_alloc: \"Was unable to allocate a slab of %d bytes!\"", C_UTILS_NODE_POOL_SLAB_SIZE);
+			return NULL;
+		}
+
+		slab->pool = pool;
+		slab->next = pool->slabs;
+		pool->slabs = slab;
+		pool->carved = C_UTILS_NODE_POOL_HEADER_SIZE;
+	}
+
+	size_t available = (C_UTILS_NODE_POOL_SLAB_SIZE - pool->carved) / node_size;
+	if(amount > available)
+		amount = available;
+
+	char *start = (char *) pool->slabs + pool->carved;
+	for(size_t i = 0; i < amount; i++) {
+		struct c_utils_node_pool_free_node *node = (void *) (start + i * node_size);
+		node->next = i + 1 < amount ? (void *) (start + (i + 1) * node_size) : NULL;
+	}
+
+	pool->carved += amount * node_size;
+	*carved = amount;
+
+	return (struct c_utils_node_pool_free_node *) start;
+}
+
+/// Returns the calling thread's cache, carving it from the pool the first time, or NULL if that fails.
+static struct c_utils_node_pool_cache *get_cache(struct c_utils_node_pool *pool) {
+	struct c_utils_node_pool_cache *cache = pthread_getspecific(pool->cache_key);
+	if(cache)
+		return cache;
+
+	size_t carved;
+	C_UTILS_SCOPED_LOCK(pool->lock)
+		cache = (struct c_utils_node_pool_cache *) carve(pool, 1, &carved);
+
+	if(!cache)
+		return NULL;
+
+	cache->pool = pool;
+	cache->head = NULL;
+	cache->count = 0;
+	pthread_setspecific(pool->cache_key, cache);
+
+	return cache;
+}
+
+/// When a thread exits, every node in it's cache is pushed onto the free-list as one batch, and the cache itself as another.
+static void flush_cache(void *data) {
+	struct c_utils_node_pool_cache *cache = data;
+	struct c_utils_node_pool *pool = cache->pool;
+
+	if(cache->head)
+		push_batch(pool, cache->head);
+
+	struct c_utils_node_pool_free_node *node = data;
+	node->next = NULL;
+	push_batch(pool, node);
+}
+
+/// Called by the hazard pointers once no thread can still be reading the node.
+static void reclaim(void *node) {
+	struct c_utils_node_pool *pool = slab_of(node)->pool;
+
+	// Once destroyed, the node is simply left to be freed along with it's slab.
+	if(!__atomic_load_n(&pool->destroyed, __ATOMIC_ACQUIRE))
+		c_utils_node_pool_free(node);
+
+	unref(pool);
+}
+
+static void unref(struct c_utils_node_pool *pool) {
+	if(__atomic_sub_fetch(&pool->refs, 1, __ATOMIC_ACQ_REL))
+		return;
+
+	struct c_utils_node_pool_slab *slab = pool->slabs;
+	while(slab) {
+		struct c_utils_node_pool_slab *next = slab->next;
+		free(slab);
+		slab = next;
+	}
+
+	c_utils_scoped_lock_destroy(pool->lock);
+	free(pool);
+}
+
+static void configure(struct c_utils_node_pool_conf *conf) {
+	if(!conf->size.node)
+		conf->size.node = c_utils_ref_size(sizeof(struct c_utils_node));
+
+	if(conf->size.node < sizeof(struct c_utils_node_pool_cache))
+		conf->size.node = sizeof(struct c_utils_node_pool_cache);
+
+	conf->size.node = (conf->size.node + C_UTILS_NODE_POOL_ALIGN - 1) & ~(size_t) (C_UTILS_NODE_POOL_ALIGN - 1);
+
+	if(!conf->size.cache)
+		conf->size.cache = default_cache_size;
+}
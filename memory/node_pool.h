@@ -0,0 +1,135 @@
+#ifndef C_UTILS_NODE_POOL_H
+#define C_UTILS_NODE_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../io/logger.h"
+
+/*
+	A slab allocator for the fixed-size nodes of the list, queue and stack, so that a structure which is
+	constantly added to and removed from stops calling malloc and free once it has warmed up.
+
+	Nodes are carved from large slabs, which are only freed when the pool is destroyed. Each thread keeps a
+	cache of free nodes, so allocating and freeing is usually a pointer swap with no atomic operations at all.
+	Once a thread's cache overflows, half of it is pushed as a batch onto a global free-list without a lock, from
+	which another thread's empty cache is refilled a batch at a time, so a producer which allocates and a consumer
+	which frees pass nodes between each other without ever touching the slabs. Only refilling takes a spinlock,
+	which is also what makes popping a batch safe from ABA, and only when the free-list is empty are more nodes
+	carved from the current slab.
+
+	As the lock-free queue and stack must not reuse a node while another thread may still be reading it, they
+	retire it with c_utils_node_pool_retire, which only returns it to the pool once no hazard pointer holds it.
+	A pool outlives it's destruction for as long as it has nodes which are still retired.
+*/
+struct c_utils_node_pool;
+
+/*
+	The size of each slab, which must be a power of two, as a node finds it's slab (and hence it's pool) by
+	masking it's own address.
+*/
+#ifdef C_UTILS_NODE_POOL_SLAB
+#define C_UTILS_NODE_POOL_SLAB_SIZE C_UTILS_NODE_POOL_SLAB
+#else
+#define C_UTILS_NODE_POOL_SLAB_SIZE (64 * 1024)
+#endif
+
+/*
+	size:
+		node:
+			default:
+				Large enough for a reference counted struct c_utils_node
+			note:
+				The size of each node, rounded up to 16 bytes. The default may be shared between lists, queues
+				and stacks alike.
+		cache:
+			default:
+				64
+			note:
+				The amount of nodes in each batch moved between a thread's cache and the global free-list. A
+				thread holds fewer than twice as many in it's cache.
+	logger:
+		default:
+			NULL
+		note:
+			Logs allocation failures.
+*/
+struct c_utils_node_pool_conf {
+	struct {
+		size_t node;
+		size_t cache;
+	} size;
+	/// Logger
+	struct c_utils_logger *logger;
+};
+
+#ifdef NO_C_UTILS_PREFIX
+/*
+	Typedefs
+*/
+typedef struct c_utils_node_pool node_pool_t;
+typedef struct c_utils_node_pool_conf node_pool_conf_t;
+
+/*
+	Functions
+*/
+#define node_pool_create(...) c_utils_node_pool_create(__VA_ARGS__)
+#define node_pool_create_conf(...) c_utils_node_pool_create_conf(__VA_ARGS__)
+#define node_pool_alloc(...) c_utils_node_pool_alloc(__VA_ARGS__)
+#define node_pool_free(...) c_utils_node_pool_free(__VA_ARGS__)
+#define node_pool_retire(...) c_utils_node_pool_retire(__VA_ARGS__)
+#define node_pool_node_size(...) c_utils_node_pool_node_size(__VA_ARGS__)
+#define node_pool_destroy(...) c_utils_node_pool_destroy(__VA_ARGS__)
+#endif
+
+/**
+ * Creates a pool of nodes large enough for any of the list, queue or stack.
+ *
+ * @return Instance, or NULL if an allocation error occurs.
+ */
+struct c_utils_node_pool *c_utils_node_pool_create(void);
+
+struct c_utils_node_pool *c_utils_node_pool_create_conf(struct c_utils_node_pool_conf *conf);
+
+/**
+ * Allocates a node from the calling thread's cache, refilling it first if it is empty.
+ *
+ * Concurrent, Is Thread Safe, and only takes a lock once every batch of allocations.
+ * @param pool Instance.
+ * @return A zeroed node, or NULL if an allocation error occurs.
+ */
+void *c_utils_node_pool_alloc(struct c_utils_node_pool *pool);
+
+/**
+ * Returns the node to the calling thread's cache, which need not be the thread which allocated it.
+ *
+ * Lock-Free: Concurrent, Is Thread Safe.
+ * @param node Node allocated by c_utils_node_pool_alloc, of any pool.
+ */
+void c_utils_node_pool_free(void *node);
+
+/**
+ * Returns the node to it's pool once no thread holds a hazard pointer to it, releasing the calling
+ * thread's own if it holds one.
+ *
+ * Lock-Free: Concurrent, Is Thread Safe.
+ * @param node Node allocated by c_utils_node_pool_alloc, of any pool.
+ * @return true if retired, false if the hazard pointers could not be allocated.
+ */
+bool c_utils_node_pool_retire(void *node);
+
+/**
+ * @param pool Instance.
+ * @return The size of each node, which may be larger than was configured.
+ */
+size_t c_utils_node_pool_node_size(struct c_utils_node_pool *pool);
+
+/**
+ * Destroys the pool, and with it every node it has handed out, other than those which are still retired,
+ * which are kept until they are reclaimed. Every structure using the pool must be destroyed first.
+ *
+ * @param pool Instance.
+ */
+void c_utils_node_pool_destroy(struct c_utils_node_pool *pool);
+
+#endif /* C_UTILS_NODE_POOL_H */
@@ -22,6 +22,8 @@ static struct c_utils_ref_count *get_ref_count_from(void *ptr) {
 	return ptr - sizeof(struct c_utils_ref_count);
 }
 
+static void no_op_destructor(void *ptr) { }
+
 void *c_utils_ref_create(size_t size) {
 	struct c_utils_ref_count_conf conf = {};
 	return c_utils_ref_create_conf(size, &conf);
@@ -32,13 +34,26 @@ void *c_utils_ref_create_conf(size_t size, struct c_utils_ref_count_conf *conf)
 		return NULL;
 
 	// Note we allocate more than just enough for the ref_count.
-	struct c_utils_ref_count *rc = malloc(sizeof(*rc) + size);
-	if(!rc)
+	void *memory = malloc(c_utils_ref_size(size));
+	if(!memory)
+		return NULL;
+
+	return c_utils_ref_create_in(memory, size, conf);
+}
+
+void *c_utils_ref_create_in(void *memory, size_t size, struct c_utils_ref_count_conf *conf) {
+	if(!memory || !conf)
 		return NULL;
 
+	struct c_utils_ref_count *rc = memory;
+
+	// The data is freed along with the ref_count, so the destructor only needs to release what it owns.
 	rc->conf = *conf;
 	if(!rc->conf.destructor)
-		rc->conf.destructor = free;
+		rc->conf.destructor = no_op_destructor;
+
+	if(!rc->conf.deallocator)
+		rc->conf.deallocator = free;
 
 	rc->refs = ATOMIC_VAR_INIT(conf->initial_ref_count);
 	// Points to the end of the struct, the data allocated after ref_count
@@ -48,6 +63,10 @@ void *c_utils_ref_create_conf(size_t size, struct c_utils_ref_count_conf *conf)
 	return rc->data;
 }
 
+size_t c_utils_ref_size(size_t size) {
+	return sizeof(struct c_utils_ref_count) + size;
+}
+
 void _c_utils_ref_inc(void *ptr, struct c_utils_location log_info) {
 	// Assure data is not null.
 	assert(ptr);
@@ -79,11 +98,14 @@ void _c_utils_ref_dec(void *ptr, struct c_utils_location log_info) {
 	struct c_utils_ref_count *rc = get_ref_count_from(ptr);
 	assert(rc->data == ptr);
 
+	// Once decremented, another thread may release the last reference and free it, so the logger is read first.
+	struct c_utils_logger *logger = rc->conf.logger;
+
 	int refs;
 	// If the count is already 0 (since it fetches old value first) we fail assertion.
 	assert((refs = atomic_fetch_sub(&rc->refs, 1)) > -1);
 
-	C_UTILS_LOG_TRACE_AT(rc->conf.logger, log_info, "Reference count was decremented from %d to %d", refs, refs - 1);
+	C_UTILS_LOG_TRACE_AT(logger, log_info, "Reference count was decremented from %d to %d", refs, refs - 1);
 	
 	/*
 		Note that if a thread attempts to increment after count is 0, this race condition invoked undefined behavior.
@@ -93,7 +115,7 @@ void _c_utils_ref_dec(void *ptr, struct c_utils_location log_info) {
 	if(!refs) {
 		C_UTILS_LOG_TRACE_AT(rc->conf.logger, log_info, "Reference count reached below 0, destroying object...");
 		rc->conf.destructor(ptr);
-		free(rc);
+		rc->conf.deallocator(rc);
 	}
 }
 
@@ -103,5 +125,5 @@ void c_utils_ref_destroy(void *ptr) {
 	struct c_utils_ref_count *rc = get_ref_count_from(ptr);
 	assert(rc->data == ptr);
 
-	free(rc);
+	rc->conf.deallocator(rc);
 }
\ No newline at end of file
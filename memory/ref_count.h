@@ -25,6 +25,8 @@ struct c_utils_ref_count_conf {
 	unsigned int initial_ref_count;
 	/// Destructor called on once ref_count is below 0.
 	void (*destructor)(void *);
+	/// Frees the memory of c_utils_ref_create_in, or free if NULL.
+	void (*deallocator)(void *);
 	/// Trace logging for reference count changes and destruction.
 	struct c_utils_logger *logger;
 };
@@ -46,6 +48,8 @@ typedef struct c_utils_ref_count_conf ref_count_conf_t;
 */
 #define ref_create(...) c_utils_ref_create(__VA_ARGS__)
 #define ref_create_conf(...) c_utils_ref_create_conf(__VA_ARGS__)
+#define ref_create_in(...) c_utils_ref_create_in(__VA_ARGS__)
+#define ref_size(...) c_utils_ref_size(__VA_ARGS__)
 #define ref_inc(...) c_utils_ref_inc(__VA_ARGS__)
 #define ref_dec(...) c_utils_ref_dec(__VA_ARGS__)
 #endif
@@ -59,6 +63,17 @@ void *c_utils_ref_create(size_t size);
 
 void *c_utils_ref_create_conf(size_t size, struct c_utils_ref_count_conf *conf);
 
+/*
+	Creates the reference count in memory the caller has allocated, of at least c_utils_ref_size(size) bytes,
+	such as from a c_utils_node_pool. The memory is given to the conf's deallocator once the count drops below 0.
+*/
+void *c_utils_ref_create_in(void *memory, size_t size, struct c_utils_ref_count_conf *conf);
+
+/*
+	The amount of memory needed to reference count an object of the given size.
+*/
+size_t c_utils_ref_size(size_t size);
+
 void _c_utils_ref_inc(void *data, struct c_utils_location log_info);
 
 void _c_utils_ref_dec(void *data, struct c_utils_location log_info);
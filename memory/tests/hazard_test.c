@@ -1,11 +1,67 @@
 #define NO_C_UTILS_PREFIX
 #include "../hazard.h"
 #include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
 
 struct hp_test {
 	bool val;
 };
 
+/// Enough retirements to force a scan, whatever the amount of hazard pointers.
+#define NUM_RETIRED (4 * C_UTILS_HAZARD_PER_THREAD * C_UTILS_HAZARD_THREADS)
+
+static pthread_barrier_t barrier;
+
+static struct hp_test held, released;
+
+static void destroy_test(void *data) {
+	((struct hp_test *) data)->val = true;
+}
+
+static void *hold(void *args) {
+	hazard_acquire(C_UTILS_HAZARD_INDEX_FREE, &held);
+	hazard_acquire(C_UTILS_HAZARD_INDEX_FREE + 1, &released);
+	hazard_release_at(C_UTILS_HAZARD_INDEX_FREE + 1, false);
+
+	pthread_barrier_wait(&barrier);
+	// Holds on until the other thread has scanned.
+	pthread_barrier_wait(&barrier);
+
+	hazard_release_all(false);
+	return NULL;
+}
+
+static void force_scan(void) {
+	for (int i = 0; i < NUM_RETIRED; i++)
+		hazard_retire(malloc(sizeof(struct hp_test)), free);
+}
+
+/*
+	Checks that releasing one index leaves the others held, as each structure releases only it's own.
+*/
+static void test_release_at(void) {
+	pthread_t thread;
+	pthread_barrier_init(&barrier, NULL, 2);
+	pthread_create(&thread, NULL, hold, NULL);
+
+	pthread_barrier_wait(&barrier);
+	hazard_retire(&held, destroy_test);
+	hazard_retire(&released, destroy_test);
+	force_scan();
+
+	assert(!held.val);
+	assert(released.val);
+
+	pthread_barrier_wait(&barrier);
+	pthread_join(thread, NULL);
+
+	force_scan();
+	assert(held.val);
+
+	pthread_barrier_destroy(&barrier);
+}
+
 /*
 	Checks for memory leakage.
 */
@@ -14,5 +70,7 @@ int main(void) {
 		hazard_acquire(0, malloc(sizeof(struct hp_test)));
 
 	hazard_release_all(true);
+
+	test_release_at();
 	return 0;
-}
\ No newline at end of file
+}
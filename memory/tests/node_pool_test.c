@@ -0,0 +1,357 @@
+#define NO_C_UTILS_PREFIX
+#include "../node_pool.h"
+#include "../ref_count.h"
+#include "../../data_structures/list.h"
+#include "../../data_structures/queue.h"
+#include "../../data_structures/stack.h"
+#include "../../io/logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/*
+	Linked with --wrap for each allocation function, so that every allocation made by the library is counted,
+	and the structures can be shown to never allocate once their pool has warmed up.
+*/
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_aligned_alloc(size_t alignment, size_t size);
+
+static volatile size_t allocations = 0;
+
+void *__wrap_malloc(size_t size) {
+	__atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t num, size_t size) {
+	__atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+	return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+	__atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+	return __real_realloc(ptr, size);
+}
+
+void *__wrap_aligned_alloc(size_t alignment, size_t size) {
+	__atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+	return __real_aligned_alloc(alignment, size);
+}
+
+static struct c_utils_logger *logger = NULL;
+
+#define NUM_ITEMS 100000
+
+#define NUM_ROUNDS 4
+
+static const int num_producers = 2;
+
+static const int num_consumers = 2;
+
+static int values[NUM_ITEMS];
+
+/// Adds to or takes from either the queue or the stack.
+struct workload {
+	void *instance;
+	bool (*add)(void *instance, void *item);
+	void *(*take)(void *instance);
+	pthread_barrier_t barrier;
+	volatile size_t taken;
+};
+
+static bool enqueue(void *queue, void *item) {
+	return queue_enqueue(queue, item);
+}
+
+static void *dequeue(void *queue) {
+	return queue_dequeue(queue);
+}
+
+static bool push(void *stack, void *item) {
+	return stack_push(stack, item);
+}
+
+static void *pop(void *stack) {
+	return stack_pop(stack);
+}
+
+static void no_op(void *item) {}
+
+/// Each thread must have both added and taken before it's hazard pointers, retirement list and cache stop growing.
+static void warm_up(struct workload *work) {
+	for (int i = 0; i < NUM_ITEMS / 100; i++) {
+		work->add(work->instance, values + i);
+		work->take(work->instance);
+	}
+}
+
+static void *produce(void *data) {
+	struct workload *work = data;
+	warm_up(work);
+
+	for (int round = 0; round < NUM_ROUNDS; round++) {
+		pthread_barrier_wait(&work->barrier);
+
+		for (int i = 0; i < NUM_ITEMS / num_producers; i++)
+			ASSERT(work->add(work->instance, values + i), logger, "add: \"Was unable to add an item!\"");
+
+		pthread_barrier_wait(&work->barrier);
+	}
+
+	return NULL;
+}
+
+static void *consume(void *data) {
+	struct workload *work = data;
+	warm_up(work);
+
+	for (int round = 0; round < NUM_ROUNDS; round++) {
+		pthread_barrier_wait(&work->barrier);
+
+		while (__atomic_load_n(&work->taken, __ATOMIC_RELAXED) < NUM_ITEMS)
+			if (work->take(work->instance))
+				__atomic_add_fetch(&work->taken, 1, __ATOMIC_RELAXED);
+
+		pthread_barrier_wait(&work->barrier);
+	}
+
+	return NULL;
+}
+
+/*
+	The first round warms up the pool, and every round after must not allocate at all.
+*/
+static void run(struct workload *work, const char *name) {
+	int num_threads = num_producers + num_consumers;
+	pthread_t threads[num_threads];
+
+	// Fill it first, so that the pool has more nodes than may be in use at once, including those held in each thread's cache.
+	for (int i = 0; i < NUM_ITEMS * 2; i++)
+		work->add(work->instance, values + i % NUM_ITEMS);
+
+	while (work->take(work->instance))
+		;
+
+	pthread_barrier_init(&work->barrier, NULL, num_threads + 1);
+	for (int i = 0; i < num_threads; i++)
+		pthread_create(threads + i, NULL, i < num_producers ? produce : consume, work);
+
+	for (int round = 0; round < NUM_ROUNDS; round++) {
+		work->taken = 0;
+		size_t before = __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+
+		pthread_barrier_wait(&work->barrier);
+		pthread_barrier_wait(&work->barrier);
+
+		size_t allocated = __atomic_load_n(&allocations, __ATOMIC_RELAXED) - before;
+		LOG_INFO(logger, "%s: Round #%d made %zu allocations", name, round, allocated);
+		ASSERT((round == 0 || allocated == 0), logger, "%s: \"Allocated %zu times in round #%d!\"", name, allocated, round);
+	}
+
+	for (int i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	pthread_barrier_destroy(&work->barrier);
+}
+
+static void test_alloc(void) {
+	node_pool_conf_t conf = { .size = { .node = 40, .cache = 16 }, .logger = logger };
+	node_pool_t *pool = node_pool_create_conf(&conf);
+	ASSERT(pool, logger, "node_pool_create_conf: \"Was unable to create pool!\"");
+	ASSERT((node_pool_node_size(pool) == 48), logger, "node_pool_node_size: \"Expected 48, but was %zu!\"", node_pool_node_size(pool));
+
+	// Spans several slabs.
+	static char *nodes[4096];
+	for (int round = 0; round < 2; round++) {
+		size_t before = allocations;
+
+		for (int i = 0; i < 4096; i++) {
+			nodes[i] = node_pool_alloc(pool);
+			ASSERT(nodes[i], logger, "node_pool_alloc: \"Was unable to allocate node %d!\"", i);
+			ASSERT((((uintptr_t) nodes[i] & 15) == 0), logger, "node_pool_alloc: \"Node %d is misaligned!\"", i);
+
+			for (int j = 0; j < 48; j++)
+				ASSERT(!nodes[i][j], logger, "node_pool_alloc: \"Node %d was not zeroed!\"", i);
+
+			memset(nodes[i], 0xFF, 48);
+			memcpy(nodes[i], &i, sizeof(i));
+		}
+
+		for (int i = 0; i < 4096; i++)
+			ASSERT((*(int *) nodes[i] == i), logger, "node_pool_alloc: \"Node %d overlaps another!\"", i);
+
+		for (int i = 0; i < 4096; i++)
+			node_pool_free(nodes[i]);
+
+		ASSERT((round == 0 || allocations == before), logger, "node_pool_alloc: \"Allocated %zu times after warming up!\"", allocations - before);
+	}
+
+	node_pool_destroy(pool);
+
+	pool = node_pool_create();
+	ASSERT((node_pool_node_size(pool) >= ref_size(sizeof(struct c_utils_node))), logger, "node_pool_create: \"Default nodes are too small for a list!\"");
+	node_pool_destroy(pool);
+}
+
+#define NUM_HANDOFF 4096
+
+#define HANDOFF_CACHE 16
+
+static void *handoff[NUM_HANDOFF];
+
+static pthread_barrier_t handoff_barrier;
+
+static void *allocate_only(void *pool) {
+	for (int i = 0; i < NUM_HANDOFF; i++)
+		ASSERT((handoff[i] = node_pool_alloc(pool)), logger, "node_pool_alloc: \"Was unable to allocate node %d!\"", i);
+
+	return NULL;
+}
+
+/// Stays alive until the nodes have been inspected, as exiting flushes it's cache.
+static void *free_only(void *pool) {
+	for (int i = 0; i < NUM_HANDOFF; i++)
+		node_pool_free(handoff[i]);
+
+	pthread_barrier_wait(&handoff_barrier);
+	pthread_barrier_wait(&handoff_barrier);
+
+	return NULL;
+}
+
+/*
+	A free node begins with the next node of it's batch, so the nodes freed by a thread which never allocates
+	must be chained together, rather than each pushed onto the free-list on it's own.
+*/
+static void test_handoff(void) {
+	node_pool_conf_t conf = { .size.cache = HANDOFF_CACHE, .logger = logger };
+	node_pool_t *pool = node_pool_create_conf(&conf);
+	ASSERT(pool, logger, "node_pool_create_conf: \"Was unable to create pool!\"");
+
+	pthread_t producer, consumer;
+	pthread_create(&producer, NULL, allocate_only, pool);
+	pthread_join(producer, NULL);
+
+	pthread_barrier_init(&handoff_barrier, NULL, 2);
+	pthread_create(&consumer, NULL, free_only, pool);
+	pthread_barrier_wait(&handoff_barrier);
+
+	size_t ends = 0;
+	for (int i = 0; i < NUM_HANDOFF; i++)
+		if (!*(void **) handoff[i])
+			ends++;
+
+	LOG_INFO(logger, "handoff: %d freed nodes ended %zu batches", NUM_HANDOFF, ends);
+	ASSERT((ends <= NUM_HANDOFF / HANDOFF_CACHE + 1), logger, "node_pool_free: \"%d nodes were freed as %zu batches!\"", NUM_HANDOFF, ends);
+
+	pthread_barrier_wait(&handoff_barrier);
+	pthread_join(consumer, NULL);
+	pthread_barrier_destroy(&handoff_barrier);
+
+	node_pool_destroy(pool);
+}
+
+static void test_too_small(void) {
+	node_pool_conf_t conf = { .size.node = sizeof(struct c_utils_node) };
+	node_pool_t *pool = node_pool_create_conf(&conf);
+
+	// Large enough for the queue and stack, but not for the list, which reference counts each node.
+	list_conf_t list_conf = { .pool = pool, .logger = logger };
+	ASSERT(!list_create_conf(&list_conf), logger, "list_create_conf: \"Accepted a pool of nodes too small!\"");
+
+	queue_conf_t queue_conf = { .pool = pool };
+	queue_t *queue = queue_create_conf(&queue_conf);
+	ASSERT(queue, logger, "queue_create_conf: \"Was unable to create queue!\"");
+
+	queue_destroy(queue, NULL);
+	node_pool_destroy(pool);
+}
+
+static void test_queue(void) {
+	node_pool_t *pool = node_pool_create();
+	ASSERT(pool, logger, "node_pool_create: \"Was unable to create pool!\"");
+
+	queue_conf_t conf = { .pool = pool };
+	struct workload work = { .add = enqueue, .take = dequeue };
+	work.instance = queue_create_conf(&conf);
+	ASSERT(work.instance, logger, "queue_create_conf: \"Was unable to create queue!\"");
+
+	run(&work, "queue");
+
+	for (int i = 0; i < 100; i++)
+		queue_enqueue(work.instance, values + i);
+
+	// Some of the dequeued nodes are still retired, and so must outlive the pool's destruction.
+	queue_destroy(work.instance, no_op);
+	node_pool_destroy(pool);
+}
+
+static void test_stack(void) {
+	node_pool_t *pool = node_pool_create();
+	ASSERT(pool, logger, "node_pool_create: \"Was unable to create pool!\"");
+
+	struct c_utils_stack_conf conf = { .lock_free = true, .pool = pool, .logger = logger };
+	struct workload work = { .add = push, .take = pop };
+	work.instance = stack_create_conf(&conf);
+	ASSERT(work.instance, logger, "stack_create_conf: \"Was unable to create stack!\"");
+
+	run(&work, "stack");
+
+	stack_destroy(work.instance);
+	node_pool_destroy(pool);
+}
+
+static void test_list(void) {
+	node_pool_t *pool = node_pool_create();
+	ASSERT(pool, logger, "node_pool_create: \"Was unable to create pool!\"");
+
+	list_conf_t conf = { .callbacks.destructors.item = no_op, .pool = pool, .logger = logger };
+	list_t *list = list_create_conf(&conf);
+	ASSERT(list, logger, "list_create_conf: \"Was unable to create list!\"");
+
+	for (int round = 0; round < NUM_ROUNDS; round++) {
+		size_t before = allocations;
+
+		for (int i = 0; i < NUM_ITEMS; i++)
+			list_add(list, values + i);
+
+		ASSERT((list_size(list) == NUM_ITEMS), logger, "list_add: \"Expected %d items, but found %zu!\"", NUM_ITEMS, list_size(list));
+
+		for (int i = 0; i < NUM_ITEMS; i++)
+			ASSERT((list_remove_at(list, 0) == values + i), logger, "list_remove_at: \"Removed the wrong item!\"");
+
+		ASSERT((round == 0 || allocations == before), logger, "list: \"Allocated %zu times in round #%d!\"", allocations - before, round);
+	}
+
+	list_destroy(list);
+	node_pool_destroy(pool);
+}
+
+int main(void) {
+	logger = logger_create("./memory/logs/node_pool_test.log", "w", LOG_LEVEL_INFO);
+	assert(logger);
+
+	test_alloc();
+	test_too_small();
+
+	LOG_INFO(logger, "Testing a thread which only frees the nodes another only allocates...");
+	test_handoff();
+
+	LOG_INFO(logger, "Testing queue with %d producers and %d consumers...", num_producers, num_consumers);
+	test_queue();
+
+	LOG_INFO(logger, "Testing lock-free stack with %d producers and %d consumers...", num_producers, num_consumers);
+	test_stack();
+
+	LOG_INFO(logger, "Testing list...");
+	test_list();
+
+	LOG_INFO(logger, "All tests passed!");
+	logger_destroy(logger);
+
+	return 0;
+}
@@ -3,6 +3,7 @@
 #include <ctype.h>
 
 #include "../data_structures/map.h"
+#include "../string/intern.h"
 #include "../io/logger.h"
 #include "../misc/alloc_check.h"
 #include "../misc/argument_check.h"
@@ -14,6 +15,90 @@ static struct c_utils_logger *logger = NULL;
 
 C_UTILS_LOGGER_AUTO_CREATE(logger, "./networking/logs/http.log", "w", C_UTILS_LOG_LEVEL_ALL);
 
+/*
+	Header field names are interned, as the same few (such as "Content-Type") recur in nearly every header.
+	The header maps hold canonical copies of them as keys, which are never freed by them, while values are
+	owned by the request or response. As the pool is never shrunk, at most C_UTILS_HTTP_HEADER_FIELD_NAMES
+	distinct names are interned, so that clients cannot grow it without limit; fields with new names past
+	that are dropped.
+*/
+static struct c_utils_intern *fields = NULL;
+
+/*
+	The pool lives as long as the process, and is not destroyed on exit, as the order of destructors
+	across modules is unspecified and the hazard pointers it retires through may already be gone.
+*/
+__attribute__((constructor)) static void init_fields(void) {
+	fields = c_utils_intern_create();
+}
+
+static char *intern_field(const char *field) {
+	const char *name = c_utils_intern_find(fields, field);
+	if (name)
+		return (char *) name;
+
+	if (c_utils_intern_size(fields) >= C_UTILS_HTTP_HEADER_FIELD_NAMES) {
+		C_UTILS_LOG_WARNING(logger, "Too many distinct header fields, dropping '%s'!", field);
+		return NULL;
+	}
+
+	return (char *) c_utils_intern_string(fields, field);
+}
+
+static struct c_utils_map *create_header(void) {
+	// Synchronized Map
+	struct c_utils_map_conf conf =
+	{
+		.flags = C_UTILS_MAP_CONCURRENT | C_UTILS_MAP_DELETE_ON_DESTROY,
+		.size.initial = bucket_size,
+		.logger = logger
+	};
+
+	return c_utils_map_create_conf(&conf);
+}
+
+/*
+	Replaces the field's value with a copy of value, which the header then owns.
+*/
+static bool set_field(struct c_utils_map *header, const char *field, const char *value) {
+	char *name = intern_field(field);
+	if (!name)
+		return false;
+
+	char *copy;
+	C_UTILS_ON_BAD_MALLOC(copy, logger, strlen(value) + 1)
+		return false;
+	strcpy(copy, value);
+
+	if (!c_utils_map_upsert(header, name, copy, NULL)) {
+		C_UTILS_LOG_WARNING(logger, "c_utils_map_upsert: 'Was unable to add key-value pair ('%s': '%s')!'", name, copy);
+		free(copy);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+	Appends each field as "Field: Value\r\n" for as long as they fit, returning the amount appended.
+*/
+static size_t fields_to_string(struct c_utils_map *header, char *buf, size_t size_left) {
+	size_t written = 0;
+	char *field, *value;
+
+	C_UTILS_MAP_FOR_EACH_PAIR(field, value, header) {
+		int len = snprintf(buf + written, size_left - written, "%s: %s\r\n", field, value);
+		if (len < 0 || (size_t) len >= size_left - written) {
+			buf[written] = '\0';
+			break;
+		}
+
+		written += len;
+	}
+
+	return written;
+}
+
 static const char *C_UTILS_HTTP_Status_Codes[] = {
 	[100] = "100 Continue",
     [101] = "101 Switching Protocols",
@@ -95,10 +180,7 @@ static void parse_http_field(struct c_utils_map *mapped_fields, const char *line
 	snprintf(field, C_UTILS_HTTP_HEADER_FIELD_LEN, "%.*s", field_len, line);
 	snprintf(value, C_UTILS_HTTP_HEADER_VALUE_LEN, "%s", offset_str);
 
-	bool was_added = c_utils_map_add(mapped_fields, field, strdup(value));
-	if (!was_added)  
-		C_UTILS_LOG_WARNING(logger, "c_utils_map_add: 'Was unable to add key-value pair ('%s': '%s')!'");
-	
+	set_field(mapped_fields, field, value);
 }
 
 static void parse_http_method(struct c_utils_request *req, const char *line) {
@@ -270,8 +352,7 @@ struct c_utils_response *c_utils_response_create(void) {
 	C_UTILS_ON_BAD_CALLOC(res, logger, sizeof(*res))
 		goto err;
 	
-	// Synchronized Map
-	res->header = c_utils_map_create(bucket_size, true);
+	res->header = create_header();
 	if (!res->header) {
 		C_UTILS_LOG_ERROR(logger, "c_utils_map_create: 'Was unable to create Hash Table!'");
 		goto err_header;
@@ -290,8 +371,7 @@ struct c_utils_request *c_utils_request_create(void) {
 	C_UTILS_ON_BAD_CALLOC(req, logger, sizeof(*req))
 		goto err;
 	
-	// Synchronized Map
-	req->header = c_utils_map_create(bucket_size, true);
+	req->header = create_header();
 	if (!req->header) {
 		C_UTILS_LOG_ERROR(logger, "c_utils_map_create: 'Was unable to create Hash Table!'");
 		goto err_header;
@@ -340,11 +420,7 @@ char *c_utils_request_append(struct c_utils_request *req, const char *header, si
 bool c_utils_response_clear(struct c_utils_response *res) {
 	C_UTILS_ARG_CHECK(logger, false, res);
 	
-	bool header_cleared = c_utils_map_clear(res->header, free);
-	if (!header_cleared) {
-		C_UTILS_LOG_ERROR(logger, "c_utils_map_clear: 'Was unable to clear hash map!'");
-		return false;
-	}
+	c_utils_map_delete_all(res->header);
 	
 	res->version = C_UTILS_HTTP_NO_VER;
 	res->status = 0;
@@ -356,11 +432,7 @@ bool c_utils_response_clear(struct c_utils_response *res) {
 bool c_utils_request_clear(struct c_utils_request *req) {
 	C_UTILS_ARG_CHECK(logger, false, req);
 	
-	bool header_cleared = c_utils_map_clear(req->header, free);
-	if (!header_cleared) {
-		C_UTILS_LOG_ERROR(logger, "c_utils_map_clear: 'Was unable to clear hash map!'");
-		return false;
-	}
+	c_utils_map_delete_all(req->header);
 	
 	req->version = C_UTILS_HTTP_NO_VER;
 	req->method = C_UTILS_HTTP_NO_METHOD;
@@ -381,7 +453,7 @@ char *c_utils_response_to_string(struct c_utils_response *res) {
 	C_UTILS_ON_BAD_CALLOC(buf, logger, C_UTILS_HTTP_HEADER_LEN + 1)
 		goto err_buf;
 
-	size_t size, i = 0, size_left = C_UTILS_HTTP_HEADER_LEN + 1;
+	size_t size_left = C_UTILS_HTTP_HEADER_LEN + 1;
 	
 	const char *status = (res->status > 509) ? NULL : C_UTILS_HTTP_Status_Codes[res->status];
 	if (!status) {
@@ -395,22 +467,16 @@ char *c_utils_response_to_string(struct c_utils_response *res) {
 		goto err_bad_version;
 	}
 
-	size_t retval = snprintf(buf, size_left, "%s %s\r\n", version, status);
-	size_left -= retval;
-	
-	char **arr = c_utils_map_key_value_to_string(res->header, NULL, ": ", NULL, &size, NULL);
-	for (; i < size; i++) {
-		// Length of the mapped value plus 2 bytes for carriage return.
-		size_t str_len = strlen(arr[i]) + 2;
-		if (size_left < str_len) 
-			break;
-		
-		snprintf(buf, size_left, "%s%s\r\n", buf, arr[i]);
-		free(arr[i]);
-		size_left -= str_len;
+	// Room is kept for the blank line which ends the header.
+	size_left -= 2;
+	size_t offset = snprintf(buf, size_left, "%s %s\r\n", version, status);
+	if (offset >= size_left) {
+		C_UTILS_LOG_INFO(logger, "Header is too long!");
+		goto err_too_long;
 	}
-	sprintf(buf, "%s\r\n\r\n", buf);
-	free(arr);
+	
+	offset += fields_to_string(res->header, buf + offset, size_left - offset);
+	strcpy(buf + offset, "\r\n");
 
 	C_UTILS_ON_BAD_REALLOC(&buf, logger, (strlen(buf) + 1))
 		goto err_buf_resize;
@@ -418,6 +484,7 @@ char *c_utils_response_to_string(struct c_utils_response *res) {
 	return buf;
 
 	err_buf_resize:
+	err_too_long:
 	err_bad_version:
 	err_bad_status:
 		free(buf);
@@ -432,7 +499,7 @@ char *c_utils_request_to_string(struct c_utils_request *req) {
 	C_UTILS_ON_BAD_CALLOC(buf, logger, C_UTILS_HTTP_HEADER_LEN + 1)
 		goto err_buf;
 	
-	size_t size, i = 0, size_left = C_UTILS_HTTP_HEADER_LEN + 1;
+	size_t size_left = C_UTILS_HTTP_HEADER_LEN + 1;
 	
 	char *method = http_method_to_string(req->method);
 	if (!method) {
@@ -451,21 +518,16 @@ char *c_utils_request_to_string(struct c_utils_request *req) {
 		goto err_bad_version;
 	}
 	
-	size_t retval = snprintf(buf, size_left, "%s %s %s\r\n", method, req->path, version);
-	size_left -= retval;
-	
-	char **arr = c_utils_map_key_value_to_string(req->header, NULL, ": ", NULL, &size, NULL);
-	for (; i < size; i++) {
-		// Length of the mapped value plus 2 bytes for carriage return.
-		size_t str_len = strlen(arr[i]) + 2;
-		if (size_left < str_len) break;
-		
-		snprintf(buf, size_left, "%s%s\r\n", buf, arr[i]);
-		free(arr[i]);
-		size_left -= str_len;
+	// Room is kept for the blank line which ends the header.
+	size_left -= 2;
+	size_t offset = snprintf(buf, size_left, "%s %s %s\r\n", method, req->path, version);
+	if (offset >= size_left) {
+		C_UTILS_LOG_INFO(logger, "Header is too long!");
+		goto err_too_long;
 	}
-	sprintf(buf, "%s\r\n\r\n", buf);
-	free(arr);
+	
+	offset += fields_to_string(req->header, buf + offset, size_left - offset);
+	strcpy(buf + offset, "\r\n");
 	
 	C_UTILS_ON_BAD_REALLOC(&buf, logger, (strlen(buf) + 1))
 		goto err_buf_resize;
@@ -473,6 +535,7 @@ char *c_utils_request_to_string(struct c_utils_request *req) {
 	return buf;
 
 	err_buf_resize:
+	err_too_long:
 	err_bad_version:
 	err_bad_path:
 	err_bad_method:
@@ -484,31 +547,25 @@ char *c_utils_request_to_string(struct c_utils_request *req) {
 bool c_utils_response_set_field(struct c_utils_response *res, char *field, char *values) {
 	C_UTILS_ARG_CHECK(logger, false, res, field, values);
 
-	c_utils_map_remove(res->header, field, free);
-	c_utils_map_add(res->header, field, values);
-	return true;
+	return set_field(res->header, field, values);
 }
 
 bool c_utils_request_set_field(struct c_utils_request *req, char *field, char *values) {
 	C_UTILS_ARG_CHECK(logger, false, req, field, values);
 
-	c_utils_map_remove(req->header, field, free);
-	c_utils_map_add(req->header, field, values);
-	return true;
+	return set_field(req->header, field, values);
 }
 
 bool c_utils_response_remove_field(struct c_utils_response *res, const char *field) {
 	C_UTILS_ARG_CHECK(logger, false, res, field);
 
-	c_utils_map_remove(res->header, field, free);
-	return true;
+	return c_utils_map_delete(res->header, field);
 }
 
 bool c_utils_request_remove_field(struct c_utils_request *req, const char *field) {
 	C_UTILS_ARG_CHECK(logger, false, req, field);
 
-	c_utils_map_remove(req->header, field, free);
-	return true;
+	return c_utils_map_delete(req->header, field);
 }
 
 char *c_utils_response_get_field(struct c_utils_response *res, const char *field) {
@@ -123,6 +123,13 @@ typedef enum c_utils_http_version http_version_e;
 #define C_UTILS_HTTP_HEADER_LEN 4096
 #endif
 
+/// Distinct header field names interned before unknown ones are dropped.
+#ifdef C_UTILS_HTTP_HEADER_FIELD_MAX_NAMES
+#define C_UTILS_HTTP_HEADER_FIELD_NAMES C_UTILS_HTTP_HEADER_FIELD_MAX_NAMES
+#else
+#define C_UTILS_HTTP_HEADER_FIELD_NAMES 1024
+#endif
+
 // TODO: Make Field Values case-insensitive!
 
 /**
@@ -0,0 +1,95 @@
+#define NO_C_UTILS_PREFIX
+#include "../intern.h"
+#include "../../io/logger.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+static struct c_utils_logger *logger = NULL;
+static const int num_strings = 10000;
+static const int num_threads = 4;
+static const char *canonical[10000];
+
+static void *intern_all(void *pool) {
+	char str[32];
+
+	// Each thread starts at a different offset, so that they race to intern different strings first.
+	for (int round = 0; round < 4; round++)
+		for (int j = 0; j < num_strings; j++) {
+			int i = (j + (uintptr_t) pthread_self()) % num_strings;
+			snprintf(str, sizeof(str), "string-%d", i);
+
+			const char *interned = intern_string(pool, str);
+			ASSERT((interned && strcmp(interned, str) == 0), logger, "c_utils_intern_string: \"Wrong canonical copy of %s!\"", str);
+
+			const char *expected = __atomic_load_n(canonical + i, __ATOMIC_RELAXED);
+			if (!expected && __atomic_compare_exchange_n(canonical + i, &expected, interned, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				continue;
+
+			ASSERT((expected == interned), logger, "c_utils_intern_string: \"Two canonical copies of %s!\"", str);
+		}
+
+	return NULL;
+}
+
+static void test_pool(intern_conf_t *conf) {
+	intern_t *pool = intern_create_conf(conf);
+	ASSERT(pool, logger, "c_utils_intern_create: \"Was unable to create pool!\"");
+
+	char buffer[] = "Content-Type";
+	const char *first = intern_string(pool, "Content-Type");
+	ASSERT((first && first != buffer && strcmp(first, buffer) == 0), logger, "c_utils_intern_string: \"Bad canonical copy!\"");
+	ASSERT((intern_string(pool, buffer) == first), logger, "c_utils_intern_string: \"Equal strings were given different copies!\"");
+	ASSERT((intern_string_n(pool, "Content-Type: text/html", 12) == first), logger, "c_utils_intern_string_n: \"Prefix was given a different copy!\"");
+	ASSERT((intern_find(pool, buffer) == first && !intern_find(pool, "Content-Length")), logger, "c_utils_intern_find: \"Wrong result!\"");
+
+	const char *html = intern_string_n(pool, "Content-Type: text/html", 4);
+	ASSERT((html && strcmp(html, "Cont") == 0 && html != first), logger, "c_utils_intern_string_n: \"Bad copy of prefix!\"");
+
+	// Larger than a quarter of a block, so it is given one of it's own.
+	size_t large_len = conf->block_size;
+	char *large = malloc(large_len + 1);
+	memset(large, 'x', large_len);
+	large[large_len] = '\0';
+	const char *large_copy = intern_string_n(pool, large, large_len);
+	ASSERT((large_copy && strcmp(large_copy, large) == 0 && intern_string(pool, large) == large_copy), logger, "c_utils_intern_string: \"Bad copy of large string!\"");
+	free(large);
+
+	memset(canonical, 0, sizeof(canonical));
+	int threads = conf->flags & INTERN_CONCURRENT ? num_threads : 1;
+	pthread_t tids[threads];
+	for (int i = 0; i < threads; i++)
+		pthread_create(tids + i, NULL, intern_all, pool);
+
+	for (int i = 0; i < threads; i++)
+		pthread_join(tids[i], NULL);
+
+	ASSERT((intern_size(pool) == (size_t)num_strings + 3), logger, "c_utils_intern_size: \"Expected %d strings, but found %zu!\"", num_strings + 3, intern_size(pool));
+
+	intern_destroy(pool);
+}
+
+int main(void) {
+	logger = logger_create("./string/Logs/intern_test.log", "w", LOG_LEVEL_ALL);
+	assert(logger);
+
+	LOG_INFO(logger, "Testing single-threaded pool...");
+	intern_conf_t conf = { .block_size = 1024, .logger = logger };
+	test_pool(&conf);
+
+	LOG_INFO(logger, "Testing concurrent pool with %d threads...", num_threads);
+	conf.flags = INTERN_CONCURRENT;
+	test_pool(&conf);
+
+	LOG_INFO(logger, "Testing concurrent pool with thread caches...");
+	conf.flags = INTERN_CONCURRENT | INTERN_THREAD_CACHE;
+	conf.cache_size = 64;
+	test_pool(&conf);
+
+	LOG_INFO(logger, "All tests passed!");
+	logger_destroy(logger);
+
+	return 0;
+}
@@ -0,0 +1,349 @@
+#include "intern.h"
+
+#include "../data_structures/map.h"
+#include "../misc/alloc_check.h"
+#include "../io/logger.h"
+#include "../threading/scoped_lock.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/// Strings no longer than this are copied to the stack to be null-terminated by c_utils_intern_string_n.
+#define C_UTILS_INTERN_STACK_LEN 256
+
+struct c_utils_intern_block {
+	/// The block allocated before this one.
+	struct c_utils_intern_block *next;
+	/// The amount of bytes of data.
+	size_t size;
+	/// The amount of bytes of data handed out.
+	size_t used;
+	char data[];
+};
+
+struct c_utils_intern {
+	/// Map from each string to it's canonical copy, which is also it's key.
+	struct c_utils_map *map;
+	/// The block currently being allocated from, followed by every block before it.
+	struct c_utils_intern_block *blocks;
+	/// Guards the blocks.
+	struct c_utils_scoped_lock *lock;
+	/// Each thread's cache, if C_UTILS_INTERN_THREAD_CACHE is flagged.
+	pthread_key_t cache_key;
+	/// The amount of entries of each cache, minus one.
+	size_t cache_mask;
+	/// Configuration
+	struct c_utils_intern_conf conf;
+};
+
+static const size_t default_block_size = 64 * 1024;
+
+static const size_t default_cache_size = 256;
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Intern Helper Functions                                     //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t hash_string(const void *str);
+
+static void *canonical_value(const void *key);
+
+static void no_op(void *value);
+
+static const char **get_cache(struct c_utils_intern *pool);
+
+static void *arena_alloc(struct c_utils_intern *pool, size_t size, size_t align);
+
+static void arena_unalloc(struct c_utils_intern *pool, void *ptr, size_t size);
+
+static void configure(struct c_utils_intern_conf *conf);
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Intern Core Functions                                       //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+struct c_utils_intern *c_utils_intern_create(void) {
+	struct c_utils_intern_conf conf = { .flags = C_UTILS_INTERN_CONCURRENT | C_UTILS_INTERN_THREAD_CACHE };
+	return c_utils_intern_create_conf(&conf);
+}
+
+struct c_utils_intern *c_utils_intern_create_conf(struct c_utils_intern_conf *conf) {
+	if(!conf)
+		return NULL;
+
+	configure(conf);
+
+	struct c_utils_intern *pool;
+	C_UTILS_ON_BAD_CALLOC(pool, conf->logger, sizeof(*pool))
+		goto err;
+
+	// The canonical copies are never freed until the pool is, so optimistic readers may always compare against them.
+	struct c_utils_map_conf map_conf =
+	{
+		.flags = conf->flags & C_UTILS_INTERN_CONCURRENT ? C_UTILS_MAP_SHARDED | C_UTILS_MAP_OPTIMISTIC_READ : 0,
+		.callbacks =
+		{
+			.destructors.value = no_op,
+			.hash_function = hash_string
+		},
+		.logger = conf->logger
+	};
+
+	pool->map = c_utils_map_create_conf(&map_conf);
+	if(!pool->map) {
+		C_UTILS_LOG_ERROR(conf->logger, "Was unable to create the map!");
+		goto err_map;
+	}
+
+	pool->lock = conf->flags & C_UTILS_INTERN_CONCURRENT ? c_utils_scoped_lock_spinlock(0, conf->logger) : c_utils_scoped_lock_no_op();
+	if(!pool->lock) {
+		C_UTILS_LOG_ERROR(conf->logger, "Was unable to create the scoped_lock!");
+		goto err_lock;
+	}
+
+	if(conf->flags & C_UTILS_INTERN_THREAD_CACHE) {
+		int failure = pthread_key_create(&pool->cache_key, NULL);
+		if(failure) {
+			C_UTILS_LOG_ERROR(conf->logger, "pthread_key_create: \"%s\"", strerror(failure));
+			goto err_key;
+		}
+
+		size_t size = 1;
+		while(size < conf->cache_size)
+			size <<= 1;
+
+		pool->cache_mask = size - 1;
+	}
+
+	pool->conf = *conf;
+
+	return pool;
+
+	err_key:
+		c_utils_scoped_lock_destroy(pool->lock);
+	err_lock:
+		c_utils_map_destroy(pool->map);
+	err_map:
+		free(pool);
+	err:
+		return NULL;
+}
+
+const char *c_utils_intern_string(struct c_utils_intern *pool, const char *str) {
+	if(!pool)
+		return NULL;
+
+	if(!str) {
+		C_UTILS_LOG_ERROR(pool->conf.logger, "Can not intern a NULL string!");
+		return NULL;
+	}
+
+	const char **cache = NULL, **entry = NULL;
+	if(pool->conf.flags & C_UTILS_INTERN_THREAD_CACHE && (cache = get_cache(pool))) {
+		entry = cache + (hash_string(str) & pool->cache_mask);
+		if(*entry && strcmp(*entry, str) == 0)
+			return *entry;
+	}
+
+	const char *canonical = c_utils_map_get(pool->map, str);
+	if(!canonical) {
+		size_t size = strlen(str) + 1;
+		char *copy = arena_alloc(pool, size, 1);
+		if(!copy)
+			return NULL;
+
+		memcpy(copy, str, size);
+
+		// Another thread may have interned the same string in the meantime, in which case theirs is canonical.
+		bool added;
+		canonical = c_utils_map_compute_if_absent(pool->map, copy, canonical_value, &added);
+		if(!added)
+			arena_unalloc(pool, copy, size);
+
+		if(!canonical)
+			return NULL;
+	}
+
+	if(entry)
+		*entry = canonical;
+
+	return canonical;
+}
+
+const char *c_utils_intern_string_n(struct c_utils_intern *pool, const char *str, size_t len) {
+	if(!pool)
+		return NULL;
+
+	if(!str) {
+		C_UTILS_LOG_ERROR(pool->conf.logger, "Can not intern a NULL string!");
+		return NULL;
+	}
+
+	char stack[C_UTILS_INTERN_STACK_LEN + 1], *terminated = stack;
+	if(len > C_UTILS_INTERN_STACK_LEN)
+		C_UTILS_ON_BAD_MALLOC(terminated, pool->conf.logger, len + 1)
+			return NULL;
+
+	memcpy(terminated, str, len);
+	terminated[len] = '\0';
+
+	const char *canonical = c_utils_intern_string(pool, terminated);
+
+	if(terminated != stack)
+		free(terminated);
+
+	return canonical;
+}
+
+const char *c_utils_intern_find(struct c_utils_intern *pool, const char *str) {
+	if(!pool || !str)
+		return NULL;
+
+	if(pool->conf.flags & C_UTILS_INTERN_THREAD_CACHE) {
+		const char **cache = get_cache(pool);
+		const char *entry = cache ? cache[hash_string(str) & pool->cache_mask] : NULL;
+		if(entry && strcmp(entry, str) == 0)
+			return entry;
+	}
+
+	return c_utils_map_get(pool->map, str);
+}
+
+size_t c_utils_intern_size(struct c_utils_intern *pool) {
+	if(!pool)
+		return 0;
+
+	return c_utils_map_size(pool->map);
+}
+
+void c_utils_intern_destroy(struct c_utils_intern *pool) {
+	if(!pool)
+		return;
+
+	c_utils_map_destroy(pool->map);
+
+	struct c_utils_intern_block *block = pool->blocks;
+	while(block) {
+		struct c_utils_intern_block *next = block->next;
+		free(block);
+		block = next;
+	}
+
+	if(pool->conf.flags & C_UTILS_INTERN_THREAD_CACHE)
+		pthread_key_delete(pool->cache_key);
+
+	c_utils_scoped_lock_destroy(pool->lock);
+	free(pool);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+//	 																				//
+//						Intern Helper Functions                                     //
+//  																				//
+//////////////////////////////////////////////////////////////////////////////////////
+
+/// FNV-1a, which is cheap for the short strings which are usually interned.
+static uint32_t hash_string(const void *str) {
+	uint32_t hash = 2166136261u;
+
+	for(const unsigned char *c = str; *c; c++) {
+		hash ^= *c;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/// The canonical copy is both the key and the value of it's pair.
+static void *canonical_value(const void *key) {
+	return (void *) key;
+}
+
+static void no_op(void *value) {}
+
+/// Returns the calling thread's cache, allocating it from the arena the first time, or NULL if that fails.
+static const char **get_cache(struct c_utils_intern *pool) {
+	const char **cache = pthread_getspecific(pool->cache_key);
+	if(cache)
+		return cache;
+
+	size_t size = (pool->cache_mask + 1) * sizeof(*cache);
+	cache = arena_alloc(pool, size, _Alignof(const char *));
+	if(!cache)
+		return NULL;
+
+	memset(cache, 0, size);
+	pthread_setspecific(pool->cache_key, cache);
+
+	return cache;
+}
+
+/*
+	Bump allocates from the current block, starting a new one when it runs out. A large allocation is given
+	a block of it's own behind the current one, so the rest of the current block is not wasted.
+*/
+static void *arena_alloc(struct c_utils_intern *pool, size_t size, size_t align) {
+	C_UTILS_SCOPED_LOCK(pool->lock) {
+		struct c_utils_intern_block *block = pool->blocks;
+
+		if(block) {
+			size_t offset = (block->used + align - 1) & ~(align - 1);
+			if(offset + size <= block->size) {
+				block->used = offset + size;
+				return block->data + offset;
+			}
+		}
+
+		bool dedicated = size > pool->conf.block_size / 4;
+		size_t block_size = dedicated ? size : pool->conf.block_size;
+
+		struct c_utils_intern_block *new_block;
+		C_UTILS_ON_BAD_MALLOC(new_block, pool->conf.logger, sizeof(*new_block) + block_size)
+			return NULL;
+
+		new_block->size = block_size;
+		new_block->used = size;
+
+		if(dedicated && block) {
+			new_block->next = block->next;
+			block->next = new_block;
+		} else {
+			new_block->next = block;
+			pool->blocks = new_block;
+		}
+
+		return new_block->data;
+	}
+
+	C_UTILS_UNACCESSIBLE;
+}
+
+/// Returns the allocation to the arena, which is only possible if it was the last one from the current block.
+static void arena_unalloc(struct c_utils_intern *pool, void *ptr, size_t size) {
+	C_UTILS_SCOPED_LOCK(pool->lock) {
+		struct c_utils_intern_block *block = pool->blocks;
+
+		if(block && (char *) ptr + size == block->data + block->used)
+			block->used -= size;
+	}
+}
+
+static void configure(struct c_utils_intern_conf *conf) {
+	if(!conf->block_size)
+		conf->block_size = default_block_size;
+
+	if(conf->flags & C_UTILS_INTERN_THREAD_CACHE && !conf->cache_size)
+		conf->cache_size = default_cache_size;
+}
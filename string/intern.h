@@ -0,0 +1,141 @@
+#ifndef C_UTILS_INTERN_H
+#define C_UTILS_INTERN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../io/logger.h"
+
+/*
+	A string interning pool, which returns a single canonical copy of each distinct string, so that interned
+	strings may be compared by their address, and duplicates take up no more memory than the first.
+
+	Canonical copies are bump allocated from large blocks (an arena), and are never freed until the pool is
+	destroyed, hence a canonical pointer remains valid for the lifetime of the pool. The pool maps each string to
+	it's canonical copy with a c_utils_map, so interning a string which is already present is a single lookup,
+	which when concurrent takes no lock at all.
+
+	A per-thread front cache may also be enabled, which remembers the most recent canonical copy for each of a
+	fixed amount of hash buckets, so that a thread which repeatedly interns the same few strings (such as the
+	names of HTTP header fields) only hashes and compares them, without touching the shared map.
+*/
+struct c_utils_intern;
+
+#define C_UTILS_INTERN_CONCURRENT 1 << 0
+#define C_UTILS_INTERN_THREAD_CACHE 1 << 1
+
+/*
+	concurrent:
+		default:
+			false
+		note:
+			Backs the pool with a sharded map with optimistic reads, so lookups are lock-free and inserts of
+			new strings only contend on their shard, and the arena on a short critical section. If this is not
+			specified, any concurrent access will yield undefined behavior.
+	thread_cache:
+		default:
+			false
+		note:
+			Gives each thread it's own direct-mapped cache of recently interned strings. The caches are
+			allocated from the arena, and so are only freed when the pool is destroyed.
+	block_size:
+		default:
+			64KB
+		note:
+			The size of each block of the arena. Strings larger than a quarter of a block are given a block of
+			their own, so that they do not waste the rest of the current one.
+	cache_size:
+		default:
+			256
+		note:
+			The amount of entries in each thread's cache, rounded up to a power of two. Relevant only when
+			C_UTILS_INTERN_THREAD_CACHE is flagged.
+*/
+struct c_utils_intern_conf {
+	/// Configuration flags
+	int flags;
+	size_t block_size;
+	size_t cache_size;
+	/// Logger
+	struct c_utils_logger *logger;
+};
+
+#ifdef NO_C_UTILS_PREFIX
+/*
+	Typedefs
+*/
+typedef struct c_utils_intern intern_t;
+typedef struct c_utils_intern_conf intern_conf_t;
+
+/*
+	Macros
+*/
+#define INTERN_CONCURRENT C_UTILS_INTERN_CONCURRENT
+#define INTERN_THREAD_CACHE C_UTILS_INTERN_THREAD_CACHE
+
+/*
+	Functions
+*/
+#define intern_create(...) c_utils_intern_create(__VA_ARGS__)
+#define intern_create_conf(...) c_utils_intern_create_conf(__VA_ARGS__)
+#define intern_string(...) c_utils_intern_string(__VA_ARGS__)
+#define intern_string_n(...) c_utils_intern_string_n(__VA_ARGS__)
+#define intern_find(...) c_utils_intern_find(__VA_ARGS__)
+#define intern_size(...) c_utils_intern_size(__VA_ARGS__)
+#define intern_destroy(...) c_utils_intern_destroy(__VA_ARGS__)
+#endif
+
+/**
+ * Creates a pool which is concurrent, with a cache per thread.
+ *
+ * @return Instance, or NULL if an allocation error occurs.
+ */
+struct c_utils_intern *c_utils_intern_create(void);
+
+struct c_utils_intern *c_utils_intern_create_conf(struct c_utils_intern_conf *conf);
+
+/**
+ * Returns the canonical copy of the string, copying it into the pool if this is the first time it was seen.
+ *
+ * Lock-Free: Concurrent, Is Thread Safe, so long as the string is already present.
+ * @param pool Instance.
+ * @param str String, which remains the caller's.
+ * @return The canonical copy, valid until the pool is destroyed, or NULL if an allocation error occurs.
+ */
+const char *c_utils_intern_string(struct c_utils_intern *pool, const char *str);
+
+/**
+ * As c_utils_intern_string, for the first len characters of str, which need not be null-terminated.
+ * Useful for interning a token in place without first copying it out.
+ *
+ * @param pool Instance.
+ * @param str Start of the string.
+ * @param len Length of the string.
+ * @return The canonical copy, which is null-terminated, or NULL if an allocation error occurs.
+ */
+const char *c_utils_intern_string_n(struct c_utils_intern *pool, const char *str, size_t len);
+
+/**
+ * Returns the canonical copy of the string if it has been interned, without interning it otherwise.
+ *
+ * Lock-Free: Concurrent, Is Thread Safe.
+ * @param pool Instance.
+ * @param str String.
+ * @return The canonical copy, or NULL if not present.
+ */
+const char *c_utils_intern_find(struct c_utils_intern *pool, const char *str);
+
+/**
+ * @param pool Instance.
+ * @return The amount of distinct strings interned.
+ */
+size_t c_utils_intern_size(struct c_utils_intern *pool);
+
+/**
+ * Destroys the pool, and with it every canonical copy it has handed out.
+ *
+ * @param pool Instance.
+ */
+void c_utils_intern_destroy(struct c_utils_intern *pool);
+
+#endif /* C_UTILS_INTERN_H */
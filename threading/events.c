@@ -176,6 +176,7 @@ void c_utils_event_destroy(struct c_utils_event *event) {
 	}
 
 	destroy_event(event);
+	free(event);
 }
 
 
@@ -202,8 +203,6 @@ static void destroy_event(void *instance) {
 	pthread_cond_destroy(&event->signal);
 	
 	C_UTILS_LOG_EVENT(event->conf.logger, event->conf.name, "Finished...");
-
-	free(event);
 }
 
 static void auto_reset_handler(struct c_utils_event *event) {
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdatomic.h>
 #include <semaphore.h>
+#include <sched.h>
 #include <string.h>
 #include <errno.h>
 
@@ -298,4 +299,128 @@ struct c_utils_scoped_lock *c_utils_scoped_lock_rwlock_from(pthread_rwlock_t *lo
    s_lock->logger = logger;
 
    return s_lock;
-}
\ No newline at end of file
+}
+
+/*
+   SeqLock
+
+   Writers serialize on the rwlock, and make the sequence odd for as long as they hold it. Hence a reader
+   which sees the same even sequence before and after reading knows no writer intervened. Readers which
+   would rather block than retry may still take the rwlock's read lock.
+*/
+
+struct c_utils_seqlock {
+   pthread_rwlock_t rwlock;
+   atomic_size_t sequence;
+   // Only ever true while a writer holds the lock, so readers releasing the lock never see it set.
+   bool writing;
+};
+
+static void _destroy_scoped_lock_seqlock(struct c_utils_scoped_lock *s_lock) {
+   struct c_utils_seqlock *lock = s_lock->lock;
+   int errcode = pthread_rwlock_destroy(&lock->rwlock);
+   if (errcode)
+      C_UTILS_LOG_ERROR(s_lock->logger, "pthread_rwlock_destroy: \"%s\"", strerror(errcode));
+
+   free(lock);
+}
+
+static void *_acquire_scoped_lock_seqlock_write(struct c_utils_scoped_lock *s_lock, struct c_utils_scoped_lock_log_info info) {
+   struct c_utils_seqlock *lock = s_lock->lock;
+   int errcode = pthread_rwlock_wrlock(&lock->rwlock);
+   if (errcode) {
+      C_UTILS_LOG_LOCK_FAILURE(s_lock->logger, info, "pthread_rwlock_wrlock: \"%s\"", strerror(errcode));
+      exit(EXIT_FAILURE);
+   } else {
+      C_UTILS_LOG_LOCK(s_lock, C_UTILS_LOG_LEVEL_TRACE, "Obtained lock...");
+      s_lock->log_info = info;
+   }
+
+   // A full barrier, so that the odd sequence is visible before anything we write, or any hazard pointer we scan.
+   atomic_fetch_add(&lock->sequence, 1);
+   lock->writing = true;
+
+   return s_lock;
+}
+
+static void *_acquire_scoped_lock_seqlock_read(struct c_utils_scoped_lock *s_lock, struct c_utils_scoped_lock_log_info info) {
+   struct c_utils_seqlock *lock = s_lock->lock;
+   int errcode = pthread_rwlock_rdlock(&lock->rwlock);
+   if (errcode) {
+      C_UTILS_LOG_LOCK_FAILURE(s_lock->logger, info, "pthread_rwlock_rdlock: \"%s\"", strerror(errcode));
+      exit(EXIT_FAILURE);
+   } else {
+      C_UTILS_LOG_LOCK(s_lock, C_UTILS_LOG_LEVEL_TRACE, "Obtained lock...");
+      s_lock->log_info = info;
+   }
+
+   return s_lock;
+}
+
+static void _release_scoped_lock_seqlock(struct c_utils_scoped_lock *s_lock) {
+   struct c_utils_seqlock *lock = s_lock->lock;
+   C_UTILS_LOG_LOCK(s_lock, C_UTILS_LOG_LEVEL_TRACE, "Releasing lock...");
+
+   if (lock->writing) {
+      lock->writing = false;
+      atomic_fetch_add_explicit(&lock->sequence, 1, memory_order_release);
+   }
+
+   int errcode = pthread_rwlock_unlock(&lock->rwlock);
+   if (errcode)
+      C_UTILS_LOG_LOCK(s_lock, C_UTILS_LOG_LEVEL_ERROR, "pthread_rwlock_unlock: \"%s\"", strerror(errcode));
+}
+
+struct c_utils_scoped_lock *c_utils_scoped_lock_seqlock(pthread_rwlockattr_t *attr, struct c_utils_logger *logger) {
+   struct c_utils_seqlock *lock;
+   C_UTILS_ON_BAD_CALLOC(lock, logger, sizeof(*lock))
+      goto err;
+
+   int failure = pthread_rwlock_init(&lock->rwlock, attr);
+   if (failure) {
+      C_UTILS_LOG_ERROR(logger, "pthread_rwlock_init: \"%s\"", strerror(failure));
+      goto err_lock_init;
+   }
+
+   atomic_init(&lock->sequence, 0);
+
+   struct c_utils_scoped_lock *s_lock;
+   C_UTILS_ON_BAD_CALLOC(s_lock, logger, sizeof(*s_lock))
+      goto err_s_lock;
+
+   s_lock->lock = lock;
+   s_lock->dispose = _destroy_scoped_lock_seqlock;
+   s_lock->acquire0 = _acquire_scoped_lock_seqlock_write;
+   s_lock->acquire1 = _acquire_scoped_lock_seqlock_read;
+   s_lock->release = _release_scoped_lock_seqlock;
+   s_lock->logger = logger;
+
+   return s_lock;
+
+   err_s_lock:
+      pthread_rwlock_destroy(&lock->rwlock);
+   err_lock_init:
+      free(lock);
+   err:
+      return NULL;
+}
+
+size_t c_utils_scoped_lock_seqlock_read_begin(struct c_utils_scoped_lock *s_lock) {
+   struct c_utils_seqlock *lock = s_lock->lock;
+   size_t sequence;
+
+   // An odd sequence means a writer is in progress, and anything we read would have to be retried anyway.
+   while ((sequence = atomic_load_explicit(&lock->sequence, memory_order_acquire)) & 1)
+      sched_yield();
+
+   return sequence;
+}
+
+bool c_utils_scoped_lock_seqlock_read_retry(struct c_utils_scoped_lock *s_lock, size_t sequence) {
+   struct c_utils_seqlock *lock = s_lock->lock;
+
+   // Our reads must complete before we check the sequence again.
+   atomic_thread_fence(memory_order_acquire);
+
+   return atomic_load_explicit(&lock->sequence, memory_order_relaxed) != sequence;
+}
@@ -3,6 +3,7 @@
 
 #include <pthread.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "../io/logger.h"
 
 struct c_utils_scoped_lock_log_info {
@@ -54,6 +55,9 @@ typedef struct c_utils_scoped_lock scoped_lock_t;
 #define scoped_lock_rwlock(...) c_utils_scoped_lock_rwlock(__VA_ARGS__)
 #define scoped_lock_rwlock_from(...) c_utils_scoped_lock_rwlock_from(__VA_ARGS__)
 #define scoped_lock_no_op(...) c_utils_scoped_lock_no_op(__VA_ARGS__)
+#define scoped_lock_seqlock(...) c_utils_scoped_lock_seqlock(__VA_ARGS__)
+#define scoped_lock_seqlock_read_begin(...) c_utils_scoped_lock_seqlock_read_begin(__VA_ARGS__)
+#define scoped_lock_seqlock_read_retry(...) c_utils_scoped_lock_seqlock_read_retry(__VA_ARGS__)
 #endif
 
 
@@ -71,6 +75,20 @@ struct c_utils_scoped_lock *c_utils_scoped_lock_rwlock(pthread_rwlockattr_t *att
 
 struct c_utils_scoped_lock *c_utils_scoped_lock_no_op();
 
+/**
+* A rwlock which also maintains a sequence counter, made odd for as long as a writer holds
+* the lock. Writers and blocking readers use it like a rwlock, while optimistic readers take
+* no lock at all: they read the sequence with c_utils_scoped_lock_seqlock_read_begin, read
+* the protected data, and must discard what they read and try again if
+* c_utils_scoped_lock_seqlock_read_retry returns true. As the data may change underneath
+* an optimistic reader, it must never follow a pointer which a writer may have freed.
+*/
+struct c_utils_scoped_lock *c_utils_scoped_lock_seqlock(pthread_rwlockattr_t *attr, struct c_utils_logger *logger);
+
+size_t c_utils_scoped_lock_seqlock_read_begin(struct c_utils_scoped_lock *lock);
+
+bool c_utils_scoped_lock_seqlock_read_retry(struct c_utils_scoped_lock *lock, size_t sequence);
+
 /**
 * Called to automatically unlock the passed c_utils_scoped_lock instance
 * once it leaves the scope. This function gets called by the GCC or
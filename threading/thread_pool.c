@@ -119,6 +119,8 @@ struct c_utils_thread_pool *c_utils_thread_pool_create_conf(struct c_utils_threa
 
 	tp->thread_count = ATOMIC_VAR_INIT(0);
 	tp->active_threads = ATOMIC_VAR_INIT(0);
+	tp->flags = 0;
+	tp->conf = *conf;
 
 	struct c_utils_blocking_queue_conf bq_conf =
 	{
@@ -262,7 +264,18 @@ struct c_utils_result *c_utils_thread_pool_add_for_result(struct c_utils_thread_
 	C_UTILS_ON_BAD_CALLOC(result, tp->conf.logger, sizeof(*result))
 		goto err_result;
 
-	result->is_ready = c_utils_event_create(result_event_name, tp->conf.logger, 0);
+	/*
+		The event is reference counted, as the caller may destroy the result as soon as it is signaled, while the
+		thread which signaled it has yet to return from doing so. The task holds a reference of it's own until then.
+	*/
+	struct c_utils_event_conf event_conf =
+	{
+		.name = result_event_name,
+		.logger = tp->conf.logger,
+		.flags = C_UTILS_EVENT_RC_INSTANCE
+	};
+
+	result->is_ready = c_utils_event_create_conf(&event_conf);
 	if (!result->is_ready) {
 		C_UTILS_LOG_ERROR(tp->conf.logger, "c_utils_event_create: 'Was unable to create event: %s!'", result_event_name);
 		goto err_result_ready;
@@ -275,6 +288,7 @@ struct c_utils_result *c_utils_thread_pool_add_for_result(struct c_utils_thread_
 	thread_task->args = args;
 	thread_task->priority = priority;
 	thread_task->result = result;
+	C_UTILS_REF_INC(result->is_ready);
 
 	C_UTILS_SCOPED_LOCK(tp->plock) {
 		if(tp->flags & SHUTDOWN)
@@ -293,7 +307,8 @@ struct c_utils_result *c_utils_thread_pool_add_for_result(struct c_utils_thread_
 
 	err_shutdown:
 	err_enqueue:
-		free(task);
+		c_utils_event_destroy(result->is_ready);
+		free(thread_task);
 	err_task:
 		c_utils_event_destroy(result->is_ready);
 	err_result_ready:
@@ -327,6 +342,13 @@ void *c_utils_result_get(struct c_utils_result *result, long long int timeout) {
 	return c_utils_event_wait_for(result->is_ready, timeout) ? result->retval : NULL;
 }
 
+size_t c_utils_thread_pool_num_threads(struct c_utils_thread_pool *tp) {
+	if(!tp)
+		return 0;
+
+	return atomic_load(&tp->thread_count);
+}
+
 bool c_utils_thread_pool_wait_for(struct c_utils_thread_pool *tp, long long int timeout) {
 	if(!tp)
 		return false;
@@ -413,18 +435,20 @@ static void destroy_thread_pool(void *instance) {
 
 	tp->flags &= ~KEEP_ALIVE;
 
-	// By destroying the PBQueue, it signals to threads waiting to wake up.
+	// By shutting down the PBQueue, it signals to threads waiting to wake up.
+	c_utils_blocking_queue_shutdown(tp->queue);
+	// Then by signaling the resume event, anything waiting on a paused thread pool wakes up.
+	c_utils_event_signal(tp->resume);
+	// Then we wait for all threads to exit gracefully, as one may still be returning from a task and use the queue or events after.
+	while (atomic_load(&tp->thread_count))
+		pthread_yield();
+
 	c_utils_blocking_queue_destroy(tp->queue);
-	// Then by destroying the resume event, anything waiting on a paused thread pool wakes up.
 	c_utils_event_destroy(tp->resume);
-	// Then we wait for all threads to that wake up to exit gracefully.
-	c_utils_thread_pool_wait_for(tp, C_UTILS_THREAD_POOL_NO_TIMEOUT);
 	// Finally, any threads waiting on the thread pool to finish will wake up.
 	c_utils_event_destroy(tp->finished);
 
-	while (atomic_load(&tp->active_threads))   
-		pthread_yield();
-	
+	c_utils_scoped_lock_destroy(tp->plock);
 	free(tp->workers);
 	free(tp);
 }
@@ -513,8 +537,9 @@ static void *get_tasks(void *args) {
 			c_utils_event_signal(tp->finished);
 	}
 
-	atomic_fetch_sub(&tp->thread_count, 1);
+	// Once decremented, the thread pool may be freed, so it must be the last access to it.
 	C_UTILS_LOG_VERBOSE(tp->conf.logger, "A thread exited!\n");
+	atomic_fetch_sub(&tp->thread_count, 1);
 
 	return NULL;
 }
@@ -531,8 +556,11 @@ static void process_task(struct c_utils_thread_task *task) {
 
 	void *retval = task->callback(task->args);
 	if (task->result) {
+		struct c_utils_event *is_ready = task->result->is_ready;
+
 		task->result->retval = retval;
-		c_utils_event_signal(task->result->is_ready);
+		c_utils_event_signal(is_ready);
+		c_utils_event_destroy(is_ready);
 	}
 
 	free(task);
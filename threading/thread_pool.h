@@ -81,6 +81,7 @@ typedef struct c_utils_result result_t;
 #define thread_pool_resume(...) c_utils_thread_pool_resume(__VA_ARGS__)
 #define thread_pool_wait(...) c_utils_thread_pool_wait(__VA_ARGS__)
 #define thread_pool_destroy(...) c_utils_thread_pool_destroy(__VA_ARGS__)
+#define thread_pool_num_threads(...) c_utils_thread_pool_num_threads(__VA_ARGS__)
 #define result_get(...) c_utils_result_get(__VA_ARGS__)
 #define result_destroy(...) c_utils_result_destroy(__VA_ARGS__)
 #endif
@@ -138,6 +139,13 @@ void c_utils_thread_pool_destroy(struct c_utils_thread_pool *tp);
  */
 void *c_utils_result_get(struct c_utils_result *result, long long int timeout);
 
+/**
+ * Obtains the amount of worker threads, such as to split work into a task for each.
+ * @param tp Thread Pool instance.
+ * @return The amount of worker threads, or 0 if tp is NULL.
+ */
+size_t c_utils_thread_pool_num_threads(struct c_utils_thread_pool *tp);
+
 bool c_utils_thread_pool_wait_for(struct c_utils_thread_pool *tp, long long int timeout);
 
 /*